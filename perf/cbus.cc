@@ -0,0 +1,204 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "core/cbus.h"
+#include "core/fiber.h"
+#include "core/memory.h"
+#include "core/say.h"
+#include "core/tweaks.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * This suite contains benchmarks for cbus - the inter-cord message bus.
+ *
+ * Several producer cords push messages to a pipe connected to the same
+ * consumer cord, which runs the cbus delivery loop. The message delivery
+ * function only counts messages, so only the bus itself is exercised.
+ */
+
+/** Name of the consumer endpoint. */
+static constexpr const char *consumer_name = "consumer";
+/** Number of messages pushed by each producer per benchmark iteration. */
+static constexpr int producer_msg_count = 1 << 16;
+/** Max number of producer cords. */
+static constexpr int producer_count_max = 8;
+
+/**
+ * Number of messages delivered to the consumer. Updated by the consumer
+ * cord only.
+ */
+static std::atomic<std::int64_t> delivered;
+
+static void
+consume_f(struct cmsg *msg)
+{
+	(void)msg;
+	delivered.store(delivered.load(std::memory_order_relaxed) + 1,
+			std::memory_order_release);
+}
+
+static const struct cmsg_hop consume_route[] = {
+	{consume_f, nullptr},
+};
+
+/** A producer cord and its messages. */
+struct Producer {
+	struct cord cord;
+	/** Max number of messages flushed to the pipe at once. */
+	int batch_size;
+	std::vector<struct cmsg> msgs;
+};
+
+static int
+producer_f(va_list ap)
+{
+	Producer *producer = va_arg(ap, Producer *);
+	struct cpipe pipe;
+	::cpipe_create(&pipe, consumer_name);
+	::cpipe_set_max_input(&pipe, producer->batch_size);
+	for (struct cmsg &msg : producer->msgs) {
+		::cmsg_init(&msg, consume_route);
+		::cpipe_push_input(&pipe, &msg);
+	}
+	/* Flushes the rest of the input. */
+	::cpipe_destroy(&pipe);
+	return 0;
+}
+
+static int
+consumer_f(va_list ap)
+{
+	(void)ap;
+	struct cbus_endpoint endpoint;
+	::cbus_endpoint_create(&endpoint, consumer_name,
+			       fiber_schedule_cb, fiber());
+	::cbus_loop(&endpoint);
+	::cbus_endpoint_destroy(&endpoint, cbus_process);
+	return 0;
+}
+
+/**
+ * The bus singleton initializes the subsystems cbus depends on and runs
+ * the consumer cord.
+ */
+class Bus final {
+public:
+	Bus(Bus &other) = delete;
+	Bus &operator=(Bus &other) = delete;
+
+	static Bus &
+	instance()
+	{
+		static Bus singleton;
+		return singleton;
+	}
+
+	/** Sets the number of times the consumer polls for messages. */
+	void
+	set_spin_count(std::uint64_t count)
+	{
+		struct tweak_value val;
+		val.type = TWEAK_VALUE_UINT;
+		val.uval = count;
+		if (::tweak_set(spin_count, &val) != 0)
+			panic("failed to set cbus_loop_spin_count");
+	}
+
+	/** Restores the default number of times the consumer spins. */
+	void
+	reset_spin_count()
+	{
+		set_spin_count(spin_count_default);
+	}
+
+private:
+	Bus()
+	{
+		::memory_init();
+		::fiber_init(fiber_c_invoke);
+		::cbus_init();
+		spin_count = ::tweak_find("cbus_loop_spin_count");
+		if (spin_count == nullptr)
+			panic("cbus_loop_spin_count tweak not found");
+		struct tweak_value val;
+		::tweak_get(spin_count, &val);
+		spin_count_default = val.uval;
+		if (::cord_costart(&consumer, consumer_name,
+				   consumer_f, nullptr) != 0)
+			panic("failed to start the consumer cord");
+	}
+
+	~Bus()
+	{
+		reset_spin_count();
+		struct cpipe pipe;
+		::cpipe_create(&pipe, consumer_name);
+		::cbus_stop_loop(&pipe);
+		::cpipe_destroy(&pipe);
+		if (::cord_join(&consumer) != 0)
+			panic("failed to join the consumer cord");
+		::cbus_free();
+		::fiber_free();
+		::memory_free();
+	}
+
+	struct cord consumer;
+	struct tweak *spin_count;
+	std::uint64_t spin_count_default;
+};
+
+/**
+ * Benchmark the throughput of messages pushed by state.range(0) producer
+ * cords in batches of state.range(1) messages each to one consumer.
+ * The consumer spins waiting for new messages unless state.range(2) is 0.
+ */
+static void
+bench_cbus_throughput(benchmark::State &state)
+{
+	Bus &bus = Bus::instance();
+	int producer_count = state.range(0);
+	std::vector<Producer> producers(producer_count);
+	for (Producer &producer : producers) {
+		producer.batch_size = state.range(1);
+		producer.msgs.resize(producer_msg_count);
+	}
+	bool spin = state.range(2) != 0;
+	if (!spin)
+		bus.set_spin_count(0);
+	std::int64_t expected = delivered.load();
+	for (MAYBE_UNUSED auto _ : state) {
+		for (Producer &producer : producers) {
+			if (::cord_costart(&producer.cord, "producer",
+					   producer_f, &producer) != 0)
+				panic("failed to start a producer cord");
+		}
+		for (Producer &producer : producers) {
+			if (::cord_join(&producer.cord) != 0)
+				panic("failed to join a producer cord");
+		}
+		expected += (std::int64_t)producer_count * producer_msg_count;
+		while (delivered.load(std::memory_order_acquire) < expected)
+			std::this_thread::yield();
+	}
+	if (!spin)
+		bus.reset_spin_count();
+	state.SetItemsProcessed(state.iterations() * producer_count *
+				producer_msg_count);
+}
+
+BENCHMARK(bench_cbus_throughput)
+	->ArgsProduct({
+		benchmark::CreateRange(1, producer_count_max, /*multi=*/2),
+		{1, 64, 1024},
+		{0, 1},
+	})
+	->ArgNames({"producers", "batch", "spin"})
+	->UseRealTime()
+	->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
+
+#include "debug_warning.h"
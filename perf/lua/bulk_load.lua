@@ -0,0 +1,126 @@
+--
+-- The test measures the time it takes to load tuples into an empty memtx
+-- space with secondary indexes in different ways.
+--
+-- Output format:
+-- <test-case> <run-time-nanoseconds-per-tuple>
+--
+-- Options:
+-- --tuples <number>   number of tuples to load (default 1e6)
+-- --indexes <number>  number of secondary indexes (default 2)
+-- --pattern <string>  run only tests matching the pattern; it's possible
+--                     to specify more than one pattern separated by '|',
+--                     for example, 'batch|bulk_load'
+--
+
+local clock = require('clock')
+local fio = require('fio')
+local msgpack = require('msgpack')
+
+local params = require('internal.argparse').parse(arg, {
+    {'tuples', 'number'},
+    {'indexes', 'number'},
+    {'pattern', 'string'},
+})
+local tuple_count = params.tuples or 1e6
+local index_count = params.indexes or 2
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local test_dir = fio.tempdir()
+box.cfg({
+    work_dir = test_dir,
+    log_level = 'error',
+    memtx_memory = 1024 * 1024 * 1024,
+})
+
+-- Tuples are generated in random order of the secondary keys.
+local tuples = {}
+for i = 1, tuple_count do
+    local tuple = {i}
+    for j = 1, index_count do
+        tuple[j + 1] = (i * 2654435761 + j) % 4294967296
+    end
+    tuple[index_count + 2] = 'data' .. i
+    tuples[i] = tuple
+end
+
+local function create_space()
+    local s = box.schema.space.create('test')
+    s:create_index('pk')
+    for j = 1, index_count do
+        s:create_index('sk' .. j, {parts = {j + 1, 'unsigned'},
+                                   unique = false})
+    end
+    return s
+end
+
+local BATCH_SIZE = 1000
+
+local TESTS = {
+    {
+        name = 'insert',
+        func = function(s)
+            for _, tuple in ipairs(tuples) do
+                s:insert(tuple)
+            end
+        end,
+    },
+    {
+        name = 'batch',
+        func = function(s)
+            for i = 1, #tuples, BATCH_SIZE do
+                box.begin()
+                for j = i, math.min(i + BATCH_SIZE - 1, #tuples) do
+                    s:insert(tuples[j])
+                end
+                box.commit()
+            end
+        end,
+    },
+    {
+        name = 'bulk_load',
+        func = function(s)
+            s:bulk_load(tuples, {batch_size = BATCH_SIZE})
+        end,
+    },
+    {
+        name = 'bulk_load_msgpack',
+        prepare = function()
+            local data = {}
+            for i, tuple in ipairs(tuples) do
+                data[i] = msgpack.encode(tuple)
+            end
+            return table.concat(data)
+        end,
+        func = function(s, data)
+            s:bulk_load(data, {batch_size = BATCH_SIZE})
+        end,
+    },
+}
+
+for _, test in ipairs(TESTS) do
+    local skip = false
+    if params.pattern then
+        skip = true
+        for _, pattern in ipairs(params.pattern) do
+            if string.match(test.name, pattern) then
+                skip = false
+                break
+            end
+        end
+    end
+    if not skip then
+        local s = create_space()
+        local arg = test.prepare and test.prepare()
+        collectgarbage('collect')
+        local t = clock.bench(test.func, s, arg)[1]
+        assert(s:len() == tuple_count)
+        s:drop()
+        print(string.format('%s %d', test.name, t / tuple_count * 1e9))
+    end
+end
+
+fio.rmtree(test_dir)
+os.exit(0)
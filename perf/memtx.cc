@@ -128,6 +128,7 @@ class Memtx final {
 					   memtx_granularity, "small",
 					   memtx_alloc_factor,
 					   /*threads_num=*/0,
+					   /*recovery_read_ahead=*/0,
 					   memtx_on_indexes_built_mock_cb);
 		if (memtx == nullptr)
 			panic("failed to create new memtx engine");
@@ -251,6 +251,25 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			 "less than or equal to 1");
 		return -1;
 	}
+	if (opts->cache_size < 0) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "cache_size must be greater than or equal to 0");
+		return -1;
+	}
+	if (opts->page_restart_interval < 0 ||
+	    opts->page_restart_interval > UINT16_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "page_restart_interval must be greater than or "
+			 "equal to 0 and less than or equal to 65535");
+		return -1;
+	}
+	if (opts->adaptive_hash_size < 0 ||
+	    opts->adaptive_hash_size > UINT32_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "adaptive_hash_size must be greater than or "
+			 "equal to 0 and less than or equal to 4294967295");
+		return -1;
+	}
 	return 0;
 }
 
@@ -599,6 +618,17 @@ space_swap_triggers(struct space *new_space, struct space *old_space)
 	old_space->sql_triggers = new_value;
 }
 
+/**
+ * Move request latency statistics to the new space, or vice versa,
+ * restore them in the old space.
+ */
+static void
+space_swap_latency(struct space *new_space, struct space *old_space)
+{
+	for (uint32_t i = 0; i < lengthof(new_space->latency); i++)
+		SWAP(new_space->latency[i], old_space->latency[i]);
+}
+
 /**
  * True if the space has records identified by key 'uid'.
  * Uses 'iid' index.
@@ -929,6 +959,7 @@ alter_space_rollback(struct trigger *trigger, void * /* event */)
 	 * constraints.
 	 */
 	space_swap_triggers(alter->new_space, alter->old_space);
+	space_swap_latency(alter->new_space, alter->old_space);
 	space_reattach_constraints(alter->old_space);
 	space_pin_collations(alter->old_space);
 	space_pin_defaults(alter->old_space);
@@ -1052,6 +1083,7 @@ alter_space_do(struct txn_stmt *stmt, struct alter_space *alter)
 	 * constraints.
 	 */
 	space_swap_triggers(alter->new_space, alter->old_space);
+	space_swap_latency(alter->new_space, alter->old_space);
 	/*
 	 * The new space is ready. Time to update the space
 	 * cache with it.
@@ -31,6 +31,7 @@
 #include "applier.h"
 
 #include <msgpuck.h>
+#include <PMurHash.h>
 
 #include "authentication.h"
 #include "xlog.h"
@@ -51,11 +52,13 @@
 #include "session.h"
 #include "cfg.h"
 #include "schema.h"
+#include "space.h"
 #include "txn.h"
 #include "box.h"
 #include "xrow.h"
 #include "scoped_guard.h"
 #include "txn_limbo.h"
+#include "assoc.h"
 #include "journal.h"
 #include "raft.h"
 #include "small/static.h"
@@ -1383,9 +1386,14 @@ applier_handle_raft_request(struct applier *applier, struct raft_request *req)
 	return box_raft_process(req, applier->instance_id);
 }
 
-static int
-apply_plain_tx(uint32_t replica_id, struct stailq *rows,
-	       bool skip_conflict, bool use_triggers)
+/**
+ * Apply all rows of a plain transaction without committing it.
+ * Returns the transaction on success. On failure the transaction is
+ * aborted and NULL is returned.
+ */
+static struct txn *
+apply_plain_tx_begin(uint32_t replica_id, struct stailq *rows,
+		     bool skip_conflict, bool use_triggers)
 {
 	/*
 	 * Explicitly begin the transaction so that we can
@@ -1396,7 +1404,7 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 	struct txn *txn = txn_begin();
 	struct applier_tx_row *item;
 	if (txn == NULL)
-		 return -1;
+		 return NULL;
 	txn->isolation = TXN_ISOLATION_READ_COMMITTED;
 
 	stailq_foreach_entry(item, rows, next) {
@@ -1490,11 +1498,21 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 		trigger_create(on_wal_write, applier_txn_wal_write_cb, rcb, NULL);
 		txn_on_wal_write(txn, on_wal_write);
 	}
-
-	return txn_commit_try_async(txn);
+	return txn;
 fail:
 	txn_abort(txn);
-	return -1;
+	return NULL;
+}
+
+static int
+apply_plain_tx(uint32_t replica_id, struct stailq *rows,
+	       bool skip_conflict, bool use_triggers)
+{
+	struct txn *txn = apply_plain_tx_begin(replica_id, rows, skip_conflict,
+					       use_triggers);
+	if (txn == NULL)
+		return -1;
+	return txn_commit_try_async(txn);
 }
 
 /** A simpler version of applier_apply_tx() for final join stage. */
@@ -1880,6 +1898,527 @@ static const struct cmsg_hop return_route[] = {
 	{applier_thread_return_batch, NULL},
 };
 
+/**
+ * A group of transactions received in one batch from the same replica
+ * that are applied concurrently, each in its own fiber.
+ *
+ * A transaction waits only for the preceding transactions it depends
+ * on to be committed before it's applied. Two transactions depend on
+ * each other if they modify the same primary key or one of them
+ * modifies a space in a way that can't be tracked by the primary key.
+ * Transactions are committed strictly in the order they were received,
+ * so the WAL order is the same as on the master.
+ *
+ * Since all transactions are applied in the tx thread, only those
+ * that may yield while being applied gain from this, i.e. vinyl ones
+ * waiting for disk reads. Such transactions are applied right after
+ * their dependencies are committed, while the others are applied only
+ * after all the preceding transactions are committed.
+ */
+struct applier_parallel {
+	/** The applier the transactions were received by. */
+	struct applier *applier;
+	/** Origin of the transactions in the group. */
+	uint32_t replica_id;
+	/**
+	 * Order latch of the origin replica. Locked as long as the group
+	 * isn't empty, NULL otherwise.
+	 */
+	struct latch *latch;
+	/** Number of transactions dispatched to the group. */
+	int64_t tx_count;
+	/**
+	 * Number of transactions that are done (committed or failed).
+	 * Since they are done in order, it's also the position of the
+	 * next transaction to commit.
+	 */
+	int64_t done_count;
+	/**
+	 * Position of the last transaction modifying a key, a space or
+	 * a whole space, see applier_parallel_key().
+	 */
+	struct mh_i64ptr_t *deps;
+	/** Set if a transaction failed, the diag holds the error. */
+	bool is_failed;
+	struct diag diag;
+	/** Signalled when a transaction is done. */
+	struct fiber_cond cond;
+};
+
+enum {
+	/** Seed of the primary key hash used for dependency tracking. */
+	APPLIER_PARALLEL_HASH_SEED = 13,
+};
+
+/** Kinds of dependency tracking keys. */
+enum applier_parallel_key_type {
+	/** A primary key of a space. */
+	APPLIER_PARALLEL_KEY_ROW,
+	/** Any key of a space. */
+	APPLIER_PARALLEL_KEY_SPACE,
+	/** A whole space. */
+	APPLIER_PARALLEL_KEY_SPACE_ALL,
+};
+
+/**
+ * Make a dependency tracking key. Space ids are less than 2^31 so
+ * the type bits never clash with the space id of a row key.
+ */
+static inline uint64_t
+applier_parallel_key(enum applier_parallel_key_type type, uint32_t space_id,
+		     uint32_t hash)
+{
+	switch (type) {
+	case APPLIER_PARALLEL_KEY_ROW:
+		return (uint64_t)space_id << 32 | hash;
+	case APPLIER_PARALLEL_KEY_SPACE:
+		return 1ULL << 63 | space_id;
+	case APPLIER_PARALLEL_KEY_SPACE_ALL:
+		return 1ULL << 63 | 1ULL << 62 | space_id;
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+static void
+applier_parallel_create(struct applier_parallel *group,
+			struct applier *applier)
+{
+	group->applier = applier;
+	group->replica_id = REPLICA_ID_NIL;
+	group->latch = NULL;
+	group->tx_count = 0;
+	group->done_count = 0;
+	group->deps = mh_i64ptr_new();
+	group->is_failed = false;
+	diag_create(&group->diag);
+	fiber_cond_create(&group->cond);
+}
+
+/** Wait until the transaction at the given position is done. */
+static void
+applier_parallel_wait(struct applier_parallel *group, int64_t seq)
+{
+	while (group->done_count <= seq)
+		fiber_cond_wait(&group->cond);
+}
+
+/**
+ * Wait for all transactions of the group to be done and make the group
+ * empty. The error of a failed transaction, if any, is left in the
+ * group diag.
+ */
+static void
+applier_parallel_drain(struct applier_parallel *group)
+{
+	applier_parallel_wait(group, group->tx_count - 1);
+	if (group->latch != NULL) {
+		latch_unlock(group->latch);
+		group->latch = NULL;
+	}
+	group->replica_id = REPLICA_ID_NIL;
+	group->tx_count = 0;
+	group->done_count = 0;
+	mh_i64ptr_clear(group->deps);
+}
+
+/**
+ * Wait for all transactions of the group to be done and make the group
+ * empty. Returns -1 and sets diag if any of the transactions failed.
+ */
+static int
+applier_parallel_flush(struct applier_parallel *group)
+{
+	applier_parallel_drain(group);
+	if (group->is_failed) {
+		group->is_failed = false;
+		diag_move(&group->diag, diag_get());
+		return -1;
+	}
+	return 0;
+}
+
+static void
+applier_parallel_destroy(struct applier_parallel *group)
+{
+	applier_parallel_drain(group);
+	mh_i64ptr_delete(group->deps);
+	diag_destroy(&group->diag);
+	fiber_cond_destroy(&group->cond);
+}
+
+/**
+ * Hash the primary key of a DML request. Only keys consisting of
+ * integer and non-collated string parts are hashed, because they have
+ * a canonical representation. Returns false if the key can't be hashed.
+ */
+static bool
+applier_parallel_key_hash(struct space *space, const struct request *req,
+			  uint32_t *hash)
+{
+	struct index *pk = space_index(space, 0);
+	if (pk == NULL)
+		return false;
+	struct key_def *key_def = pk->def->key_def;
+	const char *key = NULL;
+	const char *tuple = NULL;
+	uint32_t field_count = 0;
+	switch (req->type) {
+	case IPROTO_INSERT:
+	case IPROTO_REPLACE:
+	case IPROTO_UPSERT:
+		tuple = req->tuple;
+		field_count = mp_decode_array(&tuple);
+		break;
+	case IPROTO_DELETE:
+	case IPROTO_UPDATE:
+		if (req->index_id != 0)
+			return false;
+		key = req->key;
+		if (mp_decode_array(&key) != key_def->part_count)
+			return false;
+		break;
+	default:
+		return false;
+	}
+	uint32_t h = APPLIER_PARALLEL_HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		struct key_part *part = &key_def->parts[i];
+		if (part->path != NULL || part->coll != NULL)
+			return false;
+		if (part->type != FIELD_TYPE_UNSIGNED &&
+		    part->type != FIELD_TYPE_INTEGER &&
+		    part->type != FIELD_TYPE_STRING)
+			return false;
+		const char *field;
+		if (key != NULL) {
+			field = key;
+			mp_next(&key);
+		} else {
+			if (part->fieldno >= field_count)
+				return false;
+			field = tuple;
+			for (uint32_t j = 0; j < part->fieldno; j++)
+				mp_next(&field);
+		}
+		switch (mp_typeof(*field)) {
+		case MP_UINT:
+		case MP_INT: {
+			/* Equal integers may be encoded differently. */
+			uint64_t value = mp_typeof(*field) == MP_UINT ?
+					 mp_decode_uint(&field) :
+					 (uint64_t)mp_decode_int(&field);
+			PMurHash32_Process(&h, &carry, &value, sizeof(value));
+			total_size += sizeof(value);
+			break;
+		}
+		case MP_STR: {
+			uint32_t len;
+			const char *str = mp_decode_str(&field, &len);
+			PMurHash32_Process(&h, &carry, &len, sizeof(len));
+			PMurHash32_Process(&h, &carry, str, len);
+			total_size += sizeof(len) + len;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	*hash = PMurHash32_Result(h, carry, total_size);
+	return true;
+}
+
+/**
+ * Check if a space is modified in a way that can be tracked by the
+ * primary key: a row modification can't affect any other row.
+ */
+static bool
+applier_parallel_space_is_row_tracked(struct space *space)
+{
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		if (space->index[i]->def->opts.is_unique)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Account a dependency of the transaction at the given position on the
+ * last preceding transaction with the given key.
+ */
+static void
+applier_parallel_depend(struct applier_parallel *group, uint64_t key,
+			int64_t seq, int64_t *dep)
+{
+	struct mh_i64ptr_t *deps = group->deps;
+	mh_int_t pos = mh_i64ptr_find(deps, key, NULL);
+	if (pos == mh_end(deps))
+		return;
+	int64_t last = (int64_t)(intptr_t)mh_i64ptr_node(deps, pos)->val;
+	/* The transaction may use the same key many times. */
+	if (last < seq)
+		*dep = MAX(*dep, last);
+}
+
+/** Set the position of the last transaction with the given key. */
+static void
+applier_parallel_track(struct applier_parallel *group, uint64_t key,
+		       int64_t seq)
+{
+	struct mh_i64ptr_node_t node = {key, (void *)(intptr_t)seq};
+	mh_i64ptr_put(group->deps, &node, NULL, NULL);
+}
+
+/**
+ * Register the keys of a transaction in the group and return the
+ * position of the last preceding transaction it depends on or -1.
+ */
+static int64_t
+applier_parallel_add_deps(struct applier_parallel *group, struct stailq *rows,
+			  int64_t seq)
+{
+	int64_t dep = -1;
+	struct applier_tx_row *item;
+	stailq_foreach_entry(item, rows, next) {
+		struct request *req = &item->req.dml;
+		if (req->type == IPROTO_NOP)
+			continue;
+		struct space *space = space_by_id(req->space_id);
+		assert(space != NULL);
+		uint32_t space_id = req->space_id;
+		uint64_t space_key = applier_parallel_key(
+			APPLIER_PARALLEL_KEY_SPACE, space_id, 0);
+		uint64_t space_all_key = applier_parallel_key(
+			APPLIER_PARALLEL_KEY_SPACE_ALL, space_id, 0);
+		uint32_t hash;
+		if (applier_parallel_space_is_row_tracked(space) &&
+		    applier_parallel_key_hash(space, req, &hash)) {
+			uint64_t row_key = applier_parallel_key(
+				APPLIER_PARALLEL_KEY_ROW, space_id, hash);
+			applier_parallel_depend(group, space_all_key, seq,
+						&dep);
+			applier_parallel_depend(group, row_key, seq, &dep);
+			applier_parallel_track(group, row_key, seq);
+			applier_parallel_track(group, space_key, seq);
+		} else {
+			applier_parallel_depend(group, space_key, seq, &dep);
+			applier_parallel_track(group, space_key, seq);
+			applier_parallel_track(group, space_all_key, seq);
+		}
+	}
+	return dep;
+}
+
+/**
+ * Check if the limbo is in the same state as when a transaction
+ * from @a replica_id was found eligible for parallel apply, i.e.
+ * its rows still don't need to be filtered by
+ * applier_synchro_filter_tx().
+ */
+static bool
+applier_parallel_limbo_is_unchanged(uint32_t replica_id, uint64_t term,
+				    uint32_t owner_id)
+{
+	return !latch_is_locked(&txn_limbo.promote_latch) &&
+	       txn_limbo.promote_greatest_term == term &&
+	       txn_limbo_replica_term(&txn_limbo, replica_id) == term &&
+	       txn_limbo.owner_id == owner_id;
+}
+
+/**
+ * Apply a transaction of a group the way applier_apply_tx() does,
+ * after all the preceding transactions of the group are committed.
+ * Used if the limbo changed since the transaction was dispatched.
+ */
+static int
+applier_parallel_apply_tx_serial(struct applier *applier, struct stailq *rows)
+{
+	try {
+		applier_synchro_filter_tx(rows);
+	} catch (Exception *) {
+		return -1;
+	}
+	return apply_plain_tx(applier->instance_id, rows,
+			      replication_skip_conflict, true);
+}
+
+/** Fiber function applying a transaction of a group. */
+static int
+applier_parallel_tx_f(va_list ap)
+{
+	struct applier_parallel *group = va_arg(ap, struct applier_parallel *);
+	struct stailq *rows = va_arg(ap, struct stailq *);
+	int64_t seq = va_arg(ap, int64_t);
+	int64_t dep = va_arg(ap, int64_t);
+	bool can_yield = va_arg(ap, int);
+	uint64_t term = va_arg(ap, uint64_t);
+	uint32_t owner_id = va_arg(ap, uint32_t);
+	/*
+	 * Apply the transaction in an applier session like applier_f()
+	 * does, so that engines treat it as replicated, e.g. vinyl waits
+	 * for memory quota infinitely and doesn't abort it on switching
+	 * to read-only.
+	 */
+	session_set_type(current_session(), SESSION_TYPE_APPLIER);
+	uint32_t replica_id = group->applier->instance_id;
+	uint32_t origin_id =
+		stailq_first_entry(rows, struct applier_tx_row, next)->
+		row.replica_id;
+	struct txn *txn = NULL;
+	int rc = -1;
+	if (can_yield) {
+		applier_parallel_wait(group, dep);
+		if (!group->is_failed &&
+		    applier_parallel_limbo_is_unchanged(origin_id, term,
+							owner_id)) {
+			/*
+			 * Conflicts are resolved on retry below, in
+			 * the transaction order.
+			 */
+			txn = apply_plain_tx_begin(replica_id, rows, false,
+						   true);
+			if (txn == NULL)
+				diag_clear(diag_get());
+		}
+	}
+	/* Commit in the order the transactions were received. */
+	applier_parallel_wait(group, seq - 1);
+	if (group->is_failed) {
+		if (txn != NULL)
+			txn_abort(txn);
+		goto done;
+	}
+	/*
+	 * A PROMOTE or DEMOTE may have been applied while the
+	 * transaction was waiting for its turn, so its rows may have
+	 * to be filtered now.
+	 */
+	if (!applier_parallel_limbo_is_unchanged(origin_id, term, owner_id)) {
+		if (txn != NULL)
+			txn_abort(txn);
+		rc = applier_parallel_apply_tx_serial(group->applier, rows);
+		goto applied;
+	}
+	if (txn != NULL) {
+		rc = txn_commit_try_async(txn);
+		if (rc != 0)
+			diag_clear(diag_get());
+	}
+	/*
+	 * If the transaction was applied concurrently and failed, for
+	 * example, because of a conflict, retry it now that all the
+	 * preceding transactions are committed.
+	 */
+	if (rc != 0) {
+		rc = apply_plain_tx(replica_id, rows,
+				    replication_skip_conflict, true);
+	}
+applied:
+	if (rc == 0) {
+		struct xrow_header *last_row = &stailq_last_entry(
+			rows, struct applier_tx_row, next)->row;
+		vclock_follow(&replicaset.applier.vclock,
+			      last_row->replica_id, last_row->lsn);
+	} else {
+		group->is_failed = true;
+		diag_move(diag_get(), &group->diag);
+	}
+done:
+	group->done_count++;
+	fiber_cond_broadcast(&group->cond);
+	return 0;
+}
+
+/**
+ * Check if a transaction may be applied in parallel with others. Sets
+ * @a can_yield if the transaction may yield while being applied.
+ */
+static bool
+applier_parallel_tx_is_eligible(struct applier *applier, struct stailq *rows,
+				bool *can_yield)
+{
+	if (!replication_parallel_apply)
+		return false;
+	if (applier->state != APPLIER_SYNC && applier->state != APPLIER_FOLLOW)
+		return false;
+	struct xrow_header *first_row =
+		&stailq_first_entry(rows, struct applier_tx_row, next)->row;
+	struct xrow_header *last_row =
+		&stailq_last_entry(rows, struct applier_tx_row, next)->row;
+	/* Synchronous transactions are ordered by the limbo. */
+	if (last_row->wait_sync || (last_row->flags & IPROTO_FLAG_WAIT_ACK))
+		return false;
+	/* Rows that would be filtered by applier_synchro_filter_tx(). */
+	if (latch_is_locked(&txn_limbo.promote_latch) ||
+	    txn_limbo_replica_term(&txn_limbo, first_row->replica_id) !=
+	    txn_limbo.promote_greatest_term)
+		return false;
+	*can_yield = true;
+	struct applier_tx_row *item;
+	stailq_foreach_entry(item, rows, next) {
+		struct xrow_header *row = &item->row;
+		if (row->type == IPROTO_NOP)
+			continue;
+		if (!iproto_type_is_dml(row->type))
+			return false;
+		struct space *space = space_by_id(item->req.dml.space_id);
+		/* Triggers may depend on the order of all changes. */
+		if (space == NULL || space_is_system(space) ||
+		    space_has_before_replace_triggers(space) ||
+		    space_has_on_replace_triggers(space))
+			return false;
+		if (!space_is_vinyl(space))
+			*can_yield = false;
+	}
+	return true;
+}
+
+/**
+ * Try to apply a transaction in parallel with the other transactions
+ * of the group. Returns false if the transaction must be applied with
+ * applier_apply_tx() once the group is flushed.
+ */
+static bool
+applier_parallel_apply_tx(struct applier_parallel *group, struct stailq *rows)
+{
+	struct applier *applier = group->applier;
+	bool can_yield;
+	if (!applier_parallel_tx_is_eligible(applier, rows, &can_yield))
+		return false;
+	struct xrow_header *first_row =
+		&stailq_first_entry(rows, struct applier_tx_row, next)->row;
+	struct xrow_header *last_row =
+		&stailq_last_entry(rows, struct applier_tx_row, next)->row;
+	uint32_t replica_id = first_row->replica_id;
+	if (group->latch == NULL) {
+		/* See applier_apply_tx() for why the latch is needed. */
+		struct replica *replica = replica_by_id(replica_id);
+		struct latch *latch = (replica != NULL ? &replica->order_latch :
+				       &replicaset.applier.order_latch);
+		latch_lock(latch);
+		group->latch = latch;
+		group->replica_id = replica_id;
+	} else if (group->replica_id != replica_id) {
+		return false;
+	}
+	int64_t lsn = vclock_get(&replicaset.applier.vclock, replica_id);
+	if (lsn >= last_row->lsn)
+		return true;
+	/* A partially applied transaction is handled by applier_apply_tx(). */
+	if (lsn >= first_row->lsn)
+		return false;
+	struct fiber *f = applier_fiber_new(applier, "applier_tx",
+					    applier_parallel_tx_f, false);
+	int64_t seq = group->tx_count++;
+	int64_t dep = applier_parallel_add_deps(group, rows, seq);
+	fiber_start(f, group, rows, seq, dep, (int)can_yield,
+		    txn_limbo.promote_greatest_term, txn_limbo.owner_id);
+	return true;
+}
+
 static inline int
 applier_handle_raft(struct applier *applier, struct applier_tx_row *txr)
 {
@@ -1898,6 +2437,11 @@ applier_process_batch(struct cmsg *base)
 {
 	struct applier_data_msg *msg = (struct applier_data_msg *)base;
 	struct applier *applier = msg->base.applier;
+	struct applier_parallel group;
+	applier_parallel_create(&group, applier);
+	auto group_guard = make_scoped_guard([&] {
+		applier_parallel_destroy(&group);
+	});
 	struct applier_tx *tx;
 	stailq_foreach_entry(tx, &msg->txs, next) {
 		struct applier_tx_row *last_txr =
@@ -1912,6 +2456,15 @@ applier_process_batch(struct cmsg *base)
 			raft_process_heartbeat(box_raft(),
 					       applier->instance_id);
 		}
+		if (last_txr->row.lsn != 0 &&
+		    applier_parallel_apply_tx(&group, &tx->rows))
+			continue;
+		/*
+		 * Everything else is processed after the transactions
+		 * applied in parallel.
+		 */
+		if (applier_parallel_flush(&group) != 0)
+			diag_raise();
 		if (last_txr->row.lsn == 0) {
 			if (applier_process_heartbeat(applier, last_txr) != 0)
 				diag_raise();
@@ -1930,6 +2483,8 @@ applier_process_batch(struct cmsg *base)
 			applier_set_state(applier, APPLIER_FOLLOW);
 		}
 	}
+	if (applier_parallel_flush(&group) != 0)
+		diag_raise();
 
 	/* Return the message to applier thread. */
 	cmsg_init(&msg->base.base, return_route);
@@ -68,6 +68,7 @@
 #include "user.h"
 #include "cfg.h"
 #include "coio.h"
+#include "coio_uring.h"
 #include "replication.h" /* replica */
 #include "title.h"
 #include "xrow.h"
@@ -100,6 +101,7 @@
 #include "tt_sort.h"
 #include "event.h"
 #include "tweaks.h"
+#include "latency_histogram.h"
 
 static char status[64] = "unconfigured";
 
@@ -1705,6 +1707,18 @@ box_check_memory_quota(const char *quota_name)
 	return -1;
 }
 
+static int64_t
+box_check_vinyl_bloom_memory(void)
+{
+	int64_t limit = cfg_geti64("vinyl_bloom_memory");
+	if (limit < 0) {
+		diag_set(ClientError, ER_CFG, "vinyl_bloom_memory",
+			 "must be greater than or equal to 0");
+		return -1;
+	}
+	return limit;
+}
+
 static void
 box_check_vinyl_options(void)
 {
@@ -1718,6 +1732,8 @@ box_check_vinyl_options(void)
 
 	if (box_check_memory_quota("vinyl_memory") < 0)
 		diag_raise();
+	if (box_check_vinyl_bloom_memory() < 0)
+		diag_raise();
 
 	if (read_threads < 1) {
 		tnt_raise(ClientError, ER_CFG, "vinyl_read_threads",
@@ -1757,6 +1773,30 @@ box_check_sql_cache_size(int size)
 	return 0;
 }
 
+static int
+box_check_sql_sort_threads(int count)
+{
+	if (count < 0 || count > SQL_SORT_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "sql_sort_threads",
+			 tt_sprintf("must be greater than or equal to 0 and "
+				    "less than or equal to %d",
+				    SQL_SORT_THREADS_MAX));
+		return -1;
+	}
+	return 0;
+}
+
+static int
+box_check_sql_sort_memory(int64_t size)
+{
+	if (size < 0) {
+		diag_set(ClientError, ER_CFG, "sql_sort_memory",
+			 "must be non-negative");
+		return -1;
+	}
+	return 0;
+}
+
 static int
 box_check_allocator(void)
 {
@@ -1898,6 +1938,73 @@ box_check_memtx_sort_threads(void)
 				     " equal to %d", TT_SORT_THREADS_MAX));
 }
 
+/**
+ * Checks whether memtx_recovery_read_ahead configuration parameter
+ * is correct.
+ */
+static void
+box_check_memtx_recovery_read_ahead(void)
+{
+	int num = cfg_geti("memtx_recovery_read_ahead");
+	if (num < 0 || num > MEMTX_RECOVERY_READ_AHEAD_MAX)
+		tnt_raise(ClientError, ER_CFG, "memtx_recovery_read_ahead",
+			  tt_sprintf("must be greater than or equal to 0 and"
+				     " less than or equal to %d",
+				     MEMTX_RECOVERY_READ_AHEAD_MAX));
+}
+
+/**
+ * Checks whether wal_compression_threads configuration parameter
+ * is correct.
+ */
+static void
+box_check_wal_compression_threads(void)
+{
+	int num = cfg_geti("wal_compression_threads");
+	if (num < 0 || num > WAL_COMPRESSION_THREADS_MAX)
+		tnt_raise(ClientError, ER_CFG, "wal_compression_threads",
+			  tt_sprintf("must be greater than or equal to 0 and"
+				     " less than or equal to %d",
+				     WAL_COMPRESSION_THREADS_MAX));
+}
+
+/**
+ * Checks the io_backend configuration parameter. Returns true if
+ * file I/O should go through io_uring instead of the thread pool.
+ */
+static bool
+box_check_io_backend(void)
+{
+	const char *backend = cfg_gets("io_backend");
+	if (backend == NULL || strcmp(backend, "thread") == 0)
+		return false;
+	if (strcmp(backend, "io_uring") == 0)
+		return true;
+	tnt_raise(ClientError, ER_CFG, "io_backend",
+		  "the value must be one of the following strings: "
+		  "'thread', 'io_uring'");
+}
+
+/** Number of submission queue entries of the tx thread io_uring. */
+enum { BOX_IO_URING_ENTRIES = 256 };
+
+/**
+ * Switches file I/O of the tx thread to io_uring if it's
+ * configured. Falls back to the thread pool if io_uring isn't
+ * supported by the system.
+ */
+static void
+box_set_io_backend(void)
+{
+	if (!box_check_io_backend())
+		return;
+	if (coio_uring_init(BOX_IO_URING_ENTRIES) != 0) {
+		diag_log();
+		say_warn("io_uring is unavailable, "
+			 "falling back to the thread I/O backend");
+	}
+}
+
 void
 box_check_config(void)
 {
@@ -1965,11 +2072,18 @@ box_check_config(void)
 		diag_raise();
 	if (box_check_sql_cache_size(cfg_geti("sql_cache_size")) != 0)
 		diag_raise();
+	if (box_check_sql_sort_threads(cfg_geti("sql_sort_threads")) != 0)
+		diag_raise();
+	if (box_check_sql_sort_memory(cfg_geti64("sql_sort_memory")) != 0)
+		diag_raise();
 	if (box_check_txn_timeout() < 0)
 		diag_raise();
 	if (box_check_txn_isolation() == txn_isolation_level_MAX)
 		diag_raise();
 	box_check_memtx_sort_threads();
+	box_check_memtx_recovery_read_ahead();
+	box_check_wal_compression_threads();
+	box_check_io_backend();
 }
 
 int
@@ -2253,6 +2367,12 @@ box_set_replication_skip_conflict(void)
 	replication_skip_conflict = cfg_geti("replication_skip_conflict");
 }
 
+void
+box_set_replication_parallel_apply(void)
+{
+	replication_parallel_apply = cfg_geti("replication_parallel_apply");
+}
+
 /** Register on the master instance. Could be initial join or a name change. */
 static void
 box_register_on_master(void)
@@ -3274,6 +3394,17 @@ box_set_vinyl_cache(void)
 	vinyl_engine_set_cache(vinyl, cfg_geti64("vinyl_cache"));
 }
 
+void
+box_set_vinyl_bloom_memory(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	int64_t limit = box_check_vinyl_bloom_memory();
+	if (limit < 0)
+		diag_raise();
+	vinyl_engine_set_bloom_memory(vinyl, limit);
+}
+
 void
 box_set_vinyl_timeout(void)
 {
@@ -3310,6 +3441,26 @@ box_set_prepared_stmt_cache_size(void)
 	return 0;
 }
 
+int
+box_set_sql_sort_threads(void)
+{
+	int count = cfg_geti("sql_sort_threads");
+	if (box_check_sql_sort_threads(count) != 0)
+		return -1;
+	sql_sort_set_threads(count);
+	return 0;
+}
+
+int
+box_set_sql_sort_memory(void)
+{
+	int64_t size = cfg_geti64("sql_sort_memory");
+	if (box_check_sql_sort_memory(size) != 0)
+		return -1;
+	sql_sort_set_memory(size);
+	return 0;
+}
+
 /**
  * Report crash information to the feedback daemon
  * (ie send it to feedback daemon).
@@ -3987,6 +4138,47 @@ box_upsert(uint32_t space_id, uint32_t index_id, const char *tuple,
 	return box_process1(&request, result);
 }
 
+int
+box_bulk_load(uint32_t space_id, const char *data, const char *data_end,
+	      uint32_t batch_size, bool is_replace, uint64_t *count)
+{
+	assert(batch_size > 0);
+	*count = 0;
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = is_replace ? IPROTO_REPLACE : IPROTO_INSERT;
+	request.space_id = space_id;
+	while (data < data_end) {
+		if (box_txn_begin() != 0)
+			return -1;
+		uint32_t n = 0;
+		for (; n < batch_size && data < data_end; n++) {
+			const char *tuple = data;
+			if (mp_check(&data, data_end) != 0) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "bulk load data");
+				goto rollback;
+			}
+			if (mp_typeof(*tuple) != MP_ARRAY) {
+				diag_set(ClientError, ER_TUPLE_NOT_ARRAY);
+				goto rollback;
+			}
+			request.tuple = tuple;
+			request.tuple_end = data;
+			if (box_process1(&request, NULL) != 0)
+				goto rollback;
+		}
+		/* The whole batch is written to WAL as one entry. */
+		if (box_txn_commit() != 0)
+			return -1;
+		*count += n;
+	}
+	return 0;
+rollback:
+	box_txn_rollback();
+	return -1;
+}
+
 /**
  * Trigger space truncation by bumping a counter
  * in _truncate space.
@@ -4908,6 +5100,7 @@ engine_init()
 				    cfg_gets("memtx_allocator"),
 				    cfg_getd("slab_alloc_factor"),
 				    cfg_geti("memtx_sort_threads"),
+				    cfg_geti("memtx_recovery_read_ahead"),
 				    box_on_indexes_built);
 	engine_register((struct engine *)memtx);
 	box_set_memtx_max_tuple_size();
@@ -4932,6 +5125,7 @@ engine_init()
 	engine_register((struct engine *)vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
+	box_set_vinyl_bloom_memory();
 	box_set_vinyl_timeout();
 }
 
@@ -5506,11 +5700,16 @@ static void
 box_cfg_xc(void)
 {
 	box_set_force_recovery();
+	box_set_io_backend();
 	box_storage_init();
 	title("loading");
 
 	if (box_set_prepared_stmt_cache_size() != 0)
 		diag_raise();
+	if (box_set_sql_sort_threads() != 0)
+		diag_raise();
+	if (box_set_sql_sort_memory() != 0)
+		diag_raise();
 	box_set_net_msg_max();
 	box_set_readahead();
 	box_set_too_long_threshold();
@@ -5529,6 +5728,7 @@ box_cfg_xc(void)
 		diag_raise();
 	box_set_replication_sync_timeout();
 	box_set_replication_skip_conflict();
+	box_set_replication_parallel_apply();
 	if (box_check_instance_name(cfg_instance_name) != 0)
 		diag_raise();
 	if (box_set_wal_queue_max_size() != 0)
@@ -5771,6 +5971,7 @@ box_reset_space_stat(struct space *space, void *arg)
 	(void)arg;
 	for (uint32_t i = 0; i < space->index_count; i++)
 		index_reset_stat(space->index[i]);
+	space_reset_latency(space);
 	return 0;
 }
 
@@ -5780,6 +5981,7 @@ box_reset_stat(void)
 	rmean_cleanup(rmean_box);
 	rmean_cleanup(rmean_error);
 	engine_reset_stat();
+	latency_histogram_reset(&txn_wal_latency);
 	space_foreach(box_reset_space_stat, NULL);
 }
 
@@ -6006,7 +6208,8 @@ box_storage_init(void)
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
 	double wal_retention_period = box_check_wal_retention_period_xc();
 	if (wal_init(wal_mode, cfg_gets("wal_dir"), wal_max_size,
-		     wal_retention_period, &INSTANCE_UUID,
+		     wal_retention_period,
+		     cfg_geti("wal_compression_threads"), &INSTANCE_UUID,
 		     on_wal_garbage_collection,
 		     on_wal_checkpoint_threshold) != 0) {
 		diag_raise();
@@ -6115,6 +6318,7 @@ void
 box_free(void)
 {
 	box_storage_free();
+	coio_uring_free();
 	builtin_events_free();
 	security_free();
 	auth_free();
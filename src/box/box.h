@@ -333,6 +333,7 @@ void box_set_memtx_max_tuple_size(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
+void box_set_vinyl_bloom_memory(void);
 void box_set_vinyl_timeout(void);
 void box_set_force_recovery(void);
 int box_set_election_mode(void);
@@ -347,12 +348,15 @@ int box_set_replication_synchro_quorum(void);
 int box_set_replication_synchro_timeout(void);
 void box_set_replication_sync_timeout(void);
 void box_set_replication_skip_conflict(void);
+void box_set_replication_parallel_apply(void);
 void box_set_replication_anon(void);
 void box_set_instance_name(void);
 void box_set_replicaset_name(void);
 void box_set_cluster_name(void);
 void box_set_net_msg_max(void);
 int box_set_prepared_stmt_cache_size(void);
+int box_set_sql_sort_threads(void);
+int box_set_sql_sort_memory(void);
 int box_set_feedback(void);
 int box_set_txn_timeout(void);
 int box_set_txn_isolation(void);
@@ -777,6 +781,29 @@ int
 box_process_rw(struct request *request, struct space *space,
 	       struct tuple **result);
 
+/**
+ * Load tuples stored in a MsgPack stream (concatenated arrays) into a space.
+ * The tuples are inserted (or replaced if @a is_replace is set) in
+ * transactions of @a batch_size statements each so that every batch is
+ * written to WAL as one entry. The function must be called out of
+ * a transaction.
+ *
+ * On failure the current batch is rolled back while the batches committed
+ * before it stay in the space.
+ *
+ * \param space_id space identifier
+ * \param data the MsgPack stream
+ * \param data_end end of @a data
+ * \param batch_size max number of tuples committed in one transaction
+ * \param is_replace whether to replace tuples instead of inserting them
+ * \param[out] count number of committed tuples
+ * \retval 0 on success
+ * \retval -1 on error (check box_error_last())
+ */
+int
+box_bulk_load(uint32_t space_id, const char *data, const char *data_end,
+	      uint32_t batch_size, bool is_replace, uint64_t *count);
+
 int
 boxk(int type, uint32_t space_id, const char *format, ...);
 
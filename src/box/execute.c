@@ -154,7 +154,7 @@ sql_prepare(const char *sql, int len, struct port *port)
 		}
 	} else {
 		if (!sql_stmt_schema_version_is_valid(stmt) &&
-		    !sql_stmt_busy(stmt)) {
+		    !sql_stmt_cache_is_busy(stmt_id)) {
 			if (sql_reprepare(&stmt) != 0)
 				return -1;
 		}
@@ -252,6 +252,7 @@ sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 	sql_unbind(stmt);
 	if (sql_bind(stmt, bind, bind_count) != 0)
 		return -1;
+	stmt = sql_stmt_cache_plan(stmt_id, bind, bind_count);
 	sql_reset_autoinc_id_list(stmt);
 	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
 					       DQL_EXECUTE : DML_EXECUTE;
@@ -266,11 +267,51 @@ sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 	return 0;
 }
 
+/**
+ * Execute a statement found in the cache of shared statements.
+ * The statement is left in the cache, like a prepared one.
+ *
+ * @retval 1 The statement can't be cached, nothing is executed.
+ * @retval 0 Success.
+ * @retval -1 Error.
+ */
+static int
+sql_execute_shared(const char *sql, int len, const struct sql_bind *bind,
+		   uint32_t bind_count, struct port *port,
+		   struct region *region)
+{
+	const char *norm_sql;
+	uint32_t norm_len;
+	const struct sql_bind *norm_bind;
+	uint32_t norm_bind_count;
+	if (sql_normalize(sql, len, bind, bind_count, &norm_sql, &norm_len,
+			  &norm_bind, &norm_bind_count) != 0)
+		return 1;
+	struct Vdbe *stmt = sql_stmt_cache_get(norm_sql, norm_len, norm_bind,
+					       norm_bind_count);
+	if (stmt == NULL)
+		return 1;
+	sql_reset_autoinc_id_list(stmt);
+	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
+					       DQL_EXECUTE : DML_EXECUTE;
+	port_sql_create(port, stmt, format, false);
+	if (sql_execute(stmt, port, region) != 0) {
+		port_destroy(port);
+		sql_stmt_reset(stmt);
+		return -1;
+	}
+	sql_stmt_reset(stmt);
+	return 0;
+}
+
 int
 sql_prepare_and_execute(const char *sql, int len, const struct sql_bind *bind,
 			uint32_t bind_count, struct port *port,
 			struct region *region)
 {
+	int rc = sql_execute_shared(sql, len, bind, bind_count, port, region);
+	if (rc <= 0)
+		return rc;
 	struct Vdbe *stmt;
 	if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
 		return -1;
@@ -104,6 +104,18 @@ sql_stmt_query_str(const struct Vdbe *stmt);
 int
 sql_stmt_busy(const struct Vdbe *stmt);
 
+/**
+ * Calculate the plan class of a statement: the selectivity classes
+ * of the constraints its plan depends on (see struct sql_plan_probe)
+ * for the bound parameter values. Statements with the same text and
+ * different plan classes may be executed faster with different plans.
+ *
+ * @retval true The plan class is set.
+ * @retval false The plan does not depend on the parameter values.
+ */
+bool
+sql_stmt_plan_class(const struct Vdbe *stmt, uint32_t *plan_class);
+
 /**
  * Prepare (compile into VDBE byte-code) statement.
  *
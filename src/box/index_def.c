@@ -36,7 +36,8 @@
 #include "fiber.h"
 #include "tt_static.h"
 
-const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
+const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE",
+				    "COLUMN" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
@@ -49,6 +50,10 @@ const struct index_opts index_opts_default = {
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
 	/* .bloom_fpr           = */ 0.05,
+	/* .cache_size          = */ 0,
+	/* .page_restart_interval = */ 0,
+	/* .page_fences         = */ false,
+	/* .adaptive_hash_size  = */ 0,
 	/* .lsn                 = */ 0,
 	/* .func                = */ 0,
 	/* .hint                = */ INDEX_HINT_DEFAULT,
@@ -85,6 +90,12 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("run_count_per_level", OPT_INT64, struct index_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct index_opts, run_size_ratio),
 	OPT_DEF("bloom_fpr", OPT_FLOAT, struct index_opts, bloom_fpr),
+	OPT_DEF("cache_size", OPT_INT64, struct index_opts, cache_size),
+	OPT_DEF("page_restart_interval", OPT_INT64, struct index_opts,
+		page_restart_interval),
+	OPT_DEF("page_fences", OPT_BOOL, struct index_opts, page_fences),
+	OPT_DEF("adaptive_hash_size", OPT_INT64, struct index_opts,
+		adaptive_hash_size),
 	OPT_DEF("lsn", OPT_INT64, struct index_opts, lsn),
 	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_DEF_LEGACY("sql"),
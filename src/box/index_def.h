@@ -44,6 +44,7 @@ enum index_type {
 	TREE,     /* TREE Index */
 	BITSET,   /* BITSET Index */
 	RTREE,    /* R-Tree Index */
+	COLUMN,   /* Columnar Index */
 	index_type_MAX,
 };
 
@@ -98,6 +99,28 @@ struct index_opts {
 	double run_size_ratio;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
+	/**
+	 * Max size of memory the index can use in the vinyl tuple
+	 * cache, 0 means that it's limited only by vinyl_cache.
+	 */
+	int64_t cache_size;
+	/**
+	 * Number of statements between restart points of a vinyl
+	 * run page. Statements between restart points are stored
+	 * prefix-compressed. 0 disables prefix compression.
+	 */
+	int64_t page_restart_interval;
+	/**
+	 * Store the max key of each vinyl run page in the page
+	 * index so that pages and runs that can't contain the
+	 * searched key are skipped without reading them.
+	 */
+	bool page_fences;
+	/**
+	 * Max number of tuples cached in the adaptive hash index
+	 * of a memtx tree index, 0 disables the adaptive hash index.
+	 */
+	int64_t adaptive_hash_size;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -151,6 +174,16 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->cache_size != o2->cache_size)
+		return o1->cache_size < o2->cache_size ? -1 : 1;
+	if (o1->page_restart_interval != o2->page_restart_interval)
+		return o1->page_restart_interval <
+		       o2->page_restart_interval ? -1 : 1;
+	if (o1->page_fences != o2->page_fences)
+		return o1->page_fences - o2->page_fences;
+	if (o1->adaptive_hash_size != o2->adaptive_hash_size)
+		return o1->adaptive_hash_size < o2->adaptive_hash_size ?
+		       -1 : 1;
 	if (o1->func_id != o2->func_id)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
@@ -66,9 +66,12 @@
 #include "iproto_constants.h"
 #include "iproto_features.h"
 #include "rmean.h"
+#include "latency_histogram.h"
+#include "clock.h"
 #include "execute.h"
 #include "errinj.h"
 #include "tt_static.h"
+#include "tweaks.h"
 #include "trivia/util.h"
 #include "salad/stailq.h"
 #include "txn.h"
@@ -134,6 +137,94 @@ iproto_wpos_create(struct iproto_wpos *wpos, struct obuf *out)
 	wpos->svp = obuf_create_svp(out);
 }
 
+/**
+ * Tuples of a SELECT reply whose size is greater than or equal to
+ * this value aren't copied to the connection output buffer. Instead,
+ * the iproto thread writes them to the socket right from the tuple
+ * memory, see struct iproto_zc_ref. Zero disables zero-copy.
+ */
+static uint64_t iproto_zero_copy_threshold = 4096;
+TWEAK_UINT(iproto_zero_copy_threshold);
+
+enum {
+	/**
+	 * Max number of zero-copy references written to the socket
+	 * with one writev() call.
+	 */
+	IPROTO_ZC_WRITE_MAX = 64,
+};
+
+/**
+ * A reference to tuple data that is a part of the output, but is
+ * not stored in the output buffer (zero-copy). The data goes right
+ * before the byte of the output buffer at position @a pos, so it's
+ * spliced in the output by the iproto thread on flush.
+ *
+ * References are created and destroyed by the tx thread: the tuple
+ * is referenced for as long as the output buffer isn't reset, which
+ * happens only after it has been flushed.
+ */
+struct iproto_zc_ref {
+	/** Next reference in the list, see iproto_zc_list. */
+	struct iproto_zc_ref *next;
+	/** Position in the output buffer, see obuf::used. */
+	size_t pos;
+	/** Referenced tuple. */
+	struct tuple *tuple;
+	/** Tuple data. */
+	const char *data;
+	/** Size of the tuple data. */
+	uint32_t size;
+};
+
+/**
+ * List of zero-copy references of an output buffer sorted by
+ * position. The tx thread appends references to the list while
+ * the iproto thread may be reading it, so the link pointers are
+ * accessed with atomics. @a last is used only by the tx thread.
+ */
+struct iproto_zc_list {
+	struct iproto_zc_ref *first;
+	struct iproto_zc_ref *last;
+};
+
+static inline void
+iproto_zc_list_create(struct iproto_zc_list *list)
+{
+	list->first = NULL;
+	list->last = NULL;
+}
+
+/** Unreference the tuples of a list and free its references. */
+static void
+iproto_zc_list_destroy(struct iproto_zc_list *list, struct mempool *pool)
+{
+	struct iproto_zc_ref *ref = list->first;
+	while (ref != NULL) {
+		struct iproto_zc_ref *next = ref->next;
+		tuple_unref(ref->tuple);
+		mempool_free(pool, ref);
+		ref = next;
+	}
+	iproto_zc_list_create(list);
+}
+
+/**
+ * Move all references of @a src to the end of @a dst, making them
+ * visible to the iproto thread.
+ */
+static void
+iproto_zc_list_splice(struct iproto_zc_list *dst, struct iproto_zc_list *src)
+{
+	if (src->first == NULL)
+		return;
+	struct iproto_zc_ref **link = dst->last == NULL ?
+				      &dst->first : &dst->last->next;
+	__atomic_store_n(link, src->first, __ATOMIC_RELEASE);
+	dst->last = src->last;
+	iproto_zc_list_create(src);
+}
+
 /**
  * Message sent when iproto thread dropped all connections that requested
  * to be dropped.
@@ -216,6 +307,13 @@ struct iproto_thread {
 	 * Iproto thread stat
 	 */
 	struct rmean *rmean;
+	/**
+	 * Time requests are processed in the iproto thread, from
+	 * decoding a request to pushing it to tx plus from receiving
+	 * the reply from tx to queuing it for sending, indexed by
+	 * request type.
+	 */
+	struct latency_histogram latency[IPROTO_TYPE_STAT_MAX];
 	/*
 	 * Iproto thread id
 	 */
@@ -248,6 +346,18 @@ struct iproto_thread {
 		size_t requests_in_progress;
 		/** Iproto thread stat collected in tx thread. */
 		struct rmean *rmean;
+		/**
+		 * Time requests spend in the tx queue, indexed by
+		 * request type.
+		 */
+		struct latency_histogram queue_latency[IPROTO_TYPE_STAT_MAX];
+		/**
+		 * Time requests are processed in the tx thread, including
+		 * WAL writes, indexed by request type.
+		 */
+		struct latency_histogram latency[IPROTO_TYPE_STAT_MAX];
+		/** Memory pool for struct iproto_zc_ref. */
+		struct mempool zc_ref_pool;
 	} tx;
 };
 
@@ -387,6 +497,10 @@ enum iproto_cfg_op {
 	 * Command code do get statistic from iproto thread
 	 */
 	IPROTO_CFG_STAT,
+	/**
+	 * Command code to reset statistic owned by iproto thread
+	 */
+	IPROTO_CFG_RESET_STAT,
 	/**
 	 * Command code to notify IPROTO threads a new handler has been set or
 	 * reset.
@@ -612,6 +726,16 @@ struct iproto_msg
 	struct rlist in_inprogress;
 	/** TX thread fiber that processing this message. */
 	struct fiber *fiber;
+	/**
+	 * Time when the request was decoded by the iproto thread,
+	 * in nanoseconds, see clock_monotonic64(). Zero if latency
+	 * of the request isn't accounted.
+	 */
+	uint64_t start_time;
+	/** Time when the request was pushed to the tx thread. */
+	uint64_t push_time;
+	/** Time when the tx thread started processing the request. */
+	uint64_t tx_start_time;
 };
 
 /**
@@ -788,6 +912,24 @@ struct iproto_connection
 	 * output is available (see iproto_msg::wpos).
 	 */
 	struct iproto_wpos wend;
+	/**
+	 * Zero-copy references of the corresponding output buffer.
+	 * Appended to by the tx thread, read by the iproto thread
+	 * on flush.
+	 */
+	struct iproto_zc_list zc[2];
+	/**
+	 * Last zero-copy reference of the output buffer being flushed
+	 * that has been fully written to the socket, or NULL if none.
+	 * Used only by the iproto thread.
+	 */
+	struct iproto_zc_ref *zc_sent;
+	/**
+	 * Number of bytes of the reference following zc_sent that
+	 * have been written to the socket. Used only by the iproto
+	 * thread.
+	 */
+	size_t zc_offset;
 	/*
 	 * Size of readahead which is not parsed yet, i.e. size of
 	 * a piece of request which is not fully read. Is always
@@ -1008,6 +1150,7 @@ iproto_msg_new(struct iproto_connection *con)
 	msg->connection = con;
 	msg->stream = NULL;
 	msg->fiber = NULL;
+	msg->start_time = 0;
 	rmean_collect(con->iproto_thread->rmean, IPROTO_REQUESTS, 1);
 	return msg;
 }
@@ -1378,6 +1521,8 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 
 		iproto_msg_prepare(msg, &pos, reqend);
 		if (iproto_msg_start_processing_in_stream(msg)) {
+			if (msg->start_time != 0)
+				msg->push_time = clock_monotonic64();
 			cpipe_push_input(&con->iproto_thread->tx_pipe, &msg->base);
 			n_requests++;
 		}
@@ -1533,6 +1678,116 @@ error:;
 	iproto_connection_close(con);
 }
 
+/**
+ * Returns the zero-copy reference that follows @a ref (or the first
+ * one if @a ref is NULL) in the output buffer being flushed, provided
+ * it goes before the byte at position @a end. Otherwise returns NULL.
+ */
+static inline struct iproto_zc_ref *
+iproto_zc_next(struct iproto_connection *con, struct iproto_zc_ref *ref,
+	       size_t end)
+{
+	struct iproto_zc_ref **link = ref != NULL ? &ref->next :
+		&con->zc[con->wpos.obuf == &con->obuf[1]].first;
+	struct iproto_zc_ref *next = __atomic_load_n(link, __ATOMIC_ACQUIRE);
+	return next != NULL && next->pos <= end ? next : NULL;
+}
+
+/**
+ * Account the zero-copy references that go before position @a end
+ * of the output buffer being flushed as written.
+ */
+static void
+iproto_zc_skip(struct iproto_connection *con, size_t end)
+{
+	struct iproto_zc_ref *ref;
+	while ((ref = iproto_zc_next(con, con->zc_sent, end)) != NULL)
+		con->zc_sent = ref;
+	con->zc_offset = 0;
+}
+
+/**
+ * Advance the zero-copy write position by @a nwr bytes written to
+ * the socket by iproto_writev_zc(). Returns the number of written
+ * bytes that belong to the output buffer.
+ */
+static size_t
+iproto_zc_advance(struct iproto_connection *con, size_t begin, size_t end,
+		  size_t nwr)
+{
+	size_t pos = begin;
+	struct iproto_zc_ref *ref = iproto_zc_next(con, con->zc_sent, end);
+	while (ref != NULL) {
+		size_t n = MIN(nwr, ref->pos - pos);
+		pos += n;
+		nwr -= n;
+		if (nwr == 0)
+			break;
+		n = MIN(nwr, ref->size - con->zc_offset);
+		con->zc_offset += n;
+		nwr -= n;
+		if (con->zc_offset < ref->size)
+			break;
+		con->zc_sent = ref;
+		con->zc_offset = 0;
+		ref = iproto_zc_next(con, ref, end);
+	}
+	return pos + nwr - begin;
+}
+
+/**
+ * Write the output buffer data given in @a iov, which starts at
+ * position @a begin of the output buffer, to the socket, splicing
+ * in the zero-copy references that go before position @a end,
+ * starting from @a ref. On success, sets @a is_complete if all
+ * the data was passed to writev(). Returns the same as writev().
+ */
+static ssize_t
+iproto_writev_zc(struct iproto_connection *con, const struct iovec *iov,
+		 int iovcnt, size_t begin, size_t end,
+		 struct iproto_zc_ref *ref, bool *is_complete)
+{
+	struct iovec out[SMALL_OBUF_IOV_MAX + 1 + 2 * IPROTO_ZC_WRITE_MAX];
+	int cnt = 0;
+	int ref_cnt = 0;
+	size_t offset = con->zc_offset;
+	size_t pos = begin;
+	*is_complete = false;
+	for (int i = 0; i < iovcnt; i++) {
+		char *base = (char *)iov[i].iov_base;
+		size_t len = iov[i].iov_len;
+		for (; ref != NULL && ref->pos - pos <= len;
+		     ref = iproto_zc_next(con, ref, end)) {
+			if (ref_cnt == IPROTO_ZC_WRITE_MAX)
+				goto write;
+			size_t head = ref->pos - pos;
+			if (head > 0) {
+				out[cnt].iov_base = base;
+				out[cnt].iov_len = head;
+				cnt++;
+				base += head;
+				len -= head;
+				pos += head;
+			}
+			out[cnt].iov_base = (char *)ref->data + offset;
+			out[cnt].iov_len = ref->size - offset;
+			cnt++;
+			ref_cnt++;
+			offset = 0;
+		}
+		if (len > 0) {
+			out[cnt].iov_base = base;
+			out[cnt].iov_len = len;
+			cnt++;
+			pos += len;
+		}
+	}
+	assert(ref == NULL);
+	*is_complete = true;
+write:
+	return iostream_writev(&con->io, out, cnt);
+}
+
 /** writev() to the socket and handle the result. */
 static int
 iproto_flush(struct iproto_connection *con)
@@ -1546,23 +1801,29 @@ iproto_flush(struct iproto_connection *con)
 		 * Flush the current buffer before
 		 * advancing to the next one.
 		 */
-		if (begin->used == obuf_end.used) {
+		if (begin->used == obuf_end.used &&
+		    iproto_zc_next(con, con->zc_sent, obuf_end.used) == NULL) {
 			obuf = con->wpos.obuf = con->wend.obuf;
 			obuf_svp_reset(begin);
+			con->zc_sent = NULL;
+			con->zc_offset = 0;
 		} else {
 			end = &obuf_end;
 		}
 	}
-	if (begin->used == end->used) {
+	struct iproto_zc_ref *ref = iproto_zc_next(con, con->zc_sent,
+						   end->used);
+	if (begin->used == end->used && ref == NULL) {
 		/* Nothing to do. */
 		return 1;
 	}
 	if (!con->can_write) {
 		/* Receiving end was closed. Discard the output. */
 		*begin = *end;
+		iproto_zc_skip(con, end->used);
 		return 0;
 	}
-	assert(begin->used < end->used);
+	assert(begin->used <= end->used);
 	struct iovec iov[SMALL_OBUF_IOV_MAX+1];
 	struct iovec *src = obuf->iov;
 	int iovcnt = end->pos - begin->pos + 1;
@@ -1575,21 +1836,44 @@ iproto_flush(struct iproto_connection *con)
 	/* *Overwrite* iov_len of the last pos as it may be garbage. */
 	iov[iovcnt-1].iov_len = end->iov_len - begin->iov_len * (iovcnt == 1);
 
-	ssize_t nwr = iostream_writev(&con->io, iov, iovcnt);
+	ssize_t nwr;
+	bool is_complete = true;
+	if (ref == NULL) {
+		nwr = iostream_writev(&con->io, iov, iovcnt);
+	} else {
+		nwr = iproto_writev_zc(con, iov, iovcnt, begin->used,
+				       end->used, ref, &is_complete);
+	}
 	if (nwr >= 0) {
 		/* Count statistics */
 		rmean_collect(con->iproto_thread->rmean, IPROTO_SENT, nwr);
-		if (begin->used + nwr == end->used) {
+		size_t obuf_nwr = nwr;
+		if (ref != NULL) {
+			obuf_nwr = iproto_zc_advance(con, begin->used,
+						     end->used, nwr);
+		}
+		if (begin->used + obuf_nwr == end->used) {
 			*begin = *end;
-			return 0;
+			if (iproto_zc_next(con, con->zc_sent,
+					   end->used) == NULL)
+				return 0;
+		} else {
+			size_t offset = 0;
+			int advance = 0;
+			advance = sio_move_iov(iov, obuf_nwr, &offset);
+			/* advance write position */
+			begin->used += obuf_nwr;
+			begin->iov_len = advance == 0 ?
+					 begin->iov_len + offset : offset;
+			begin->pos += advance;
+			assert(begin->pos <= end->pos);
 		}
-		size_t offset = 0;
-		int advance = 0;
-		advance = sio_move_iov(iov, nwr, &offset);
-		begin->used += nwr;             /* advance write position */
-		begin->iov_len = advance == 0 ? begin->iov_len + offset: offset;
-		begin->pos += advance;
-		assert(begin->pos <= end->pos);
+		/*
+		 * Not all the data fit in one writev() call, so
+		 * the socket may still be writable.
+		 */
+		if (!is_complete)
+			return 0;
 		return IOSTREAM_WANT_WRITE;
 	} else if (nwr == IOSTREAM_ERROR) {
 		/*
@@ -1601,6 +1885,7 @@ iproto_flush(struct iproto_connection *con)
 		diag_log();
 		con->can_write = false;
 		*begin = *end;
+		iproto_zc_skip(con, end->used);
 		return 0;
 	}
 	return nwr;
@@ -1659,6 +1944,10 @@ iproto_connection_new(struct iproto_thread *iproto_thread)
 	con->tx.p_obuf = &con->obuf[0];
 	iproto_wpos_create(&con->wpos, con->tx.p_obuf);
 	iproto_wpos_create(&con->wend, con->tx.p_obuf);
+	iproto_zc_list_create(&con->zc[0]);
+	iproto_zc_list_create(&con->zc[1]);
+	con->zc_sent = NULL;
+	con->zc_offset = 0;
 	con->parse_size = 0;
 	con->can_write = true;
 	con->long_poll_count = 0;
@@ -1802,6 +2091,8 @@ iproto_msg_prepare(struct iproto_msg *msg, const char **pos, const char *reqend)
 
 	type = msg->header.type;
 	stream_id = msg->header.stream_id;
+	if (type < IPROTO_TYPE_STAT_MAX)
+		msg->start_time = clock_monotonic64();
 	request_is_not_for_stream =
 		((type > IPROTO_TYPE_STAT_MAX &&
 		 type != IPROTO_PING) || type == IPROTO_AUTH);
@@ -2063,6 +2354,9 @@ tx_process_destroy(struct cmsg *m)
 	 * obuf is being destroyed in tx thread cause it is where
 	 * it was allocated.
 	 */
+	struct mempool *pool = &con->iproto_thread->tx.zc_ref_pool;
+	iproto_zc_list_destroy(&con->zc[0], pool);
+	iproto_zc_list_destroy(&con->zc[1], pool);
 	obuf_destroy(&con->obuf[0]);
 	obuf_destroy(&con->obuf[1]);
 }
@@ -2153,8 +2447,12 @@ tx_accept_wpos(struct iproto_connection *con, const struct iproto_wpos *wpos)
 		 * guaranteed to have been flushed first, since
 		 * buffers are never flushed out of order.
 		 */
-		if (obuf_size(prev) != 0)
+		if (obuf_size(prev) != 0) {
 			obuf_reset(prev);
+			iproto_zc_list_destroy(
+				&con->zc[prev == &con->obuf[1]],
+				&con->iproto_thread->tx.zc_ref_pool);
+		}
 	}
 	if (obuf_size(con->tx.p_obuf) != 0 && obuf_size(prev) == 0) {
 		/*
@@ -2197,6 +2495,13 @@ tx_accept_msg(struct cmsg *m)
 	rlist_add_entry(&msg->connection->tx.inprogress, msg,
 			in_inprogress);
 	msg->fiber = fiber();
+	msg->tx_start_time = clock_monotonic64();
+	if (msg->start_time != 0) {
+		latency_histogram_collect(
+			&msg->connection->iproto_thread->tx.queue_latency[
+				msg->header.type],
+			msg->tx_start_time - msg->push_time);
+	}
 	rmean_collect(msg->connection->iproto_thread->tx.rmean,
 		      REQUESTS_IN_PROGRESS, 1);
 	flightrec_write_request(msg->reqstart, msg->len);
@@ -2250,12 +2555,36 @@ tx_end_msg(struct iproto_msg *msg, struct obuf_svp *svp)
 	msg->connection->iproto_thread->tx.requests_in_progress--;
 	rlist_del(&msg->in_inprogress);
 	msg->fiber = NULL;
+	if (msg->start_time != 0) {
+		latency_histogram_collect(
+			&msg->connection->iproto_thread->tx.latency[
+				msg->header.type],
+			clock_monotonic64() - msg->tx_start_time);
+	}
 	struct obuf *out = msg->connection->tx.p_obuf;
 	if (msg->connection->tx.p_obuf->used != svp->used)
 		/* Log response to the flight recorder. */
 		flightrec_write_response(out, svp);
 }
 
+/**
+ * Same as tx_end_msg(), but also accounts the request latency in
+ * the statistics of the space the request was made to. Used for
+ * SELECT and DML requests.
+ */
+static inline void
+tx_end_dml_msg(struct iproto_msg *msg, struct obuf_svp *svp)
+{
+	struct space *space;
+	if (msg->start_time != 0 &&
+	    (space = space_by_id(msg->dml.space_id)) != NULL) {
+		space_collect_latency(space, msg->header.type,
+				      clock_monotonic64() -
+				      msg->tx_start_time);
+	}
+	tx_end_msg(msg, svp);
+}
+
 /**
  * Write error message to the output buffer and advance write position.
  */
@@ -2475,13 +2804,57 @@ tx_process1(struct cmsg *m)
 	iproto_reply_select(out, &svp, msg->header.sync, ::schema_version,
 			    tuple != 0, box_tuple_as_ext);
 	iproto_wpos_create(&msg->wpos, out);
-	tx_end_msg(msg, &svp);
+	tx_end_dml_msg(msg, &svp);
 	return;
 error:
 	out = msg->connection->tx.p_obuf;
 	svp = obuf_create_svp(out);
 	tx_reply_error(msg);
-	tx_end_msg(msg, &svp);
+	tx_end_dml_msg(msg, &svp);
+}
+
+/**
+ * Dump the tuples returned by a SELECT request to an output buffer
+ * like port_dump_msgpack_16() does, but instead of copying the tuples
+ * whose size exceeds iproto_zero_copy_threshold, reference them and
+ * add to @a zc. The size of the referenced data is added to @a zc_size.
+ * Returns the number of tuples or -1 on error.
+ */
+static int
+tx_dump_select(struct iproto_connection *con, struct port *port,
+	       struct obuf *out, struct iproto_zc_list *zc, size_t *zc_size)
+{
+	struct port_c *port_c = (struct port_c *)port;
+	struct mempool *pool = &con->iproto_thread->tx.zc_ref_pool;
+	for (struct port_c_entry *pe = port_c->first; pe != NULL;
+	     pe = pe->next) {
+		assert(pe->type == PORT_C_ENTRY_TUPLE);
+		struct tuple *tuple = pe->tuple;
+		uint32_t size;
+		const char *data = tuple_data_range(tuple, &size);
+		if (size < iproto_zero_copy_threshold) {
+			if (obuf_dup(out, data, size) != size) {
+				diag_set(OutOfMemory, size, "obuf_dup", "data");
+				return -1;
+			}
+			continue;
+		}
+		struct iproto_zc_ref *ref =
+			(struct iproto_zc_ref *)xmempool_alloc(pool);
+		ref->next = NULL;
+		ref->pos = obuf_size(out);
+		ref->tuple = tuple;
+		ref->data = data;
+		ref->size = size;
+		tuple_ref(tuple);
+		if (zc->last == NULL)
+			zc->first = ref;
+		else
+			zc->last->next = ref;
+		zc->last = ref;
+		*zc_size += size;
+	}
+	return port_c->size;
 }
 
 static void
@@ -2494,6 +2867,13 @@ tx_process_select(struct cmsg *m)
 	struct obuf *out;
 	struct obuf_svp svp;
 	struct port port;
+	struct iproto_zc_list zc;
+	iproto_zc_list_create(&zc);
+	size_t zc_size = 0;
+	auto zc_guard = make_scoped_guard([&] {
+		iproto_zc_list_destroy(
+			&zc, &msg->connection->iproto_thread->tx.zc_ref_pool);
+	});
 
 	struct mp_box_ctx ctx;
 	struct mp_ctx *ctx_ref = NULL;
@@ -2546,7 +2926,12 @@ tx_process_select(struct cmsg *m)
 	/*
 	 * SELECT output format has not changed since Tarantool 1.6
 	 */
-	count = port_dump_msgpack_16_with_ctx(&port, out, ctx_ref);
+	if (box_tuple_as_ext || iproto_zero_copy_threshold == 0) {
+		count = port_dump_msgpack_16_with_ctx(&port, out, ctx_ref);
+	} else {
+		count = tx_dump_select(msg->connection, &port, out,
+				       &zc, &zc_size);
+	}
 	port_destroy(&port);
 	if (count < 0 || (box_tuple_as_ext &&
 			  tuple_format_map_to_iproto_obuf(&ctx.tuple_format_map,
@@ -2563,9 +2948,24 @@ tx_process_select(struct cmsg *m)
 		iproto_reply_select(out, &svp, msg->header.sync,
 				    ::schema_version, count, box_tuple_as_ext);
 	}
+	if (zc_size != 0) {
+		/*
+		 * The body length doesn't account the tuple data
+		 * that isn't copied to the output buffer. Fix it
+		 * and let the iproto thread see the references.
+		 */
+		iproto_header_encode((char *)obuf_svp_to_ptr(out, &svp),
+				     IPROTO_OK, msg->header.sync,
+				     ::schema_version,
+				     obuf_size(out) - svp.used -
+				     IPROTO_HEADER_LEN + zc_size);
+		iproto_zc_list_splice(
+			&msg->connection->zc[out == &msg->connection->obuf[1]],
+			&zc);
+	}
 	region_truncate(&fiber()->gc, region_svp);
 	iproto_wpos_create(&msg->wpos, out);
-	tx_end_msg(msg, &svp);
+	tx_end_dml_msg(msg, &svp);
 	return;
 discard:
 	/* Discard the prepared select. */
@@ -2575,7 +2975,7 @@ tx_process_select(struct cmsg *m)
 	out = msg->connection->tx.p_obuf;
 	svp = obuf_create_svp(out);
 	tx_reply_error(msg);
-	tx_end_msg(msg, &svp);
+	tx_end_dml_msg(msg, &svp);
 }
 
 static int
@@ -3198,6 +3598,8 @@ iproto_msg_finish_processing_in_stream(struct iproto_msg *msg)
 		assert(stream->current != NULL);
 		stream->current->wpos = con->wpos;
 		con->iproto_thread->requests_in_stream_queue--;
+		if (stream->current->start_time != 0)
+			stream->current->push_time = clock_monotonic64();
 		cpipe_push_input(&con->iproto_thread->tx_pipe,
 				 &stream->current->base);
 		cpipe_flush_input(&con->iproto_thread->tx_pipe);
@@ -3210,6 +3612,9 @@ net_send_msg(struct cmsg *m)
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct iproto_connection *con = msg->connection;
 
+	uint64_t send_start_time = 0;
+	if (msg->start_time != 0)
+		send_start_time = clock_monotonic64();
 	iproto_msg_finish_processing_in_stream(msg);
 	if (msg->len != 0) {
 		/* Discard request (see iproto_enqueue_batch()). */
@@ -3226,6 +3631,13 @@ net_send_msg(struct cmsg *m)
 	} else if (iproto_connection_is_idle(con)) {
 		iproto_connection_close(con);
 	}
+	if (msg->start_time != 0) {
+		/* Don't account the time spent in the tx thread. */
+		latency_histogram_collect(
+			&con->iproto_thread->latency[msg->header.type],
+			msg->push_time - msg->start_time +
+			clock_monotonic64() - send_start_time);
+	}
 	iproto_msg_delete(msg);
 }
 
@@ -3680,6 +4092,8 @@ iproto_thread_init(struct iproto_thread *iproto_thread)
 	/* Init statistics counter */
 	iproto_thread->rmean = rmean_new(rmean_net_strings, RMEAN_NET_LAST);
 	iproto_thread->tx.rmean = rmean_new(rmean_tx_strings, RMEAN_TX_LAST);
+	mempool_create(&iproto_thread->tx.zc_ref_pool, &cord()->slabc,
+		       sizeof(struct iproto_zc_ref));
 	rlist_create(&iproto_thread->stopped_connections);
 	iproto_thread->tx.requests_in_progress = 0;
 	iproto_thread->requests_in_stream_queue = 0;
@@ -3955,6 +4369,11 @@ iproto_do_cfg_f(struct cbus_call_msg *m)
 	case IPROTO_CFG_STAT:
 		iproto_fill_stat(iproto_thread, cfg_msg);
 		break;
+	case IPROTO_CFG_RESET_STAT:
+		rmean_cleanup(iproto_thread->rmean);
+		for (int type = 0; type < IPROTO_TYPE_STAT_MAX; type++)
+			latency_histogram_reset(&iproto_thread->latency[type]);
+		break;
 	case IPROTO_CFG_OVERRIDE:
 		if (cfg_msg->override.is_set) {
 			uint32_t old;
@@ -4208,9 +4627,37 @@ iproto_thread_stats_get(struct iproto_stats *stats, int thread_id)
 void
 iproto_reset_stat(void)
 {
+	struct iproto_cfg_msg cfg_msg;
+	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_RESET_STAT);
 	for (int i = 0; i < iproto_threads_count; i++) {
-		rmean_cleanup(iproto_threads[i].rmean);
-		rmean_cleanup(iproto_threads[i].tx.rmean);
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		/* Statistic collected in iproto thread is reset there. */
+		iproto_do_cfg(iproto_thread, &cfg_msg);
+		rmean_cleanup(iproto_thread->tx.rmean);
+		for (int type = 0; type < IPROTO_TYPE_STAT_MAX; type++) {
+			latency_histogram_reset(
+				&iproto_thread->tx.queue_latency[type]);
+			latency_histogram_reset(
+				&iproto_thread->tx.latency[type]);
+		}
+	}
+}
+
+void
+iproto_latency_get(uint32_t type, struct latency_histogram *net,
+		   struct latency_histogram *queue,
+		   struct latency_histogram *tx)
+{
+	assert(type < IPROTO_TYPE_STAT_MAX);
+	memset(net, 0, sizeof(*net));
+	memset(queue, 0, sizeof(*queue));
+	memset(tx, 0, sizeof(*tx));
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		latency_histogram_merge(net, &iproto_thread->latency[type]);
+		latency_histogram_merge(queue,
+					&iproto_thread->tx.queue_latency[type]);
+		latency_histogram_merge(tx, &iproto_thread->tx.latency[type]);
 	}
 }
 
@@ -4324,6 +4771,7 @@ iproto_free(void)
 		evio_service_detach(&iproto_threads[i].binary);
 		rmean_delete(iproto_threads[i].rmean);
 		rmean_delete(iproto_threads[i].tx.rmean);
+		mempool_destroy(&iproto_threads[i].tx.zc_ref_pool);
 		slab_cache_destroy(&iproto_threads[i].net_slabc);
 	}
 	free(iproto_threads);
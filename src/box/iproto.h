@@ -40,6 +40,7 @@ struct uri_set;
 struct session;
 struct user;
 struct iostream;
+struct latency_histogram;
 
 #if defined(__cplusplus)
 extern "C" {
@@ -104,11 +105,27 @@ void
 iproto_thread_stats_get(struct iproto_stats *stats, int thread_id);
 
 /**
- * Reset network statistics.
+ * Reset network statistics. Statistic owned by iproto threads is
+ * reset in those threads, so the function waits for each of them.
  */
 void
 iproto_reset_stat(void);
 
+/**
+ * Get latency histograms of requests of the given type, merged over
+ * all iproto threads:
+ * - @net: processing in the iproto thread, that is decoding a request
+ *   and pushing it to the tx thread plus queuing the reply received
+ *   from the tx thread for sending;
+ * - @queue: from pushing a request to the tx thread to starting its
+ *   processing there;
+ * - @tx: processing in the tx thread, including the WAL write.
+ */
+void
+iproto_latency_get(uint32_t type, struct latency_histogram *net,
+		   struct latency_histogram *queue,
+		   struct latency_histogram *tx);
+
 /**
  * Return count of the addresses currently served by iproto.
  */
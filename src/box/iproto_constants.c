@@ -123,3 +123,10 @@ const char *vy_page_info_key_strs[vy_page_info_key_MAX] = {
 const char *vy_row_index_key_strs[vy_row_index_key_MAX] = {
 	VY_ROW_INDEX_KEYS(VY_ROW_INDEX_KEY_STRS_MEMBER)
 };
+
+#define VY_ROW_DELTA_KEY_STRS_MEMBER(s, ...) \
+	[VY_ROW_DELTA_ ## s] = #s,
+
+const char *vy_row_delta_key_strs[vy_row_delta_key_MAX] = {
+	VY_ROW_DELTA_KEYS(VY_ROW_DELTA_KEY_STRS_MEMBER)
+};
@@ -391,11 +391,12 @@ iproto_key_bit(unsigned char key)
 	_(WATCH_ONCE, 77)						\
 									\
 	/**
-	 * The following three requests are reserved for vinyl types.
+	 * The following four requests are reserved for vinyl types.
 	 *
 	 * VY_INDEX_RUN_INFO = 100
 	 * VY_INDEX_PAGE_INFO = 101
 	 * VY_RUN_ROW_INDEX = 102
+	 * VY_RUN_ROW_DELTA = 103
 	 */								\
 									\
 	/** Non-final response type. */					\
@@ -422,6 +423,8 @@ enum iproto_type {
 	VY_INDEX_PAGE_INFO = 101,
 	/** Vinyl row index stored in .run file */
 	VY_RUN_ROW_INDEX = 102,
+	/** Prefix-compressed vinyl statement stored in .run file */
+	VY_RUN_ROW_DELTA = 103,
 };
 
 /** IPROTO type name by code */
@@ -465,6 +468,8 @@ iproto_type_name(uint16_t type)
 		return "PAGEINFO";
 	case VY_RUN_ROW_INDEX:
 		return "ROWINDEX";
+	case VY_RUN_ROW_DELTA:
+		return "ROWDELTA";
 	default:
 		return NULL;
 	}
@@ -595,6 +600,8 @@ request_replace_body_create(struct request_replace_body *body,
 	_(BLOOM_FILTER, 7)						\
 	/** Number of statements of each type (map). */			\
 	_(STMT_STAT, 8)							\
+	/** Split block bloom filter for keys. */			\
+	_(BLOOM_FILTER_SPLIT, 9)					\
 
 #define VY_RUN_INFO_KEY_MEMBER(s, v) VY_RUN_INFO_ ## s = v,
 
@@ -633,6 +640,10 @@ vy_run_info_key_name(enum vy_run_info_key key)
 	_(MIN_KEY, 5)							\
 	/** Offset of the row index in the page. */			\
 	_(ROW_INDEX_OFFSET, 6)						\
+	/** Number of statements between restart points. */		\
+	_(RESTART_INTERVAL, 7)						\
+	/** Maximal key stored in the page. */				\
+	_(MAX_KEY, 8)							\
 
 #define VY_PAGE_INFO_KEY_MEMBER(s, v) VY_PAGE_INFO_ ## s = v,
 
@@ -661,6 +672,8 @@ vy_page_info_key_name(enum vy_page_info_key key)
 #define VY_ROW_INDEX_KEYS(_)						\
 	/** Array of row offsets. */					\
 	_(DATA, 1)							\
+	/** Number of statements between restart points. */		\
+	_(RESTART_INTERVAL, 2)						\
 
 #define VY_ROW_INDEX_KEY_MEMBER(s, v) VY_ROW_INDEX_ ## s = v,
 
@@ -682,6 +695,38 @@ vy_row_index_key_name(enum vy_row_index_key key)
 	return vy_row_index_key_strs[key];
 }
 
+/**
+ * Xrow keys for a prefix-compressed Vinyl statement.
+ * @sa VY_RUN_ROW_DELTA.
+ */
+#define VY_ROW_DELTA_KEYS(_)						\
+	/** Type of the statement. */					\
+	_(TYPE, 1)							\
+	/** Size of the body prefix shared with the previous row. */	\
+	_(PREFIX_SIZE, 2)						\
+	/** The rest of the statement body. */				\
+	_(SUFFIX, 3)							\
+
+#define VY_ROW_DELTA_KEY_MEMBER(s, v) VY_ROW_DELTA_ ## s = v,
+
+enum vy_row_delta_key {
+	VY_ROW_DELTA_KEYS(VY_ROW_DELTA_KEY_MEMBER)
+	vy_row_delta_key_MAX
+};
+
+/**
+ * Return vy_row_delta key name by @a key code.
+ * @param key key
+ */
+static inline const char *
+vy_row_delta_key_name(enum vy_row_delta_key key)
+{
+	if (key <= 0 || key >= vy_row_delta_key_MAX)
+		return NULL;
+	extern const char *vy_row_delta_key_strs[];
+	return vy_row_delta_key_strs[key];
+}
+
 /** Initialize the "IPROTO constants" subsystem. */
 static inline void
 iproto_constants_init(void)
@@ -251,6 +251,17 @@ lbox_cfg_set_vinyl_cache(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_bloom_memory(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_bloom_memory();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 {
@@ -289,6 +300,22 @@ lbox_set_prepared_stmt_cache_size(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_sql_sort_threads(struct lua_State *L)
+{
+	if (box_set_sql_sort_threads() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_sql_sort_memory(struct lua_State *L)
+{
+	if (box_set_sql_sort_memory() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_worker_pool_threads(struct lua_State *L)
 {
@@ -448,6 +475,14 @@ lbox_cfg_set_replication_skip_conflict(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_parallel_apply(struct lua_State *L)
+{
+	(void) L;
+	box_set_replication_parallel_apply();
+	return 0;
+}
+
 static int
 lbox_cfg_set_feedback(struct lua_State *L)
 {
@@ -512,6 +547,7 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_vinyl_memory", lbox_cfg_set_vinyl_memory},
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_cache", lbox_cfg_set_vinyl_cache},
+		{"cfg_set_vinyl_bloom_memory", lbox_cfg_set_vinyl_bloom_memory},
 		{"cfg_set_vinyl_timeout", lbox_cfg_set_vinyl_timeout},
 		{"cfg_set_force_recovery", lbox_cfg_set_force_recovery},
 		{"cfg_set_election_mode", lbox_cfg_set_election_mode},
@@ -525,12 +561,15 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_replication_synchro_timeout", lbox_cfg_set_replication_synchro_timeout},
 		{"cfg_set_replication_sync_timeout", lbox_cfg_set_replication_sync_timeout},
 		{"cfg_set_replication_skip_conflict", lbox_cfg_set_replication_skip_conflict},
+		{"cfg_set_replication_parallel_apply", lbox_cfg_set_replication_parallel_apply},
 		{"cfg_set_replication_anon", lbox_cfg_set_replication_anon},
 		{"cfg_set_replicaset_name", lbox_cfg_set_replicaset_name},
 		{"cfg_set_instance_name", lbox_cfg_set_instance_name},
 		{"cfg_set_cluster_name", lbox_cfg_set_cluster_name},
 		{"cfg_set_net_msg_max", lbox_cfg_set_net_msg_max},
 		{"cfg_set_sql_cache_size", lbox_set_prepared_stmt_cache_size},
+		{"cfg_set_sql_sort_threads", lbox_cfg_set_sql_sort_threads},
+		{"cfg_set_sql_sort_memory", lbox_cfg_set_sql_sort_memory},
 		{"cfg_set_feedback", lbox_cfg_set_feedback},
 		{"cfg_set_txn_timeout", lbox_cfg_set_txn_timeout},
 		{"cfg_set_txn_isolation", lbox_cfg_set_txn_isolation},
@@ -729,6 +729,14 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'io_collect_interval',
             default = box.NULL,
         }),
+        io_backend = schema.enum({
+            'thread',
+            'io_uring',
+        }, {
+            box_cfg = 'io_backend',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
         too_long_threshold = schema.scalar({
             type = 'number',
             box_cfg = 'too_long_threshold',
@@ -1144,6 +1152,16 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'sql_cache_size',
             default = 5 * 1024 * 1024,
         }),
+        sort_threads = schema.scalar({
+            type = 'integer',
+            box_cfg = 'sql_sort_threads',
+            default = box.NULL,
+        }),
+        sort_memory = schema.scalar({
+            type = 'integer',
+            box_cfg = 'sql_sort_memory',
+            default = box.NULL,
+        }),
     }),
     memtx = schema.record({
         memory = schema.scalar({
@@ -1188,6 +1206,12 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = box.NULL,
         }),
+        recovery_read_ahead = schema.scalar({
+            type = 'integer',
+            box_cfg = 'memtx_recovery_read_ahead',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
     }),
     vinyl = schema.record({
         bloom_fpr = schema.scalar({
@@ -1196,6 +1220,11 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = 0.05,
         }),
+        bloom_memory = schema.scalar({
+            type = 'integer',
+            box_cfg = 'vinyl_bloom_memory',
+            default = 0,
+        }),
         cache = schema.scalar({
             type = 'integer',
             box_cfg = 'vinyl_cache',
@@ -1303,6 +1332,12 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'wal_cleanup_delay',
             default = 4 * 3600,
         }),
+        compression_threads = schema.scalar({
+            type = 'integer',
+            box_cfg = 'wal_compression_threads',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
         retention_period = enterprise_edition(schema.scalar({
             type = 'number',
             box_cfg = 'wal_retention_period',
@@ -1488,6 +1523,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'replication_skip_conflict',
             default = false,
         }),
+        parallel_apply = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'replication_parallel_apply',
+            default = false,
+        }),
         election_mode = schema.enum({
             'off',
             'voter',
@@ -34,6 +34,7 @@
 #include "info/info.h"
 #include "box/box.h"
 #include "box/index.h"
+#include "box/memtx_column.h"
 #include "box/lua/tuple.h"
 #include "box/lua/misc.h"
 #include "small/region.h"
@@ -418,6 +419,59 @@ lbox_index_compact(lua_State *L)
 	return 0;
 }
 
+static int
+lbox_index_aggregate(lua_State *L)
+{
+	if (lua_gettop(L) != 5 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	    lua_type(L, 3) != LUA_TSTRING || !lua_isnumber(L, 4) ||
+	    lua_type(L, 5) != LUA_TTABLE) {
+		diag_set(IllegalParams, "Usage: index.aggregate(space_id, "
+			 "index_id, func, part, conditions)");
+		return luaT_error(L);
+	}
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+	const char *func = lua_tostring(L, 3);
+	uint32_t part = lua_tonumber(L, 4);
+	enum memtx_column_agg agg = STR2ENUM(memtx_column_agg, func);
+	if (agg == memtx_column_agg_MAX) {
+		diag_set(IllegalParams, "unknown aggregate function '%s'",
+			 func);
+		return luaT_error(L);
+	}
+	size_t conds_len;
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *conds = lbox_encode_tuple_on_gc(L, 5, &conds_len);
+	if (conds == NULL)
+		return luaT_error(L);
+
+	struct memtx_column_result result;
+	int rc = box_index_aggregate(space_id, index_id, agg, part, conds,
+				     &result);
+	region_truncate(&fiber()->gc, region_svp);
+	if (rc != 0)
+		return luaT_error(L);
+	if (result.is_null) {
+		lua_pushnil(L);
+		return 1;
+	}
+	switch (result.type) {
+	case FIELD_TYPE_UNSIGNED:
+		luaL_pushuint64(L, result.value.u);
+		break;
+	case FIELD_TYPE_INTEGER:
+		luaL_pushint64(L, result.value.i);
+		break;
+	case FIELD_TYPE_DOUBLE:
+		lua_pushnumber(L, result.value.d);
+		break;
+	default:
+		unreachable();
+	}
+	return 1;
+}
+
 /* }}} */
 
 void
@@ -451,6 +505,7 @@ box_lua_index_init(struct lua_State *L)
 		{"truncate", lbox_truncate},
 		{"stat", lbox_index_stat},
 		{"compact", lbox_index_compact},
+		{"aggregate", lbox_index_aggregate},
 		{NULL, NULL}
 	};
 
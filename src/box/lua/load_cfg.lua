@@ -111,6 +111,7 @@ local default_cfg = {
     vinyl_range_size          = nil, -- set automatically
     vinyl_page_size           = 8 * 1024,
     vinyl_bloom_fpr           = 0.05,
+    vinyl_bloom_memory        = 0,
 
     log                 = log.cfg.log,
     log_nonblock        = log.cfg.nonblock,
@@ -149,6 +150,7 @@ local default_cfg = {
     flightrec_requests_max_res_size = ifdef_flightrec(16384),
 
     io_collect_interval = nil,
+    io_backend          = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
     too_long_threshold  = 0.5,
@@ -159,6 +161,7 @@ local default_cfg = {
     wal_cleanup_delay   = 4 * 3600,
     wal_retention_period = ifdef_wal_retention_period(0),
     wal_ext             = ifdef_wal_ext(nil),
+    wal_compression_threads = nil,
     force_recovery      = false,
     replication         = nil,
     instance_uuid       = nil,
@@ -189,6 +192,7 @@ local default_cfg = {
     replication_connect_timeout = 30,
     replication_connect_quorum = nil, -- connect all
     replication_skip_conflict = false,
+    replication_parallel_apply = false,
     replication_anon      = false,
     replication_threads   = 1,
     bootstrap_strategy    = "auto",
@@ -202,9 +206,12 @@ local default_cfg = {
     feedback_metrics_limit = ifdef_feedback(1024 * 1024),
     net_msg_max           = 768,
     sql_cache_size        = 5 * 1024 * 1024,
+    sql_sort_threads      = nil,
+    sql_sort_memory       = nil,
     txn_timeout           = 365 * 100 * 86400,
     txn_isolation         = "best-effort",
     memtx_sort_threads    = nil,
+    memtx_recovery_read_ahead = nil,
 
     metrics     = {
         include = 'all',
@@ -311,6 +318,7 @@ local template_cfg = {
     vinyl_range_size          = 'number',
     vinyl_page_size           = 'number',
     vinyl_bloom_fpr           = 'number',
+    vinyl_bloom_memory        = 'number',
 
     log                 = 'string',
     log_nonblock        = 'boolean',
@@ -349,6 +357,7 @@ local template_cfg = {
     flightrec_requests_max_res_size = ifdef_flightrec('number'),
 
     io_collect_interval = 'number',
+    io_backend          = 'string',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
     too_long_threshold  = 'number',
@@ -358,6 +367,7 @@ local template_cfg = {
     wal_cleanup_delay   = 'number',
     wal_retention_period = ifdef_wal_retention_period('number'),
     wal_ext             = ifdef_wal_ext('table'),
+    wal_compression_threads = 'number',
     force_recovery      = 'boolean',
     replication         = 'string, number, table',
     instance_uuid       = 'string',
@@ -390,6 +400,7 @@ local template_cfg = {
     replication_connect_timeout = 'number',
     replication_connect_quorum = 'number',
     replication_skip_conflict = 'boolean',
+    replication_parallel_apply = 'boolean',
     replication_anon      = 'boolean',
     replication_threads   = 'number',
     bootstrap_strategy    = 'string',
@@ -403,8 +414,11 @@ local template_cfg = {
     feedback_metrics_limit = ifdef_feedback('number'),
     net_msg_max           = 'number',
     sql_cache_size        = 'number',
+    sql_sort_threads      = 'number',
+    sql_sort_memory       = 'number',
     txn_timeout           = 'number',
     memtx_sort_threads    = 'number',
+    memtx_recovery_read_ahead = 'number',
 
     metrics = 'table',
 }
@@ -495,6 +509,7 @@ local dynamic_cfg = {
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
+    vinyl_bloom_memory      = private.cfg_set_vinyl_bloom_memory,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
     vinyl_defer_deletes     = nop,
     checkpoint_count        = private.cfg_set_checkpoint_count,
@@ -521,6 +536,7 @@ local dynamic_cfg = {
     replication_synchro_quorum = private.cfg_set_replication_synchro_quorum,
     replication_synchro_timeout = private.cfg_set_replication_synchro_timeout,
     replication_skip_conflict = private.cfg_set_replication_skip_conflict,
+    replication_parallel_apply = private.cfg_set_replication_parallel_apply,
     replication_anon        = private.cfg_set_replication_anon,
     bootstrap_strategy      = private.cfg_set_bootstrap_strategy,
     instance_uuid           = check_instance_uuid,
@@ -530,6 +546,8 @@ local dynamic_cfg = {
     cluster_name            = private.cfg_set_cluster_name,
     net_msg_max             = private.cfg_set_net_msg_max,
     sql_cache_size          = private.cfg_set_sql_cache_size,
+    sql_sort_threads        = private.cfg_set_sql_sort_threads,
+    sql_sort_memory         = private.cfg_set_sql_sort_memory,
     txn_timeout             = private.cfg_set_txn_timeout,
     txn_isolation           = private.cfg_set_txn_isolation,
     auth_type               = private.cfg_set_auth_type,
@@ -670,6 +688,7 @@ local dynamic_cfg_skip_at_load = {
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
+    vinyl_bloom_memory      = true,
     vinyl_timeout           = true,
     too_long_threshold      = true,
     election_mode           = true,
@@ -684,6 +703,7 @@ local dynamic_cfg_skip_at_load = {
     replication_synchro_quorum = true,
     replication_synchro_timeout = true,
     replication_skip_conflict = true,
+    replication_parallel_apply = true,
     replication_anon        = true,
     bootstrap_strategy      = true,
     wal_dir_rescan_delay    = true,
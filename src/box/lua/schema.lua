@@ -937,6 +937,8 @@ box.schema.space.drop = atomic_wrapper(function(space_id, space_name, opts)
     local _truncate = box.space[box.schema.TRUNCATE_ID]
     local _space_sequence = box.space[box.schema.SPACE_SEQUENCE_ID]
     local _func_index = box.space[box.schema.FUNC_INDEX_ID]
+    -- Missing until the schema is upgraded to 3.1.0.
+    local _sql_stat = box.space[box.schema.SQL_STAT_ID]
     -- This is needed to support dropping temporary spaces
     -- in read-only mode, because sequences aren't supported for them yet
     -- and therefore such requests aren't allowed in read-only mode.
@@ -953,6 +955,11 @@ box.schema.space.drop = atomic_wrapper(function(space_id, space_name, opts)
     for _, t in _func_index.index.primary:pairs({space_id}) do
         _func_index:delete({space_id, t.index_id})
     end
+    if _sql_stat ~= nil then
+        for _, t in _sql_stat:pairs({space_id}) do
+            _sql_stat:delete({space_id, t.index_id})
+        end
+    end
     local keys = _vindex:select(space_id)
     for i = #keys, 1, -1 do
         local v = keys[i]
@@ -1540,6 +1547,10 @@ local index_options = {
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
+    cache_size = 'number',
+    page_restart_interval = 'number',
+    page_fences = 'boolean',
+    adaptive_hash_size = 'number',
     func = 'number, string',
     hint = 'boolean',
 }
@@ -1615,6 +1626,7 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
     local type_dependent_defaults = {
         rtree = {parts = { 2, 'array' }, unique = false},
         bitset = {parts = { 2, 'unsigned' }, unique = false},
+        column = {parts = { 2, 'unsigned' }, unique = false},
         other = {parts = { 1, 'unsigned' }, unique = true},
     }
     options_defaults = type_dependent_defaults[options.type]
@@ -1682,6 +1694,10 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
             bloom_fpr = options.bloom_fpr,
+            cache_size = options.cache_size,
+            page_restart_interval = options.page_restart_interval,
+            page_fences = options.page_fences,
+            adaptive_hash_size = options.adaptive_hash_size,
             func = options.func,
             hint = options.hint,
     }
@@ -1723,6 +1739,14 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
     return space.index[name]
 end)
 
+-- Delete statistics of an index collected by SQL ANALYZE.
+local function sql_stat_delete(space_id, index_id)
+    local _sql_stat = box.space[box.schema.SQL_STAT_ID]
+    if _sql_stat ~= nil and _sql_stat:get{space_id, index_id} ~= nil then
+        _sql_stat:delete{space_id, index_id}
+    end
+end
+
 box.schema.index.drop = atomic_wrapper(function(space_id, index_id)
     check_param(space_id, 'space_id', 'number', 2)
     check_param(index_id, 'index_id', 'number', 2)
@@ -1744,6 +1768,7 @@ box.schema.index.drop = atomic_wrapper(function(space_id, index_id)
     for _, v in box.space._func_index:pairs{space_id, index_id} do
         _func_index:delete({v.space_id, v.index_id})
     end
+    sql_stat_delete(space_id, index_id)
     _index:delete{space_id, index_id}
 
     feedback_save_event('drop_index')
@@ -1805,6 +1830,7 @@ box.schema.index.alter = atomic_wrapper(function(space_id, index_id, options)
         add_op(options.id, 2)
         add_op(options.name, 3)
         add_op(options.type, 4)
+        sql_stat_delete(space_id, index_id)
         _index:update({space_id, index_id}, ops)
         return
     end
@@ -1854,6 +1880,9 @@ box.schema.index.alter = atomic_wrapper(function(space_id, index_id, options)
                                                         space_id, index_id,
                                                         space.name,
                                                         options.name, 2)
+    if options.parts ~= nil or options.type ~= tuple.type then
+        sql_stat_delete(space_id, index_id)
+    end
     _index:replace{space_id, index_id, options.name, options.type,
                    index_opts, parts}
     if index_opts.func ~= nil then
@@ -2490,6 +2519,52 @@ base_index_mt.count_luac = function(index, key, opts)
     return internal.count(index.space_id, index.id, itype, key);
 end
 
+-- Find the number of the index part indexing the given field.
+local function index_part_by_field(index, field, level)
+    local fieldno = field
+    if type(field) == 'string' then
+        local format = box.space[index.space_id]:format()
+        fieldno = nil
+        for i, f in ipairs(format) do
+            if f.name == field then
+                fieldno = i
+                break
+            end
+        end
+    end
+    for i, part in ipairs(index.parts) do
+        if part.fieldno == fieldno then
+            return i - 1
+        end
+    end
+    box.error(box.error.ILLEGAL_PARAMS, string.format(
+              "field %s is not indexed by index '%s'", tostring(field),
+              index.name), level + 1)
+end
+
+-- aggregate function over a COLUMN index
+base_index_mt.aggregate = function(index, func, field, conditions)
+    check_index_arg(index, 'aggregate', 2)
+    check_param(func, 'func', 'string', 2)
+    if conditions ~= nil then
+        check_param(conditions, 'conditions', 'table', 2)
+    end
+    local part = 0
+    if field ~= nil then
+        part = index_part_by_field(index, field, 2)
+    end
+    local conds = {}
+    for i, cond in ipairs(conditions or {}) do
+        if type(cond) ~= 'table' or #cond ~= 3 then
+            box.error(box.error.ILLEGAL_PARAMS, "conditions must be " ..
+                      "an array of {operator, field, value}", 2)
+        end
+        conds[i] = {cond[1], index_part_by_field(index, cond[2], 2),
+                    cond[3]}
+    end
+    return internal.aggregate(index.space_id, index.id, func, part, conds)
+end
+
 base_index_mt.get_ffi = function(index, key)
     if builtin.box_read_ffi_is_disabled then
         return base_index_mt.get_luac(index, key)
@@ -2743,6 +2818,151 @@ space_mt.replace = function(space, tuple)
     return internal.replace(space.id, tuple);
 end
 space_mt.put = space_mt.replace; -- put is an alias for replace
+
+-- Default number of tuples committed in one bulk load transaction.
+local BULK_LOAD_BATCH_SIZE = 1000
+
+local bulk_load_options = {
+    batch_size = function(batch_size, level)
+        if type(batch_size) ~= 'number' or batch_size <= 0 or
+                batch_size > 0xffffffff or
+                math.floor(batch_size) ~= batch_size then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "batch_size must be a positive integer", level + 1)
+        end
+        return true
+    end,
+    mode = function(mode, level)
+        if mode ~= 'insert' and mode ~= 'replace' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "mode must be either 'insert' or 'replace'", level + 1)
+        end
+        return true
+    end,
+}
+
+-- Loads tuples into the space in transactions of batch_size statements
+-- each. Returns the number of loaded tuples.
+local function bulk_load_batches(space, source, batch_size, is_replace)
+    if type(source) == 'string' then
+        return internal.space.bulk_load(space.id, source, batch_size,
+                                        is_replace)
+    end
+    local next_tuple
+    if type(source) == 'table' then
+        local i = 0
+        next_tuple = function()
+            i = i + 1
+            return source[i]
+        end
+    else
+        next_tuple = source
+    end
+    local load = is_replace and internal.replace or internal.insert
+    local count = 0
+    local batch = {}
+    while true do
+        -- The source may yield so the batch is collected before
+        -- the transaction is started.
+        local n = 0
+        while n < batch_size do
+            local tuple = next_tuple()
+            if tuple == nil then
+                break
+            end
+            n = n + 1
+            batch[n] = tuple
+        end
+        if n == 0 then
+            break
+        end
+        box.begin()
+        for i = 1, n do
+            local ok, err = pcall(load, space.id, batch[i])
+            if not ok then
+                box.rollback()
+                error(err)
+            end
+            batch[i] = nil
+        end
+        box.commit()
+        count = count + n
+    end
+    return count
+end
+
+-- Returns the definitions (_index tuples) of the secondary indexes of
+-- the space if they can be built after the space is filled, i.e. if
+-- it's an empty memtx space, or nil otherwise.
+local function bulk_load_deferred_indexes(space)
+    if space.engine ~= 'memtx' or space:len() > 0 then
+        return nil
+    end
+    local indexes = {}
+    for _, index in box.space._index:pairs({space.id}) do
+        if index.iid ~= 0 then
+            table.insert(indexes, index)
+        end
+    end
+    return #indexes > 0 and indexes or nil
+end
+
+-- Loads tuples into an empty memtx space with only the primary index
+-- and then builds the secondary indexes, sorting each of them once
+-- rather than inserting tuples one by one. The load is all or nothing:
+-- on failure, for example, if a unique secondary key is duplicated,
+-- the space is truncated and its indexes are restored.
+local function bulk_load_deferred(space, indexes, source, batch_size,
+                                  is_replace)
+    local _index = box.space._index
+    local ok, res = pcall(function()
+        for i = #indexes, 1, -1 do
+            _index:delete({space.id, indexes[i].iid})
+        end
+        local count = bulk_load_batches(space, source, batch_size,
+                                        is_replace)
+        for _, index in ipairs(indexes) do
+            _index:insert(index)
+        end
+        return count
+    end)
+    if not ok then
+        space:truncate()
+        for _, index in ipairs(indexes) do
+            if _index:get({space.id, index.iid}) == nil then
+                _index:insert(index)
+            end
+        end
+        error(res, 0)
+    end
+    return res
+end
+
+-- Loads tuples into the space in transactions of opts.batch_size
+-- statements each. The source is either a MsgPack stream of tuples
+-- (a string), or a table of tuples, or a function returning the next
+-- tuple on each call and nil in the end. Returns the number of loaded
+-- tuples.
+space_mt.bulk_load = function(space, source, opts)
+    check_space_arg(space, 'bulk_load', 2)
+    check_param_table(opts, bulk_load_options, 2)
+    local batch_size = opts and opts.batch_size or BULK_LOAD_BATCH_SIZE
+    local is_replace = opts ~= nil and opts.mode == 'replace'
+    if box.is_in_txn() then
+        box.error(box.error.ACTIVE_TRANSACTION, 2)
+    end
+    if type(source) ~= 'string' and type(source) ~= 'table' and
+            type(source) ~= 'function' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "source must be a string, a table or a function", 2)
+    end
+    local indexes = bulk_load_deferred_indexes(space)
+    if indexes ~= nil then
+        return bulk_load_deferred(space, indexes, source, batch_size,
+                                  is_replace)
+    end
+    return bulk_load_batches(space, source, batch_size, is_replace)
+end
 space_mt.update = function(space, key, ops)
     check_space_arg(space, 'update', 2)
     return check_primary_index(space, 2):update(key, ops)
@@ -565,6 +565,11 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnil(L);
 			lua_setfield(L, -2, "hint");
 		}
+		if (space_is_memtx(space) && index_opts->adaptive_hash_size > 0)
+			lua_pushnumber(L, index_opts->adaptive_hash_size);
+		else
+			lua_pushnil(L);
+		lua_setfield(L, -2, "adaptive_hash_size");
 
 		if (index_opts->func_id > 0) {
 			lua_pushstring(L, "func");
@@ -653,6 +658,22 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnumber(L, index_opts->bloom_fpr);
 			lua_setfield(L, -2, "bloom_fpr");
 
+			if (index_opts->cache_size > 0) {
+				lua_pushnumber(L, index_opts->cache_size);
+				lua_setfield(L, -2, "cache_size");
+			}
+
+			if (index_opts->page_restart_interval > 0) {
+				lua_pushnumber(L,
+					index_opts->page_restart_interval);
+				lua_setfield(L, -2, "page_restart_interval");
+			}
+
+			if (index_opts->page_fences) {
+				lua_pushboolean(L, true);
+				lua_setfield(L, -2, "page_fences");
+			}
+
 			lua_settable(L, -3);
 		}
 		lua_setfield(L, -2, index_def->name);
@@ -853,6 +874,30 @@ lbox_space_frommap(struct lua_State *L)
 	return luaL_error(L, "Usage: space:frommap(map, opts)");
 }
 
+/**
+ * Load tuples from a MsgPack stream into a space in batches.
+ * Takes the space id, the stream, the batch size and the replace flag.
+ * Returns the number of loaded tuples.
+ */
+static int
+lbox_space_bulk_load(struct lua_State *L)
+{
+	if (lua_gettop(L) != 4 || !lua_isnumber(L, 1) ||
+	    lua_type(L, 2) != LUA_TSTRING || !lua_isnumber(L, 3))
+		return luaL_error(L, "Usage: space:bulk_load(data, opts)");
+	uint32_t space_id = lua_tointeger(L, 1);
+	size_t size;
+	const char *data = lua_tolstring(L, 2, &size);
+	uint32_t batch_size = lua_tointeger(L, 3);
+	bool is_replace = lua_toboolean(L, 4);
+	uint64_t count;
+	if (box_bulk_load(space_id, data, data + size, batch_size,
+			  is_replace, &count) != 0)
+		return luaT_error(L);
+	luaL_pushuint64(L, count);
+	return 1;
+}
+
 /**
  * Push to Lua stack a table with the statistics on the memory usage by tuples
  * of the space.
@@ -969,6 +1014,8 @@ box_lua_space_init(struct lua_State *L)
 	lua_setfield(L, -2, "FUNC_INDEX_ID");
 	lua_pushnumber(L, BOX_SESSION_SETTINGS_ID);
 	lua_setfield(L, -2, "SESSION_SETTINGS_ID");
+	lua_pushnumber(L, BOX_SQL_STAT_ID);
+	lua_setfield(L, -2, "SQL_STAT_ID");
 	lua_pushnumber(L, BOX_SYSTEM_ID_MIN);
 	lua_setfield(L, -2, "SYSTEM_ID_MIN");
 	lua_pushnumber(L, BOX_SYSTEM_ID_MAX);
@@ -1010,6 +1057,7 @@ box_lua_space_init(struct lua_State *L)
 	static const struct luaL_Reg space_internal_lib[] = {
 		{"frommap", lbox_space_frommap},
 		{"stat", lbox_space_stat},
+		{"bulk_load", lbox_space_bulk_load},
 		{NULL, NULL}
 	};
 	luaL_findtable(L, LUA_GLOBALSINDEX, "box.internal.space", 0);
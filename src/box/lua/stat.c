@@ -33,6 +33,7 @@
 
 #include <string.h>
 #include <rmean.h>
+#include <latency_histogram.h>
 
 #include <lua.h>
 #include <lauxlib.h>
@@ -44,6 +45,8 @@
 #include "box/vinyl.h"
 #include "box/sql.h"
 #include "box/memtx_engine.h"
+#include "box/space.h"
+#include "box/txn.h"
 #include "info/info.h"
 #include "lua/info.h"
 #include "lua/utils.h"
@@ -326,6 +329,86 @@ lbox_stat_sql(struct lua_State *L)
 	return 1;
 }
 
+/** Append a latency histogram summary to an info table. */
+static void
+latency_histogram_info(struct info_handler *h, const char *key,
+		       const struct latency_histogram *hist)
+{
+	info_table_begin(h, key);
+	info_append_int(h, "count", latency_histogram_count(hist));
+	info_append_double(h, "p50", latency_histogram_percentile(hist, 50));
+	info_append_double(h, "p99", latency_histogram_percentile(hist, 99));
+	info_append_double(h, "p999",
+			   latency_histogram_percentile(hist, 99.9));
+	info_append_double(h, "max", (double)hist->max / 1000000);
+	info_table_end(h);
+}
+
+static int
+lbox_stat_latency_space(struct space *space, void *arg)
+{
+	struct info_handler *h = (struct info_handler *)arg;
+	bool is_empty = true;
+	for (uint32_t type = 0; type < lengthof(space->latency); type++) {
+		struct latency_histogram *hist = space->latency[type];
+		if (hist == NULL || latency_histogram_count(hist) == 0)
+			continue;
+		if (is_empty)
+			info_table_begin(h, space_name(space));
+		is_empty = false;
+		latency_histogram_info(h, iproto_type_name(type), hist);
+	}
+	if (!is_empty)
+		info_table_end(h);
+	return 0;
+}
+
+/**
+ * box.stat.latency()
+ *
+ * Returns request latency percentiles, in seconds:
+ *
+ * - request: per request type, the time spent by a request in
+ *   the iproto thread (net), waiting in the tx queue (queue) and
+ *   being processed in the tx thread, including WAL (tx);
+ * - wal: WAL write latency;
+ * - space: per space and per request type, the time spent in
+ *   the tx thread by SELECT and DML requests.
+ *
+ * Only request types and spaces that have been accessed since
+ * the last box.stat.reset() are shown.
+ */
+static int
+lbox_stat_latency(struct lua_State *L)
+{
+	struct info_handler h;
+	luaT_info_handler_create(&h, L);
+	info_begin(&h);
+	info_table_begin(&h, "request");
+	struct latency_histogram net, queue, tx;
+	for (uint32_t type = 0; type < IPROTO_TYPE_STAT_MAX; type++) {
+		const char *name = iproto_type_name(type);
+		if (name == NULL || !filter_box_stat_item(name))
+			continue;
+		iproto_latency_get(type, &net, &queue, &tx);
+		if (latency_histogram_count(&net) == 0 &&
+		    latency_histogram_count(&tx) == 0)
+			continue;
+		info_table_begin(&h, name);
+		latency_histogram_info(&h, "net", &net);
+		latency_histogram_info(&h, "queue", &queue);
+		latency_histogram_info(&h, "tx", &tx);
+		info_table_end(&h);
+	}
+	info_table_end(&h); /* request */
+	latency_histogram_info(&h, "wal", &txn_wal_latency);
+	info_table_begin(&h, "space");
+	space_foreach(lbox_stat_latency_space, &h);
+	info_table_end(&h); /* space */
+	info_end(&h);
+	return 1;
+}
+
 static const struct luaL_Reg lbox_stat_meta [] = {
 	{"__index", lbox_stat_index},
 	{"__call",  lbox_stat_call},
@@ -367,6 +450,7 @@ box_lua_stat_init(struct lua_State *L)
 		{"vinyl", lbox_stat_vinyl},
 		{"reset", lbox_stat_reset},
 		{"sql", lbox_stat_sql},
+		{"latency", lbox_stat_latency},
 		{NULL, NULL}
 	};
 
@@ -1416,8 +1416,28 @@ local function add_trigger_to_func()
     _space:update({_vfunc.id}, ops)
 end
 
+local function create_sql_stat_space()
+    log.info("create space _sql_stat")
+    local _space = box.space[box.schema.SPACE_ID]
+    local _index = box.space[box.schema.INDEX_ID]
+    local _priv = box.space[box.schema.PRIV_ID]
+    local format = {{name = 'space_id', type = 'unsigned'},
+                    {name = 'index_id', type = 'unsigned'},
+                    {name = 'tuple_count', type = 'unsigned'},
+                    {name = 'distinct', type = 'array'},
+                    {name = 'samples', type = 'array'}}
+    _space:insert{box.schema.SQL_STAT_ID, ADMIN, '_sql_stat', 'memtx', 0,
+                  setmap({}), format}
+    log.info("create index primary on _sql_stat")
+    _index:insert{box.schema.SQL_STAT_ID, 0, 'primary', 'tree',
+                  {unique = true}, {{0, 'unsigned'}, {1, 'unsigned'}}}
+    -- Statistics are written by ANALYZE on behalf of admin.
+    _priv:insert{ADMIN, PUBLIC, 'space', box.schema.SQL_STAT_ID, box.priv.R}
+end
+
 local function upgrade_to_3_1_0()
     add_trigger_to_func()
+    create_sql_stat_space()
 end
 
 --------------------------------------------------------------------------------
@@ -1999,8 +2019,27 @@ local function drop_trigger_from_func(issue_handler)
     end
 end
 
+-- See create_sql_stat_space.
+local function drop_sql_stat_space(issue_handler)
+    local _sql_stat = box.space[box.schema.SQL_STAT_ID]
+    if issue_handler.dry_run or _sql_stat == nil then
+        return
+    end
+    local _priv = box.space[box.schema.PRIV_ID]
+    log.info("revoke grants on _sql_stat")
+    for _, v in _priv.index.object:pairs({'space', _sql_stat.id}) do
+        _priv:delete{v.grantee, v.object_type, v.object_id}
+    end
+    log.info("drop index primary on _sql_stat")
+    box.space._index:delete{_sql_stat.id, 0}
+    box.space._truncate:delete{_sql_stat.id}
+    log.info("drop space _sql_stat")
+    box.space._space:delete{_sql_stat.id}
+end
+
 local function downgrade_from_3_1_0(issue_handler)
     drop_trigger_from_func(issue_handler)
+    drop_sql_stat_space(issue_handler)
 end
 
 -- Versions should be ordered from newer to older.
@@ -0,0 +1,950 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_column.h"
+
+#include <limits>
+#include <math.h>
+#include <string.h>
+#include <small/mempool.h>
+
+#include "trivia/util.h"
+
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "index.h"
+#include "key_def.h"
+#include "memtx_engine.h"
+#include "memtx_tx.h"
+#include "msgpuck.h"
+#include "schema.h"
+#include "space.h"
+#include "tuple.h"
+#include "txn.h"
+#include "user_def.h"
+
+const char *memtx_column_agg_strs[] = {"count", "sum", "min", "max"};
+
+const char *memtx_column_op_strs[] = {"=", "~=", "<", "<=", ">", ">="};
+
+enum {
+	/** Number of rows processed by an aggregate kernel at once. */
+	MEMTX_COLUMN_CHUNK_SIZE = 1024,
+	/** Initial capacity of the column arrays. */
+	MEMTX_COLUMN_MIN_CAPACITY = 1024,
+};
+
+struct memtx_column_index {
+	struct index base;
+	/** Number of tuples stored in the index. */
+	uint32_t count;
+	/** Number of tuples the arrays have room for. */
+	uint32_t capacity;
+	/** Indexed tuples, in the same order as the column values. */
+	struct tuple **tuples;
+	/** Map: tuple -> its position in the arrays. */
+	struct mh_column_index_t *tuple_to_pos;
+	/** Number of columns, equals the number of key parts. */
+	uint32_t column_count;
+	/**
+	 * Value arrays, one per key part. Each array stores elements
+	 * of the type that corresponds to the key part type: uint64_t
+	 * for UNSIGNED, int64_t for INTEGER, double for DOUBLE.
+	 */
+	union memtx_column_value **columns;
+};
+
+struct column_hash_entry {
+	struct tuple *tuple;
+	uint32_t pos;
+};
+
+#define mh_int_t uint32_t
+#define mh_arg_t int
+
+#if UINTPTR_MAX == 0xffffffff
+#define mh_hash_key(a, arg) ((uintptr_t)(a))
+#else
+#define mh_hash_key(a, arg) ((uint32_t)(((uintptr_t)(a)) >> 33 ^ ((uintptr_t)(a)) ^ ((uintptr_t)(a)) << 11))
+#endif
+#define mh_hash(a, arg) mh_hash_key((a)->tuple, arg)
+#define mh_cmp(a, b, arg) ((a)->tuple != (b)->tuple)
+#define mh_cmp_key(a, b, arg) ((a) != (b)->tuple)
+
+#define mh_node_t struct column_hash_entry
+#define mh_key_t struct tuple *
+#define mh_name _column_index
+#define MH_SOURCE 1
+#include <salad/mhash.h>
+
+/* {{{ Column storage ********************************************/
+
+/**
+ * Decode the values of the key parts of @a tuple.
+ * Returns -1 and sets diag if a value can't be stored in a column.
+ */
+static int
+memtx_column_decode(struct key_def *key_def, struct tuple *tuple,
+		    union memtx_column_value *values)
+{
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		struct key_part *part = &key_def->parts[i];
+		const char *field = tuple_field_by_part(tuple, part,
+							MULTIKEY_NONE);
+		/* Nullable parts are rejected by check_index_def. */
+		assert(field != NULL && mp_typeof(*field) != MP_NIL);
+		switch (part->type) {
+		case FIELD_TYPE_UNSIGNED:
+			values[i].u = mp_decode_uint(&field);
+			break;
+		case FIELD_TYPE_INTEGER:
+			if (mp_read_int64(&field, &values[i].i) != 0) {
+				diag_set(ClientError, ER_UNSUPPORTED,
+					 "COLUMN index", "integer values "
+					 "greater than INT64_MAX");
+				return -1;
+			}
+			break;
+		case FIELD_TYPE_DOUBLE:
+			if (mp_read_double_lossy(&field, &values[i].d) != 0)
+				unreachable();
+			break;
+		default:
+			unreachable();
+		}
+	}
+	return 0;
+}
+
+/**
+ * Make sure the index arrays have room for @a capacity tuples.
+ * Arrays are only grown, so on failure the index stays usable.
+ */
+static int
+memtx_column_index_reserve_impl(struct memtx_column_index *index,
+				uint32_t capacity)
+{
+	if (capacity <= index->capacity)
+		return 0;
+	capacity = MAX(capacity, MEMTX_COLUMN_MIN_CAPACITY);
+	capacity = MAX(capacity, index->capacity * 2);
+	size_t size = (size_t)capacity * sizeof(*index->tuples);
+	struct tuple **tuples = (struct tuple **)realloc(index->tuples, size);
+	if (tuples == NULL)
+		goto fail;
+	index->tuples = tuples;
+	size = (size_t)capacity * sizeof(**index->columns);
+	for (uint32_t i = 0; i < index->column_count; i++) {
+		union memtx_column_value *values = (union memtx_column_value *)
+			realloc(index->columns[i], size);
+		if (values == NULL)
+			goto fail;
+		index->columns[i] = values;
+	}
+	index->capacity = capacity;
+	return 0;
+fail:
+	diag_set(OutOfMemory, size, "realloc", "memtx column index");
+	return -1;
+}
+
+/** Append a tuple with decoded key part values to the index. */
+static void
+memtx_column_index_append(struct memtx_column_index *index,
+			  struct tuple *tuple,
+			  const union memtx_column_value *values)
+{
+	assert(index->count < index->capacity);
+	uint32_t pos = index->count++;
+	index->tuples[pos] = tuple;
+	for (uint32_t i = 0; i < index->column_count; i++)
+		index->columns[i][pos] = values[i];
+	struct column_hash_entry entry;
+	entry.tuple = tuple;
+	entry.pos = pos;
+	mh_column_index_put(index->tuple_to_pos, &entry, NULL, 0);
+}
+
+/**
+ * Remove a tuple from the index. The last tuple is moved to
+ * the freed position so that the arrays stay dense.
+ * Returns false if the tuple isn't in the index.
+ */
+static bool
+memtx_column_index_remove(struct memtx_column_index *index,
+			  struct tuple *tuple)
+{
+	mh_int_t k = mh_column_index_find(index->tuple_to_pos, tuple, 0);
+	if (k == mh_end(index->tuple_to_pos))
+		return false;
+	uint32_t pos = mh_column_index_node(index->tuple_to_pos, k)->pos;
+	mh_column_index_del(index->tuple_to_pos, k, 0);
+	uint32_t last = --index->count;
+	if (pos == last)
+		return true;
+	struct tuple *moved = index->tuples[last];
+	index->tuples[pos] = moved;
+	for (uint32_t i = 0; i < index->column_count; i++)
+		index->columns[i][pos] = index->columns[i][last];
+	k = mh_column_index_find(index->tuple_to_pos, moved, 0);
+	assert(k != mh_end(index->tuple_to_pos));
+	mh_column_index_node(index->tuple_to_pos, k)->pos = pos;
+	return true;
+}
+
+/* }}} */
+
+/* {{{ Aggregate kernels *****************************************/
+
+/*
+ * The kernels below process a chunk of rows at a time. A selection
+ * vector holds 1 for each row that satisfies all the conditions
+ * checked so far and 0 otherwise. The loops are branch-free so that
+ * the compiler can vectorize them.
+ */
+
+/** Clear the selection of rows that don't satisfy a condition. */
+template <class T>
+static void
+memtx_column_filter(const T *values, uint32_t n, enum memtx_column_op op,
+		    T value, uint8_t *sel)
+{
+	switch (op) {
+	case MEMTX_COLUMN_OP_EQ:
+		for (uint32_t i = 0; i < n; i++)
+			sel[i] &= values[i] == value;
+		break;
+	case MEMTX_COLUMN_OP_NE:
+		for (uint32_t i = 0; i < n; i++)
+			sel[i] &= values[i] != value;
+		break;
+	case MEMTX_COLUMN_OP_LT:
+		for (uint32_t i = 0; i < n; i++)
+			sel[i] &= values[i] < value;
+		break;
+	case MEMTX_COLUMN_OP_LE:
+		for (uint32_t i = 0; i < n; i++)
+			sel[i] &= values[i] <= value;
+		break;
+	case MEMTX_COLUMN_OP_GT:
+		for (uint32_t i = 0; i < n; i++)
+			sel[i] &= values[i] > value;
+		break;
+	case MEMTX_COLUMN_OP_GE:
+		for (uint32_t i = 0; i < n; i++)
+			sel[i] &= values[i] >= value;
+		break;
+	default:
+		unreachable();
+	}
+}
+
+/** Return the number of selected rows. */
+static uint32_t
+memtx_column_count(const uint8_t *sel, uint32_t n)
+{
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < n; i++)
+		count += sel[i];
+	return count;
+}
+
+/**
+ * Accumulator of a sum of 64-bit integers. The upper and lower
+ * halves of the values are summed up separately, which can't
+ * overflow for up to 2^32 values, so the loop has no overflow
+ * checks and the resulting sum is exact.
+ */
+template <class T>
+struct memtx_column_int_sum {
+	/** Sum of the upper halves (arithmetic shift for signed). */
+	T hi;
+	/** Sum of the lower halves. */
+	uint64_t lo;
+};
+
+template <class T>
+static void
+memtx_column_sum(const T *values, const uint8_t *sel, uint32_t n,
+		 struct memtx_column_int_sum<T> *sum)
+{
+	T hi = 0;
+	uint64_t lo = 0;
+	for (uint32_t i = 0; i < n; i++) {
+		T v = sel[i] ? values[i] : 0;
+		hi += v >> 32;
+		lo += (uint32_t)v;
+	}
+	sum->hi += hi;
+	sum->lo += lo;
+}
+
+static void
+memtx_column_sum(const double *values, const uint8_t *sel, uint32_t n,
+		 double *sum)
+{
+	double s = 0;
+	for (uint32_t i = 0; i < n; i++)
+		s += sel[i] ? values[i] : 0;
+	*sum += s;
+}
+
+/**
+ * Combine the halves of an integer sum.
+ * Returns -1 and sets diag on overflow.
+ */
+template <class T>
+static int
+memtx_column_sum_result(const struct memtx_column_int_sum<T> *sum,
+			T *result)
+{
+	T hi;
+	T lo_hi = (T)(sum->lo >> 32);
+	T lo_lo = (T)(sum->lo & UINT32_MAX);
+	if (__builtin_add_overflow(sum->hi, lo_hi, &hi) ||
+	    __builtin_mul_overflow(hi, (T)1 << 32, &hi) ||
+	    __builtin_add_overflow(hi, lo_lo, result)) {
+		diag_set(ClientError, ER_INTEGER_OVERFLOW);
+		return -1;
+	}
+	return 0;
+}
+
+template <class T>
+static void
+memtx_column_min(const T *values, const uint8_t *sel, uint32_t n, T *min)
+{
+	T m = *min;
+	for (uint32_t i = 0; i < n; i++) {
+		T v = sel[i] ? values[i] : std::numeric_limits<T>::max();
+		m = v < m ? v : m;
+	}
+	*min = m;
+}
+
+template <class T>
+static void
+memtx_column_max(const T *values, const uint8_t *sel, uint32_t n, T *max)
+{
+	T m = *max;
+	for (uint32_t i = 0; i < n; i++) {
+		T v = sel[i] ? values[i] : std::numeric_limits<T>::lowest();
+		m = v > m ? v : m;
+	}
+	*max = m;
+}
+
+/* }}} */
+
+/* {{{ Aggregate *************************************************/
+
+/** Decoded aggregate condition. */
+struct memtx_column_cond {
+	/** Key part number. */
+	uint32_t part;
+	/** Comparison operator. */
+	enum memtx_column_op op;
+	/** Value to compare with. */
+	union memtx_column_value value;
+};
+
+/** Decode a condition value for a key part of the given type. */
+static int
+memtx_column_cond_value_decode(enum field_type type, const char **data,
+			       uint32_t part, union memtx_column_value *value)
+{
+	/* Any number is allowed to be compared with a DOUBLE column. */
+	enum field_type key_type = type == FIELD_TYPE_DOUBLE ?
+				   FIELD_TYPE_NUMBER : type;
+	if (key_part_validate(key_type, *data, part, false) != 0)
+		return -1;
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+		value->u = mp_decode_uint(data);
+		break;
+	case FIELD_TYPE_INTEGER:
+		if (mp_read_int64(data, &value->i) != 0) {
+			diag_set(ClientError, ER_UNSUPPORTED, "COLUMN index",
+				 "integer values greater than INT64_MAX");
+			return -1;
+		}
+		break;
+	case FIELD_TYPE_DOUBLE:
+		if (mp_read_double_lossy(data, &value->d) != 0) {
+			diag_set(ClientError, ER_KEY_PART_TYPE, part,
+				 field_type_strs[type]);
+			return -1;
+		}
+		break;
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+/**
+ * Decode aggregate conditions from MsgPack. The result is allocated
+ * on the fiber region.
+ */
+static int
+memtx_column_conds_decode(struct key_def *key_def, const char *data,
+			  struct memtx_column_cond **p_conds,
+			  uint32_t *p_cond_count)
+{
+	const char *usage = "conditions must be an array of "
+			    "{operator, key part number, value}";
+	if (mp_typeof(*data) != MP_ARRAY) {
+		diag_set(IllegalParams, usage);
+		return -1;
+	}
+	uint32_t cond_count = mp_decode_array(&data);
+	struct memtx_column_cond *conds =
+		xregion_alloc_array(&fiber()->gc, struct memtx_column_cond,
+				    MAX(cond_count, 1U));
+	for (uint32_t i = 0; i < cond_count; i++) {
+		struct memtx_column_cond *cond = &conds[i];
+		if (mp_typeof(*data) != MP_ARRAY ||
+		    mp_decode_array(&data) != 3 ||
+		    mp_typeof(*data) != MP_STR) {
+			diag_set(IllegalParams, usage);
+			return -1;
+		}
+		uint32_t len;
+		const char *str = mp_decode_str(&data, &len);
+		cond->op = STRN2ENUM(memtx_column_op, str, len);
+		if (cond->op == memtx_column_op_MAX) {
+			diag_set(IllegalParams, "unknown operator '%.*s'",
+				 (int)len, str);
+			return -1;
+		}
+		if (mp_typeof(*data) != MP_UINT) {
+			diag_set(IllegalParams, usage);
+			return -1;
+		}
+		uint64_t part = mp_decode_uint(&data);
+		if (part >= key_def->part_count) {
+			diag_set(IllegalParams, "invalid key part number %llu",
+				 (unsigned long long)part);
+			return -1;
+		}
+		cond->part = part;
+		if (memtx_column_cond_value_decode(key_def->parts[part].type,
+						   &data, part,
+						   &cond->value) != 0)
+			return -1;
+	}
+	*p_conds = conds;
+	*p_cond_count = cond_count;
+	return 0;
+}
+
+/**
+ * State of an aggregate computation. Depending on the type of
+ * the aggregated key part and the function, one of the members of
+ * each union is used.
+ */
+struct memtx_column_agg_state {
+	/** Number of selected rows. */
+	uint64_t count;
+	union {
+		struct memtx_column_int_sum<uint64_t> u;
+		struct memtx_column_int_sum<int64_t> i;
+		double d;
+	} sum;
+	/** Current minimum or maximum. */
+	union memtx_column_value value;
+};
+
+/** Apply the conditions to a chunk of rows. */
+static void
+memtx_column_chunk_filter(struct key_def *key_def,
+			  union memtx_column_value **columns,
+			  const struct memtx_column_cond *conds,
+			  uint32_t cond_count, uint32_t n, uint8_t *sel)
+{
+	for (uint32_t i = 0; i < cond_count; i++) {
+		const struct memtx_column_cond *cond = &conds[i];
+		const union memtx_column_value *values = columns[cond->part];
+		switch (key_def->parts[cond->part].type) {
+		case FIELD_TYPE_UNSIGNED:
+			memtx_column_filter((const uint64_t *)values, n,
+					    cond->op, cond->value.u, sel);
+			break;
+		case FIELD_TYPE_INTEGER:
+			memtx_column_filter((const int64_t *)values, n,
+					    cond->op, cond->value.i, sel);
+			break;
+		case FIELD_TYPE_DOUBLE:
+			memtx_column_filter((const double *)values, n,
+					    cond->op, cond->value.d, sel);
+			break;
+		default:
+			unreachable();
+		}
+	}
+}
+
+/** Aggregate the selected rows of a chunk. */
+static void
+memtx_column_chunk_aggregate(enum memtx_column_agg agg, enum field_type type,
+			     const union memtx_column_value *values,
+			     const uint8_t *sel, uint32_t n,
+			     struct memtx_column_agg_state *state)
+{
+	state->count += memtx_column_count(sel, n);
+	const uint64_t *u = (const uint64_t *)values;
+	const int64_t *i = (const int64_t *)values;
+	const double *d = (const double *)values;
+	switch (agg) {
+	case MEMTX_COLUMN_AGG_COUNT:
+		break;
+	case MEMTX_COLUMN_AGG_SUM:
+		if (type == FIELD_TYPE_UNSIGNED)
+			memtx_column_sum(u, sel, n, &state->sum.u);
+		else if (type == FIELD_TYPE_INTEGER)
+			memtx_column_sum(i, sel, n, &state->sum.i);
+		else
+			memtx_column_sum(d, sel, n, &state->sum.d);
+		break;
+	case MEMTX_COLUMN_AGG_MIN:
+		if (type == FIELD_TYPE_UNSIGNED)
+			memtx_column_min(u, sel, n, &state->value.u);
+		else if (type == FIELD_TYPE_INTEGER)
+			memtx_column_min(i, sel, n, &state->value.i);
+		else
+			memtx_column_min(d, sel, n, &state->value.d);
+		break;
+	case MEMTX_COLUMN_AGG_MAX:
+		if (type == FIELD_TYPE_UNSIGNED)
+			memtx_column_max(u, sel, n, &state->value.u);
+		else if (type == FIELD_TYPE_INTEGER)
+			memtx_column_max(i, sel, n, &state->value.i);
+		else
+			memtx_column_max(d, sel, n, &state->value.d);
+		break;
+	default:
+		unreachable();
+	}
+}
+
+/** Initialize the aggregate state. */
+static void
+memtx_column_agg_state_create(struct memtx_column_agg_state *state,
+			      enum memtx_column_agg agg, enum field_type type)
+{
+	memset(state, 0, sizeof(*state));
+	if (agg == MEMTX_COLUMN_AGG_MIN) {
+		if (type == FIELD_TYPE_UNSIGNED)
+			state->value.u = std::numeric_limits<uint64_t>::max();
+		else if (type == FIELD_TYPE_INTEGER)
+			state->value.i = std::numeric_limits<int64_t>::max();
+		else
+			state->value.d = std::numeric_limits<double>::max();
+	} else if (agg == MEMTX_COLUMN_AGG_MAX) {
+		if (type == FIELD_TYPE_UNSIGNED)
+			state->value.u = 0;
+		else if (type == FIELD_TYPE_INTEGER)
+			state->value.i = std::numeric_limits<int64_t>::min();
+		else
+			state->value.d = std::numeric_limits<double>::lowest();
+	}
+}
+
+/** Convert the aggregate state to the result. */
+static int
+memtx_column_agg_state_result(const struct memtx_column_agg_state *state,
+			      enum memtx_column_agg agg, enum field_type type,
+			      struct memtx_column_result *result)
+{
+	result->is_null = false;
+	result->type = type;
+	result->count = state->count;
+	switch (agg) {
+	case MEMTX_COLUMN_AGG_COUNT:
+		result->type = FIELD_TYPE_UNSIGNED;
+		result->value.u = state->count;
+		return 0;
+	case MEMTX_COLUMN_AGG_SUM:
+		if (type == FIELD_TYPE_UNSIGNED)
+			return memtx_column_sum_result(&state->sum.u,
+						       &result->value.u);
+		if (type == FIELD_TYPE_INTEGER)
+			return memtx_column_sum_result(&state->sum.i,
+						       &result->value.i);
+		result->value.d = state->sum.d;
+		return 0;
+	case MEMTX_COLUMN_AGG_MIN:
+	case MEMTX_COLUMN_AGG_MAX:
+		result->is_null = state->count == 0;
+		result->value = state->value;
+		return 0;
+	default:
+		unreachable();
+		return 0;
+	}
+}
+
+/**
+ * Fill a chunk of column values with the values visible from
+ * the current transaction. Used when the MVCC engine is enabled,
+ * because the column arrays store values of dirty tuples, too.
+ */
+static void
+memtx_column_chunk_clarify(struct memtx_column_index *index,
+			   struct space *space, uint32_t start, uint32_t n,
+			   union memtx_column_value **columns, uint8_t *sel)
+{
+	struct txn *txn = in_txn();
+	struct key_def *key_def = index->base.def->key_def;
+	size_t region_svp = region_used(&fiber()->gc);
+	union memtx_column_value *values =
+		xregion_alloc_array(&fiber()->gc, union memtx_column_value,
+				    index->column_count);
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t pos = start + i;
+		struct tuple *tuple = index->tuples[pos];
+		struct tuple *visible = memtx_tx_tuple_clarify(
+			txn, space, tuple, &index->base, 0);
+		sel[i] = visible != NULL;
+		for (uint32_t j = 0; j < index->column_count; j++)
+			values[j] = index->columns[j][pos];
+		/*
+		 * A tuple that used to be in the index was decoded
+		 * successfully on insertion so this can't fail.
+		 */
+		if (visible != NULL && visible != tuple &&
+		    memtx_column_decode(key_def, visible, values) != 0)
+			unreachable();
+		for (uint32_t j = 0; j < index->column_count; j++)
+			columns[j][i] = values[j];
+	}
+	region_truncate(&fiber()->gc, region_svp);
+}
+
+int
+memtx_column_index_aggregate(struct index *base, enum memtx_column_agg agg,
+			     uint32_t part, const char *conds_data,
+			     struct memtx_column_result *result)
+{
+	assert(base->def->type == COLUMN);
+	struct memtx_column_index *index = (struct memtx_column_index *)base;
+	struct key_def *key_def = base->def->key_def;
+	assert(agg < memtx_column_agg_MAX);
+	if (agg == MEMTX_COLUMN_AGG_COUNT)
+		part = 0;
+	if (part >= key_def->part_count) {
+		diag_set(IllegalParams, "invalid key part number %u", part);
+		return -1;
+	}
+	enum field_type type = key_def->parts[part].type;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct memtx_column_cond *conds;
+	uint32_t cond_count;
+	if (memtx_column_conds_decode(key_def, conds_data, &conds,
+				      &cond_count) != 0) {
+		region_truncate(region, region_svp);
+		return -1;
+	}
+	struct space *space = space_by_id(base->def->space_id);
+	bool need_clarify = memtx_tx_manager_use_mvcc_engine;
+	union memtx_column_value **columns =
+		xregion_alloc_array(region, union memtx_column_value *,
+				    index->column_count);
+	if (need_clarify) {
+		memtx_tx_track_full_scan(in_txn(), space, base);
+		for (uint32_t i = 0; i < index->column_count; i++) {
+			columns[i] = xregion_alloc_array(
+				region, union memtx_column_value,
+				MEMTX_COLUMN_CHUNK_SIZE);
+		}
+	}
+	uint8_t sel[MEMTX_COLUMN_CHUNK_SIZE];
+	struct memtx_column_agg_state state;
+	memtx_column_agg_state_create(&state, agg, type);
+	for (uint32_t start = 0; start < index->count;
+	     start += MEMTX_COLUMN_CHUNK_SIZE) {
+		uint32_t n = MIN(index->count - start,
+				 (uint32_t)MEMTX_COLUMN_CHUNK_SIZE);
+		if (need_clarify) {
+			memtx_column_chunk_clarify(index, space, start, n,
+						   columns, sel);
+		} else {
+			memset(sel, 1, n);
+			for (uint32_t i = 0; i < index->column_count; i++)
+				columns[i] = index->columns[i] + start;
+		}
+		memtx_column_chunk_filter(key_def, columns, conds, cond_count,
+					  n, sel);
+		memtx_column_chunk_aggregate(agg, type, columns[part], sel, n,
+					     &state);
+	}
+	region_truncate(region, region_svp);
+/********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
+	memtx_tx_story_gc();
+/*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
+	return memtx_column_agg_state_result(&state, agg, type, result);
+}
+
+int
+box_index_aggregate(uint32_t space_id, uint32_t index_id,
+		    enum memtx_column_agg agg, uint32_t part,
+		    const char *conds, struct memtx_column_result *result)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return -1;
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	struct index *index = index_find(space, index_id);
+	if (index == NULL)
+		return -1;
+	if (index->def->type != COLUMN) {
+		diag_set(UnsupportedIndexFeature, index->def, "aggregate");
+		return -1;
+	}
+	struct txn *txn;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+		return -1;
+	int rc = memtx_column_index_aggregate(index, agg, part, conds, result);
+	txn_end_ro_stmt(txn, &svp);
+	return rc;
+}
+
+/* }}} */
+
+/* {{{ Iterator **************************************************/
+
+struct memtx_column_iterator {
+	/** Must be the first member. */
+	struct iterator base;
+	/** Position of the next tuple to return. */
+	uint32_t pos;
+	/** Memory pool the iterator was allocated from. */
+	struct mempool *pool;
+};
+
+static_assert(sizeof(struct memtx_column_iterator) <= MEMTX_ITERATOR_SIZE,
+	      "sizeof(struct memtx_column_iterator) must be less than or "
+	      "equal to MEMTX_ITERATOR_SIZE");
+
+static void
+memtx_column_iterator_free(struct iterator *iterator)
+{
+	struct memtx_column_iterator *it =
+		(struct memtx_column_iterator *)iterator;
+	mempool_free(it->pool, it);
+}
+
+/**
+ * The iterator returns tuples in the order they are stored in the
+ * arrays. Since a deleted tuple is replaced with the last one, tuples
+ * deleted or inserted during iteration may be skipped.
+ */
+static int
+memtx_column_iterator_next(struct iterator *iterator, struct tuple **ret)
+{
+	struct memtx_column_iterator *it =
+		(struct memtx_column_iterator *)iterator;
+	struct space *space;
+	struct index *base;
+	index_weak_ref_get_checked(&iterator->index_ref, &space, &base);
+	struct memtx_column_index *index = (struct memtx_column_index *)base;
+	struct txn *txn = in_txn();
+	do {
+		if (it->pos >= index->count) {
+			*ret = NULL;
+			return 0;
+		}
+		struct tuple *tuple = index->tuples[it->pos++];
+		*ret = memtx_tx_tuple_clarify(txn, space, tuple, base, 0);
+/********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
+		memtx_tx_story_gc();
+/*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
+	} while (*ret == NULL);
+	return 0;
+}
+
+/* }}} */
+
+/* {{{ Index *****************************************************/
+
+static void
+memtx_column_index_destroy(struct index *base)
+{
+	struct memtx_column_index *index = (struct memtx_column_index *)base;
+	mh_column_index_delete(index->tuple_to_pos);
+	for (uint32_t i = 0; i < index->column_count; i++)
+		free(index->columns[i]);
+	free(index->columns);
+	free(index->tuples);
+	free(index);
+}
+
+static ssize_t
+memtx_column_index_size(struct index *base)
+{
+	struct memtx_column_index *index = (struct memtx_column_index *)base;
+	struct space *space = space_by_id(base->def->space_id);
+	/* Substract invisible count. */
+	return index->count -
+	       memtx_tx_index_invisible_count(in_txn(), space, base);
+}
+
+static ssize_t
+memtx_column_index_bsize(struct index *base)
+{
+	struct memtx_column_index *index = (struct memtx_column_index *)base;
+	size_t row_size = sizeof(*index->tuples) +
+			  index->column_count * sizeof(**index->columns);
+	return (size_t)index->capacity * row_size +
+	       mh_column_index_memsize(index->tuple_to_pos);
+}
+
+static ssize_t
+memtx_column_index_count(struct index *base, enum iterator_type type,
+			 const char *key, uint32_t part_count)
+{
+	if (type == ITER_ALL)
+		return memtx_column_index_size(base); /* optimization */
+	return generic_index_count(base, type, key, part_count);
+}
+
+static int
+memtx_column_index_replace(struct index *base, struct tuple *old_tuple,
+			   struct tuple *new_tuple, enum dup_replace_mode mode,
+			   struct tuple **result, struct tuple **successor)
+{
+	struct memtx_column_index *index = (struct memtx_column_index *)base;
+	(void)mode;
+
+	/* COLUMN index doesn't support ordering. */
+	*successor = NULL;
+	*result = NULL;
+
+	assert(!base->def->opts.is_unique);
+	assert(old_tuple != NULL || new_tuple != NULL);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	union memtx_column_value *values = NULL;
+	/*
+	 * Decode the new tuple and allocate room for it before
+	 * removing the old one so that the index isn't modified
+	 * on failure.
+	 */
+	if (new_tuple != NULL) {
+		values = xregion_alloc_array(region, union memtx_column_value,
+					     index->column_count);
+		if (memtx_column_decode(base->def->key_def, new_tuple,
+					values) != 0 ||
+		    memtx_column_index_reserve_impl(index,
+						    index->count + 1) != 0) {
+			region_truncate(region, region_svp);
+			return -1;
+		}
+	}
+	if (old_tuple != NULL && memtx_column_index_remove(index, old_tuple))
+		*result = old_tuple;
+	if (new_tuple != NULL)
+		memtx_column_index_append(index, new_tuple, values);
+	region_truncate(region, region_svp);
+	return 0;
+}
+
+static struct iterator *
+memtx_column_index_create_iterator(struct index *base, enum iterator_type type,
+				   const char *key, uint32_t part_count,
+				   const char *pos)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	(void)key;
+	(void)part_count;
+
+	if (pos != NULL) {
+		diag_set(UnsupportedIndexFeature, base->def, "pagination");
+		return NULL;
+	}
+	if (type != ITER_ALL) {
+		diag_set(UnsupportedIndexFeature, base->def,
+			 "requested iterator type");
+		return NULL;
+	}
+	struct memtx_column_iterator *it = (struct memtx_column_iterator *)
+		mempool_alloc(&memtx->iterator_pool);
+	if (it == NULL) {
+		diag_set(OutOfMemory, sizeof(*it),
+			 "memtx_column_index", "iterator");
+		return NULL;
+	}
+	iterator_create(&it->base, base);
+	it->pool = &memtx->iterator_pool;
+	it->pos = 0;
+	it->base.next_internal = memtx_column_iterator_next;
+	it->base.next = memtx_iterator_next;
+	it->base.position = generic_iterator_position;
+	it->base.free = memtx_column_iterator_free;
+	struct space *space = space_by_id(base->def->space_id);
+	memtx_tx_track_full_scan(in_txn(), space, base);
+	return &it->base;
+}
+
+static int
+memtx_column_index_reserve(struct index *base, uint32_t size_hint)
+{
+	struct memtx_column_index *index = (struct memtx_column_index *)base;
+	return memtx_column_index_reserve_impl(index, size_hint);
+}
+
+static const struct index_vtab memtx_column_index_vtab = {
+	/* .destroy = */ memtx_column_index_destroy,
+	/* .commit_create = */ generic_index_commit_create,
+	/* .abort_create = */ generic_index_abort_create,
+	/* .commit_modify = */ generic_index_commit_modify,
+	/* .commit_drop = */ generic_index_commit_drop,
+	/* .update_def = */ generic_index_update_def,
+	/* .depends_on_pk = */ generic_index_depends_on_pk,
+	/* .def_change_requires_rebuild = */
+		memtx_index_def_change_requires_rebuild,
+	/* .size = */ memtx_column_index_size,
+	/* .bsize = */ memtx_column_index_bsize,
+	/* .min = */ generic_index_min,
+	/* .max = */ generic_index_max,
+	/* .random = */ generic_index_random,
+	/* .count = */ memtx_column_index_count,
+	/* .get_internal = */ generic_index_get_internal,
+	/* .get = */ generic_index_get,
+	/* .replace = */ memtx_column_index_replace,
+	/* .create_iterator = */ memtx_column_index_create_iterator,
+	/* .create_read_view = */ generic_index_create_read_view,
+	/* .stat = */ generic_index_stat,
+	/* .compact = */ generic_index_compact,
+	/* .reset_stat = */ generic_index_reset_stat,
+	/* .begin_build = */ generic_index_begin_build,
+	/* .reserve = */ memtx_column_index_reserve,
+	/* .build_next = */ generic_index_build_next,
+	/* .end_build = */ generic_index_end_build,
+};
+
+struct index *
+memtx_column_index_new(struct memtx_engine *memtx, struct index_def *def)
+{
+	assert(def->iid > 0);
+	assert(!def->opts.is_unique);
+
+	struct memtx_column_index *index =
+		(struct memtx_column_index *)xcalloc(1, sizeof(*index));
+	index_create(&index->base, (struct engine *)memtx,
+		     &memtx_column_index_vtab, def);
+	index->column_count = def->key_def->part_count;
+	index->columns = (union memtx_column_value **)
+		xcalloc(index->column_count, sizeof(*index->columns));
+	index->tuple_to_pos = mh_column_index_new();
+	return &index->base;
+}
+
+/* }}} */
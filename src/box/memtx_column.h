@@ -0,0 +1,111 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "field_def.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct index;
+struct index_def;
+struct memtx_engine;
+
+/**
+ * COLUMN index is a secondary memtx index that doesn't support
+ * lookups. Instead, it stores the values of its key parts in typed
+ * arrays, one per part, so that aggregates over a space can be
+ * computed without decoding tuples, with loops the compiler can
+ * vectorize.
+ */
+struct index *
+memtx_column_index_new(struct memtx_engine *memtx, struct index_def *def);
+
+/** Aggregate function computed by a COLUMN index. */
+enum memtx_column_agg {
+	MEMTX_COLUMN_AGG_COUNT,
+	MEMTX_COLUMN_AGG_SUM,
+	MEMTX_COLUMN_AGG_MIN,
+	MEMTX_COLUMN_AGG_MAX,
+	memtx_column_agg_MAX,
+};
+
+/** Lower-case names of aggregate functions. */
+extern const char *memtx_column_agg_strs[];
+
+/** Comparison operator of an aggregate condition. */
+enum memtx_column_op {
+	MEMTX_COLUMN_OP_EQ,
+	MEMTX_COLUMN_OP_NE,
+	MEMTX_COLUMN_OP_LT,
+	MEMTX_COLUMN_OP_LE,
+	MEMTX_COLUMN_OP_GT,
+	MEMTX_COLUMN_OP_GE,
+	memtx_column_op_MAX,
+};
+
+/** Names of comparison operators: '=', '~=', '<', '<=', '>', '>='. */
+extern const char *memtx_column_op_strs[];
+
+/**
+ * Value stored in a column. Which member is used depends on the type
+ * of the key part: UNSIGNED, INTEGER or DOUBLE.
+ */
+union memtx_column_value {
+	uint64_t u;
+	int64_t i;
+	double d;
+};
+
+/** Result of an aggregate function. */
+struct memtx_column_result {
+	/**
+	 * Type of the result: UNSIGNED for COUNT, the type of
+	 * the aggregated key part otherwise.
+	 */
+	enum field_type type;
+	/** Set if MIN or MAX is computed over no values. */
+	bool is_null;
+	/** Number of the values the function is computed over. */
+	uint64_t count;
+	/** The result unless is_null is set. */
+	union memtx_column_value value;
+};
+
+/**
+ * Compute an aggregate function over the values of a key part of
+ * a COLUMN index.
+ *
+ * @param index - COLUMN index
+ * @param agg - aggregate function
+ * @param part - key part to aggregate, ignored for COUNT
+ * @param conds - MsgPack array of conditions, each of which is
+ *  an array [op, part, value], see enum memtx_column_op; only
+ *  the values that satisfy all the conditions are aggregated
+ * @param result - the result of the aggregate function
+ * @retval 0 success
+ * @retval -1 error, diag is set
+ */
+int
+memtx_column_index_aggregate(struct index *index, enum memtx_column_agg agg,
+			     uint32_t part, const char *conds,
+			     struct memtx_column_result *result);
+
+/**
+ * Look up a COLUMN index by space and index id and compute
+ * an aggregate function over it, see memtx_column_index_aggregate().
+ */
+int
+box_index_aggregate(uint32_t space_id, uint32_t index_id,
+		    enum memtx_column_agg agg, uint32_t part,
+		    const char *conds, struct memtx_column_result *result);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -35,6 +35,8 @@
 #include <small/mempool.h>
 
 #include "fiber.h"
+#include "fiber_cond.h"
+#include "cbus.h"
 #include "errinj.h"
 #include "coio_task.h"
 #include "info/info.h"
@@ -109,24 +111,51 @@ memtx_end_build_primary_key(struct space *space, void *param)
 }
 
 /**
- * Build memtx secondary index based on the contents of primary index.
+ * Limit of the memory taken by the build arrays of the secondary indexes
+ * filled in one pass over the primary index on recovery. A build array
+ * is only freed by end_build(), so the indexes of a space are split into
+ * groups fitting the limit, one pass per group. An index exceeding the
+ * limit alone gets a pass of its own.
+ */
+enum { MEMTX_BUILD_PASS_MEMORY = 1024 * 1024 * 1024 };
+
+/**
+ * Estimate the memory index_reserve() takes to build an index of
+ * @a tuple_count tuples until end_build().
+ */
+static size_t
+memtx_index_build_memory(struct index *index, uint32_t tuple_count)
+{
+	if (index->def->type != TREE)
+		return 0;
+	return (size_t)tuple_count *
+	       memtx_tree_index_build_entry_size(index->def);
+}
+
+/**
+ * Build secondary indexes [@a begin, @a end) of a space based on the
+ * contents of primary index in a single pass over it.
  */
 static int
-memtx_build_secondary_index(struct index *index, struct index *pk)
+memtx_build_secondary_index_group(struct space *space, uint32_t begin,
+				  uint32_t end)
 {
+	struct index *pk = space->index[0];
 	ssize_t n_tuples = index_size(pk);
 	if (n_tuples < 0)
 		return -1;
 	uint32_t estimated_tuples = n_tuples * 1.2;
 
-	index_begin_build(index);
-	if (index_reserve(index, estimated_tuples) < 0)
-		return -1;
-
-	if (n_tuples > 0) {
-		say_info("Adding %zd keys to %s index '%s' ...",
-			 n_tuples, index_type_strs[index->def->type],
-			 index->def->name);
+	for (uint32_t i = begin; i < end; i++) {
+		struct index *index = space->index[i];
+		index_begin_build(index);
+		if (index_reserve(index, estimated_tuples) < 0)
+			return -1;
+		if (n_tuples > 0) {
+			say_info("Adding %zd keys to %s index '%s' ...",
+				 n_tuples, index_type_strs[index->def->type],
+				 index->def->name);
+		}
 	}
 
 	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
@@ -141,7 +170,11 @@ memtx_build_secondary_index(struct index *index, struct index *pk)
 			break;
 		if (tuple == NULL)
 			break;
-		rc = index_build_next(index, tuple);
+		for (uint32_t i = begin; i < end; i++) {
+			rc = index_build_next(space->index[i], tuple);
+			if (rc != 0)
+				break;
+		}
 		if (rc != 0)
 			break;
 	}
@@ -149,7 +182,39 @@ memtx_build_secondary_index(struct index *index, struct index *pk)
 	if (rc != 0)
 		return -1;
 
-	index_end_build(index);
+	for (uint32_t i = begin; i < end; i++)
+		index_end_build(space->index[i]);
+	return 0;
+}
+
+/**
+ * Build memtx secondary indexes based on the contents of primary index.
+ * As many indexes as fit MEMTX_BUILD_PASS_MEMORY are built in a single
+ * pass over the primary index.
+ */
+static int
+memtx_build_secondary_indexes(struct space *space)
+{
+	ssize_t n_tuples = index_size(space->index[0]);
+	if (n_tuples < 0)
+		return -1;
+	uint32_t estimated_tuples = n_tuples * 1.2;
+	uint32_t begin = 1;
+	while (begin < space->index_count) {
+		size_t memory = memtx_index_build_memory(space->index[begin],
+							 estimated_tuples);
+		uint32_t end = begin + 1;
+		for (; end < space->index_count; end++) {
+			size_t next = memtx_index_build_memory(
+				space->index[end], estimated_tuples);
+			if (memory + next > MEMTX_BUILD_PASS_MEMORY)
+				break;
+			memory += next;
+		}
+		if (memtx_build_secondary_index_group(space, begin, end) != 0)
+			return -1;
+		begin = end;
+	}
 	return 0;
 }
 
@@ -177,11 +242,8 @@ memtx_build_secondary_keys(struct space *space, void *param)
 				 space_name(space));
 		}
 
-		for (uint32_t j = 1; j < space->index_count; j++) {
-			if (memtx_build_secondary_index(space->index[j],
-							pk) < 0)
-				return -1;
-		}
+		if (memtx_build_secondary_indexes(space) < 0)
+			return -1;
 
 		if (n_tuples > 0) {
 			say_info("Space '%s': done", space_name(space));
@@ -247,17 +309,332 @@ static int
 memtx_engine_recover_snapshot_row(struct xrow_header *row,
 				  enum snapshot_recovery_state *state);
 
-int
-memtx_engine_recover_snapshot(struct memtx_engine *memtx,
-			      const struct vclock *vclock)
+/**
+ * Recovers an INSERT request decoded from a snapshot xrow.
+ *
+ * @retval -1 error, diagnostic set
+ * @retval 0 success
+ */
+static int
+memtx_engine_recover_snapshot_request(struct request *request,
+				      enum snapshot_recovery_state *state);
+
+/**
+ * Size of a batch of snapshot rows read ahead by the snapshot reader
+ * thread, in bytes. A batch may be bigger if a single row doesn't fit.
+ */
+enum { MEMTX_SNAPSHOT_BATCH_SIZE = 1024 * 1024 };
+
+/**
+ * Log a message every MEMTX_SNAPSHOT_PROGRESS_ROWS recovered snapshot rows
+ * and yield to let other fibers run.
+ */
+enum { MEMTX_SNAPSHOT_PROGRESS_ROWS = 100000 };
+
+struct memtx_snapshot_reader;
+
+/**
+ * A batch of snapshot rows read, decompressed and decoded by the snapshot
+ * reader thread. Row headers, bodies and decoded requests are owned by
+ * the batch and stay valid until the batch is resubmitted to the reader.
+ */
+struct memtx_snapshot_batch {
+	/** Base class. */
+	struct cbus_call_msg base;
+	/** Reader this batch belongs to. */
+	struct memtx_snapshot_reader *reader;
+	/** Set in tx when the reader thread is done with the batch. */
+	bool is_complete;
+	/** Set if there are no more rows in the snapshot. */
+	bool is_last;
+	/** Raw rows (headers and bodies) copied from the snapshot. */
+	char *data;
+	/** Number of bytes used in the data buffer. */
+	size_t data_size;
+	/** Number of bytes allocated for the data buffer. */
+	size_t data_capacity;
+	/** Decoded row headers pointing to the data buffer. */
+	struct xrow_header *rows;
+	/**
+	 * Requests decoded from the rows, one per row. Set only for
+	 * IPROTO_INSERT rows, other rows are decoded in tx.
+	 */
+	struct request *requests;
+	/** Number of rows in the batch. */
+	uint32_t row_count;
+	/** Number of rows allocated for the rows and requests arrays. */
+	uint32_t row_capacity;
+};
+
+/**
+ * Snapshot reader is a thread that reads, decompresses and decodes
+ * snapshot rows ahead of tx so that the tx thread only has to allocate
+ * tuples and insert them into indexes. Batches are submitted to the
+ * reader in a round-robin fashion and, since the reader processes them
+ * in order, complete in the same order.
+ */
+struct memtx_snapshot_reader {
+	/** Snapshot file name. */
+	const char *filename;
+	/** Reader thread. */
+	struct cord cord;
+	/** Pipe from tx to the reader thread. */
+	struct cpipe reader_pipe;
+	/** Pipe from the reader thread to tx. */
+	struct cpipe tx_pipe;
+	/** Snapshot cursor. Accessed only from the reader thread. */
+	struct xlog_cursor cursor;
+	/**
+	 * Row that was read from the cursor, but didn't fit in the previous
+	 * batch. Points to the cursor buffer, which stays valid until the
+	 * cursor is advanced. Accessed only from the reader thread.
+	 */
+	struct xrow_header pending_row;
+	/** Set if pending_row is valid. */
+	bool has_pending_row;
+	/**
+	 * Set by the reader thread when there's nothing more to read,
+	 * either because the end of the snapshot was reached or because
+	 * an error occurred.
+	 */
+	bool is_done;
+	/** Set if the snapshot EOF marker was found. */
+	bool has_eof_marker;
+	/** Batches, box.cfg.memtx_recovery_read_ahead of them. */
+	struct memtx_snapshot_batch *batches;
+	/** Number of batches. */
+	int batch_count;
+	/** Number of batches submitted to the reader thread. */
+	int in_progress;
+	/** Signaled when a batch is complete. */
+	struct fiber_cond cond;
+};
+
+/**
+ * Appends a row to a snapshot batch. Returns false if the row doesn't fit.
+ * Called in the reader thread.
+ */
+static bool
+memtx_snapshot_batch_add_row(struct memtx_snapshot_batch *batch,
+			     const struct xrow_header *row)
+{
+	assert(row->bodycnt == 1);
+	const char *begin = row->header;
+	const char *end = (const char *)row->body[0].iov_base +
+			  row->body[0].iov_len;
+	size_t size = end - begin;
+	if (batch->data_size + size > batch->data_capacity) {
+		if (batch->row_count > 0)
+			return false;
+		/* Nothing refers to the buffer yet so it's safe to grow it. */
+		batch->data = (char *)xrealloc(batch->data, size);
+		batch->data_capacity = size;
+	}
+	if (batch->row_count == batch->row_capacity) {
+		batch->row_capacity = MAX(batch->row_capacity * 2, 1024U);
+		batch->rows = (struct xrow_header *)xrealloc(
+			batch->rows, batch->row_capacity * sizeof(*batch->rows));
+		batch->requests = (struct request *)xrealloc(
+			batch->requests,
+			batch->row_capacity * sizeof(*batch->requests));
+	}
+	char *data = batch->data + batch->data_size;
+	memcpy(data, begin, size);
+	batch->data_size += size;
+	struct xrow_header *copy = &batch->rows[batch->row_count++];
+	*copy = *row;
+	copy->header = data;
+	copy->header_end = data + (row->header_end - begin);
+	copy->body[0].iov_base =
+		data + ((const char *)row->body[0].iov_base - begin);
+	return true;
+}
+
+/** Stops reading the snapshot. Called in the reader thread. */
+static void
+memtx_snapshot_reader_done(struct memtx_snapshot_reader *reader)
 {
-	/* Process existing snapshot */
-	say_info("recovery start");
-	int64_t signature = vclock_sum(vclock);
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    signature, NONE);
+	reader->is_done = true;
+	if (xlog_cursor_is_open(&reader->cursor)) {
+		reader->has_eof_marker = xlog_cursor_is_eof(&reader->cursor);
+		xlog_cursor_close(&reader->cursor, false);
+	}
+}
 
-	say_info("recovering from `%s'", filename);
+/**
+ * Fills a snapshot batch with rows read from the snapshot and decodes
+ * them. Called in the reader thread. On read or decode error, the batch
+ * is truncated to the rows preceding the invalid one.
+ */
+static int
+memtx_snapshot_reader_read_f(struct cbus_call_msg *base)
+{
+	struct memtx_snapshot_batch *batch =
+		(struct memtx_snapshot_batch *)base;
+	struct memtx_snapshot_reader *reader = batch->reader;
+	struct xlog_cursor *cursor = &reader->cursor;
+	bool is_broken = false;
+	batch->data_size = 0;
+	batch->row_count = 0;
+	batch->is_last = false;
+	if (reader->is_done) {
+		batch->is_last = true;
+		return 0;
+	}
+	if (cursor->state == XLOG_CURSOR_NEW &&
+	    xlog_cursor_open(cursor, reader->filename) != 0)
+		goto fail;
+	if (reader->has_pending_row) {
+		VERIFY(memtx_snapshot_batch_add_row(batch,
+						    &reader->pending_row));
+		reader->has_pending_row = false;
+	}
+	while (true) {
+		struct xrow_header row;
+		int rc = xlog_cursor_next(cursor, &row, false);
+		if (rc < 0) {
+			/* Decode the rows read so far before failing. */
+			is_broken = true;
+			break;
+		}
+		if (rc > 0) {
+			memtx_snapshot_reader_done(reader);
+			batch->is_last = true;
+			break;
+		}
+		if (!memtx_snapshot_batch_add_row(batch, &row)) {
+			reader->pending_row = row;
+			reader->has_pending_row = true;
+			break;
+		}
+	}
+	for (uint32_t i = 0; i < batch->row_count; i++) {
+		struct xrow_header *row = &batch->rows[i];
+		if (row->type != IPROTO_INSERT)
+			continue;
+		if (xrow_decode_dml(row, &batch->requests[i],
+				    dml_request_key_map(row->type)) != 0) {
+			batch->row_count = i;
+			goto fail;
+		}
+	}
+	if (is_broken)
+		goto fail;
+	return 0;
+fail:
+	memtx_snapshot_reader_done(reader);
+	batch->is_last = true;
+	return -1;
+}
+
+/** Called in tx when the reader thread is done with a batch. */
+static int
+memtx_snapshot_batch_complete_f(struct cbus_call_msg *base)
+{
+	struct memtx_snapshot_batch *batch =
+		(struct memtx_snapshot_batch *)base;
+	struct memtx_snapshot_reader *reader = batch->reader;
+	assert(reader->in_progress > 0);
+	reader->in_progress--;
+	batch->is_complete = true;
+	fiber_cond_broadcast(&reader->cond);
+	return 0;
+}
+
+/** Submits a batch to the reader thread. */
+static void
+memtx_snapshot_reader_submit(struct memtx_snapshot_reader *reader,
+			     struct memtx_snapshot_batch *batch)
+{
+	batch->is_complete = false;
+	reader->in_progress++;
+	cbus_call_async(&reader->reader_pipe, &reader->tx_pipe, &batch->base,
+			memtx_snapshot_reader_read_f,
+			memtx_snapshot_batch_complete_f);
+}
+
+/** Snapshot reader thread function. */
+static int
+memtx_snapshot_reader_f(va_list ap)
+{
+	struct memtx_snapshot_reader *reader =
+		va_arg(ap, struct memtx_snapshot_reader *);
+	struct cbus_endpoint endpoint;
+	cpipe_create(&reader->tx_pipe, "tx_prio");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&reader->tx_pipe);
+	if (xlog_cursor_is_open(&reader->cursor))
+		xlog_cursor_close(&reader->cursor, false);
+	return 0;
+}
+
+/** Starts the snapshot reader thread. */
+static int
+memtx_snapshot_reader_start(struct memtx_snapshot_reader *reader,
+			    const char *filename, int batch_count)
+{
+	assert(batch_count > 0);
+	memset(reader, 0, sizeof(*reader));
+	reader->filename = filename;
+	reader->batch_count = batch_count;
+	reader->batches = (struct memtx_snapshot_batch *)xcalloc(
+		batch_count, sizeof(*reader->batches));
+	for (int i = 0; i < batch_count; i++) {
+		struct memtx_snapshot_batch *batch = &reader->batches[i];
+		batch->reader = reader;
+		batch->is_complete = true;
+		batch->data = (char *)xmalloc(MEMTX_SNAPSHOT_BATCH_SIZE);
+		batch->data_capacity = MEMTX_SNAPSHOT_BATCH_SIZE;
+	}
+	fiber_cond_create(&reader->cond);
+	if (cord_costart(&reader->cord, "snapshot_reader",
+			 memtx_snapshot_reader_f, reader) != 0) {
+		fiber_cond_destroy(&reader->cond);
+		for (int i = 0; i < batch_count; i++)
+			free(reader->batches[i].data);
+		free(reader->batches);
+		return -1;
+	}
+	cpipe_create(&reader->reader_pipe, "snapshot_reader");
+	return 0;
+}
+
+/**
+ * Waits for all submitted batches to complete, stops the snapshot reader
+ * thread and frees the batches.
+ */
+static void
+memtx_snapshot_reader_stop(struct memtx_snapshot_reader *reader)
+{
+	while (reader->in_progress > 0)
+		fiber_cond_wait(&reader->cond);
+	cbus_stop_loop(&reader->reader_pipe);
+	cpipe_destroy(&reader->reader_pipe);
+	if (cord_join(&reader->cord) != 0)
+		panic_syserror("failed to join snapshot reader thread");
+	for (int i = 0; i < reader->batch_count; i++) {
+		struct memtx_snapshot_batch *batch = &reader->batches[i];
+		diag_destroy(&batch->base.diag);
+		free(batch->data);
+		free(batch->rows);
+		free(batch->requests);
+	}
+	free(reader->batches);
+	fiber_cond_destroy(&reader->cond);
+}
+
+/**
+ * Reads the snapshot in the tx thread.
+ */
+static int
+memtx_engine_read_snapshot(struct memtx_engine *memtx, const char *filename,
+			   int64_t signature,
+			   enum snapshot_recovery_state *state,
+			   bool *has_eof_marker)
+{
 	struct xlog_cursor cursor;
 	if (xlog_cursor_open(&cursor, filename) < 0)
 		return -1;
@@ -266,11 +643,10 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	struct xrow_header row;
 	uint64_t row_count = 0;
 	bool force_recovery = false;
-	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
 	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
 		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(&row, &state);
-		if (state == DONE_RECOVERING_SYSTEM_SPACES)
+		rc = memtx_engine_recover_snapshot_row(&row, state);
+		if (*state == DONE_RECOVERING_SYSTEM_SPACES)
 			force_recovery = memtx->force_recovery;
 		if (rc < 0) {
 			if (!force_recovery)
@@ -279,13 +655,98 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 			diag_log();
 		}
 		++row_count;
-		if (row_count % 100000 == 0) {
+		if (row_count % MEMTX_SNAPSHOT_PROGRESS_ROWS == 0) {
 			say_info_ratelimited("%.1fM rows processed",
 					     row_count / 1e6);
 			fiber_yield_timeout(0);
 		}
 	}
 	xlog_cursor_close(&cursor, false);
+	*has_eof_marker = xlog_cursor_is_eof(&cursor);
+	return rc < 0 ? -1 : 0;
+}
+
+/**
+ * Reads the snapshot with the help of the snapshot reader thread, which
+ * reads, decompresses and decodes rows ahead of tx. Not used in the force
+ * recovery mode, because the latter needs to skip broken rows, which
+ * can only be done while reading the snapshot row by row.
+ */
+static int
+memtx_engine_read_snapshot_ahead(struct memtx_engine *memtx,
+				 const char *filename, int64_t signature,
+				 enum snapshot_recovery_state *state,
+				 bool *has_eof_marker)
+{
+	assert(!memtx->force_recovery);
+	struct memtx_snapshot_reader reader;
+	if (memtx_snapshot_reader_start(&reader, filename,
+					memtx->recovery_read_ahead) != 0)
+		return -1;
+	for (int i = 0; i < reader.batch_count; i++)
+		memtx_snapshot_reader_submit(&reader, &reader.batches[i]);
+
+	int rc = 0;
+	uint64_t row_count = 0;
+	for (int i = 0; ; i = (i + 1) % reader.batch_count) {
+		struct memtx_snapshot_batch *batch = &reader.batches[i];
+		while (!batch->is_complete)
+			fiber_cond_wait(&reader.cond);
+		for (uint32_t j = 0; j < batch->row_count; j++) {
+			struct xrow_header *row = &batch->rows[j];
+			row->lsn = signature;
+			if (row->type == IPROTO_INSERT) {
+				assert(batch->requests[j].header == row);
+				rc = memtx_engine_recover_snapshot_request(
+					&batch->requests[j], state);
+			} else {
+				rc = memtx_engine_recover_snapshot_row(row,
+								       state);
+			}
+			if (rc != 0)
+				break;
+			++row_count;
+			if (row_count % MEMTX_SNAPSHOT_PROGRESS_ROWS == 0) {
+				say_info_ratelimited("%.1fM rows processed",
+						     row_count / 1e6);
+				fiber_yield_timeout(0);
+			}
+		}
+		if (rc == 0 && batch->base.rc != 0) {
+			diag_move(&batch->base.diag, diag_get());
+			rc = -1;
+		}
+		if (rc != 0 || batch->is_last)
+			break;
+		memtx_snapshot_reader_submit(&reader, batch);
+	}
+	memtx_snapshot_reader_stop(&reader);
+	*has_eof_marker = reader.has_eof_marker;
+	return rc;
+}
+
+int
+memtx_engine_recover_snapshot(struct memtx_engine *memtx,
+			      const struct vclock *vclock)
+{
+	/* Process existing snapshot */
+	say_info("recovery start");
+	int64_t signature = vclock_sum(vclock);
+	const char *filename = xdir_format_filename(&memtx->snap_dir,
+						    signature, NONE);
+
+	say_info("recovering from `%s'", filename);
+	int rc;
+	bool has_eof_marker = false;
+	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
+	if (memtx->recovery_read_ahead > 0 && !memtx->force_recovery) {
+		rc = memtx_engine_read_snapshot_ahead(memtx, filename,
+						      signature, &state,
+						      &has_eof_marker);
+	} else {
+		rc = memtx_engine_read_snapshot(memtx, filename, signature,
+						&state, &has_eof_marker);
+	}
 	if (rc < 0)
 		return -1;
 
@@ -294,11 +755,11 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	 * marker - such snapshots are very likely corrupted and
 	 * should not be trusted.
 	 */
-	if (!xlog_cursor_is_eof(&cursor)) {
+	if (!has_eof_marker) {
 		if (!memtx->force_recovery)
-			panic("snapshot `%s' has no EOF marker", cursor.name);
+			panic("snapshot `%s' has no EOF marker", filename);
 		else
-			say_error("snapshot `%s' has no EOF marker", cursor.name);
+			say_error("snapshot `%s' has no EOF marker", filename);
 	}
 
 	/*
@@ -381,13 +842,21 @@ memtx_engine_recover_snapshot_row(struct xrow_header *row,
 		return -1;
 	}
 	struct request request;
-	RegionGuard region_guard(&fiber()->gc);
 	if (xrow_decode_dml(row, &request, dml_request_key_map(row->type)) != 0)
 		return -1;
-	bool is_system_space_request = space_id_is_system(request.space_id);
+	return memtx_engine_recover_snapshot_request(&request, state);
+}
+
+static int
+memtx_engine_recover_snapshot_request(struct request *request,
+				      enum snapshot_recovery_state *state)
+{
+	assert(request->type == IPROTO_INSERT);
+	RegionGuard region_guard(&fiber()->gc);
+	bool is_system_space_request = space_id_is_system(request->space_id);
 	if (snapshot_recovery_state_update(state, is_system_space_request) != 0)
 		return -1;
-	struct space *space = space_cache_find(request.space_id);
+	struct space *space = space_cache_find(request->space_id);
 	if (space == NULL)
 		goto log_request;
 	/* memtx snapshot must contain only memtx spaces */
@@ -399,13 +868,13 @@ memtx_engine_recover_snapshot_row(struct xrow_header *row,
 	txn = txn_begin();
 	if (txn == NULL)
 		goto log_request;
-	if (txn_begin_stmt(txn, space, request.type) != 0)
+	if (txn_begin_stmt(txn, space, request->type) != 0)
 		goto rollback;
 	/* no access checks here - applier always works with admin privs */
 	struct tuple *unused;
-	if (space_execute_dml(space, txn, &request, &unused) != 0)
+	if (space_execute_dml(space, txn, request, &unused) != 0)
 		goto rollback_stmt;
-	if (txn_commit_stmt(txn, &request) != 0)
+	if (txn_commit_stmt(txn, request) != 0)
 		goto rollback;
 	/*
 	 * Snapshot rows are confirmed by definition. They don't need to go to
@@ -418,7 +887,7 @@ memtx_engine_recover_snapshot_row(struct xrow_header *row,
 rollback:
 	txn_abort(txn);
 log_request:
-	say_error("error at request: %s", request_str(&request));
+	say_error("error at request: %s", request_str(request));
 	return -1;
 }
 
@@ -1476,6 +1945,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
 		 bool dontdump, unsigned granularity,
 		 const char *allocator, float alloc_factor, int sort_threads,
+		 int recovery_read_ahead,
 		 memtx_on_indexes_built_cb on_indexes_built)
 {
 	int64_t snap_signature;
@@ -1618,6 +2088,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		}
 	}
 	memtx->sort_threads = sort_threads;
+	memtx->recovery_read_ahead = recovery_read_ahead;
 
 	memtx->base.vtab = &memtx_engine_vtab;
 	memtx->base.name = "memtx";
@@ -1705,6 +2176,14 @@ memtx_engine_stat_tx(struct memtx_engine *memtx, struct info_handler *h)
 		info_table_end(h);
 	}
 	info_table_end(h); /* tuples */
+	info_table_begin(h, "gc");
+	append_total_count_stats(h, "debt", stats.gc_debt.total,
+				 stats.gc_debt.count);
+	info_table_begin(h, "bulk");
+	info_append_int(h, "count", stats.gc_bulk_count);
+	info_append_int(h, "stories", stats.gc_bulk_deleted);
+	info_table_end(h); /* bulk */
+	info_table_end(h); /* gc */
 	info_table_end(h); /* mvcc */
 	info_table_end(h); /* tx */
 }
@@ -2084,7 +2563,8 @@ memtx_prepare_read_view_tuple(struct tuple *tuple,
 				memtx_read_view_tuple_needs_upgrade(
 					index->space->upgrade, tuple);
 	result->data = tuple_data_range(tuple, &result->size);
-	if (!index->space->rv->disable_decompression) {
+	if (!index->space->rv->disable_decompression &&
+	    tuple_is_compressed(tuple)) {
 		result->data = memtx_tuple_decompress_raw(
 				result->data, result->data + result->size,
 				&result->size);
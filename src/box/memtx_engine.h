@@ -186,6 +186,13 @@ struct memtx_engine {
 	 * start.
 	 */
 	int sort_threads;
+	/**
+	 * Max number of snapshot row batches that may be read, decompressed
+	 * and decoded ahead by the snapshot reader thread during recovery,
+	 * box.cfg.memtx_recovery_read_ahead. If 0, the snapshot is read
+	 * in the tx thread.
+	 */
+	int recovery_read_ahead;
 };
 
 struct memtx_gc_task;
@@ -222,6 +229,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
 		 bool dontdump, unsigned granularity,
 		 const char *allocator, float alloc_factor, int threads_num,
+		 int recovery_read_ahead,
 		 memtx_on_indexes_built_cb on_indexes_built);
 
 /**
@@ -251,6 +259,9 @@ enum {
 	MEMTX_SLAB_SIZE = 4 * 1024 * 1024
 };
 
+/** Max value of box.cfg.memtx_recovery_read_ahead. */
+enum { MEMTX_RECOVERY_READ_AHEAD_MAX = 1024 };
+
 /**
  * Allocate and return new memtx tuple. Data validation depends
  * on @a validate value. On error returns NULL and set diag.
@@ -362,14 +373,15 @@ memtx_engine_new_xc(const char *snap_dirname, bool force_recovery,
 		    uint64_t tuple_arena_max_size, uint32_t objsize_min,
 		    bool dontdump, unsigned granularity,
 		    const char *allocator, float alloc_factor,
-		    int sort_threads,
+		    int sort_threads, int recovery_read_ahead,
 		    memtx_on_indexes_built_cb on_indexes_built)
 {
 	struct memtx_engine *memtx;
 	memtx = memtx_engine_new(snap_dirname, force_recovery,
 				 tuple_arena_max_size, objsize_min, dontdump,
 				 granularity, allocator, alloc_factor,
-				 sort_threads, on_indexes_built);
+				 sort_threads, recovery_read_ahead,
+				 on_indexes_built);
 	if (memtx == NULL)
 		diag_raise();
 	return memtx;
@@ -41,6 +41,7 @@
 #include "memtx_tree.h"
 #include "memtx_rtree.h"
 #include "memtx_bitset.h"
+#include "memtx_column.h"
 #include "memtx_engine.h"
 #include "column_mask.h"
 #include "sequence.h"
@@ -867,6 +868,55 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 		}
 		/* no furter checks of parts needed */
 		return 0;
+	case COLUMN:
+		if (index_def->opts.is_unique) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "COLUMN index can not be unique");
+			return -1;
+		}
+		if (key_def->is_multikey) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "COLUMN index cannot be multikey");
+			return -1;
+		}
+		if (key_def->for_func_index) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "COLUMN index can not use a function");
+			return -1;
+		}
+		for (uint32_t i = 0; i < key_def->part_count; i++) {
+			struct key_part *part = &key_def->parts[i];
+			if (part->path != NULL) {
+				diag_set(ClientError, ER_MODIFY_INDEX,
+					 index_def->name, space_name(space),
+					 "COLUMN index can not use JSON paths");
+				return -1;
+			}
+			/*
+			 * Nullable parts are rejected above, but
+			 * exclude_null may be set on its own.
+			 */
+			if (part->exclude_null) {
+				diag_set(ClientError, ER_MODIFY_INDEX,
+					 index_def->name, space_name(space),
+					 "COLUMN index can not exclude nulls");
+				return -1;
+			}
+			if (part->type != FIELD_TYPE_UNSIGNED &&
+			    part->type != FIELD_TYPE_INTEGER &&
+			    part->type != FIELD_TYPE_DOUBLE) {
+				diag_set(ClientError, ER_MODIFY_INDEX,
+					 index_def->name, space_name(space),
+					 "COLUMN index field type must be "
+					 "UNSIGNED or INTEGER or DOUBLE");
+				return -1;
+			}
+		}
+		/* no furter checks of parts needed */
+		return 0;
 	default:
 		diag_set(ClientError, ER_INDEX_TYPE,
 			 index_def->name, space_name(space));
@@ -885,6 +935,18 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 		return -1;
 	}
 
+	if (index_def->opts.adaptive_hash_size > 0 &&
+	    (index_def->type != TREE || !index_def->opts.is_unique ||
+	     index_def->key_def->is_nullable ||
+	     index_def->key_def->is_multikey ||
+	     index_def->key_def->for_func_index)) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "adaptive hash is only reasonable with unique "
+			 "non-nullable memtx tree index");
+		return -1;
+	}
+
 	/* Only HASH and TREE indexes check parts there. */
 	if (index_def_check_field_types(index_def, space_name(space)) != 0)
 		return -1;
@@ -935,6 +997,8 @@ memtx_space_create_index(struct space *space, struct index_def *index_def)
 		return memtx_rtree_index_new(memtx, index_def);
 	case BITSET:
 		return memtx_bitset_index_new(memtx, index_def);
+	case COLUMN:
+		return memtx_column_index_new(memtx, index_def);
 	default:
 		unreachable();
 		return NULL;
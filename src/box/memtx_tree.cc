@@ -43,6 +43,8 @@
 #include "trivia/config.h"
 #include "trivia/util.h"
 #include "tt_sort.h"
+#include "info/info.h"
+#include "random.h"
 #include <small/mempool.h>
 
 /**
@@ -110,6 +112,21 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 	return a->tuple == b->tuple;
 }
 
+/**
+ * Returns the hint of a key that can be compared with the hints of
+ * tree elements to narrow down a block search, see BPS_TREE_KEY_HINT.
+ * Hints of multikey and functional index elements are not comparison
+ * hints so HINT_NONE is returned for them.
+ */
+static inline hint_t
+memtx_tree_key_search_hint(const struct memtx_tree_key_data<true> *key,
+			   struct key_def *cmp_def)
+{
+	if (cmp_def->is_multikey || cmp_def->for_func_index)
+		return HINT_NONE;
+	return key->hint;
+}
+
 #define BPS_TREE_NAME memtx_tree
 #define BPS_TREE_BLOCK_SIZE (512)
 #define BPS_TREE_EXTENT_SIZE MEMTX_EXTENT_SIZE
@@ -133,12 +150,16 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #undef bps_tree_key_t
 
 #define BPS_TREE_NAMESPACE NS_USE_HINT
+#define BPS_TREE_ELEM_HINT(elem) (elem).hint
+#define BPS_TREE_KEY_HINT(key, arg) memtx_tree_key_search_hint(key, arg)
 #define bps_tree_elem_t struct memtx_tree_data<true>
 #define bps_tree_key_t struct memtx_tree_key_data<true> *
 
 #include "salad/bps_tree.h"
 
 #undef BPS_TREE_NAMESPACE
+#undef BPS_TREE_ELEM_HINT
+#undef BPS_TREE_KEY_HINT
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
 
@@ -206,10 +227,63 @@ invalidate_tree_iterator(NS_USE_HINT::memtx_tree_iterator *itr)
 	*itr = NS_USE_HINT::memtx_tree_invalid_iterator();
 }
 
+/* {{{ Adaptive hash index *****************************************/
+
+static inline bool
+memtx_tree_ahi_equal_key(struct tuple *tuple, const char *key,
+			 struct key_def *key_def)
+{
+	return tuple_compare_with_key(tuple, HINT_NONE, key,
+				      key_def->part_count, HINT_NONE,
+				      key_def) == 0;
+}
+
+#define LIGHT_NAME _ahi
+#define LIGHT_DATA_TYPE struct tuple *
+#define LIGHT_KEY_TYPE const char *
+#define LIGHT_CMP_ARG_TYPE struct key_def *
+#define LIGHT_EQUAL(a, b, c) ((a) == (b))
+#define LIGHT_EQUAL_KEY(a, b, c) memtx_tree_ahi_equal_key(a, b, c)
+
+#include "salad/light.h"
+
+#undef LIGHT_NAME
+#undef LIGHT_DATA_TYPE
+#undef LIGHT_KEY_TYPE
+#undef LIGHT_CMP_ARG_TYPE
+#undef LIGHT_EQUAL
+#undef LIGHT_EQUAL_KEY
+
+/** Adaptive hash index statistics. */
+struct memtx_tree_ahi_stat {
+	/** Number of lookups in the adaptive hash index. */
+	int64_t lookup;
+	/** Number of lookups that found the tuple. */
+	int64_t hit;
+	/** Number of tuples evicted to make room for new ones. */
+	int64_t evict;
+};
+
+/* }}} */
+
 template <bool USE_HINT>
 struct memtx_tree_index {
 	struct index base;
 	memtx_tree_t<USE_HINT> tree;
+	/**
+	 * Adaptive hash index: a bounded cache of tuples found by
+	 * full key lookups in a unique index, so that hot keys are
+	 * found without descending the tree. Tuples are hashed with
+	 * tuple_hash() and are kept in sync with the tree on replace.
+	 */
+	struct light_ahi_core ahi;
+	/**
+	 * Max number of tuples in the adaptive hash index,
+	 * 0 if the adaptive hash index is disabled.
+	 */
+	uint32_t ahi_size;
+	/** Adaptive hash index statistics. */
+	struct memtx_tree_ahi_stat ahi_stat;
 	struct memtx_tree_data<USE_HINT> *build_array;
 	size_t build_array_size, build_array_alloc_size;
 	struct memtx_gc_task gc_task;
@@ -238,6 +312,114 @@ memtx_tree_qcompare(const void* a, const void *b, void *c)
 			     data_b->hint, key_def);
 }
 
+/**
+ * Allocate an extent for the adaptive hash index. Unlike
+ * memtx_index_extent_alloc(), doesn't use the extents reserved
+ * for index updates and doesn't run garbage collection, because
+ * the adaptive hash index is filled on lookups. Failing to add a
+ * tuple to the cache is not an error.
+ */
+static void *
+memtx_tree_ahi_extent_alloc(void *ctx)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)ctx;
+	return mempool_alloc(&memtx->index_extent_pool);
+}
+
+/**
+ * (Re)create the adaptive hash index according to the index
+ * definition. Drops all cached tuples.
+ */
+template <bool USE_HINT>
+static void
+memtx_tree_ahi_create(struct memtx_tree_index<USE_HINT> *index)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)index->base.engine;
+	struct index_def *def = index->base.def;
+	index->ahi_size = def->opts.adaptive_hash_size;
+	light_ahi_create(&index->ahi, def->key_def, MEMTX_EXTENT_SIZE,
+			 memtx_tree_ahi_extent_alloc, memtx_index_extent_free,
+			 memtx, &memtx->index_extent_stats);
+}
+
+/**
+ * Look up a tuple by a full unique key in the adaptive hash
+ * index. Returns NULL if the tuple isn't cached.
+ */
+template <bool USE_HINT>
+static inline struct tuple *
+memtx_tree_ahi_find(struct memtx_tree_index<USE_HINT> *index,
+		    const char *key)
+{
+	if (index->ahi_size == 0)
+		return NULL;
+	index->ahi_stat.lookup++;
+	if (light_ahi_count(&index->ahi) == 0)
+		return NULL;
+	uint32_t hash = key_hash(key, index->base.def->key_def);
+	uint32_t pos = light_ahi_find_key(&index->ahi, hash, key);
+	if (pos == light_ahi_end)
+		return NULL;
+	index->ahi_stat.hit++;
+	return *light_ahi_get(&index->ahi, pos);
+}
+
+/**
+ * Add a tuple found in the tree by a full unique key to the
+ * adaptive hash index. If the index is full, a random tuple is
+ * evicted from it: keys that are looked up often get back soon
+ * while rarely used ones are eventually pushed out.
+ */
+template <bool USE_HINT>
+static void
+memtx_tree_ahi_insert(struct memtx_tree_index<USE_HINT> *index,
+		      struct tuple *tuple)
+{
+	if (index->ahi_size == 0)
+		return;
+	struct light_ahi_core *ahi = &index->ahi;
+	uint32_t hash = tuple_hash(tuple, index->base.def->key_def);
+	/*
+	 * A key may hash differently from an equal tuple (think of
+	 * 1 and 1.0 stored in a 'number' field) so the tuple may be
+	 * cached already.
+	 */
+	if (light_ahi_find(ahi, hash, tuple) != light_ahi_end)
+		return;
+	if (light_ahi_count(ahi) >= index->ahi_size) {
+		uint32_t rnd = pseudo_random_in_range(0, UINT32_MAX);
+		uint32_t pos = light_ahi_random(ahi, rnd);
+		assert(pos != light_ahi_end);
+		light_ahi_delete(ahi, pos);
+		index->ahi_stat.evict++;
+	}
+	light_ahi_insert(ahi, hash, tuple);
+}
+
+/**
+ * Remove a tuple that was deleted from the tree from the adaptive
+ * hash index. If @a new_tuple is not NULL, it replaced the deleted
+ * tuple in the tree and takes its place in the cache.
+ */
+template <bool USE_HINT>
+static void
+memtx_tree_ahi_delete(struct memtx_tree_index<USE_HINT> *index,
+		      struct tuple *old_tuple, struct tuple *new_tuple)
+{
+	struct light_ahi_core *ahi = &index->ahi;
+	if (light_ahi_count(ahi) == 0)
+		return;
+	struct key_def *key_def = index->base.def->key_def;
+	uint32_t pos = light_ahi_find(ahi, tuple_hash(old_tuple, key_def),
+				      old_tuple);
+	if (pos == light_ahi_end)
+		return;
+	light_ahi_delete(ahi, pos);
+	if (new_tuple != NULL)
+		light_ahi_insert(ahi, tuple_hash(new_tuple, key_def),
+				 new_tuple);
+}
+
 /* {{{ MemtxTree Iterators ****************************************/
 template <bool USE_HINT>
 struct tree_iterator {
@@ -887,6 +1069,7 @@ static void
 memtx_tree_index_free(struct memtx_tree_index<USE_HINT> *index)
 {
 	memtx_tree_destroy(&index->tree);
+	light_ahi_destroy(&index->ahi);
 	free(index->build_array);
 	free(index);
 }
@@ -985,6 +1168,12 @@ memtx_tree_index_update_def(struct index *base)
 	index->tree.common.arg = def->opts.is_unique &&
 				 !def->key_def->is_nullable ?
 				 def->key_def : def->cmp_def;
+	/*
+	 * The old key definition may be freed, so drop the cached
+	 * tuples rather than look for those that still match.
+	 */
+	light_ahi_destroy(&index->ahi);
+	memtx_tree_ahi_create(index);
 }
 
 static bool
@@ -1007,13 +1196,51 @@ memtx_tree_index_size(struct index *base)
 	       memtx_tx_index_invisible_count(in_txn(), space, base);
 }
 
+/** Size of memory used by the adaptive hash index. */
+template <bool USE_HINT>
+static size_t
+memtx_tree_ahi_mem_used(struct memtx_tree_index<USE_HINT> *index)
+{
+	return matras_extent_count(&index->ahi.mtable) * MEMTX_EXTENT_SIZE;
+}
+
 template <bool USE_HINT>
 static ssize_t
 memtx_tree_index_bsize(struct index *base)
 {
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
-	return memtx_tree_mem_used(&index->tree);
+	return memtx_tree_mem_used(&index->tree) +
+	       memtx_tree_ahi_mem_used(index);
+}
+
+template <bool USE_HINT>
+static void
+memtx_tree_index_stat(struct index *base, struct info_handler *h)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	info_begin(h);
+	if (index->ahi_size > 0) {
+		struct memtx_tree_ahi_stat *stat = &index->ahi_stat;
+		info_table_begin(h, "adaptive_hash");
+		info_append_int(h, "count", light_ahi_count(&index->ahi));
+		info_append_int(h, "bytes", memtx_tree_ahi_mem_used(index));
+		info_append_int(h, "lookup", stat->lookup);
+		info_append_int(h, "hit", stat->hit);
+		info_append_int(h, "evict", stat->evict);
+		info_table_end(h); /* adaptive_hash */
+	}
+	info_end(h);
+}
+
+template <bool USE_HINT>
+static void
+memtx_tree_index_reset_stat(struct index *base)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	memset(&index->ahi_stat, 0, sizeof(index->ahi_stat));
 }
 
 template <bool USE_HINT>
@@ -1067,6 +1294,14 @@ memtx_tree_index_get_internal(struct index *base, const char *key,
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
 	struct txn *txn = in_txn();
 	struct space *space = space_by_id(base->def->space_id);
+	struct tuple *tuple = memtx_tree_ahi_find(index, key);
+	if (tuple != NULL) {
+		*result = memtx_tx_tuple_clarify(txn, space, tuple, base, 0);
+/********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
+		memtx_tx_story_gc();
+/*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
+		return 0;
+	}
 	struct memtx_tree_key_data<USE_HINT> key_data;
 	key_data.key = key;
 	key_data.part_count = part_count;
@@ -1084,6 +1319,7 @@ memtx_tree_index_get_internal(struct index *base, const char *key,
 	}
 	bool is_multikey = base->def->key_def->is_multikey;
 	uint32_t mk_index = is_multikey ? (uint32_t)res->hint : 0;
+	memtx_tree_ahi_insert(index, res->tuple);
 	*result = memtx_tx_tuple_clarify(txn, space, res->tuple, base,
 					 mk_index);
 /********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
@@ -1232,6 +1468,7 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 		}
 		*successor = suc_data.tuple;
 		if (dup_data.tuple != NULL) {
+			memtx_tree_ahi_delete(index, dup_data.tuple, new_tuple);
 			*result = dup_data.tuple;
 			return 0;
 		}
@@ -1243,6 +1480,7 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 		if (USE_HINT)
 			old_data.set_hint(tuple_hint(old_tuple, cmp_def));
 		memtx_tree_delete(&index->tree, old_data);
+		memtx_tree_ahi_delete(index, old_tuple, NULL);
 		*result = old_tuple;
 	} else {
 		*result = NULL;
@@ -1805,9 +2043,8 @@ memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
 		return 0;
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
-	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
-	return memtx_tree_index_build_array_append(index, tuple,
-						   tuple_hint(tuple, cmp_def));
+	/* Hints are calculated in bulk by memtx_tree_index_end_build(). */
+	return memtx_tree_index_build_array_append(index, tuple, HINT_NONE);
 }
 
 static int
@@ -1910,6 +2147,93 @@ memtx_tree_index_build_array_deduplicate(
 	index->build_array_size = w_idx + 1;
 }
 
+/**
+ * If the build array is shorter than this, hints of its elements are
+ * calculated in the calling thread.
+ */
+enum { MEMTX_TREE_BUILD_HINTS_NOSPAWN_SIZE = 1024 };
+
+/** A thread calculating hints of a part of the index build array. */
+template <bool USE_HINT>
+struct memtx_tree_build_hints_worker {
+	/** The worker cord. */
+	struct cord cord;
+	/** Begin of the build array part processed by this thread. */
+	struct memtx_tree_data<USE_HINT> *begin;
+	/** End of the build array part processed by this thread. */
+	struct memtx_tree_data<USE_HINT> *end;
+	/** Key definition used for calculating hints. */
+	struct key_def *cmp_def;
+};
+
+/** Calculate hints of the build array elements in the given range. */
+template <bool USE_HINT>
+static void
+memtx_tree_build_hints_range(struct memtx_tree_data<USE_HINT> *begin,
+			     struct memtx_tree_data<USE_HINT> *end,
+			     struct key_def *cmp_def)
+{
+	for (struct memtx_tree_data<USE_HINT> *elem = begin;
+	     elem < end; elem++)
+		elem->set_hint(tuple_hint(elem->tuple, cmp_def));
+}
+
+template <bool USE_HINT>
+static int
+memtx_tree_build_hints_f(va_list ap)
+{
+	struct memtx_tree_build_hints_worker<USE_HINT> *worker =
+		va_arg(ap, struct memtx_tree_build_hints_worker<USE_HINT> *);
+	memtx_tree_build_hints_range(worker->begin, worker->end,
+				     worker->cmp_def);
+	return 0;
+}
+
+/**
+ * Calculate hints of all the elements of the index build array.
+ * The array is split into equal parts processed by @a thread_count
+ * threads. The calling fiber yields while waiting for the threads.
+ */
+template <bool USE_HINT>
+static void
+memtx_tree_index_build_hints(struct memtx_tree_index<USE_HINT> *index,
+			     int thread_count)
+{
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	struct memtx_tree_data<USE_HINT> *array = index->build_array;
+	size_t count = index->build_array_size;
+	if (count < MEMTX_TREE_BUILD_HINTS_NOSPAWN_SIZE || thread_count <= 1) {
+		memtx_tree_build_hints_range(array, array + count, cmp_def);
+		return;
+	}
+	struct memtx_tree_build_hints_worker<USE_HINT> *workers =
+		(struct memtx_tree_build_hints_worker<USE_HINT> *)
+		xcalloc(thread_count, sizeof(*workers));
+	size_t step = DIV_ROUND_UP(count, thread_count);
+	for (int i = 0; i < thread_count; i++) {
+		struct memtx_tree_build_hints_worker<USE_HINT> *worker =
+			&workers[i];
+		worker->begin = array + MIN(i * step, count);
+		worker->end = array + MIN((i + 1) * step, count);
+		worker->cmp_def = cmp_def;
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "hint.worker.%d", i);
+		if (cord_costart(&worker->cord, name,
+				 memtx_tree_build_hints_f<USE_HINT>,
+				 worker) != 0) {
+			diag_log();
+			panic("cord_start failed");
+		}
+	}
+	for (int i = 0; i < thread_count; i++) {
+		if (cord_cojoin(&workers[i].cord) != 0) {
+			diag_log();
+			panic("cord_cojoin failed");
+		}
+	}
+	free(workers);
+}
+
 template <bool USE_HINT>
 static void
 memtx_tree_index_end_build(struct index *base)
@@ -1918,6 +2242,14 @@ memtx_tree_index_end_build(struct index *base)
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	if (USE_HINT && !cmp_def->is_multikey && !cmp_def->for_func_index) {
+		/*
+		 * Hints of multikey and functional index elements are
+		 * set by build_next(), others are calculated here.
+		 */
+		memtx_tree_index_build_hints<USE_HINT>(index,
+						       memtx->sort_threads);
+	}
 	tt_sort(index->build_array, index->build_array_size,
 		sizeof(index->build_array[0]), memtx_tree_qcompare<USE_HINT>,
 		cmp_def, memtx->sort_threads);
@@ -2249,9 +2581,9 @@ get_memtx_tree_index_vtab(void)
 			memtx_tree_index_create_iterator<USE_HINT>,
 		/* .create_read_view = */
 			memtx_tree_index_create_read_view<USE_HINT>,
-		/* .stat = */ generic_index_stat,
+		/* .stat = */ memtx_tree_index_stat<USE_HINT>,
 		/* .compact = */ generic_index_compact,
-		/* .reset_stat = */ generic_index_reset_stat,
+		/* .reset_stat = */ memtx_tree_index_reset_stat<USE_HINT>,
 		/* .begin_build = */ memtx_tree_index_begin_build<USE_HINT>,
 		/* .reserve = */ memtx_tree_index_reserve<USE_HINT>,
 		/* .build_next = */ is_mk ? memtx_tree_index_build_next_multikey :
@@ -2280,9 +2612,21 @@ memtx_tree_index_new_tpl(struct memtx_engine *memtx, struct index_def *def,
 	memtx_tree_create(&index->tree, cmp_def, memtx_index_extent_alloc,
 			  memtx_index_extent_free, memtx,
 			  &memtx->index_extent_stats);
+	memtx_tree_ahi_create(index);
 	return &index->base;
 }
 
+size_t
+memtx_tree_index_build_entry_size(const struct index_def *def)
+{
+	/* Follows the choice of the index vtab below. */
+	bool use_hint = def->key_def->for_func_index ||
+			def->key_def->is_multikey ||
+			def->opts.hint == INDEX_HINT_ON;
+	return use_hint ? sizeof(struct memtx_tree_data<true>) :
+			  sizeof(struct memtx_tree_data<false>);
+}
+
 struct index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def)
 {
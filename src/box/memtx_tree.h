@@ -30,6 +30,7 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <stddef.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -42,6 +43,13 @@ struct memtx_engine;
 struct index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def);
 
+/**
+ * Return the size of an element of the array a TREE index with the
+ * given definition is built from, see index_reserve().
+ */
+size_t
+memtx_tree_index_build_entry_size(const struct index_def *def);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
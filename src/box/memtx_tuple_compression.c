@@ -0,0 +1,188 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_tuple_compression.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "memtx_engine.h"
+#include "mp_compression.h"
+#include "mp_extension_types.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "tuple.h"
+#include "tuple_format.h"
+
+#if defined(ENABLE_TUPLE_COMPRESSION)
+# error unimplemented
+#endif
+
+/** Returns the compression type of a top-level field in a format. */
+static inline enum compression_type
+memtx_tuple_field_compression_type(struct tuple_format *format,
+				   uint32_t fieldno)
+{
+	if (fieldno >= tuple_format_field_count(format))
+		return COMPRESSION_TYPE_NONE;
+	return tuple_format_field(format, fieldno)->compression_type;
+}
+
+/** Checks if a MsgPack field is stored in the MP_COMPRESSION extension. */
+static inline bool
+memtx_tuple_field_is_compressed(const char *field)
+{
+	if (mp_typeof(*field) != MP_EXT)
+		return false;
+	int8_t type;
+	mp_decode_extl(&field, &type);
+	return type == MP_COMPRESSION;
+}
+
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	assert(format->is_compressed);
+	assert(!tuple_is_compressed(tuple));
+	uint32_t size;
+	const char *data = tuple_data_range(tuple, &size);
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+	/*
+	 * First pass: find out how much memory the compressed tuple
+	 * data may take in the worst case.
+	 */
+	size_t size_max = mp_sizeof_array(field_count);
+	const char *field = pos;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field_end = field;
+		mp_next(&field_end);
+		size_t field_size = field_end - field;
+		enum compression_type type =
+			memtx_tuple_field_compression_type(format, i);
+		if (type != COMPRESSION_TYPE_NONE)
+			size_max += mp_compress_bound(field_size, type);
+		else
+			size_max += field_size;
+		field = field_end;
+	}
+	/* Second pass: encode the new tuple data. */
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	char *buf = xregion_alloc(region, size_max);
+	char *buf_pos = mp_encode_array(buf, field_count);
+	bool is_compressed = false;
+	field = pos;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field_end = field;
+		mp_next(&field_end);
+		size_t field_size = field_end - field;
+		enum compression_type type =
+			memtx_tuple_field_compression_type(format, i);
+		char *compressed_end = NULL;
+		if (type != COMPRESSION_TYPE_NONE &&
+		    field_size >= MEMTX_TUPLE_COMPRESSION_MIN_FIELD_SIZE &&
+		    !memtx_tuple_field_is_compressed(field)) {
+			compressed_end = mp_compress(buf_pos, field,
+						     field_size, type);
+		}
+		if (compressed_end != NULL) {
+			buf_pos = compressed_end;
+			is_compressed = true;
+		} else {
+			memcpy(buf_pos, field, field_size);
+			buf_pos += field_size;
+		}
+		field = field_end;
+	}
+	assert(buf_pos <= buf + size_max);
+	struct tuple *result = tuple;
+	if (is_compressed) {
+		result = memtx_tuple_new_raw(format, buf, buf_pos, false);
+		if (result != NULL)
+			tuple_set_flag(result, TUPLE_IS_COMPRESSED);
+	}
+	region_truncate(region, region_svp);
+	return result;
+}
+
+struct tuple *
+memtx_tuple_decompress_slow(struct tuple *tuple)
+{
+	assert(tuple_is_compressed(tuple));
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t size;
+	const char *data = tuple_data_range(tuple, &size);
+	data = memtx_tuple_decompress_raw(data, data + size, &size);
+	struct tuple *result = NULL;
+	if (data != NULL) {
+		result = memtx_tuple_new_raw(tuple_format(tuple), data,
+					     data + size, false);
+	}
+	region_truncate(region, region_svp);
+	return result;
+}
+
+const char *
+memtx_tuple_decompress_raw(const char *tuple, const char *tuple_end,
+			   uint32_t *p_size)
+{
+	/*
+	 * First pass: calculate the size of the decompressed data
+	 * and check if there's anything to decompress at all.
+	 */
+	const char *pos = tuple;
+	uint32_t field_count = mp_decode_array(&pos);
+	const char *fields = pos;
+	size_t size = mp_sizeof_array(field_count);
+	bool is_compressed = false;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		if (memtx_tuple_field_is_compressed(field)) {
+			ssize_t raw_size = mp_decompressed_size(field);
+			if (raw_size < 0)
+				goto corrupted;
+			size += raw_size;
+			is_compressed = true;
+		} else {
+			size += pos - field;
+		}
+	}
+	assert(pos == tuple_end);
+	if (!is_compressed) {
+		*p_size = tuple_end - tuple;
+		return tuple;
+	}
+	/* Second pass: decompress the data. */
+	char *buf = xregion_alloc(&fiber()->gc, size);
+	char *buf_pos = mp_encode_array(buf, field_count);
+	pos = fields;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		if (memtx_tuple_field_is_compressed(field)) {
+			ssize_t raw_size = mp_decompress(&pos, buf_pos,
+							 buf + size - buf_pos);
+			if (raw_size < 0)
+				goto corrupted;
+			buf_pos += raw_size;
+		} else {
+			mp_next(&pos);
+			memcpy(buf_pos, field, pos - field);
+			buf_pos += pos - field;
+		}
+	}
+	assert(buf_pos == buf + size);
+	*p_size = size;
+	return buf;
+corrupted:
+	diag_set(ClientError, ER_DECOMPRESSION, "corrupted data");
+	return NULL;
+}
@@ -17,28 +17,47 @@
 extern "C" {
 #endif
 
-static inline struct tuple *
-memtx_tuple_compress(struct tuple *tuple)
-{
-        (void)tuple;
-        unreachable();
-        return NULL;
-}
+/**
+ * Fields shorter than this are never compressed: the MP_COMPRESSION
+ * header and the compressor frame overhead would eat up the gain.
+ */
+enum { MEMTX_TUPLE_COMPRESSION_MIN_FIELD_SIZE = 64 };
+
+/**
+ * Returns a new memtx tuple in which all fields of @a tuple that have
+ * a compression type set in the tuple format are compressed. If none
+ * of the fields is worth compressing, returns @a tuple itself.
+ * On error returns NULL and sets diag.
+ */
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple);
 
+/** Slow path of memtx_tuple_decompress(). */
+struct tuple *
+memtx_tuple_decompress_slow(struct tuple *tuple);
+
+/**
+ * Returns a new memtx tuple with all compressed fields of @a tuple
+ * decompressed or @a tuple itself if it isn't compressed.
+ * On error returns NULL and sets diag.
+ */
 static inline struct tuple *
 memtx_tuple_decompress(struct tuple *tuple)
 {
-	assert(!tuple_is_compressed(tuple));
-	return tuple;
+	if (likely(!tuple_is_compressed(tuple)))
+		return tuple;
+	return memtx_tuple_decompress_slow(tuple);
 }
 
-static inline const char *
+/**
+ * Decompresses all compressed fields of raw tuple data. The result is
+ * allocated on the fiber region unless the data doesn't contain any
+ * compressed fields, in which case @a tuple is returned as is.
+ * On error returns NULL and sets diag.
+ */
+const char *
 memtx_tuple_decompress_raw(const char *tuple, const char *tuple_end,
-			   uint32_t *p_size)
-{
-	*p_size = tuple_end - tuple;
-	return tuple;
-}
+			   uint32_t *p_size);
 
 #if defined(__cplusplus)
 } /* extern "C" */
@@ -38,6 +38,7 @@
 
 #include "schema_def.h"
 #include "small/mempool.h"
+#include "tweaks.h"
 
 enum {
 	/**
@@ -116,14 +117,17 @@ struct memtx_story {
 	struct rlist in_space_stories;
 	/**
 	 * Number of indexes in this space - and the count of link[].
+	 * The story is allocated from a pool matching this count, so
+	 * the links are stored inline. Packed to a byte (along with
+	 * the following members) to keep the story header small.
 	 */
-	uint32_t index_count;
+	uint8_t index_count;
 	/**
-	 * Status of story, describes the reason why story cannot be deleted.
-	 * It is initialized in memtx_story constructor and is changed only in
-	 * memtx_tx_story_gc.
+	 * Status of story, describes the reason why story cannot be deleted,
+	 * see enum memtx_tx_story_status. It is initialized in memtx_story
+	 * constructor and is changed only in memtx_tx_story_gc.
 	 */
-	enum memtx_tx_story_status status;
+	uint8_t status;
 	/**
 	 * Flag is set when @a tuple is not placed in primary key and
 	 * the story is the only reason why @a tuple cannot be deleted.
@@ -136,6 +140,11 @@ struct memtx_story {
 	struct memtx_story_link link[];
 };
 
+static_assert(BOX_INDEX_MAX <= UINT8_MAX + 1,
+	      "memtx_story::index_count must fit the index count");
+static_assert(MEMTX_TX_STORY_STATUS_MAX <= UINT8_MAX + 1,
+	      "memtx_story::status must fit the story status");
+
 static uint32_t
 memtx_tx_story_key_hash(const struct tuple *a)
 {
@@ -572,6 +581,21 @@ struct tx_manager
 	struct rlist all_txs;
 	/** Accumulated number of GC steps that should be done. */
 	size_t must_do_gc_steps;
+	/**
+	 * Lowest read view PSN that all stories retained for read views
+	 * were checked against, either by the last round of the incremental
+	 * GC or by the last bulk GC pass. Once the oldest read view moves
+	 * past it, such stories may have become garbage - it is GC debt.
+	 */
+	int64_t gc_rv_psn;
+	/** Lowest read view PSN at the start of the current GC round. */
+	int64_t gc_round_rv_psn;
+	/** Number of stories retained for read views after last bulk pass. */
+	size_t gc_bulk_retained;
+	/** Number of bulk GC passes done. */
+	size_t gc_bulk_count;
+	/** Number of stories deleted by bulk GC passes. */
+	size_t gc_bulk_deleted;
 };
 
 enum {
@@ -583,6 +607,14 @@ enum {
 		TX_MANAGER_GC_STEPS_SIZE = 2,
 };
 
+/**
+ * Min number of stories retained for read views that makes TX manager
+ * collect garbage in one pass over all stories instead of several steps
+ * per new story when the oldest read view moves forward.
+ */
+static uint64_t memtx_tx_gc_bulk_threshold = 10000;
+TWEAK_UINT(memtx_tx_gc_bulk_threshold);
+
 /** That's a definition, see declaration for description. */
 bool memtx_tx_manager_use_mvcc_engine = false;
 
@@ -617,6 +649,11 @@ memtx_tx_manager_init()
 	rlist_create(&txm.all_txs);
 	txm.traverse_all_stories = &txm.all_stories;
 	txm.must_do_gc_steps = 0;
+	txm.gc_rv_psn = 0;
+	txm.gc_round_rv_psn = 0;
+	txm.gc_bulk_retained = 0;
+	txm.gc_bulk_count = 0;
+	txm.gc_bulk_deleted = 0;
 	memset(&txm.story_stats, 0, sizeof(txm.story_stats));
 }
 
@@ -633,6 +670,26 @@ memtx_tx_manager_free()
 	memtx_tx_mempool_destroy(&txm.full_scan_gap_item_mempool);
 }
 
+/**
+ * Lowest PSN of transactions in read view. Stories that were added and
+ * deleted before it can't be seen by any read view.
+ */
+static int64_t
+memtx_tx_lowest_rv_psn(void)
+{
+	/*
+	 * Default value is txn_next_psn because if it is not so some
+	 * stories (stories produced by last txn at least) will be marked as
+	 * potentially in read view even though there are no txns in read view.
+	 */
+	if (rlist_empty(&txm.read_view_txs))
+		return txn_next_psn;
+	struct txn *txn = rlist_first_entry(&txm.read_view_txs, struct txn,
+					    in_read_view_txs);
+	assert(txn->rv_psn != 0);
+	return txn->rv_psn;
+}
+
 void
 memtx_tx_statistics_collect(struct memtx_tx_statistics *stats)
 {
@@ -641,6 +698,10 @@ memtx_tx_statistics_collect(struct memtx_tx_statistics *stats)
 		stats->stories[i] = txm.story_stats[i];
 		stats->retained_tuples[i] = txm.retained_tuple_stats[i];
 	}
+	if (memtx_tx_lowest_rv_psn() > txm.gc_rv_psn)
+		stats->gc_debt = txm.story_stats[MEMTX_TX_STORY_READ_VIEW];
+	stats->gc_bulk_count = txm.gc_bulk_count;
+	stats->gc_bulk_deleted = txm.gc_bulk_deleted;
 	if (rlist_empty(&txm.all_txs)) {
 		return;
 	}
@@ -1511,38 +1572,12 @@ memtx_tx_story_full_unlink_story_gc_step(struct memtx_story *story)
 }
 
 /**
- * Run one step of a crawler that traverses all stories and removes no more
- * used stories.
+ * Check whether @a story is still used, update its status and delete it
+ * if it is not. Return true if the story was deleted.
  */
-void
-memtx_tx_story_gc_step()
+static bool
+memtx_tx_story_gc_try(struct memtx_story *story, int64_t lowest_rv_psn)
 {
-	if (txm.traverse_all_stories == &txm.all_stories) {
-		/* We came to the head of the list. */
-		txm.traverse_all_stories = txm.traverse_all_stories->next;
-		return;
-	}
-
-	/*
-	 * Lowest read view PSN.
-	 * Default value is txn_next_psn because if it is not so some
-	 * stories (stories produced by last txn at least) will be marked as
-	 * potentially in read view even though there are no txns in read view.
-	 */
-	int64_t lowest_rv_psn = txn_next_psn;
-	if (!rlist_empty(&txm.read_view_txs)) {
-		struct txn *txn =
-			rlist_first_entry(&txm.read_view_txs, struct txn,
-					  in_read_view_txs);
-		assert(txn->rv_psn != 0);
-		lowest_rv_psn = txn->rv_psn;
-	}
-
-	struct memtx_story *story =
-		rlist_entry(txm.traverse_all_stories, struct memtx_story,
-			    in_all_stories);
-	txm.traverse_all_stories = txm.traverse_all_stories->next;
-
 	/**
 	 * The order in which conditions are checked is important,
 	 * see description of enum memtx_tx_story_status.
@@ -1551,13 +1586,13 @@ memtx_tx_story_gc_step()
 	    !rlist_empty(&story->reader_list)) {
 		memtx_tx_story_set_status(story, MEMTX_TX_STORY_USED);
 		/* The story is used directly by some transactions. */
-		return;
+		return false;
 	}
 	if (story->add_psn >= lowest_rv_psn ||
 	    story->del_psn >= lowest_rv_psn) {
 		memtx_tx_story_set_status(story, MEMTX_TX_STORY_READ_VIEW);
 		/* The story can be used by a read view. */
-		return;
+		return false;
 	}
 	for (uint32_t i = 0; i < story->index_count; i++) {
 		struct memtx_story_link *link = &story->link[i];
@@ -1574,7 +1609,7 @@ memtx_tx_story_gc_step()
 			if (link->older_story != NULL) {
 				memtx_tx_story_set_status(story,
 							  MEMTX_TX_STORY_USED);
-				return;
+				return false;
 			}
 		} else if (i > 0 && link->newer_story->add_stmt != NULL) {
 			/*
@@ -1584,24 +1619,103 @@ memtx_tx_story_gc_step()
 			 */
 			memtx_tx_story_set_status(story,
 						  MEMTX_TX_STORY_USED);
-			return;
+			return false;
 		}
 		if (!rlist_empty(&link->read_gaps)) {
 			memtx_tx_story_set_status(story,
 						  MEMTX_TX_STORY_TRACK_GAP);
 			/* The story is used for gap tracking. */
-			return;
+			return false;
 		}
 	}
 
 	/* Unlink and delete the story */
 	memtx_tx_story_full_unlink_story_gc_step(story);
 	memtx_tx_story_delete(story);
+	return true;
+}
+
+/**
+ * Run one step of a crawler that traverses all stories and removes no more
+ * used stories.
+ */
+void
+memtx_tx_story_gc_step()
+{
+	int64_t lowest_rv_psn = memtx_tx_lowest_rv_psn();
+	if (txm.traverse_all_stories == &txm.all_stories) {
+		/* We came to the head of the list. */
+		txm.traverse_all_stories = txm.traverse_all_stories->next;
+		/*
+		 * All the stories have been checked against the lowest
+		 * read view PSN as of the round start or a greater one.
+		 */
+		txm.gc_rv_psn = MAX(txm.gc_rv_psn, txm.gc_round_rv_psn);
+		txm.gc_round_rv_psn = lowest_rv_psn;
+		return;
+	}
+	struct memtx_story *story =
+		rlist_entry(txm.traverse_all_stories, struct memtx_story,
+			    in_all_stories);
+	txm.traverse_all_stories = txm.traverse_all_stories->next;
+	memtx_tx_story_gc_try(story, lowest_rv_psn);
+}
+
+/**
+ * Check whether it's time to collect stories retained for read views
+ * in one pass. It is when the oldest read view has moved since the last
+ * check and there are enough such stories: at least the threshold, twice
+ * as many as there were left by the last bulk pass (so that passes over
+ * still used stories are amortized by new stories) and at least half of
+ * all stories (so that the pass mostly visits garbage).
+ */
+static bool
+memtx_tx_story_gc_bulk_is_needed(int64_t lowest_rv_psn)
+{
+	if (lowest_rv_psn <= txm.gc_rv_psn)
+		return false;
+	size_t rv_count = txm.story_stats[MEMTX_TX_STORY_READ_VIEW].count;
+	if (rv_count == 0 || rv_count < memtx_tx_gc_bulk_threshold ||
+	    rv_count < 2 * txm.gc_bulk_retained)
+		return false;
+	size_t total_count = 0;
+	for (size_t i = 0; i < MEMTX_TX_STORY_STATUS_MAX; i++)
+		total_count += txm.story_stats[i].count;
+	return 2 * rv_count >= total_count;
+}
+
+/**
+ * Traverse all stories at once and remove no more used ones. Stories are
+ * listed in the order of creation, so history chains are unlinked from
+ * the bottom, and whole chains of stories retained only by read views
+ * that are gone are deleted in one pass.
+ */
+static void
+memtx_tx_story_gc_bulk(int64_t lowest_rv_psn)
+{
+	struct memtx_story *story, *tmp;
+	size_t deleted = 0;
+	rlist_foreach_entry_safe(story, &txm.all_stories,
+				 in_all_stories, tmp) {
+		if (memtx_tx_story_gc_try(story, lowest_rv_psn))
+			deleted++;
+	}
+	txm.gc_rv_psn = lowest_rv_psn;
+	txm.gc_bulk_retained =
+		txm.story_stats[MEMTX_TX_STORY_READ_VIEW].count;
+	txm.gc_bulk_count++;
+	txm.gc_bulk_deleted += deleted;
 }
 
 void
 memtx_tx_story_gc()
 {
+	int64_t lowest_rv_psn = memtx_tx_lowest_rv_psn();
+	if (memtx_tx_story_gc_bulk_is_needed(lowest_rv_psn)) {
+		memtx_tx_story_gc_bulk(lowest_rv_psn);
+		txm.must_do_gc_steps = 0;
+		return;
+	}
 	for (size_t i = 0; i < txm.must_do_gc_steps; i++)
 		memtx_tx_story_gc_step();
 	txm.must_do_gc_steps = 0;
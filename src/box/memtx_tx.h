@@ -132,6 +132,15 @@ struct memtx_tx_statistics {
 	size_t tx_max[TX_ALLOC_TYPE_MAX];
 	/* Number of txns registered in memtx transaction manager. */
 	size_t txn_count;
+	/*
+	 * Stories retained for read views that may have become garbage
+	 * since the oldest read view moved and haven't been checked yet.
+	 */
+	struct memtx_tx_stats gc_debt;
+	/* Number of passes of bulk garbage collection. */
+	size_t gc_bulk_count;
+	/* Number of stories deleted by bulk garbage collection. */
+	size_t gc_bulk_deleted;
 };
 
 /**
@@ -346,7 +355,9 @@ memtx_tx_track_full_scan(struct txn *txn, struct space *space,
 }
 
 /**
- * Run several rounds of memtx_tx_story_gc_step()
+ * Run several rounds of memtx_tx_story_gc_step() or, if the oldest read
+ * view has moved and left a lot of stories behind, collect them all in
+ * one pass.
  */
 void
 memtx_tx_story_gc();
@@ -60,6 +60,7 @@ int replication_synchro_quorum = 1;
 double replication_synchro_timeout = 5.0; /* seconds */
 double replication_sync_timeout = 300.0; /* seconds */
 bool replication_skip_conflict = false;
+bool replication_parallel_apply = false;
 int replication_threads = 1;
 
 bool cfg_replication_anon = true;
@@ -208,6 +208,12 @@ extern double replication_sync_timeout;
  */
 extern bool replication_skip_conflict;
 
+/*
+ * Allows applying replicated transactions that don't depend on each
+ * other concurrently in separate fibers.
+ */
+extern bool replication_parallel_apply;
+
 /** How many threads to use for decoding incoming replication stream. */
 extern int replication_threads;
 
@@ -61,6 +61,13 @@ extern struct rlist on_schema_init;
 bool
 dd_check_is_disabled(void);
 
+/**
+ * Returns true and sets diag if the schema is older than the one
+ * required by this build.
+ */
+bool
+box_schema_needs_upgrade(void);
+
 /** \cond public */
 
 /**
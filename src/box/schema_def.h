@@ -124,6 +124,8 @@ enum {
 	BOX_FUNC_INDEX_ID = 372,
 	/** Space id of _session_settings. */
 	BOX_SESSION_SETTINGS_ID = 380,
+	/** Space id of _sql_stat. */
+	BOX_SQL_STAT_ID = 388,
 	/** End of the reserved range of system spaces. */
 	BOX_SYSTEM_ID_MAX = 511,
 	BOX_ID_NIL = 2147483647
@@ -303,6 +305,15 @@ enum {
 	BOX_SESSION_SETTINGS_FIELD_VALUE = 1,
 };
 
+/** _sql_stat fields. */
+enum {
+	BOX_SQL_STAT_FIELD_SPACE_ID = 0,
+	BOX_SQL_STAT_FIELD_INDEX_ID = 1,
+	BOX_SQL_STAT_FIELD_TUPLE_COUNT = 2,
+	BOX_SQL_STAT_FIELD_DISTINCT = 3,
+	BOX_SQL_STAT_FIELD_SAMPLES = 4,
+};
+
 /*
  * Different objects which can be subject to access
  * control.
@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "bit/bit.h"
+#include "latency_histogram.h"
 #include "tuple_format.h"
 #include "trigger.h"
 #include "user.h"
@@ -717,6 +718,8 @@ space_delete(struct space *space)
 	space_reset_events(space);
 	if (space->upgrade != NULL)
 		space_upgrade_delete(space->upgrade);
+	for (uint32_t i = 0; i < lengthof(space->latency); i++)
+		free(space->latency[i]);
 	space_def_delete(space->def);
 	/*
 	 * SQL triggers should be deleted with on_replace_dd_triggers on
@@ -728,6 +731,30 @@ space_delete(struct space *space)
 	space->vtab->destroy(space);
 }
 
+void
+space_collect_latency(struct space *space, uint32_t type, uint64_t value)
+{
+	assert(type < lengthof(space->latency));
+	struct latency_histogram *hist = space->latency[type];
+	if (hist == NULL) {
+		/* Statistics aren't worth failing a request. */
+		hist = (struct latency_histogram *)calloc(1, sizeof(*hist));
+		if (hist == NULL)
+			return;
+		space->latency[type] = hist;
+	}
+	latency_histogram_collect(hist, value);
+}
+
+void
+space_reset_latency(struct space *space)
+{
+	for (uint32_t i = 0; i < lengthof(space->latency); i++) {
+		if (space->latency[i] != NULL)
+			latency_histogram_reset(space->latency[i]);
+	}
+}
+
 /**
  * Call a visitor function for spaces with id in the range [id_min..id_max].
  */
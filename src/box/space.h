@@ -56,6 +56,7 @@ struct tuple;
 struct tuple_format;
 struct space_upgrade;
 struct space_wal_ext;
+struct latency_histogram;
 
 struct space_vtab {
 	/** Free a space instance. */
@@ -284,6 +285,12 @@ struct space {
 	 * this object in sync. For more information see #9120.
 	 */
 	int lua_ref;
+	/**
+	 * Latency of IPROTO requests to this space, indexed by request
+	 * type (SELECT and DML only). A histogram is allocated on the
+	 * first request of its type, so it may be NULL.
+	 */
+	struct latency_histogram *latency[IPROTO_UPSERT + 1];
 };
 
 /** Space alter statement. */
@@ -715,6 +722,18 @@ space_new_ephemeral(struct space_def *space_def, struct rlist *key_list);
 void
 space_delete(struct space *space);
 
+/**
+ * Account the latency of an IPROTO request to a space.
+ * @type is the request type, SELECT or DML.
+ * @value is the observed latency, in nanoseconds.
+ */
+void
+space_collect_latency(struct space *space, uint32_t type, uint64_t value);
+
+/** Reset the request latency histograms of a space. */
+void
+space_reset_latency(struct space *space);
+
 /**
  * Call a visitor function on every space. Spaces are visited in order from
  * lowest space id to the highest, however, system spaces are visited first.
@@ -84,6 +84,7 @@ sql_init(void)
 
 	sql_stmt_cache_init();
 	sql_built_in_functions_cache_init();
+	sql_index_stat_init();
 
 	assert(db != NULL);
 }
@@ -198,6 +199,27 @@ int tarantoolsqlNext(BtCursor *pCur, int *pRes)
 	return cursor_advance(pCur, pRes);
 }
 
+int
+tarantoolsqlNextBatch(struct BtCursor *pCur, struct tuple **tuples,
+		      uint32_t size, uint32_t *count)
+{
+	uint32_t n = 0;
+	int res = 0;
+	while (n < size && pCur->eState == CURSOR_VALID) {
+		assert(iterator_direction(pCur->iter_type) > 0);
+		assert(pCur->last_tuple != NULL);
+		/* Pass the reference held by the cursor to the batch. */
+		tuples[n++] = pCur->last_tuple;
+		pCur->last_tuple = NULL;
+		if (cursor_advance(pCur, &res) != 0) {
+			*count = n;
+			return -1;
+		}
+	}
+	*count = n;
+	return 0;
+}
+
 /*
  * Set cursor to the previous entry in ephemeral space.
  * If state of cursor is invalid (e.g. it is still under construction,
@@ -1205,11 +1227,16 @@ sql_debug_info(struct info_handler *h)
 	extern int sql_sort_count;
 	extern int sql_found_count;
 	extern int sql_xfer_count;
+	extern int sql_plan_count;
+	extern double sql_plan_time;
 	info_begin(h);
 	info_append_int(h, "sql_search_count", sql_search_count);
 	info_append_int(h, "sql_sort_count", sql_sort_count);
 	info_append_int(h, "sql_found_count", sql_found_count);
 	info_append_int(h, "sql_xfer_count", sql_xfer_count);
+	info_append_int(h, "sql_plan_count", sql_plan_count);
+	info_append_double(h, "sql_plan_time", sql_plan_time);
+	sql_stmt_cache_debug_info(h);
 	info_end(h);
 }
 
@@ -1371,6 +1398,9 @@ index_field_tuple_est(const struct index_def *idx_def, uint32_t field)
 	if (field == idx_def->key_def->part_count &&
 	    idx_def->opts.is_unique)
 		return 0;
+	int16_t est;
+	if (sql_index_stat_tuple_est(idx_def, field, &est) == 0)
+		return est;
 	return default_tuple_est[field + 1 >= 6 ? 6 : field];
 }
 
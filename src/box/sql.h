@@ -64,6 +64,24 @@ sql_built_in_functions_cache_init(void);
 void
 sql_built_in_functions_cache_free(void);
 
+/** Maximal value of box.cfg.sql_sort_threads. */
+enum { SQL_SORT_THREADS_MAX = 16 };
+
+/**
+ * Set the number of worker threads which sort and merge runs of an SQL
+ * sorter. Zero means the number of online CPUs.
+ */
+void
+sql_sort_set_threads(int count);
+
+/**
+ * Set the memory limit of an SQL sorter in bytes. Sorted runs which
+ * don't fit in it are spilled to temporary files. Zero means the
+ * default limit.
+ */
+void
+sql_sort_set_memory(int64_t size);
+
 
 struct Expr;
 struct Parse;
@@ -0,0 +1,692 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/*
+ * This file contains code for the ANALYZE statement and for the index
+ * statistics used by the query planner.
+ *
+ * ANALYZE scans each TREE index of a space in key order and computes:
+ *
+ *  - the number of entries in the index;
+ *  - the number of distinct values of each key prefix, which is exact
+ *    since equal prefixes are adjacent in an ordered scan;
+ *  - up to SQL_STAT_SAMPLE_COUNT samples of the first key part taken
+ *    at equal distances, an equi-depth histogram. For each sampled
+ *    value the number of entries with a smaller and with an equal
+ *    first key part is kept.
+ *
+ * Statistics are stored in the _sql_stat system space, one tuple per
+ * index:
+ *
+ *   [space_id, index_id, tuple_count, [distinct, ...],
+ *    [[value, lt, eq], ...]]
+ *
+ * The planner decodes the tuples on demand and caches the result. A
+ * cache entry references the tuple it was decoded from, so the entry is
+ * known to be stale once the tuple is replaced or deleted. Entries of a
+ * space are dropped whenever the space or its indexes are altered.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+
+#include "assoc.h"
+#include "box/box.h"
+#include "box/error.h"
+#include "box/index.h"
+#include "box/schema.h"
+#include "box/session.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "box/txn.h"
+#include "box/user_def.h"
+#include "msgpuck/msgpuck.h"
+#include "small/region.h"
+
+enum {
+	/** Maximum number of samples kept for an index. */
+	SQL_STAT_SAMPLE_COUNT = 24,
+};
+
+/**
+ * Number of index entries scanned by ANALYZE between yields. In
+ * debug mode yield more often for testing purposes.
+ */
+#ifdef NDEBUG
+enum { SQL_STAT_YIELD_LOOPS = 1000 };
+#else
+enum { SQL_STAT_YIELD_LOOPS = 10 };
+#endif
+
+/** A sampled value of the first key part. */
+struct sql_index_sample {
+	/** The value, MsgPack. */
+	const char *value;
+	/** Size of the value. */
+	uint32_t value_size;
+	/** Number of entries with a smaller first key part. */
+	uint64_t lt;
+	/** Number of entries with an equal first key part. */
+	uint64_t eq;
+};
+
+/** Statistics of an index decoded from a _sql_stat tuple. */
+struct sql_index_stat {
+	/** Referenced tuple the statistics are decoded from. */
+	struct tuple *tuple;
+	/** Number of entries in the index. */
+	uint64_t tuple_count;
+	/** Number of key parts. */
+	uint32_t part_count;
+	/** Number of distinct values of each key prefix. */
+	uint64_t *distinct;
+	/** Number of samples, sorted by value. */
+	uint32_t sample_count;
+	/** Samples, values point to the tuple data. */
+	struct sql_index_sample *samples;
+};
+
+/** Decoded statistics by (space_id << 32 | index_id). */
+static struct mh_i64ptr_t *sql_index_stat_cache = NULL;
+
+void
+sql_analyze(struct Parse *parse, struct Token *name)
+{
+	uint32_t space_id = 0;
+	if (name != NULL) {
+		const struct space *space = sql_space_by_token(name);
+		if (space == NULL) {
+			const char *name_str = sql_tt_name_from_token(name);
+			diag_set(ClientError, ER_NO_SUCH_SPACE, name_str);
+			parse->is_aborted = true;
+			return;
+		}
+		if (space->def->opts.is_view) {
+			const char *err_msg =
+				tt_sprintf("can not analyze space '%s' because "
+					   "space is a view", space->def->name);
+			diag_set(ClientError, ER_SQL_EXECUTE, err_msg);
+			parse->is_aborted = true;
+			return;
+		}
+		space_id = space->def->id;
+	}
+	struct Vdbe *v = sqlGetVdbe(parse);
+	sqlVdbeAddOp1(v, OP_Analyze, space_id);
+}
+
+/**
+ * Return the number of leading key parts equal in two keys without
+ * array headers.
+ */
+static uint32_t
+sql_stat_common_parts(const char *key_a, const char *key_b,
+		      struct key_def *key_def)
+{
+	uint32_t part_count = key_def->part_count;
+	if (key_compare(key_a, part_count, HINT_NONE, key_b, part_count,
+			HINT_NONE, key_def) == 0)
+		return part_count;
+	uint32_t i = 0;
+	while (key_compare(key_a, i + 1, HINT_NONE, key_b, i + 1, HINT_NONE,
+			   key_def) == 0)
+		i++;
+	return i;
+}
+
+/**
+ * Make @a sample hold a copy of the first key part of @a key, which has
+ * no array header.
+ */
+static void
+sql_stat_sample_take(struct sql_index_sample *sample, const char *key,
+		     uint64_t lt, struct region *region)
+{
+	const char *key_end = key;
+	mp_next(&key_end);
+	sample->value_size = key_end - key;
+	char *value = xregion_alloc(region, sample->value_size);
+	memcpy(value, key, sample->value_size);
+	sample->value = value;
+	sample->lt = lt;
+}
+
+/**
+ * Scan an index and encode its statistics as a _sql_stat tuple on
+ * the region. Unless run in a transaction, the scan yields every
+ * SQL_STAT_YIELD_LOOPS entries. If the index is dropped or altered
+ * meanwhile, @a data is set to NULL.
+ */
+static int
+sql_stat_collect(struct index *index, struct region *region,
+		 const char **data, size_t *size)
+{
+	struct key_def *key_def = index->def->key_def;
+	uint32_t space_id = index->def->space_id;
+	uint32_t iid = index->def->iid;
+	uint32_t part_count = key_def->part_count;
+	uint64_t *distinct = xregion_alloc_array(region, typeof(*distinct),
+						 part_count);
+	memset(distinct, 0, part_count * sizeof(*distinct));
+	/* The last slot is reserved for the maximal value. */
+	struct sql_index_sample *samples =
+		xregion_alloc_array(region, typeof(*samples),
+				    SQL_STAT_SAMPLE_COUNT + 1);
+	uint32_t sample_count = 0;
+	ssize_t size_est = index_size(index);
+	uint64_t step = MAX(size_est / SQL_STAT_SAMPLE_COUNT, 1);
+	/*
+	 * Yielding in a memtx transaction would abort it. The index
+	 * iterator is safe to use across yields.
+	 */
+	bool can_yield = in_txn() == NULL;
+	struct index_weak_ref index_ref;
+	index_weak_ref_create(&index_ref, index);
+
+	struct iterator *it = index_create_iterator(index, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		return -1;
+	/* Key of the previous entry without the array header. */
+	char *prev = NULL;
+	uint32_t prev_capacity = 0;
+	uint64_t count = 0;
+	/* Rank of the first entry with the current first key part. */
+	uint64_t run_start = 0;
+	/* Sample of the current first key part if it was sampled. */
+	struct sql_index_sample *run_sample = NULL;
+	struct tuple *tuple;
+	while (true) {
+		if (iterator_next(it, &tuple) != 0)
+			goto error;
+		if (tuple == NULL)
+			break;
+		size_t svp = region_used(region);
+		uint32_t key_size;
+		const char *key = tuple_extract_key(tuple, key_def,
+						    MULTIKEY_NONE, &key_size);
+		if (key == NULL)
+			goto error;
+		const char *key_end = key + key_size;
+		mp_decode_array(&key);
+		key_size = key_end - key;
+		uint32_t common = prev == NULL ? 0 :
+				  sql_stat_common_parts(prev, key, key_def);
+		for (uint32_t i = common; i < part_count; i++)
+			distinct[i]++;
+		if (common == 0) {
+			if (run_sample != NULL)
+				run_sample->eq = count - run_start;
+			run_sample = NULL;
+			run_start = count;
+		}
+		if (key_size > prev_capacity) {
+			prev_capacity = MAX(key_size, 2 * prev_capacity);
+			prev = sql_xrealloc(prev, prev_capacity);
+		}
+		memcpy(prev, key, key_size);
+		region_truncate(region, svp);
+		if (count % step == 0 && run_sample == NULL &&
+		    sample_count < SQL_STAT_SAMPLE_COUNT) {
+			run_sample = &samples[sample_count++];
+			sql_stat_sample_take(run_sample, prev, run_start,
+					     region);
+		}
+		if (++count % SQL_STAT_YIELD_LOOPS != 0 || !can_yield)
+			continue;
+		fiber_sleep(0);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			goto error;
+		}
+		if (!index_weak_ref_check(&index_ref)) {
+			/* The key definition may be gone, give up. */
+			iterator_delete(it);
+			sql_xfree(prev);
+			*data = NULL;
+			return 0;
+		}
+	}
+	iterator_delete(it);
+	if (count > 0 && run_sample == NULL) {
+		/* Keep the maximal value to bound the histogram. */
+		run_sample = &samples[sample_count++];
+		sql_stat_sample_take(run_sample, prev, run_start, region);
+	}
+	if (run_sample != NULL)
+		run_sample->eq = count - run_start;
+	sql_xfree(prev);
+
+	size_t total = mp_sizeof_array(5) + mp_sizeof_uint(space_id) +
+		       mp_sizeof_uint(iid) + mp_sizeof_uint(count) +
+		       mp_sizeof_array(part_count) +
+		       mp_sizeof_array(sample_count);
+	for (uint32_t i = 0; i < part_count; i++)
+		total += mp_sizeof_uint(distinct[i]);
+	for (uint32_t i = 0; i < sample_count; i++) {
+		total += mp_sizeof_array(3) + samples[i].value_size +
+			 mp_sizeof_uint(samples[i].lt) +
+			 mp_sizeof_uint(samples[i].eq);
+	}
+	char *buf = xregion_alloc(region, total);
+	char *pos = mp_encode_array(buf, 5);
+	pos = mp_encode_uint(pos, space_id);
+	pos = mp_encode_uint(pos, iid);
+	pos = mp_encode_uint(pos, count);
+	pos = mp_encode_array(pos, part_count);
+	for (uint32_t i = 0; i < part_count; i++)
+		pos = mp_encode_uint(pos, distinct[i]);
+	pos = mp_encode_array(pos, sample_count);
+	for (uint32_t i = 0; i < sample_count; i++) {
+		pos = mp_encode_array(pos, 3);
+		memcpy(pos, samples[i].value, samples[i].value_size);
+		pos += samples[i].value_size;
+		pos = mp_encode_uint(pos, samples[i].lt);
+		pos = mp_encode_uint(pos, samples[i].eq);
+	}
+	assert(pos == buf + total);
+	*data = buf;
+	*size = total;
+	return 0;
+error:
+	iterator_delete(it);
+	sql_xfree(prev);
+	return -1;
+}
+
+/** Store statistics of an index in _sql_stat. */
+static int
+sql_stat_analyze_index(struct index *index)
+{
+	struct region *region = &fiber()->gc;
+	size_t svp = region_used(region);
+	const char *data;
+	size_t size;
+	if (sql_stat_collect(index, region, &data, &size) != 0) {
+		region_truncate(region, svp);
+		return -1;
+	}
+	if (data == NULL) {
+		/* The index was dropped or altered during the scan. */
+		region_truncate(region, svp);
+		return 0;
+	}
+	struct credentials *orig_credentials = effective_user();
+	fiber_set_user(fiber(), &admin_credentials);
+	int rc = box_replace(BOX_SQL_STAT_ID, data, data + size, NULL);
+	fiber_set_user(fiber(), orig_credentials);
+	region_truncate(region, svp);
+	return rc;
+}
+
+/**
+ * Statistics are only collected for indexes which can be scanned in
+ * key order and contain one entry per tuple.
+ */
+static bool
+sql_stat_index_is_supported(const struct index_def *def)
+{
+	return def->type == TREE && !def->key_def->is_multikey &&
+	       !def->key_def->for_func_index;
+}
+
+/** Store statistics of all supported indexes of a space. */
+static int
+sql_stat_analyze_space(uint32_t space_id)
+{
+	/*
+	 * Scanning vinyl indexes and writing statistics yield, so
+	 * the space is looked up again for each index.
+	 */
+	for (uint32_t i = 0; ; i++) {
+		struct space *space = space_by_id(space_id);
+		if (space == NULL || i >= space->index_count)
+			return 0;
+		struct index *index = space->index[i];
+		if (!sql_stat_index_is_supported(index->def))
+			continue;
+		if (sql_stat_analyze_index(index) != 0)
+			return -1;
+	}
+}
+
+/** Identifiers of the spaces to be analyzed. */
+struct sql_stat_space_list {
+	uint32_t *ids;
+	uint32_t count;
+	uint32_t capacity;
+};
+
+/** Add a user space the current user can read to the list. */
+static int
+sql_stat_space_list_add(struct space *space, void *data)
+{
+	struct sql_stat_space_list *list = data;
+	if (space_is_system(space) || space->def->opts.is_view ||
+	    space->index_count == 0)
+		return 0;
+	if (access_check_space(space, PRIV_R) != 0) {
+		diag_clear(diag_get());
+		return 0;
+	}
+	if (list->count == list->capacity) {
+		list->capacity = MAX(2 * list->capacity, 16);
+		list->ids = sql_xrealloc(list->ids, list->capacity *
+					 sizeof(list->ids[0]));
+	}
+	list->ids[list->count++] = space->def->id;
+	return 0;
+}
+
+/** Check that _sql_stat exists, it is missing in an old schema. */
+static int
+sql_stat_space_check(void)
+{
+	if (space_by_id(BOX_SQL_STAT_ID) != NULL)
+		return 0;
+	if (!box_schema_needs_upgrade())
+		diag_set(ClientError, ER_NO_SUCH_SPACE, "_sql_stat");
+	return -1;
+}
+
+int
+sql_stat_analyze(uint32_t space_id)
+{
+	if (space_id != 0) {
+		struct space *space = space_by_id(space_id);
+		if (space == NULL) {
+			diag_set(ClientError, ER_NO_SUCH_SPACE,
+				 int2str(space_id));
+			return -1;
+		}
+		if (access_check_space(space, PRIV_R) != 0 ||
+		    sql_stat_space_check() != 0)
+			return -1;
+		return sql_stat_analyze_space(space_id);
+	}
+	struct sql_stat_space_list list = {NULL, 0, 0};
+	space_foreach(sql_stat_space_list_add, &list);
+	int rc = list.count == 0 ? 0 : sql_stat_space_check();
+	for (uint32_t i = 0; i < list.count && rc == 0; i++)
+		rc = sql_stat_analyze_space(list.ids[i]);
+	sql_xfree(list.ids);
+	return rc;
+}
+
+/**
+ * Decode statistics of an index from a _sql_stat tuple. Return NULL
+ * if the tuple is malformed or does not match the index definition.
+ */
+static struct sql_index_stat *
+sql_index_stat_new(struct tuple *tuple, const struct index_def *def)
+{
+	const char *data = tuple_data(tuple);
+	if (mp_decode_array(&data) < BOX_SQL_STAT_FIELD_SAMPLES + 1)
+		return NULL;
+	for (uint32_t i = 0; i < BOX_SQL_STAT_FIELD_TUPLE_COUNT; i++)
+		mp_next(&data);
+	if (mp_typeof(*data) != MP_UINT)
+		return NULL;
+	uint64_t tuple_count = mp_decode_uint(&data);
+	if (mp_typeof(*data) != MP_ARRAY)
+		return NULL;
+	uint32_t part_count = mp_decode_array(&data);
+	if (part_count != def->key_def->part_count)
+		return NULL;
+	const char *distinct = data;
+	for (uint32_t i = 0; i < part_count; i++) {
+		if (mp_typeof(*data) != MP_UINT)
+			return NULL;
+		mp_next(&data);
+	}
+	if (mp_typeof(*data) != MP_ARRAY)
+		return NULL;
+	uint32_t sample_count = mp_decode_array(&data);
+	const char *samples = data;
+	for (uint32_t i = 0; i < sample_count; i++) {
+		if (mp_typeof(*data) != MP_ARRAY || mp_decode_array(&data) != 3)
+			return NULL;
+		mp_next(&data);
+		if (mp_typeof(*data) != MP_UINT)
+			return NULL;
+		mp_next(&data);
+		if (mp_typeof(*data) != MP_UINT)
+			return NULL;
+		mp_next(&data);
+	}
+
+	size_t size = sizeof(struct sql_index_stat) +
+		      part_count * sizeof(uint64_t) +
+		      sample_count * sizeof(struct sql_index_sample);
+	struct sql_index_stat *stat = sql_xmalloc(size);
+	stat->tuple = tuple;
+	tuple_ref(tuple);
+	stat->tuple_count = tuple_count;
+	stat->part_count = part_count;
+	stat->sample_count = sample_count;
+	stat->samples = (struct sql_index_sample *)(stat + 1);
+	stat->distinct = (uint64_t *)(stat->samples + sample_count);
+	for (uint32_t i = 0; i < part_count; i++)
+		stat->distinct[i] = mp_decode_uint(&distinct);
+	for (uint32_t i = 0; i < sample_count; i++) {
+		struct sql_index_sample *sample = &stat->samples[i];
+		mp_decode_array(&samples);
+		sample->value = samples;
+		mp_next(&samples);
+		sample->value_size = samples - sample->value;
+		sample->lt = mp_decode_uint(&samples);
+		sample->eq = mp_decode_uint(&samples);
+	}
+	return stat;
+}
+
+static void
+sql_index_stat_delete(struct sql_index_stat *stat)
+{
+	tuple_unref(stat->tuple);
+	sql_xfree(stat);
+}
+
+/**
+ * Drop cached statistics of the indexes of a created, altered or
+ * dropped space. The index definitions they were decoded for may be
+ * gone.
+ */
+static int
+sql_index_stat_on_alter_space(struct trigger *trigger, void *event)
+{
+	(void)trigger;
+	struct space *space = event;
+	struct mh_i64ptr_t *h = sql_index_stat_cache;
+	mh_int_t i;
+	mh_foreach(h, i) {
+		struct mh_i64ptr_node_t *node = mh_i64ptr_node(h, i);
+		if (node->key >> 32 != space->def->id)
+			continue;
+		sql_index_stat_delete(node->val);
+		mh_i64ptr_del(h, i, NULL);
+	}
+	return 0;
+}
+
+static TRIGGER(sql_index_stat_on_alter_space_trigger,
+	       sql_index_stat_on_alter_space);
+
+void
+sql_index_stat_init(void)
+{
+	sql_index_stat_cache = mh_i64ptr_new();
+	trigger_add(&on_alter_space, &sql_index_stat_on_alter_space_trigger);
+}
+
+/**
+ * Return statistics of an index or NULL if the index has not been
+ * analyzed.
+ */
+static const struct sql_index_stat *
+sql_index_stat_get(const struct index_def *def)
+{
+	struct space *stat_space = space_by_id(BOX_SQL_STAT_ID);
+	if (stat_space == NULL)
+		return NULL;
+	struct index *pk = space_index(stat_space, 0);
+	if (pk == NULL)
+		return NULL;
+	char key[16];
+	char *key_end = mp_encode_uint(key, def->space_id);
+	key_end = mp_encode_uint(key_end, def->iid);
+	assert(key_end <= key + sizeof(key));
+	(void)key_end;
+	struct tuple *tuple;
+	if (index_get_internal(pk, key, 2, &tuple) != 0) {
+		diag_clear(diag_get());
+		return NULL;
+	}
+	struct mh_i64ptr_t *h = sql_index_stat_cache;
+	uint64_t cache_key = (uint64_t)def->space_id << 32 | def->iid;
+	mh_int_t i = mh_i64ptr_find(h, cache_key, NULL);
+	if (i != mh_end(h)) {
+		struct sql_index_stat *stat = mh_i64ptr_node(h, i)->val;
+		if (stat->tuple == tuple)
+			return stat;
+		mh_i64ptr_del(h, i, NULL);
+		sql_index_stat_delete(stat);
+	}
+	if (tuple == NULL)
+		return NULL;
+	struct sql_index_stat *stat = sql_index_stat_new(tuple, def);
+	if (stat == NULL)
+		return NULL;
+	struct mh_i64ptr_node_t node = {cache_key, stat};
+	mh_i64ptr_put(h, &node, NULL, NULL);
+	return stat;
+}
+
+int
+sql_index_stat_tuple_est(const struct index_def *def, uint32_t field,
+			 int16_t *est)
+{
+	const struct sql_index_stat *stat = sql_index_stat_get(def);
+	if (stat == NULL)
+		return -1;
+	assert(field <= stat->part_count);
+	if (field == 0) {
+		*est = sqlLogEst(stat->tuple_count);
+		return 0;
+	}
+	uint64_t distinct = stat->distinct[field - 1];
+	*est = distinct == 0 ? 0 : sqlLogEst(stat->tuple_count / distinct);
+	return 0;
+}
+
+/** Return the number of entries with NULL in the first key part. */
+static uint64_t
+sql_index_stat_null_count(const struct sql_index_stat *stat)
+{
+	if (stat->sample_count == 0 ||
+	    mp_typeof(*stat->samples[0].value) != MP_NIL)
+		return 0;
+	return stat->samples[0].eq;
+}
+
+/**
+ * Estimate the number of entries with the first key part less than
+ * @a value or, if @a is_inclusive is set, less than or equal to it.
+ */
+static int
+sql_index_stat_rank(const struct sql_index_stat *stat,
+		    const struct coll *coll, const struct Mem *value,
+		    bool is_inclusive, uint64_t *rank)
+{
+	/* Rank of the entry following the previous sampled value. */
+	uint64_t prev_end = 0;
+	for (uint32_t i = 0; i < stat->sample_count; i++) {
+		const struct sql_index_sample *sample = &stat->samples[i];
+		if (mp_typeof(*sample->value) == MP_NIL) {
+			prev_end = sample->lt + sample->eq;
+			continue;
+		}
+		struct Mem mem;
+		mem_create(&mem);
+		uint32_t unused;
+		int cmp;
+		if (mem_from_mp_ephemeral(&mem, sample->value, &unused) != 0 ||
+		    mem_cmp(&mem, value, &cmp, coll) != 0)
+			return -1;
+		if (cmp == 0) {
+			*rank = sample->lt + (is_inclusive ? sample->eq : 0);
+			return 0;
+		}
+		if (cmp > 0) {
+			/* The value is between two sampled values. */
+			*rank = (prev_end + sample->lt) / 2;
+			return 0;
+		}
+		prev_end = sample->lt + sample->eq;
+	}
+	*rank = stat->tuple_count;
+	return 0;
+}
+
+int
+sql_index_stat_range_est(const struct index_def *def,
+			 const struct Mem *lower, bool is_lower_inclusive,
+			 const struct Mem *upper, bool is_upper_inclusive,
+			 uint64_t *count)
+{
+	const struct sql_index_stat *stat = sql_index_stat_get(def);
+	if (stat == NULL || stat->sample_count == 0)
+		return -1;
+	const struct coll *coll = def->key_def->parts[0].coll;
+	/* NULLs precede all values and never satisfy a comparison. */
+	uint64_t lower_rank = sql_index_stat_null_count(stat);
+	uint64_t upper_rank = stat->tuple_count;
+	if (lower != NULL &&
+	    sql_index_stat_rank(stat, coll, lower, !is_lower_inclusive,
+				&lower_rank) != 0)
+		goto error;
+	if (upper != NULL &&
+	    sql_index_stat_rank(stat, coll, upper, is_upper_inclusive,
+				&upper_rank) != 0)
+		goto error;
+	*count = upper_rank > lower_rank ? upper_rank - lower_rank : 0;
+	return 0;
+error:
+	/* Values of incomparable types, the estimate is unknown. */
+	diag_clear(diag_get());
+	return -1;
+}
+
+int
+sql_index_stat_eq_est(const struct index_def *def, const struct Mem *value,
+		      uint64_t *count)
+{
+	const struct sql_index_stat *stat = sql_index_stat_get(def);
+	if (stat == NULL || stat->sample_count == 0)
+		return -1;
+	const struct coll *coll = def->key_def->parts[0].coll;
+	uint64_t lt, le;
+	if (sql_index_stat_rank(stat, coll, value, false, &lt) != 0 ||
+	    sql_index_stat_rank(stat, coll, value, true, &le) != 0) {
+		diag_clear(diag_get());
+		return -1;
+	}
+	if (le > lt) {
+		/* The value is sampled, the count is exact. */
+		*count = le - lt;
+		return 0;
+	}
+	/* Spread the rest of entries evenly over the other values. */
+	uint64_t sampled = 0;
+	for (uint32_t i = 0; i < stat->sample_count; i++)
+		sampled += stat->samples[i].eq;
+	if (sampled >= stat->tuple_count ||
+	    stat->distinct[0] <= stat->sample_count) {
+		*count = 0;
+		return 0;
+	}
+	*count = (stat->tuple_count - sampled) /
+		 (stat->distinct[0] - stat->sample_count);
+	return 0;
+}
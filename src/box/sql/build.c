@@ -1668,6 +1668,26 @@ vdbe_emit_revoke_object(struct Parse *parser, const char *object_type,
 	sqlReleaseTempRange(parser, key_reg, 4);
 }
 
+/**
+ * Generate code to delete statistics of an index collected by
+ * ANALYZE, if any.
+ */
+static void
+vdbe_emit_stat_delete(struct Parse *parser, uint32_t space_id,
+		      uint32_t index_id)
+{
+	if (space_by_id(BOX_SQL_STAT_ID) == NULL)
+		return;
+	struct Vdbe *v = sqlGetVdbe(parser);
+	int key_reg = sqlGetTempRange(parser, 3);
+	sqlVdbeAddOp2(v, OP_Integer, space_id, key_reg);
+	sqlVdbeAddOp2(v, OP_Integer, index_id, key_reg + 1);
+	sqlVdbeAddOp3(v, OP_MakeRecord, key_reg, 2, key_reg + 2);
+	sqlVdbeAddOp2(v, OP_SDelete, BOX_SQL_STAT_ID, key_reg + 2);
+	VdbeComment((v, "Delete statistics of index %u", index_id));
+	sqlReleaseTempRange(parser, key_reg, 3);
+}
+
 /**
  * Generate code to drop a table.
  * This routine includes dropping triggers, sequences,
@@ -1757,9 +1777,11 @@ sql_code_drop_table(struct Parse *parse_context, const struct space *space,
 			 * secondary exist.
 			 */
 			for (uint32_t i = 1; i < index_count; ++i) {
-				sqlVdbeAddOp2(v, OP_Integer,
-						  space->index[i]->def->iid,
-						  index_id_reg);
+				uint32_t iid = space->index[i]->def->iid;
+				vdbe_emit_stat_delete(parse_context, space_id,
+						      iid);
+				sqlVdbeAddOp2(v, OP_Integer, iid,
+					      index_id_reg);
 				sqlVdbeAddOp3(v, OP_MakeRecord,
 						  space_id_reg, 2, idx_rec_reg);
 				sqlVdbeAddOp2(v, OP_SDelete, BOX_INDEX_ID,
@@ -1769,6 +1791,7 @@ sql_code_drop_table(struct Parse *parse_context, const struct space *space,
 					     space->index[i]->def->iid));
 			}
 		}
+		vdbe_emit_stat_delete(parse_context, space_id, 0);
 		sqlVdbeAddOp2(v, OP_Integer, 0, index_id_reg);
 		sqlVdbeAddOp3(v, OP_MakeRecord, space_id_reg, 2,
 				  idx_rec_reg);
@@ -2176,6 +2199,7 @@ sql_drop_table_constraint(struct Parse *parser, const struct Token *table_name,
 			parser->is_aborted = true;
 			return;
 		}
+		vdbe_emit_stat_delete(parser, space->def->id, index_id);
 		int regs = sqlGetTempRange(parser, 3);
 		sqlVdbeCountChanges(v);
 		sqlVdbeAddOp2(v, OP_Integer, space->def->id, regs);
@@ -2263,6 +2287,7 @@ sql_drop_primary_key(struct Parse *parser, const struct Token *table_name,
 
 	uint32_t index_id = sql_index_id_by_token(space, name);
 	if (index_id == 0) {
+		vdbe_emit_stat_delete(parser, space->def->id, 0);
 		int regs = sqlGetTempRange(parser, 3);
 		struct Vdbe *v = sqlGetVdbe(parser);
 		sqlVdbeCountChanges(v);
@@ -2294,6 +2319,7 @@ sql_drop_unique(struct Parse *parser, const struct Token *table_name,
 
 	uint32_t index_id = sql_index_id_by_token(space, name);
 	if (index_id != 0 && index_id != UINT32_MAX) {
+		vdbe_emit_stat_delete(parser, space->def->id, index_id);
 		int regs = sqlGetTempRange(parser, 3);
 		struct Vdbe *v = sqlGetVdbe(parser);
 		sqlVdbeCountChanges(v);
@@ -3050,6 +3076,7 @@ sql_drop_index(struct Parse *parse_context)
 		goto exit_drop_index;
 	}
 
+	vdbe_emit_stat_delete(parse_context, space->def->id, index_id);
 	int regs = sqlGetTempRange(parse_context, 3);
 	sqlVdbeCountChanges(v);
 	sqlVdbeAddOp2(v, OP_Integer, space->def->id, regs);
@@ -1508,6 +1508,14 @@ cmd ::= FUNCTION_KW(T) expr(E). {
   pParse->parsed_ast.expr = E.pExpr;
 }
 
+/////////////////////////////// The ANALYZE command ///////////////////////////
+cmd ::= ANALYZE. {
+  sql_analyze(pParse, NULL);
+}
+cmd ::= ANALYZE nm(X). {
+  sql_analyze(pParse, &X);
+}
+
 //////////////////////////// The SHOW CREATE TABLE command /////////////////////
 cmd ::= SHOW CREATE TABLE nm(X). {
   sql_emit_show_create_table_one(pParse, &X);
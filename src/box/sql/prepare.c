@@ -38,15 +38,28 @@
 #include "tarantoolInt.h"
 #include "box/space.h"
 #include "box/session.h"
+#include "clock.h"
 
-int
-sql_stmt_compile(const char *zSql, int nBytes, struct Vdbe *pReprepare,
-		 struct Vdbe **ppStmt, const char **pzTail)
+/** Number of statements compiled so far. */
+int sql_plan_count = 0;
+/** Time spent on compilation of statements, in seconds. */
+double sql_plan_time = 0;
+
+/**
+ * Compile a statement. Values bound to @a bound_stmt, if it is not
+ * NULL, are used to estimate the selectivity of constraints with
+ * parameters.
+ */
+static int
+sqlPrepare(const char *zSql, int nBytes, struct Vdbe *pReprepare,
+	   struct Vdbe *bound_stmt, struct Vdbe **ppStmt, const char **pzTail)
 {
 	int rc = 0;	/* Result code */
 	Parse sParse;		/* Parsing context */
+	double start = clock_monotonic();
 	sql_parser_create(&sParse, current_session()->sql_flags);
 	sParse.pReprepare = pReprepare;
+	sParse.bound_stmt = bound_stmt;
 	*ppStmt = NULL;
 
 	/* Check to verify that it is possible to get a read lock on all
@@ -160,9 +173,25 @@ sql_stmt_compile(const char *zSql, int nBytes, struct Vdbe *pReprepare,
  end_prepare:
 
 	sql_parser_destroy(&sParse);
+	sql_plan_count++;
+	sql_plan_time += clock_monotonic() - start;
 	return rc;
 }
 
+int
+sql_stmt_compile(const char *sql, int bytes_count, struct Vdbe *re_prepared,
+		 struct Vdbe **stmt, const char **sql_tail)
+{
+	return sqlPrepare(sql, bytes_count, re_prepared, NULL, stmt, sql_tail);
+}
+
+int
+sql_stmt_compile_bound(const char *sql, int bytes_count,
+		       struct Vdbe *bound_stmt, struct Vdbe **stmt)
+{
+	return sqlPrepare(sql, bytes_count, NULL, bound_stmt, stmt, NULL);
+}
+
 /*
  * Rerun the compilation of a statement after a schema change.
  */
@@ -40,6 +40,7 @@
 #include "vdbeInt.h"
 #include "box/box.h"
 #include "box/coll_id_cache.h"
+#include "box/memtx_column.h"
 #include "box/schema.h"
 
 /*
@@ -4492,6 +4493,281 @@ is_simple_count(struct Select *select, struct AggInfo *agg_info)
 	return space;
 }
 
+/** Maximum number of WHERE terms evaluated by OP_BatchFilter. */
+enum { BATCH_FILTER_MAX = 16 };
+
+/** WHERE clause term evaluated by OP_BatchFilter. */
+struct batch_filter {
+	/** The comparison. */
+	struct Expr *term;
+	/** Column of the table compared. */
+	struct Expr *column;
+	/** Constant the column is compared with. */
+	struct Expr *value;
+	/** Comparison operator of the term. */
+	int op;
+	/** True if the constant is the left operand. */
+	bool is_value_left;
+};
+
+/**
+ * Return true if @a fieldno is the first field of an index of
+ * @a space, so the planner may use the index instead of a full
+ * scan. COLUMN indexes are not used by the planner.
+ */
+static bool
+space_has_index_on(const struct space *space, uint32_t fieldno)
+{
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		const struct index_def *def = space->index[i]->def;
+		if (def->type != COLUMN &&
+		    def->key_def->parts[0].fieldno == fieldno)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Return true if @a fieldno is a part of a secondary index of
+ * @a space, so the planner may scan the index instead of the table.
+ * Scanning the primary index is the same as scanning the table, so
+ * it is not taken into account, and neither are COLUMN indexes.
+ */
+static bool
+space_index_covers(const struct space *space, uint32_t fieldno)
+{
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		if (space->index[i]->def->type == COLUMN)
+			continue;
+		const struct key_def *key_def = space->index[i]->def->key_def;
+		for (uint32_t j = 0; j < key_def->part_count; j++) {
+			if (key_def->parts[j].fieldno == fieldno)
+				return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Split the WHERE clause @a expr into comparisons of columns of
+ * the table with cursor @a cursor with constants. Columns that
+ * are the first fields of indexes are not allowed.
+ *
+ * @retval true if the whole clause was split, false otherwise.
+ */
+static bool
+batch_filters_from_where(struct Expr *expr, int cursor,
+			 const struct space *space,
+			 struct batch_filter *filters, int *filter_count)
+{
+	if (expr->op == TK_AND) {
+		return batch_filters_from_where(expr->pLeft, cursor, space,
+						filters, filter_count) &&
+		       batch_filters_from_where(expr->pRight, cursor, space,
+						filters, filter_count);
+	}
+	int op = expr->op;
+	switch (op) {
+	case TK_EQ:
+	case TK_NE:
+	case TK_LT:
+	case TK_LE:
+	case TK_GT:
+	case TK_GE:
+		break;
+	default:
+		return false;
+	}
+	struct Expr *column = expr->pLeft;
+	struct Expr *value = expr->pRight;
+	bool is_value_left = column->op != TK_COLUMN_REF;
+	if (is_value_left)
+		SWAP(column, value);
+	if (column->op != TK_COLUMN_REF || column->iTable != cursor ||
+	    !sqlExprIsConstant(value) || sqlExprIsVector(value) ||
+	    space_has_index_on(space, column->iColumn) ||
+	    *filter_count == BATCH_FILTER_MAX)
+		return false;
+	struct batch_filter *filter = &filters[(*filter_count)++];
+	filter->term = expr;
+	filter->column = column;
+	filter->value = value;
+	filter->op = op;
+	filter->is_value_left = is_value_left;
+	return true;
+}
+
+/**
+ * This function tests if the aggregate query without GROUP BY
+ * can be executed by the batch opcodes, i.e. is of the form:
+ *
+ *   SELECT agg(<col>), ... FROM <tbl> [WHERE <col> <op> <const> AND ...]
+ *
+ * where table is not a sub-select or view, all aggregates are
+ * COUNT(*) or non-DISTINCT COUNT, SUM, TOTAL, AVG, MIN or MAX of
+ * a column of the table that is not a part of a secondary index and
+ * each column in the WHERE clause is not the first field of an index.
+ * Indexed columns are left to the planner, which can search or scan
+ * an index instead of the table. So is a single MIN or MAX of the
+ * first field of an index, which is looked up in the index. The scan
+ * must be allowed, since otherwise the regular code raises an error.
+ *
+ * Queries with GROUP BY are not batched: their rows are sorted by
+ * the grouping key and fed to the aggregates one by one.
+ *
+ * @param parse Parsing context.
+ * @param select The select statement in form of aggregate query.
+ * @param agg_info The associated aggregate-info object.
+ * @param[out] filters The WHERE clause terms.
+ * @param[out] filter_count Number of the terms.
+ * @retval Pointer to space representing the table,
+ *         if the query matches this pattern. NULL otherwise.
+ */
+static struct space *
+is_batch_aggregate(struct Parse *parse, struct Select *select,
+		   struct AggInfo *agg_info, struct batch_filter *filters,
+		   int *filter_count)
+{
+	assert(select->pGroupBy == NULL);
+	*filter_count = 0;
+	if (select->pHaving != NULL || select->pSrc->nSrc != 1 ||
+	    select->pSrc->a[0].pSelect != NULL ||
+	    select->pSrc->a[0].fg.isIndexedBy ||
+	    agg_info->nAccumulator != 0 || agg_info->nFunc == 0)
+		return NULL;
+	struct SrcList_item *src = &select->pSrc->a[0];
+	if (src->fg.disallow_scan && (parse->sql_flags & SQL_SeqScan) == 0)
+		return NULL;
+	struct space *space = src->space;
+	assert(space != NULL && !space->def->opts.is_view);
+	struct index *pk = space_index(space, 0);
+	if (pk == NULL || pk->def->type != TREE)
+		return NULL;
+	for (int i = 0; i < agg_info->nFunc; i++) {
+		struct AggInfo_func *agg_func = &agg_info->aFunc[i];
+		if (agg_func->iDistinct >= 0 ||
+		    agg_func->func->def->language != FUNC_LANGUAGE_SQL_BUILTIN)
+			return NULL;
+		const char *name = agg_func->func->def->name;
+		if (strcmp(name, "COUNT") != 0 && strcmp(name, "SUM") != 0 &&
+		    strcmp(name, "TOTAL") != 0 && strcmp(name, "AVG") != 0 &&
+		    strcmp(name, "MIN") != 0 && strcmp(name, "MAX") != 0)
+			return NULL;
+		struct ExprList *args = agg_func->pExpr->x.pList;
+		if (args == NULL || args->nExpr == 0)
+			continue;
+		struct Expr *arg = args->a[0].pExpr;
+		if (args->nExpr != 1 || arg->op != TK_AGG_COLUMN ||
+		    arg->iTable != src->iCursor ||
+		    space_index_covers(space, arg->iColumn))
+			return NULL;
+		if (agg_info->nFunc == 1 && (strcmp(name, "MIN") == 0 ||
+					     strcmp(name, "MAX") == 0) &&
+		    space_has_index_on(space, arg->iColumn))
+			return NULL;
+	}
+	if (select->pWhere != NULL &&
+	    !batch_filters_from_where(select->pWhere, src->iCursor, space,
+				      filters, filter_count))
+		return NULL;
+	return space;
+}
+
+/**
+ * Return the function a COLUMN index computes for the aggregate
+ * @a agg_func and the key part of @a key_def it is computed over,
+ * or memtx_column_agg_MAX if the index can't compute it.
+ */
+static enum memtx_column_agg
+column_agg_from_func(struct AggInfo_func *agg_func, int cursor,
+		     const struct key_def *key_def, uint32_t *part)
+{
+	*part = 0;
+	if (agg_func->iDistinct >= 0 ||
+	    agg_func->func->def->language != FUNC_LANGUAGE_SQL_BUILTIN)
+		return memtx_column_agg_MAX;
+	const char *name = agg_func->func->def->name;
+	enum memtx_column_agg agg;
+	if (strcmp(name, "COUNT") == 0)
+		agg = MEMTX_COLUMN_AGG_COUNT;
+	else if (strcmp(name, "SUM") == 0)
+		agg = MEMTX_COLUMN_AGG_SUM;
+	else if (strcmp(name, "MIN") == 0)
+		agg = MEMTX_COLUMN_AGG_MIN;
+	else if (strcmp(name, "MAX") == 0)
+		agg = MEMTX_COLUMN_AGG_MAX;
+	else
+		return memtx_column_agg_MAX;
+	struct ExprList *args = agg_func->pExpr->x.pList;
+	if (args == NULL || args->nExpr == 0) {
+		return agg == MEMTX_COLUMN_AGG_COUNT ? agg :
+		       memtx_column_agg_MAX;
+	}
+	struct Expr *arg = args->a[0].pExpr;
+	if (args->nExpr != 1 || arg->op != TK_AGG_COLUMN ||
+	    arg->iTable != cursor)
+		return memtx_column_agg_MAX;
+	const struct key_part *key_part =
+		key_def_find_by_fieldno(key_def, arg->iColumn);
+	if (key_part == NULL || key_part->path != NULL)
+		return memtx_column_agg_MAX;
+	/* Parts of a COLUMN index are not nullable. */
+	*part = key_part - key_def->parts;
+	return agg;
+}
+
+/**
+ * This function tests if the aggregate query without GROUP BY
+ * can be computed by a COLUMN index, i.e. is of the form:
+ *
+ *   SELECT agg(<col>), ... FROM <tbl>
+ *
+ * where table is not a sub-select or view and all aggregates are
+ * COUNT(*) or non-DISTINCT COUNT, SUM, MIN or MAX of key parts of
+ * the same COLUMN index of the table. The WHERE clause is not pushed
+ * down to the index, so queries with it are not accepted. The scan
+ * must be allowed, since otherwise the regular code raises an error.
+ *
+ * @param parse Parsing context.
+ * @param select The select statement in form of aggregate query.
+ * @param agg_info The associated aggregate-info object.
+ * @retval Pointer to the COLUMN index, if the query matches this
+ *         pattern. NULL otherwise.
+ */
+static struct index *
+is_column_aggregate(struct Parse *parse, struct Select *select,
+		    struct AggInfo *agg_info)
+{
+	assert(select->pGroupBy == NULL);
+	if (select->pWhere != NULL || select->pHaving != NULL ||
+	    select->pSrc->nSrc != 1 || select->pSrc->a[0].pSelect != NULL ||
+	    select->pSrc->a[0].fg.isIndexedBy ||
+	    agg_info->nAccumulator != 0 || agg_info->nFunc == 0)
+		return NULL;
+	struct SrcList_item *src = &select->pSrc->a[0];
+	if (src->fg.disallow_scan && (parse->sql_flags & SQL_SeqScan) == 0)
+		return NULL;
+	struct space *space = src->space;
+	assert(space != NULL && !space->def->opts.is_view);
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		if (index->def->type != COLUMN)
+			continue;
+		int j;
+		for (j = 0; j < agg_info->nFunc; j++) {
+			uint32_t part;
+			if (column_agg_from_func(&agg_info->aFunc[j],
+						 src->iCursor,
+						 index->def->key_def,
+						 &part) == memtx_column_agg_MAX)
+				break;
+		}
+		if (j == agg_info->nFunc)
+			return index;
+	}
+	return NULL;
+}
+
 /*
  * If the source-list item passed as an argument was augmented with an
  * INDEXED BY clause, then try to locate the specified index. If there
@@ -5483,6 +5759,192 @@ explain_simple_count(struct Parse *parse_context, const char *table_name)
 	}
 }
 
+/**
+ * Add a single OP_Explain instruction to the VDBE to explain
+ * an aggregate query executed by the batch opcodes.
+ *
+ * @param parse_context Current parsing context.
+ * @param table_name Name of table being queried.
+ */
+static void
+explain_batch_aggregate(struct Parse *parse_context, const char *table_name)
+{
+	if (parse_context->explain == 2) {
+		char *zEqp = sqlMPrintf("BATCH SCAN TABLE %s", table_name);
+		sqlVdbeAddOp4(parse_context->pVdbe, OP_Explain,
+				  parse_context->iSelectId, 0, 0, zEqp,
+				  P4_DYNAMIC);
+	}
+}
+
+/**
+ * Add a single OP_Explain instruction to the VDBE to explain
+ * an aggregate query computed by a COLUMN index.
+ *
+ * @param parse_context Current parsing context.
+ * @param table_name Name of table being queried.
+ * @param index_name Name of the COLUMN index.
+ */
+static void
+explain_column_aggregate(struct Parse *parse_context, const char *table_name,
+			 const char *index_name)
+{
+	if (parse_context->explain == 2) {
+		char *zEqp = sqlMPrintf("SCAN TABLE %s USING COLUMN INDEX %s",
+					table_name, index_name);
+		sqlVdbeAddOp4(parse_context->pVdbe, OP_Explain,
+				  parse_context->iSelectId, 0, 0, zEqp,
+				  P4_DYNAMIC);
+	}
+}
+
+/**
+ * Generate code for an aggregate query accepted by
+ * is_column_aggregate(). Each aggregate is computed by a single
+ * OP_ColumnAggregate over the typed arrays of the COLUMN index,
+ * and its result is stored in the register of the aggregate.
+ *
+ * @param parse Parsing context.
+ * @param agg_info The associated aggregate-info object.
+ * @param src The table.
+ * @param index The COLUMN index.
+ */
+static void
+vdbe_emit_column_aggregate(struct Parse *parse, struct AggInfo *agg_info,
+			   struct SrcList_item *src, struct index *index)
+{
+	struct Vdbe *v = parse->pVdbe;
+	struct space *space = src->space;
+	for (int i = 0; i < agg_info->nFunc; i++) {
+		struct AggInfo_func *agg_func = &agg_info->aFunc[i];
+		uint32_t part;
+		enum memtx_column_agg agg =
+			column_agg_from_func(agg_func, src->iCursor,
+					     index->def->key_def, &part);
+		assert(agg != memtx_column_agg_MAX);
+		sqlVdbeAddOp4Int(v, OP_ColumnAggregate, space->def->id,
+				 index->def->iid, agg_func->iMem, part);
+		sqlVdbeChangeP5(v, agg);
+	}
+	explain_column_aggregate(parse, space->def->name, index->def->name);
+}
+
+/**
+ * Emit OP_BatchColumn decoding field @a fieldno to a new column
+ * vector unless the field is already decoded.
+ *
+ * @param v VDBE.
+ * @param cursor Table cursor.
+ * @param fieldno Number of the field.
+ * @param fieldnos Fields decoded to the column vectors so far.
+ * @param column_count Number of the column vectors.
+ * @retval Number of the column vector with the field.
+ */
+static int
+vdbe_emit_batch_column(struct Vdbe *v, int cursor, uint32_t fieldno,
+		       uint32_t *fieldnos, int *column_count)
+{
+	for (int i = 0; i < *column_count; i++) {
+		if (fieldnos[i] == fieldno)
+			return i;
+	}
+	int column = (*column_count)++;
+	fieldnos[column] = fieldno;
+	sqlVdbeAddOp3(v, OP_BatchColumn, cursor, fieldno, column);
+	return column;
+}
+
+/**
+ * Generate code for an aggregate query accepted by
+ * is_batch_aggregate(). Instead of the regular loop running
+ * OP_Column, comparisons and OP_AggStep for every row, the table
+ * is read by OP_BatchNext a batch at a time, the WHERE clause
+ * terms deselect rows of the batch and the aggregates are
+ * accumulated over the selected rows.
+ *
+ * @param parse Parsing context.
+ * @param agg_info The associated aggregate-info object.
+ * @param space The table.
+ * @param filters The WHERE clause terms.
+ * @param filter_count Number of the terms.
+ */
+static void
+vdbe_emit_batch_aggregate(struct Parse *parse, struct AggInfo *agg_info,
+			  struct space *space, struct batch_filter *filters,
+			  int filter_count)
+{
+	struct Vdbe *v = parse->pVdbe;
+	resetAccumulator(parse, agg_info);
+	int value_regs[BATCH_FILTER_MAX];
+	struct coll *colls[BATCH_FILTER_MAX];
+	for (int i = 0; i < filter_count; i++) {
+		struct Expr *term = filters[i].term;
+		uint32_t coll_id;
+		if (sql_binary_compare_coll_seq(parse, term->pLeft,
+						term->pRight, &coll_id) != 0) {
+			parse->is_aborted = true;
+			return;
+		}
+		colls[i] = coll_by_id(coll_id)->coll;
+		value_regs[i] = ++parse->nMem;
+		sqlExprCode(parse, filters[i].value, value_regs[i]);
+	}
+	const int cursor = parse->nTab++;
+	vdbe_emit_open_cursor(parse, cursor, 0, space);
+	uint32_t *fieldnos = sql_xmalloc((filter_count + agg_info->nFunc) *
+					 sizeof(*fieldnos));
+	int column_count = 0;
+	int addr_open = sqlVdbeAddOp1(v, OP_BatchOpen, cursor);
+	int label_done = sqlVdbeMakeLabel(v);
+	sqlVdbeAddOp2(v, OP_Rewind, cursor, label_done);
+	int addr_loop = sqlVdbeAddOp2(v, OP_BatchNext, cursor, label_done);
+	assert(TK_EQ == OP_Eq && TK_NE == OP_Ne && TK_LT == OP_Lt &&
+	       TK_LE == OP_Le && TK_GT == OP_Gt && TK_GE == OP_Ge);
+	for (int i = 0; i < filter_count; i++) {
+		int column = vdbe_emit_batch_column(v, cursor,
+						    filters[i].column->iColumn,
+						    fieldnos, &column_count);
+		sqlVdbeAddOp4(v, OP_BatchFilter, cursor, column, value_regs[i],
+			      (char *)colls[i], P4_COLLSEQ);
+		int p5 = filters[i].op;
+		if (filters[i].is_value_left)
+			p5 |= BATCH_FILTER_VALUE_LEFT;
+		sqlVdbeChangeP5(v, p5);
+	}
+	for (int i = 0; i < agg_info->nFunc; i++) {
+		struct AggInfo_func *agg_func = &agg_info->aFunc[i];
+		struct ExprList *args = agg_func->pExpr->x.pList;
+		int column = -1;
+		struct coll *coll = NULL;
+		if (args != NULL && args->nExpr > 0) {
+			struct Expr *arg = args->a[0].pExpr;
+			column = vdbe_emit_batch_column(v, cursor, arg->iColumn,
+							fieldnos,
+							&column_count);
+			bool unused;
+			uint32_t id;
+			if (sql_func_flag_is_set(agg_func->func,
+						 SQL_FUNC_NEEDCOLL) &&
+			    sql_expr_coll(parse, arg, &unused, &id,
+					  &coll) != 0) {
+				sql_xfree(fieldnos);
+				return;
+			}
+		}
+		struct sql_context *ctx = sql_context_new(agg_func->func, coll);
+		sqlVdbeAddOp3(v, OP_BatchAggStep, cursor, column,
+			      agg_func->iMem);
+		sqlVdbeAppendP4(v, ctx, P4_FUNCCTX);
+	}
+	sqlVdbeGoto(v, addr_loop);
+	sqlVdbeResolveLabel(v, label_done);
+	sqlVdbeAddOp1(v, OP_Close, cursor);
+	sqlVdbeChangeP2(v, addr_open, column_count);
+	sql_xfree(fieldnos);
+	finalizeAggFunctions(parse, agg_info);
+	explain_batch_aggregate(parse, space->def->name);
+}
+
 /**
  * Generate VDBE code that HALT program when subselect returned
  * more than one row (determined as LIMIT 1 overflow).
@@ -6332,6 +6794,10 @@ sqlSelect(Parse * pParse,		/* The parser context */
 		} /* endif pGroupBy.  Begin aggregate queries without GROUP BY: */
 		else {
 			struct space *space = is_simple_count(p, &sAggInfo);
+			struct index *column_index = space != NULL ? NULL :
+				is_column_aggregate(pParse, p, &sAggInfo);
+			struct batch_filter filters[BATCH_FILTER_MAX];
+			int filter_count;
 			if (space != NULL) {
 				/*
 				 * If is_simple_count() returns a pointer to
@@ -6365,6 +6831,20 @@ sqlSelect(Parse * pParse,		/* The parser context */
 						  sAggInfo.aFunc[0].iMem);
 				sqlVdbeAddOp1(v, OP_Close, cursor);
 				explain_simple_count(pParse, space->def->name);
+			} else if (column_index != NULL) {
+				vdbe_emit_column_aggregate(pParse, &sAggInfo,
+							   &p->pSrc->a[0],
+							   column_index);
+			} else if ((space = is_batch_aggregate(pParse, p,
+							       &sAggInfo,
+							       filters,
+							       &filter_count))
+				   != NULL) {
+				vdbe_emit_batch_aggregate(pParse, &sAggInfo,
+							  space, filters,
+							  filter_count);
+				if (pParse->is_aborted)
+					goto select_end;
 			} else
 			{
 				/* Check if the query is of one of the following forms:
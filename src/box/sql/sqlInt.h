@@ -317,6 +317,15 @@ int
 sql_stmt_compile(const char *sql, int bytes_count, struct Vdbe *re_prepared,
 		 struct Vdbe **stmt, const char **sql_tail);
 
+/**
+ * Compile the statement the same way sql_stmt_compile() does it, but
+ * choose the plan for the values bound to @a bound_stmt, a statement
+ * compiled from the same SQL text.
+ */
+int
+sql_stmt_compile_bound(const char *sql, int bytes_count,
+		       struct Vdbe *bound_stmt, struct Vdbe **stmt);
+
 /** This is the top-level implementation of sqlStep(). */
 int
 sql_step(struct Vdbe *v);
@@ -1226,6 +1235,79 @@ struct UnpackedRecord {
 int16_t
 index_field_tuple_est(const struct index_def *idx, uint32_t field);
 
+/**
+ * Estimate logarithm of tuples selected by given field the same way
+ * index_field_tuple_est() does it, using statistics collected by
+ * ANALYZE.
+ *
+ * @retval 0 Success, @a est is set.
+ * @retval -1 The index has not been analyzed.
+ */
+int
+sql_index_stat_tuple_est(const struct index_def *def, uint32_t field,
+			 int16_t *est);
+
+/**
+ * Estimate the number of index entries whose first key part is
+ * between @a lower and @a upper using statistics collected by
+ * ANALYZE. A NULL bound means that the range is not bounded from
+ * that side.
+ *
+ * @retval 0 Success, @a count is set.
+ * @retval -1 The index has not been analyzed or the bounds can not
+ *         be compared with the indexed values.
+ */
+int
+sql_index_stat_range_est(const struct index_def *def,
+			 const struct Mem *lower, bool is_lower_inclusive,
+			 const struct Mem *upper, bool is_upper_inclusive,
+			 uint64_t *count);
+
+/**
+ * Estimate the number of index entries whose first key part is equal
+ * to @a value using statistics collected by ANALYZE.
+ *
+ * @retval 0 Success, @a count is set.
+ * @retval -1 The index has not been analyzed or the value can not
+ *         be compared with the indexed values.
+ */
+int
+sql_index_stat_eq_est(const struct index_def *def, const struct Mem *value,
+		      uint64_t *count);
+
+/**
+ * Maximal number of plan probes of a statement. The selectivity of
+ * each one takes two bits of the plan class.
+ */
+enum { SQL_PLAN_PROBE_MAX = 16 };
+
+/**
+ * A constraint on the first column of an analyzed index whose bounds
+ * are parameters of the statement. The plan chosen for the statement
+ * depends on the number of rows the constraint selects, so it is
+ * re-estimated for the bound values, see sql_stmt_plan_class().
+ * An equality constraint has the same inclusive lower and upper bound.
+ */
+struct sql_plan_probe {
+	/** ID of the space of the index. */
+	uint32_t space_id;
+	/** ID of the index. */
+	uint32_t index_id;
+	/** Number of the lower bound parameter, 0 if unbounded. */
+	uint32_t lower;
+	/** Number of the upper bound parameter, 0 if unbounded. */
+	uint32_t upper;
+	/** True if the lower bound is inclusive. */
+	bool is_lower_inclusive;
+	/** True if the upper bound is inclusive. */
+	bool is_upper_inclusive;
+};
+
+/** Remember that the plan of the statement depends on @a probe. */
+void
+sql_vdbe_add_plan_probe(struct Vdbe *vdbe,
+			const struct sql_plan_probe *probe);
+
 #ifdef DEFAULT_TUPLE_COUNT
 #undef DEFAULT_TUPLE_COUNT
 #endif
@@ -1233,6 +1315,12 @@ index_field_tuple_est(const struct index_def *idx, uint32_t field);
 /** [10*log_{2}(1048576)] == 200 */
 #define DEFAULT_TUPLE_LOG_COUNT 200
 
+/**
+ * Memory limit of the hash table of a hash join, in bytes. A larger
+ * build side is stored in an ephemeral space instead.
+ */
+#define SQL_HASH_JOIN_MEMORY_MAX (64 * 1024 * 1024)
+
 /*
  * An instance of this structure contains information needed to generate
  * code for a SELECT that contains aggregate functions.
@@ -2041,6 +2129,12 @@ struct Parse {
 	int iNextSelectId;	/* Next available select ID for EXPLAIN output */
 	VList *pVList;		/* Mapping between variable names and numbers */
 	Vdbe *pReprepare;	/* VM being reprepared (sqlReprepare()) */
+	/**
+	 * Statement with values bound to the parameters, which are
+	 * used to estimate the selectivity of constraints. NULL if
+	 * the values are unknown.
+	 */
+	struct Vdbe *bound_stmt;
 	const char *zTail;	/* All SQL text past the last semicolon parsed */
 	TriggerPrg *pTriggerPrg;	/* Linked list of coded triggers */
 	With *pWith;		/* Current WITH clause, or NULL */
@@ -2681,6 +2775,27 @@ sql_emit_show_create_table_all(struct Parse *parse);
 void
 sql_show_create_table(uint32_t space_id, struct Mem *ret, struct Mem *err);
 
+/**
+ * Emit VDBE instructions for "ANALYZE;" and "ANALYZE table_name;"
+ * statements.
+ *
+ * @param parse Parsing context.
+ * @param name Name of the table or NULL to analyze all tables.
+ */
+void
+sql_analyze(struct Parse *parse, struct Token *name);
+
+/**
+ * Collect statistics of the indexes of the space with the given ID or
+ * of all user spaces if it is 0 and store them in _sql_stat.
+ */
+int
+sql_stat_analyze(uint32_t space_id);
+
+/** Initialize the cache of statistics decoded from _sql_stat. */
+void
+sql_index_stat_init(void);
+
 /**
  * Return true if given column is part of primary key.
  * If field number is less than 63, corresponding bit
@@ -4104,6 +4219,39 @@ sql_alter_table_rename(struct Parse *parse);
 int
 sql_token(const char *z, int *type, bool *is_reserved);
 
+struct sql_bind;
+
+/**
+ * Normalize a statement for the statement cache: replace literals
+ * which are operands of comparisons in WHERE, ON and HAVING clauses,
+ * values assigned by UPDATE and values of rows inserted by INSERT
+ * with parameters, so statements which differ only in these
+ * constants have the same text. Literals of the result set, LIMIT,
+ * ORDER BY and other clauses, which may affect the metadata or
+ * the plan of the statement, are kept. The statement is returned as
+ * is if it has named parameters.
+ *
+ * The normalized text and parameters are allocated on the fiber
+ * region.
+ *
+ * @param sql Text of the statement.
+ * @param len Length of @a sql.
+ * @param bind Parameters of the statement.
+ * @param bind_count Number of @a bind.
+ * @param[out] out_sql Normalized text.
+ * @param[out] out_len Length of @a out_sql.
+ * @param[out] out_bind Parameters of the normalized statement.
+ * @param[out] out_bind_count Number of @a out_bind.
+ *
+ * @retval 0 Success.
+ * @retval -1 The statement is not DML, refers to a collation or can
+ *         not be tokenized and should not be cached.
+ */
+int
+sql_normalize(const char *sql, uint32_t len, const struct sql_bind *bind,
+	      uint32_t bind_count, const char **out_sql, uint32_t *out_len,
+	      const struct sql_bind **out_bind, uint32_t *out_bind_count);
+
 /**
  * Mark every prepared statement as expired.
  *
@@ -8,6 +8,8 @@
 
 #include <stdint.h>
 
+struct tuple;
+
 /** Structure describing field dependencies for foreign keys. */
 struct field_link {
 	/**
@@ -62,6 +64,18 @@ int tarantoolsqlFirst(BtCursor * pCur, int *pRes);
 int tarantoolsqlLast(BtCursor * pCur, int *pRes);
 int tarantoolsqlNext(BtCursor * pCur, int *pRes);
 int tarantoolsqlPrevious(BtCursor * pCur, int *pRes);
+
+/**
+ * Move up to @a size tuples starting with the current one to
+ * @a tuples and advance the cursor past them. The tuples are
+ * referenced, the caller must unreference them. The number of
+ * fetched tuples is returned in @a count, zero means that the
+ * cursor is exhausted.
+ */
+int
+tarantoolsqlNextBatch(struct BtCursor *pCur, struct tuple **tuples,
+		      uint32_t size, uint32_t *count);
+
 int tarantoolsqlMovetoUnpacked(BtCursor * pCur, UnpackedRecord * pIdxKey,
 				   int *pRes);
 int64_t
@@ -41,6 +41,7 @@
 
 #include "box/session.h"
 #include "box/schema.h"
+#include "box/bind.h"
 #include "say.h"
 #include "sqlInt.h"
 #include "tarantoolInt.h"
@@ -664,3 +665,414 @@ sql_trigger_compile(const char *sql)
 	sql_parser_destroy(&parser);
 	return trigger;
 }
+
+/** Context of a literal, see sql_normalize(). */
+enum sql_literal_ctx {
+	/** The literal may not be replaced. */
+	SQL_LITERAL_OTHER,
+	/** FROM clause, where a subquery may be nested. */
+	SQL_LITERAL_FROM,
+	/** WHERE, ON or HAVING clause. */
+	SQL_LITERAL_FILTER,
+	/** SET clause of UPDATE. */
+	SQL_LITERAL_SET,
+	/** VALUES clause of INSERT. */
+	SQL_LITERAL_VALUES,
+	/** A row of VALUES clause of INSERT. */
+	SQL_LITERAL_ROW,
+};
+
+/** Maximal nesting of parentheses in a normalized statement. */
+enum { SQL_NORMALIZE_DEPTH_MAX = 32 };
+
+/** A significant token of a normalized statement. */
+struct sql_norm_token {
+	/** Type of the token. */
+	int type;
+	/** Offset of the token in the statement. */
+	uint32_t offset;
+	/** Length of the token. */
+	uint32_t len;
+};
+
+/** A literal which is replaced with a parameter. */
+struct sql_norm_literal {
+	/** Offset of the literal including its sign. */
+	uint32_t offset;
+	/** Length of the literal including its sign. */
+	uint32_t len;
+	/** Value of the literal. */
+	struct sql_bind bind;
+};
+
+static bool
+sql_token_is_cmp(int type)
+{
+	return type == TK_EQ || type == TK_NE || type == TK_LT ||
+	       type == TK_LE || type == TK_GT || type == TK_GE;
+}
+
+/**
+ * Check that a literal surrounded by @a prev and @a next tokens
+ * is a whole operand of a comparison, an assignment or a value of
+ * an inserted row, depending on the context.
+ */
+static bool
+sql_literal_is_operand(enum sql_literal_ctx ctx, int prev, int next)
+{
+	switch (ctx) {
+	case SQL_LITERAL_FILTER:
+		if (!sql_token_is_cmp(prev))
+			return false;
+		switch (next) {
+		case TK_AND:
+		case TK_OR:
+		case TK_RP:
+		case TK_SEMI:
+		case TK_GROUP:
+		case TK_ORDER:
+		case TK_LIMIT:
+		case TK_UNION:
+		case TK_EXCEPT:
+		case TK_INTERSECT:
+		case TK_JOIN:
+		case TK_JOIN_KW:
+		case TK_WHERE:
+		case TK_HAVING:
+			return true;
+		default:
+			return false;
+		}
+	case SQL_LITERAL_SET:
+		return prev == TK_EQ && (next == TK_COMMA ||
+					 next == TK_WHERE || next == TK_SEMI);
+	case SQL_LITERAL_ROW:
+		return (prev == TK_LP || prev == TK_COMMA) &&
+		       (next == TK_COMMA || next == TK_RP);
+	default:
+		return false;
+	}
+}
+
+/**
+ * Decode the value of a literal. The text of the literal is
+ * zero-terminated.
+ *
+ * @retval 0 Success.
+ * @retval -1 The literal is left as is: its value can not be
+ *         represented by a parameter or is invalid, so the error is
+ *         raised by the parser.
+ */
+static int
+sql_literal_decode(const char *z, uint32_t len, int type, bool is_neg,
+		   struct sql_bind *bind)
+{
+	struct region *region = &fiber()->gc;
+	bind->name = NULL;
+	bind->name_len = 0;
+	switch (type) {
+	case TK_INTEGER: {
+		if (z[0] == '0' && (z[1] == 'x' || z[1] == 'X'))
+			return -1;
+		int64_t value;
+		bool unused;
+		if (sql_atoi64(z, &value, &unused, len) != 0)
+			return -1;
+		if (!is_neg) {
+			bind->type = MP_UINT;
+			bind->u64 = value;
+			return 0;
+		}
+		if (value == 0 || (uint64_t)value > (uint64_t)INT64_MAX + 1)
+			return -1;
+		bind->type = MP_INT;
+		bind->i64 = (int64_t)(0 - (uint64_t)value);
+		return 0;
+	}
+	case TK_FLOAT: {
+		double value;
+		sqlAtoF(z, &value, len);
+		bind->type = MP_DOUBLE;
+		bind->d = is_neg ? -value : value;
+		return 0;
+	}
+	case TK_DECIMAL: {
+		decimal_t value;
+		if (decimal_from_string(&value, z) == NULL)
+			return -1;
+		bind->type = MP_EXT;
+		bind->ext_type = MP_DECIMAL;
+		if (is_neg)
+			decimal_minus(&bind->dec, &value);
+		else
+			bind->dec = value;
+		return 0;
+	}
+	case TK_STRING: {
+		assert(len >= 2 && z[0] == '\'' && z[len - 1] == '\'');
+		char *str = xregion_alloc(region, len);
+		uint32_t size = 0;
+		for (uint32_t i = 1; i < len - 1; i++) {
+			str[size++] = z[i];
+			if (z[i] == '\'')
+				i++;
+		}
+		bind->type = MP_STR;
+		bind->s = str;
+		bind->bytes = size;
+		return 0;
+	}
+	default:
+		unreachable();
+	}
+}
+
+int
+sql_normalize(const char *sql, uint32_t len, const struct sql_bind *bind,
+	      uint32_t bind_count, const char **out_sql, uint32_t *out_len,
+	      const struct sql_bind **out_bind, uint32_t *out_bind_count)
+{
+	struct region *region = &fiber()->gc;
+	char *z = xregion_alloc(region, len + 1);
+	memcpy(z, sql, len);
+	z[len] = '\0';
+	/* Split the statement into significant tokens. */
+	uint32_t token_count = 0;
+	uint32_t token_size = 32;
+	struct sql_norm_token *tokens =
+		xregion_alloc_array(region, typeof(*tokens), token_size);
+	for (uint32_t offset = 0; offset < len;) {
+		int type;
+		bool unused;
+		uint32_t token_len = sql_token(&z[offset], &type, &unused);
+		if (type == TK_ILLEGAL)
+			return -1;
+		if (type != TK_SPACE && type != TK_LINEFEED) {
+			if (token_count == token_size) {
+				struct sql_norm_token *new_tokens =
+					xregion_alloc_array(region,
+							    typeof(*tokens),
+							    2 * token_size);
+				memcpy(new_tokens, tokens,
+				       token_size * sizeof(*tokens));
+				tokens = new_tokens;
+				token_size *= 2;
+			}
+			tokens[token_count].type = type;
+			tokens[token_count].offset = offset;
+			tokens[token_count].len = token_len;
+			token_count++;
+		}
+		offset += token_len;
+	}
+	if (token_count == 0)
+		return -1;
+	int stmt_type = tokens[0].type;
+	switch (stmt_type) {
+	case TK_SELECT:
+	case TK_VALUES:
+	case TK_WITH:
+	case TK_INSERT:
+	case TK_REPLACE:
+	case TK_UPDATE:
+	case TK_DELETE:
+		break;
+	default:
+		return -1;
+	}
+	enum sql_literal_ctx ctx[SQL_NORMALIZE_DEPTH_MAX];
+	uint32_t depth = 0;
+	ctx[0] = SQL_LITERAL_OTHER;
+	/*
+	 * Number of parameters of the original statement. Literals
+	 * are replaced only if the parameters are anonymous and all of
+	 * them go before the replaced literals, so the parameters of
+	 * the normalized statement are the original ones followed by
+	 * the literals.
+	 */
+	uint32_t param_count = 0;
+	bool is_exact = false;
+	for (uint32_t i = 0; i < bind_count; i++) {
+		if (bind[i].name != NULL)
+			is_exact = true;
+	}
+	uint32_t literal_count = 0;
+	uint32_t literal_size = 0;
+	struct sql_norm_literal *literals = NULL;
+	for (uint32_t i = 0; i < token_count; i++) {
+		int type = tokens[i].type;
+		int prev = i > 0 ? tokens[i - 1].type : TK_SEMI;
+		switch (type) {
+		case TK_SELECT:
+		case TK_GROUP:
+		case TK_ORDER:
+		case TK_LIMIT:
+		case TK_UNION:
+		case TK_EXCEPT:
+		case TK_INTERSECT:
+		case TK_USING:
+			ctx[depth] = SQL_LITERAL_OTHER;
+			continue;
+		case TK_FROM:
+		case TK_JOIN:
+		case TK_JOIN_KW:
+			ctx[depth] = SQL_LITERAL_FROM;
+			continue;
+		case TK_WHERE:
+		case TK_ON:
+		case TK_HAVING:
+			ctx[depth] = SQL_LITERAL_FILTER;
+			continue;
+		case TK_SET:
+			if (depth == 0 && stmt_type == TK_UPDATE)
+				ctx[depth] = SQL_LITERAL_SET;
+			continue;
+		case TK_VALUES:
+			if (depth == 0 && (stmt_type == TK_INSERT ||
+					   stmt_type == TK_REPLACE))
+				ctx[depth] = SQL_LITERAL_VALUES;
+			continue;
+		case TK_LP: {
+			if (++depth == SQL_NORMALIZE_DEPTH_MAX)
+				return -1;
+			enum sql_literal_ctx parent = ctx[depth - 1];
+			ctx[depth] = SQL_LITERAL_OTHER;
+			if (parent == SQL_LITERAL_FILTER &&
+			    (sql_token_is_cmp(prev) || prev == TK_WHERE ||
+			     prev == TK_ON || prev == TK_HAVING ||
+			     prev == TK_AND || prev == TK_OR ||
+			     prev == TK_NOT || prev == TK_LP ||
+			     prev == TK_EXISTS))
+				ctx[depth] = SQL_LITERAL_FILTER;
+			else if (parent == SQL_LITERAL_VALUES &&
+				 (prev == TK_VALUES || prev == TK_COMMA))
+				ctx[depth] = SQL_LITERAL_ROW;
+			continue;
+		}
+		case TK_RP:
+			if (depth-- == 0)
+				return -1;
+			continue;
+		case TK_VARNUM:
+			param_count++;
+			if (literal_count > 0 ||
+			    sqlIsdigit(z[tokens[i].offset + 1]))
+				is_exact = true;
+			continue;
+		case TK_COLON:
+		case TK_VARIABLE:
+			is_exact = true;
+			continue;
+		case TK_COLLATE:
+			/*
+			 * A collation may be dropped without a change of
+			 * the schema version.
+			 */
+			return -1;
+		case TK_MINUS:
+		case TK_INTEGER:
+		case TK_FLOAT:
+		case TK_DECIMAL:
+		case TK_STRING:
+			break;
+		default:
+			continue;
+		}
+		if (is_exact)
+			continue;
+		/* Check that the literal is an operand. */
+		uint32_t last = i;
+		bool is_neg = false;
+		if (type == TK_MINUS) {
+			if (i + 1 == token_count)
+				continue;
+			type = tokens[i + 1].type;
+			if (type != TK_INTEGER && type != TK_FLOAT &&
+			    type != TK_DECIMAL)
+				continue;
+			is_neg = true;
+			last = i + 1;
+		}
+		int next = last + 1 < token_count ? tokens[last + 1].type :
+			   TK_SEMI;
+		if (!sql_literal_is_operand(ctx[depth], prev, next))
+			continue;
+		bool is_allowed = true;
+		for (uint32_t j = 0; j < depth && is_allowed; j++) {
+			is_allowed = ctx[j] == SQL_LITERAL_FROM ||
+				     ctx[j] == SQL_LITERAL_FILTER ||
+				     ctx[j] == SQL_LITERAL_VALUES;
+		}
+		if (!is_allowed)
+			continue;
+		if (literal_count == literal_size) {
+			literal_size = literal_size == 0 ? 16 :
+				       2 * literal_size;
+			struct sql_norm_literal *new_literals =
+				xregion_alloc_array(region, typeof(*literals),
+						    literal_size);
+			if (literal_count > 0) {
+				memcpy(new_literals, literals,
+				       literal_count * sizeof(*literals));
+			}
+			literals = new_literals;
+		}
+		struct sql_norm_literal *literal = &literals[literal_count];
+		const struct sql_norm_token *value = &tokens[last];
+		char saved = z[value->offset + value->len];
+		z[value->offset + value->len] = '\0';
+		int rc = sql_literal_decode(&z[value->offset], value->len,
+					    type, is_neg, &literal->bind);
+		z[value->offset + value->len] = saved;
+		if (rc != 0)
+			continue;
+		literal->offset = tokens[i].offset;
+		literal->len = value->offset + value->len - tokens[i].offset;
+		literal_count++;
+		i = last;
+	}
+	if (depth != 0)
+		return -1;
+	if (is_exact || bind_count > param_count || literal_count == 0) {
+		*out_sql = sql;
+		*out_len = len;
+		*out_bind = bind;
+		*out_bind_count = bind_count;
+		return 0;
+	}
+	/* Replace the literals with parameters. */
+	char *norm = xregion_alloc(region, len);
+	uint32_t norm_len = 0;
+	uint32_t offset = 0;
+	for (uint32_t i = 0; i < literal_count; i++) {
+		uint32_t size = literals[i].offset - offset;
+		memcpy(&norm[norm_len], &sql[offset], size);
+		norm_len += size;
+		norm[norm_len++] = '?';
+		offset = literals[i].offset + literals[i].len;
+	}
+	memcpy(&norm[norm_len], &sql[offset], len - offset);
+	norm_len += len - offset;
+	uint32_t norm_bind_count = param_count + literal_count;
+	struct sql_bind *norm_bind =
+		xregion_alloc_array(region, typeof(*norm_bind),
+				    norm_bind_count);
+	for (uint32_t i = 0; i < param_count; i++) {
+		if (i < bind_count) {
+			norm_bind[i] = bind[i];
+		} else {
+			norm_bind[i].name = NULL;
+			norm_bind[i].name_len = 0;
+			norm_bind[i].type = MP_NIL;
+		}
+	}
+	for (uint32_t i = 0; i < literal_count; i++)
+		norm_bind[param_count + i] = literals[i].bind;
+	for (uint32_t i = 0; i < norm_bind_count; i++)
+		norm_bind[i].pos = i + 1;
+	*out_sql = norm;
+	*out_len = norm_len;
+	*out_bind = norm_bind;
+	*out_bind_count = norm_bind_count;
+	return 0;
+}
@@ -41,6 +41,7 @@
  */
 #include "box/box.h"
 #include "box/error.h"
+#include "box/memtx_column.h"
 #include "box/txn.h"
 #include "box/tuple.h"
 #include "box/port.h"
@@ -1917,6 +1918,10 @@ case OP_Column: {
 			} else {
 				goto op_column_out;
 			}
+		} else if (pC->eCurType == CURTYPE_HASH) {
+			uint32_t size;
+			const char *data = sqlVdbeHashRowData(pC, &size);
+			vdbe_field_ref_prepare_data(&pC->field_ref, data, size);
 		} else {
 			pCrsr = pC->uc.pCursor;
 			assert(pC->eCurType==CURTYPE_TARANTOOL);
@@ -1930,7 +1935,8 @@ case OP_Column: {
 		pC->cacheStatus = p->cacheCtr;
 	}
 	assert(pC->eCurType == CURTYPE_TARANTOOL ||
-	       pC->eCurType == CURTYPE_PSEUDO);
+	       pC->eCurType == CURTYPE_PSEUDO ||
+	       pC->eCurType == CURTYPE_HASH);
 	struct Mem *default_val_mem =
 		pOp->p4type == P4_MEM ? pOp->p4.pMem : NULL;
 	if (vdbe_field_ref_fetch(&pC->field_ref, p2, pDest) != 0)
@@ -1947,6 +1953,8 @@ case OP_Column: {
 	/* Currently PSEUDO cursor does not have info about field types. */
 	if (pC->eCurType == CURTYPE_TARANTOOL)
 		field_type = pC->uc.pCursor->space->def->fields[p2].type;
+	else if (pC->eCurType == CURTYPE_HASH)
+		field_type = sqlVdbeHashFieldType(pC, p2);
 	if (field_type == FIELD_TYPE_ANY)
 		pDest->flags |= MEM_Any;
 	else if (field_type == FIELD_TYPE_SCALAR)
@@ -2139,6 +2147,50 @@ case OP_Count: {         /* out2 */
 	break;
 }
 
+/* Opcode: ColumnAggregate P1 P2 P3 P4 P5
+ * Synopsis: r[P3]=agg(P5) of part P4
+ *
+ * Compute aggregate function P5, see enum memtx_column_agg, over
+ * key part P4 of COLUMN index P2 of space P1 and store the result
+ * in register P3. The result of SUM, MIN and MAX of no values is
+ * NULL.
+ */
+case OP_ColumnAggregate: {         /* out3 */
+	assert(pOp->p4type == P4_INT32);
+	assert(pOp->p5 < memtx_column_agg_MAX);
+	char conds[8];
+	mp_encode_array(conds, 0);
+	struct memtx_column_result result;
+	if (box_index_aggregate(pOp->p1, pOp->p2, pOp->p5, pOp->p4.i, conds,
+				&result) != 0) {
+		struct error *e = diag_last_error(diag_get());
+		/* Report an overflow the same way OP_AggStep does. */
+		if (box_error_code(e) == ER_INTEGER_OVERFLOW) {
+			diag_set(ClientError, ER_SQL_EXECUTE,
+				 "integer is overflowed");
+		}
+		goto abort_due_to_error;
+	}
+	pOut = vdbe_prepare_null_out(p, pOp->p3);
+	if (result.is_null ||
+	    (result.count == 0 && pOp->p5 != MEMTX_COLUMN_AGG_COUNT))
+		break;
+	switch (result.type) {
+	case FIELD_TYPE_UNSIGNED:
+		mem_set_uint(pOut, result.value.u);
+		break;
+	case FIELD_TYPE_INTEGER:
+		mem_set_int(pOut, result.value.i, result.value.i < 0);
+		break;
+	case FIELD_TYPE_DOUBLE:
+		mem_set_double(pOut, result.value.d);
+		break;
+	default:
+		unreachable();
+	}
+	break;
+}
+
 /**
  * Opcode: CreateForeignKey P1 * * P4 *
  *
@@ -2583,6 +2635,131 @@ case OP_OpenPseudo: {
 	break;
 }
 
+/* Opcode: HashOpen P1 P2 * P4 *
+ * Synopsis: key=P2 fields
+ *
+ * Open cursor P1 on a new empty hash table of a hash join. P4 is
+ * a description of the fields of records stored in the table, the
+ * first P2 of them form the join key.
+ *
+ * The table is filled with HashInsert and searched with HashSeek and
+ * HashNext.  The OP_Column opcode works on the record the cursor
+ * points to.
+ */
+case OP_HashOpen: {
+	assert(pOp->p1 >= 0);
+	assert(pOp->p2 > 0);
+	assert(pOp->p4type == P4_DYNAMIC);
+	struct sql_space_info *info = pOp->p4.space_info;
+	assert(info != NULL);
+	struct VdbeCursor *cur = allocateCursor(p, pOp->p1, info->field_count,
+						CURTYPE_HASH);
+	if (cur == NULL)
+		goto abort_due_to_error;
+	cur->nullRow = 1;
+	cur->uc.pHash = NULL;
+	cur->key_def = NULL;
+	if (sqlVdbeHashInit(cur, info, pOp->p2) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
+/* Opcode: BatchOpen P1 P2 * * *
+ *
+ * Attach a batch with P2 column vectors to the table cursor P1. The
+ * cursor must be positioned with OP_Rewind and then read with
+ * OP_BatchNext.
+ */
+case OP_BatchOpen: {
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->eCurType == CURTYPE_TARANTOOL);
+	sqlVdbeBatchOpen(cur, pOp->p2);
+	break;
+}
+
+/* Opcode: BatchNext P1 P2 * * *
+ *
+ * Replace the batch of cursor P1 with the next rows of the cursor and
+ * select all of them. If there are no more rows, jump to P2.
+ */
+case OP_BatchNext: {       /* jump */
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->pBatch != NULL);
+	uint32_t size;
+	if (sqlVdbeBatchNext(cur, &size) != 0)
+		goto abort_due_to_error;
+	if (size == 0)
+		goto jump_to_p2;
+#ifdef SQL_TEST
+	/* Count the successful cursor moves as OP_Next does. */
+	sql_search_count += size;
+	if (!sqlCursorIsValidNN(cur->uc.pCursor))
+		sql_search_count--;
+#endif
+	break;
+}
+
+/* Opcode: BatchColumn P1 P2 P3 * *
+ * Synopsis: vec[P3]=field(P2)
+ *
+ * Decode field P2 of the selected rows of the batch of cursor P1 to
+ * column vector P3.
+ */
+case OP_BatchColumn: {
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->pBatch != NULL);
+	if (sqlVdbeBatchColumn(cur, pOp->p2, pOp->p3) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
+/* Opcode: BatchFilter P1 P2 P3 P4 P5
+ * Synopsis: select where vec[P2] cmp r[P3]
+ *
+ * Deselect the rows of the batch of cursor P1 for which the comparison
+ * of column vector P2 with register P3 is not true. The low byte of P5
+ * is the opcode of the comparison, one of OP_Eq, OP_Ne, OP_Lt, OP_Le,
+ * OP_Gt and OP_Ge. If BATCH_FILTER_VALUE_LEFT is set in P5, register P3
+ * is the left operand. P4 is the collation used to compare strings.
+ */
+case OP_BatchFilter: {
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	assert(pOp->p4type == P4_COLLSEQ);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->pBatch != NULL);
+	pIn3 = &aMem[pOp->p3];
+	bool is_value_left = (pOp->p5 & BATCH_FILTER_VALUE_LEFT) != 0;
+	if (sqlVdbeBatchFilter(cur, pOp->p2, pOp->p5 & 0xff, pIn3,
+			       is_value_left, pOp->p4.pColl) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
+/* Opcode: BatchAggStep P1 P2 P3 P4 *
+ * Synopsis: accum=r[P3] step(vec[P2])
+ *
+ * Execute the step function of an aggregate for every selected row of
+ * the batch of cursor P1. The argument is taken from column vector P2,
+ * the function has no arguments if P2 is negative. P4 is a pointer to
+ * an sql_context object that is used to run the function. Register P3
+ * is the accumulator.
+ */
+case OP_BatchAggStep: {
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	assert(pOp->p4type == P4_FUNCCTX);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->pBatch != NULL);
+	struct sql_context *ctx = pOp->p4.pCtx;
+	ctx->pOut = &aMem[pOp->p3];
+	ctx->skipFlag = 0;
+	if (sqlVdbeBatchAggStep(cur, pOp->p2, ctx) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
 /* Opcode: Close P1 * * * *
  *
  * Close a cursor previously opened as P1.  If P1 is not
@@ -2790,6 +2967,53 @@ case OP_SeekGE: {       /* jump, in3 */
 	break;
 }
 
+/* Opcode: HashSeek P1 P2 P3 P4 *
+ * Synopsis: key=r[P3@P4]
+ *
+ * P3 is the first of P4 registers that form a key. Position hash
+ * cursor P1 at the first record with an equal key. If there is no
+ * such record or the key contains NULL, jump to P2.
+ *
+ * Other records with the same key are visited with HashNext.
+ */
+case OP_HashSeek: {       /* jump, in3 */
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->eCurType == CURTYPE_HASH);
+	assert(pOp->p4type == P4_INT32);
+	uint32_t len = pOp->p4.i;
+	assert(len == cur->key_def->part_count);
+	cur->nullRow = 1;
+	cur->cacheStatus = CACHE_STALE;
+	struct Mem *mems = &aMem[pOp->p3];
+	for (uint32_t i = 0; i < len; ++i) {
+		enum field_type type = cur->key_def->parts[i].type;
+		struct Mem *mem = &mems[i];
+		if (mem_is_null(mem))
+			goto jump_to_p2;
+		if (mem_is_field_compatible(mem, type))
+			continue;
+		if (!sql_type_is_numeric(type) || !mem_is_num(mem)) {
+			diag_set(ClientError, ER_SQL_TYPE_MISMATCH,
+				 mem_str(mem), field_type_strs[type]);
+			goto abort_due_to_error;
+		}
+		/* Nothing is equal to a value that can't be cast precisely. */
+		if (mem_cast_implicit_number(mem, type) != 0)
+			goto jump_to_p2;
+	}
+	int res;
+	if (sqlVdbeHashSeek(cur, mems, len, &res) != 0)
+		goto abort_due_to_error;
+#ifdef SQL_TEST
+	sql_search_count++;
+#endif
+	assert(pOp->p2 > 0);
+	if (res != 0)
+		goto jump_to_p2;
+	cur->nullRow = 0;
+	break;
+}
+
 /* Opcode: Found P1 P2 P3 P4 *
  * Synopsis: key=r[P3@P4]
  *
@@ -3449,6 +3673,12 @@ case OP_Rewind: {        /* jump */
  * invoked.  This opcode advances the cursor to the next sorted
  * record, or jumps to P2 if there are no more sorted records.
  */
+/* Opcode: HashNext P1 P2 * * *
+ *
+ * Advance hash cursor P1 to the next record with the key used by the
+ * last HashSeek and jump to P2.  If there are no more such records,
+ * fall through to the following instruction.
+ */
 case OP_SorterNext: {  /* jump */
 	VdbeCursor *pC;
 	int res;
@@ -3459,6 +3689,12 @@ case OP_SorterNext: {  /* jump */
 	if (sqlVdbeSorterNext(pC, &res) != 0)
 		goto abort_due_to_error;
 	goto next_tail;
+case OP_HashNext:      /* jump */
+	pC = p->apCsr[pOp->p1];
+	assert(pC->eCurType == CURTYPE_HASH);
+	if (sqlVdbeHashNext(pC, &res) != 0)
+		goto abort_due_to_error;
+	goto next_tail;
 case OP_PrevIfOpen:    /* jump */
 case OP_NextIfOpen:    /* jump */
 	if (p->apCsr[pOp->p1]==0) break;
@@ -3521,6 +3757,24 @@ case OP_SorterInsert: {      /* in2 */
 	break;
 }
 
+/* Opcode: HashInsert P1 P2 * * *
+ * Synopsis: key=r[P2]
+ *
+ * Register P2 holds a record made using the MakeRecord instruction.
+ * This opcode inserts the record into the hash table of cursor P1.
+ */
+case OP_HashInsert: {      /* in2 */
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cursor = p->apCsr[pOp->p1];
+	assert(cursor != NULL);
+	assert(cursor->eCurType == CURTYPE_HASH);
+	pIn2 = &aMem[pOp->p2];
+	assert(mem_is_bin(pIn2));
+	if (sqlVdbeHashInsert(cursor, pIn2) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
 /* Opcode: IdxInsert P1 P2 P3 * P5
  * Synopsis: key=r[P1]
  *
@@ -3977,19 +4231,14 @@ case OP_RenameTable: {
 	break;
 }
 
-/* Opcode: LoadAnalysis P1 * * * *
+/* Opcode: Analyze P1 * * * *
  *
- * Read the sql_stat1 table for database P1 and load the content
- * of that table into the internal index hash table.  This will cause
- * the analysis to be used when preparing all subsequent queries.
+ * Collect statistics of the indexes of space P1, or of all user
+ * spaces if P1 is 0, and store them in _sql_stat.
  */
-case OP_LoadAnalysis: {
-	assert(pOp->p1==0 );
-	/* TODO: Enable analysis. */
-	/*
-	if (sql_analysis_load(db) != 0)
+case OP_Analyze: {
+	if (sql_stat_analyze(pOp->p1) != 0)
 		goto abort_due_to_error;
-	*/
 	break;
 }
 
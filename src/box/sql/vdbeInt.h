@@ -56,10 +56,17 @@ typedef unsigned Bool;
 /* Opaque type used by code in vdbesort.c */
 typedef struct VdbeSorter VdbeSorter;
 
+/* Opaque type used by code in vdbehash.c */
+typedef struct VdbeHash VdbeHash;
+
+/* Opaque type used by code in vdbebatch.c */
+typedef struct VdbeBatch VdbeBatch;
+
 /* Types of VDBE cursors */
 #define CURTYPE_TARANTOOL   0
 #define CURTYPE_SORTER      1
 #define CURTYPE_PSEUDO      2
+#define CURTYPE_HASH        3
 
 /*
  * A VdbeCursor is an superclass (a wrapper) for various cursor objects:
@@ -68,6 +75,7 @@ typedef struct VdbeSorter VdbeSorter;
  *          -  On either an ephemeral or ordinary space
  *      * A sorter
  *      * A one-row "pseudotable" stored in a single register
+ *      * A hash table of a hash join
  */
 typedef struct VdbeCursor VdbeCursor;
 struct VdbeCursor {
@@ -90,6 +98,8 @@ struct VdbeCursor {
 	/* NB: seekResult does not distinguish between "no seeks have ever occurred
 	 * on this cursor" and "the most recent seek was an exact match".
 	 */
+	/** Batch of rows of a CURTYPE_TARANTOOL cursor or NULL. */
+	VdbeBatch *pBatch;
 
 	/* When a new VdbeCursor is allocated, only the fields above are zeroed.
 	 * The fields that follow are uninitialized, and must be individually
@@ -99,6 +109,7 @@ struct VdbeCursor {
 		BtCursor *pCursor;	/* CURTYPE_TARANTOOL */
 		int pseudoTableReg;	/* CURTYPE_PSEUDO. Reg holding content. */
 		VdbeSorter *pSorter;	/* CURTYPE_SORTER. Sorter object */
+		VdbeHash *pHash;	/* CURTYPE_HASH. Hash table object */
 	} uc;
 	/** Info about keys needed by index cursors. */
 	struct key_def *key_def;
@@ -279,6 +290,13 @@ struct Vdbe {
 	 * Result set consists of two binding variables.
 	 */
 	uint32_t res_var_count;
+	/**
+	 * Constraints with parameters the plan of the statement
+	 * depends on, see sql_stmt_plan_class().
+	 */
+	struct sql_plan_probe *plan_probes;
+	/** Number of the @a plan_probes. */
+	uint32_t plan_probe_count;
 	VList *pVList;		/* Name of variables */
 	i64 startTime;		/* Time when query started - used for profiling */
 	int nOp;		/* Number of instructions in the program */
@@ -378,6 +396,104 @@ int sqlVdbeSorterRewind(const VdbeCursor *, int *);
 int sqlVdbeSorterWrite(const VdbeCursor *, Mem *);
 int sqlVdbeSorterCompare(const VdbeCursor *, Mem *, int, int *);
 
+/**
+ * Create an empty hash table for a hash cursor. Records stored in the
+ * table have fields described by @a info, the first @a part_count of
+ * them form the key. The key definition is stored in the cursor.
+ */
+int
+sqlVdbeHashInit(struct VdbeCursor *cur, const struct sql_space_info *info,
+		uint32_t part_count);
+
+/** Free the hash table and the key definition of a hash cursor. */
+void
+sqlVdbeHashClose(struct VdbeCursor *cur);
+
+/**
+ * Insert a record made by OP_MakeRecord into the hash table. Records
+ * with NULL in a key field are skipped since they never match. If the
+ * table exceeds SQL_HASH_JOIN_MEMORY_MAX, its records are moved to an
+ * ephemeral space.
+ */
+int
+sqlVdbeHashInsert(const struct VdbeCursor *cur, const struct Mem *record);
+
+/**
+ * Position the cursor at the first record with the key given by @a count
+ * MEMs. @a res is set to 0 if a record is found and to 1 otherwise.
+ */
+int
+sqlVdbeHashSeek(struct VdbeCursor *cur, const struct Mem *mems,
+		uint32_t count, int *res);
+
+/**
+ * Advance the cursor to the next record with the key of the last seek.
+ * @a res is set to 1 if there are no more such records.
+ */
+int
+sqlVdbeHashNext(struct VdbeCursor *cur, int *res);
+
+/** Return the record the hash cursor points to. */
+const char *
+sqlVdbeHashRowData(const struct VdbeCursor *cur, uint32_t *size);
+
+/** Return the type of a field of the hash table records. */
+enum field_type
+sqlVdbeHashFieldType(const struct VdbeCursor *cur, uint32_t fieldno);
+
+/**
+ * Attach a batch with @a column_count column vectors to a table
+ * cursor. The cursor is read by OP_BatchNext after that.
+ */
+void
+sqlVdbeBatchOpen(struct VdbeCursor *cur, uint32_t column_count);
+
+/** Release the tuples and the column vectors of a cursor batch. */
+void
+sqlVdbeBatchClose(struct VdbeCursor *cur);
+
+/**
+ * Replace the batch with the next rows of the cursor and select
+ * all of them. The number of the rows is returned in @a size, it
+ * is 0 if the cursor is exhausted.
+ */
+int
+sqlVdbeBatchNext(struct VdbeCursor *cur, uint32_t *size);
+
+/**
+ * Decode field @a fieldno of the selected rows of the batch to
+ * the column vector @a column.
+ */
+int
+sqlVdbeBatchColumn(struct VdbeCursor *cur, uint32_t fieldno,
+		   uint32_t column);
+
+/**
+ * OP_BatchFilter flag: the constant is the left operand of the
+ * comparison.
+ */
+#define BATCH_FILTER_VALUE_LEFT 0x100
+
+/**
+ * Deselect rows for which comparison @a op (one of OP_Eq, OP_Ne,
+ * OP_Lt, OP_Le, OP_Gt, OP_Ge) of the column vector @a column with
+ * @a value is not true. The column is the left operand unless
+ * @a is_value_left is set.
+ */
+int
+sqlVdbeBatchFilter(struct VdbeCursor *cur, uint32_t column, int op,
+		   const struct Mem *value, bool is_value_left,
+		   const struct coll *coll);
+
+/**
+ * Execute the step function of an aggregate for every selected
+ * row of the batch. The argument is taken from the column vector
+ * @a column, or there is no argument if @a column is negative.
+ */
+int
+sqlVdbeBatchAggStep(struct VdbeCursor *cur, int column,
+		    struct sql_context *ctx);
+
 int sqlVdbeMemTranslate(Mem *, u8);
 #ifdef SQL_DEBUG
 void sqlVdbePrintSql(Vdbe *);
@@ -37,7 +37,10 @@
 #include "sqlInt.h"
 #include "mem.h"
 #include "vdbeInt.h"
+#include "box/index.h"
+#include "box/schema.h"
 #include "box/session.h"
+#include "box/space.h"
 
 /*
  * Invoke the profile callback.  This routine is only called if we already
@@ -254,6 +257,8 @@ sql_stmt_est_size(const struct Vdbe *v)
 	size += sizeof(uint32_t) * v->res_var_count;
 	/* Cursors */
 	size += sizeof(struct VdbeCursor *) * v->nCursor;
+	/* Plan probes */
+	size += sizeof(struct sql_plan_probe) * v->plan_probe_count;
 
 	for (int i = 0; i < v->nOp; ++i) {
 		/* Estimate size of p4 operand. */
@@ -570,6 +575,77 @@ sql_stmt_busy(const struct Vdbe *v)
 	return v->magic == VDBE_MAGIC_RUN && v->pc >= 0;
 }
 
+/**
+ * Return the selectivity class of a plan probe for the bound
+ * parameter values: 0 if less than 1% of the index entries satisfy
+ * the constraint, 1 if less than 10%, 2 if less than a half and 3
+ * otherwise or if the selectivity is unknown.
+ */
+static uint32_t
+vdbe_plan_probe_class(const struct Vdbe *v, const struct sql_plan_probe *probe)
+{
+	struct space *space = space_by_id(probe->space_id);
+	if (space == NULL)
+		return 3;
+	struct index *index = space_index(space, probe->index_id);
+	if (index == NULL)
+		return 3;
+	const struct Mem *lower = NULL;
+	const struct Mem *upper = NULL;
+	if (probe->lower != 0) {
+		if (probe->lower > (uint32_t)v->nVar)
+			return 3;
+		lower = &v->aVar[probe->lower - 1];
+	}
+	if (probe->upper != 0) {
+		if (probe->upper > (uint32_t)v->nVar)
+			return 3;
+		upper = &v->aVar[probe->upper - 1];
+	}
+	/* Nothing is compared equal to NULL. */
+	if ((lower != NULL && mem_is_null(lower)) ||
+	    (upper != NULL && mem_is_null(upper)))
+		return 0;
+	uint64_t total, count;
+	if (sql_index_stat_range_est(index->def, NULL, false, NULL, false,
+				     &total) != 0 || total == 0)
+		return 3;
+	int rc;
+	if (probe->lower != 0 && probe->lower == probe->upper) {
+		rc = sql_index_stat_eq_est(index->def, lower, &count);
+	} else {
+		rc = sql_index_stat_range_est(index->def,
+					      lower, probe->is_lower_inclusive,
+					      upper, probe->is_upper_inclusive,
+					      &count);
+	}
+	if (rc != 0)
+		return 3;
+	if (count * 100 < total)
+		return 0;
+	if (count * 10 < total)
+		return 1;
+	if (count * 2 < total)
+		return 2;
+	return 3;
+}
+
+bool
+sql_stmt_plan_class(const struct Vdbe *v, uint32_t *plan_class)
+{
+	if (v->plan_probe_count == 0)
+		return false;
+	static_assert(SQL_PLAN_PROBE_MAX * 2 <= sizeof(*plan_class) * 8,
+		      "plan class must fit the classes of all probes");
+	uint32_t result = 0;
+	for (uint32_t i = 0; i < v->plan_probe_count; i++) {
+		result = result << 2 |
+			 vdbe_plan_probe_class(v, &v->plan_probes[i]);
+	}
+	*plan_class = result;
+	return true;
+}
+
 const char *
 sql_sql(struct Vdbe *p)
 {
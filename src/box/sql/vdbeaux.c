@@ -1477,8 +1477,12 @@ sqlVdbeFreeCursor(struct VdbeCursor *pCx)
 			sqlVdbeSorterClose(pCx);
 			break;
 		}
+	case CURTYPE_HASH:
+		sqlVdbeHashClose(pCx);
+		break;
 	case CURTYPE_TARANTOOL:{
 		assert(pCx->uc.pCursor != 0);
+		sqlVdbeBatchClose(pCx);
 		sql_cursor_close(pCx->uc.pCursor);
 			break;
 		}
@@ -1985,6 +1989,7 @@ sqlVdbeClearObject(struct Vdbe *p)
 		sql_xfree(p->pFree);
 	}
 	vdbeFreeOpArray(p->aOp, p->nOp);
+	sql_xfree(p->plan_probes);
 	sql_xfree(p->zSql);
 }
 
@@ -2069,6 +2074,25 @@ vdbe_get_bound_value(struct Vdbe *vdbe, int id)
 	return &vdbe->aVar[id];
 }
 
+void
+sql_vdbe_add_plan_probe(struct Vdbe *vdbe, const struct sql_plan_probe *probe)
+{
+	for (uint32_t i = 0; i < vdbe->plan_probe_count; i++) {
+		const struct sql_plan_probe *p = &vdbe->plan_probes[i];
+		if (p->space_id == probe->space_id &&
+		    p->index_id == probe->index_id &&
+		    p->lower == probe->lower && p->upper == probe->upper &&
+		    p->is_lower_inclusive == probe->is_lower_inclusive &&
+		    p->is_upper_inclusive == probe->is_upper_inclusive)
+			return;
+	}
+	if (vdbe->plan_probe_count == SQL_PLAN_PROBE_MAX)
+		return;
+	size_t size = (vdbe->plan_probe_count + 1) * sizeof(*probe);
+	vdbe->plan_probes = sql_xrealloc(vdbe->plan_probes, size);
+	vdbe->plan_probes[vdbe->plan_probe_count++] = *probe;
+}
+
 void
 sqlVdbeRecordUnpackMsgpack(struct key_def *key_def,	/* Information about the record format */
 			       const void *pKey,	/* The binary record */
@@ -0,0 +1,234 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/*
+ * This file contains code for the VdbeBatch object, used to scan a table
+ * cursor a batch of rows at a time.
+ *
+ * A batch holds up to VDBE_BATCH_SIZE tuples fetched from the cursor and
+ * a selection vector, the positions of the rows which passed all filters
+ * so far. Fields of the selected rows are decoded to column vectors of
+ * MEMs by OP_BatchColumn. OP_BatchFilter and OP_BatchAggStep then loop
+ * over a column vector instead of dispatching a sequence of opcodes for
+ * each row, and a field is only decoded for the rows that are still
+ * selected when it is first needed.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+#include "vdbeInt.h"
+#include "tarantoolInt.h"
+
+#include "box/error.h"
+#include "box/space.h"
+#include "box/tuple.h"
+
+/** Maximum number of rows in a batch. */
+enum { VDBE_BATCH_SIZE = 256 };
+
+struct VdbeBatch {
+	/** Referenced tuples of the batch. */
+	struct tuple *tuples[VDBE_BATCH_SIZE];
+	/** Number of tuples in the batch. */
+	uint32_t size;
+	/** Positions of the selected rows in ascending order. */
+	uint16_t selection[VDBE_BATCH_SIZE];
+	/** Number of the selected rows. */
+	uint32_t selected;
+	/** Number of column vectors. */
+	uint32_t column_count;
+	/**
+	 * Column vectors, VDBE_BATCH_SIZE MEMs each. Only MEMs of
+	 * the selected rows are valid.
+	 */
+	struct Mem columns[0];
+};
+
+/** Unreference the tuples of the batch. */
+static void
+vdbe_batch_release(struct VdbeBatch *batch)
+{
+	for (uint32_t i = 0; i < batch->size; i++)
+		tuple_unref(batch->tuples[i]);
+	batch->size = 0;
+	batch->selected = 0;
+}
+
+void
+sqlVdbeBatchOpen(struct VdbeCursor *cur, uint32_t column_count)
+{
+	assert(cur->eCurType == CURTYPE_TARANTOOL);
+	assert(cur->pBatch == NULL);
+	uint32_t mem_count = column_count * VDBE_BATCH_SIZE;
+	struct VdbeBatch *batch =
+		sql_xmalloc(sizeof(*batch) + mem_count * sizeof(struct Mem));
+	batch->size = 0;
+	batch->selected = 0;
+	batch->column_count = column_count;
+	for (uint32_t i = 0; i < mem_count; i++)
+		mem_create(&batch->columns[i]);
+	cur->pBatch = batch;
+}
+
+void
+sqlVdbeBatchClose(struct VdbeCursor *cur)
+{
+	struct VdbeBatch *batch = cur->pBatch;
+	if (batch == NULL)
+		return;
+	vdbe_batch_release(batch);
+	uint32_t mem_count = batch->column_count * VDBE_BATCH_SIZE;
+	for (uint32_t i = 0; i < mem_count; i++)
+		mem_destroy(&batch->columns[i]);
+	sql_xfree(batch);
+	cur->pBatch = NULL;
+}
+
+int
+sqlVdbeBatchNext(struct VdbeCursor *cur, uint32_t *size)
+{
+	assert(cur->eCurType == CURTYPE_TARANTOOL);
+	struct VdbeBatch *batch = cur->pBatch;
+	assert(batch != NULL);
+	vdbe_batch_release(batch);
+	if (tarantoolsqlNextBatch(cur->uc.pCursor, batch->tuples,
+				  VDBE_BATCH_SIZE, &batch->size) != 0)
+		return -1;
+	for (uint32_t i = 0; i < batch->size; i++)
+		batch->selection[i] = i;
+	batch->selected = batch->size;
+	*size = batch->size;
+	return 0;
+}
+
+int
+sqlVdbeBatchColumn(struct VdbeCursor *cur, uint32_t fieldno,
+		   uint32_t column)
+{
+	struct VdbeBatch *batch = cur->pBatch;
+	assert(batch != NULL && column < batch->column_count);
+	struct space_def *def = cur->uc.pCursor->space->def;
+	assert(fieldno < def->field_count);
+	/* Metatype flags are set the same way OP_Column does it. */
+	uint32_t flags = 0;
+	switch (def->fields[fieldno].type) {
+	case FIELD_TYPE_ANY:
+		flags = MEM_Any;
+		break;
+	case FIELD_TYPE_SCALAR:
+		flags = MEM_Scalar;
+		break;
+	case FIELD_TYPE_NUMBER:
+		flags = MEM_Number;
+		break;
+	default:
+		break;
+	}
+	struct Mem *values = &batch->columns[column * VDBE_BATCH_SIZE];
+	for (uint32_t i = 0; i < batch->selected; i++) {
+		uint32_t row = batch->selection[i];
+		struct Mem *mem = &values[row];
+		mem_destroy(mem);
+		const char *field = tuple_field(batch->tuples[row], fieldno);
+		if (field == NULL)
+			continue;
+		uint32_t unused;
+		if (mem_from_mp_ephemeral(mem, field, &unused) != 0)
+			return -1;
+		if (!mem_is_null(mem))
+			mem->flags |= flags;
+	}
+	return 0;
+}
+
+int
+sqlVdbeBatchFilter(struct VdbeCursor *cur, uint32_t column, int op,
+		   const struct Mem *value, bool is_value_left,
+		   const struct coll *coll)
+{
+	struct VdbeBatch *batch = cur->pBatch;
+	assert(batch != NULL && column < batch->column_count);
+	if (mem_is_null(value)) {
+		batch->selected = 0;
+		return 0;
+	}
+	const struct Mem *values = &batch->columns[column * VDBE_BATCH_SIZE];
+	uint32_t selected = 0;
+	for (uint32_t i = 0; i < batch->selected; i++) {
+		uint32_t row = batch->selection[i];
+		if (mem_is_null(&values[row]))
+			continue;
+		const struct Mem *left = &values[row];
+		const struct Mem *right = value;
+		if (is_value_left)
+			SWAP(left, right);
+		int cmp;
+		if (mem_cmp(left, right, &cmp, coll) != 0)
+			return -1;
+		bool is_true;
+		switch (op) {
+		case OP_Eq:
+			is_true = cmp == 0;
+			break;
+		case OP_Ne:
+			is_true = cmp != 0;
+			break;
+		case OP_Lt:
+			is_true = cmp < 0;
+			break;
+		case OP_Le:
+			is_true = cmp <= 0;
+			break;
+		case OP_Gt:
+			is_true = cmp > 0;
+			break;
+		case OP_Ge:
+			is_true = cmp >= 0;
+			break;
+		default:
+			unreachable();
+		}
+		if (is_true)
+			batch->selection[selected++] = row;
+	}
+	batch->selected = selected;
+	return 0;
+}
+
+int
+sqlVdbeBatchAggStep(struct VdbeCursor *cur, int column,
+		    struct sql_context *ctx)
+{
+	struct VdbeBatch *batch = cur->pBatch;
+	assert(batch != NULL);
+	assert(ctx->func->def->language == FUNC_LANGUAGE_SQL_BUILTIN);
+	struct func_sql_builtin *func = (struct func_sql_builtin *)ctx->func;
+	if (column < 0) {
+		for (uint32_t i = 0; i < batch->selected; i++) {
+			func->call(ctx, 0, NULL);
+			if (ctx->is_aborted)
+				return -1;
+		}
+		return 0;
+	}
+	assert((uint32_t)column < batch->column_count);
+	const struct Mem *values = &batch->columns[column * VDBE_BATCH_SIZE];
+	/* The argument type is checked the same way OP_ApplyType does it. */
+	enum field_type type = func->param_list[0];
+	struct Mem arg;
+	mem_create(&arg);
+	for (uint32_t i = 0; i < batch->selected; i++) {
+		mem_copy_as_ephemeral(&arg, &values[batch->selection[i]]);
+		if (mem_cast_implicit(&arg, type) != 0) {
+			diag_set(ClientError, ER_SQL_TYPE_MISMATCH,
+				 mem_str(&arg), field_type_strs[type]);
+			return -1;
+		}
+		func->call(ctx, 1, &arg);
+		if (ctx->is_aborted)
+			return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,513 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/*
+ * This file contains code for the VdbeHash object, used in concert with
+ * a VdbeCursor to implement the build and probe sides of a hash join.
+ *
+ * The build side inserts records made with OP_MakeRecord. The first
+ * key_def->part_count fields of a record form the join key, the rest are
+ * the payload columns the query needs. Records are copied to a region
+ * owned by the table and chained into buckets by the key hash. The probe
+ * side looks up a key given as an array of MEMs and then iterates over
+ * all records with an equal key.
+ *
+ * The memory used by the table is limited. Once the limit is reached,
+ * the records are moved to an ephemeral space indexed by the join key
+ * and a row number, just like the automatic index the hash join
+ * replaces, and the rest of the build and the probe use the space.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+#include "vdbeInt.h"
+#include "tarantoolInt.h"
+
+#include "box/index.h"
+#include "box/key_def.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "errinj.h"
+#include "small/region.h"
+#include "msgpuck/msgpuck.h"
+#include "mp_decimal.h"
+
+#include <float.h>
+#include <math.h>
+#include <PMurHash.h>
+
+/** Initial number of buckets of a hash table. Must be a power of two. */
+enum { VDBE_HASH_MIN_BUCKETS = 64 };
+
+/** Seed of the join key hash. */
+enum { VDBE_HASH_SEED = 13 };
+
+/** A record stored in a hash table. */
+struct vdbe_hash_entry {
+	/** Next record in the same bucket. */
+	struct vdbe_hash_entry *next;
+	/** Hash of the record key. */
+	uint32_t hash;
+	/** Size of the record data. */
+	uint32_t size;
+	/** The record, a MessagePack array. */
+	char data[0];
+};
+
+struct VdbeHash {
+	/** Memory for the records. */
+	struct region region;
+	/** Bucket heads, bucket_mask + 1 of them. */
+	struct vdbe_hash_entry **buckets;
+	/** Number of buckets minus one. */
+	uint32_t bucket_mask;
+	/** Number of records in the table. */
+	uint32_t count;
+	/** Record the cursor points to or NULL. */
+	struct vdbe_hash_entry *current;
+	/** Last probe key without the array header. */
+	char *key;
+	/** Size of the probe key buffer. */
+	uint32_t key_capacity;
+	/** Hash of the last probe key. */
+	uint32_t key_hash;
+	/**
+	 * Ephemeral space the records are moved to once the table
+	 * exceeds the memory limit or NULL.
+	 */
+	struct space *space;
+	/** Iterator over the records with the last probe key. */
+	struct iterator *iterator;
+	/** Referenced tuple the cursor points to or NULL. */
+	struct tuple *tuple;
+	/** Row number of the next record inserted into the space. */
+	uint64_t rowid;
+	/** Number of fields in a record. */
+	uint32_t field_count;
+	/** Types of the record fields. */
+	enum field_type types[0];
+};
+
+int
+sqlVdbeHashInit(struct VdbeCursor *cur, const struct sql_space_info *info,
+		uint32_t part_count)
+{
+	assert(cur->eCurType == CURTYPE_HASH);
+	assert(part_count > 0 && part_count <= info->field_count);
+	struct region *gc = &fiber()->gc;
+	size_t svp = region_used(gc);
+	struct key_part_def *parts = xregion_alloc_array(gc, typeof(parts[0]),
+							 part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		parts[i] = key_part_def_default;
+		parts[i].fieldno = i;
+		parts[i].type = info->types[i];
+		parts[i].coll_id = info->coll_ids[i];
+		parts[i].is_nullable = true;
+		parts[i].sort_order = SORT_ORDER_UNDEF;
+	}
+	struct key_def *key_def = key_def_new(parts, part_count,
+					      KEY_DEF_UNORDERED);
+	region_truncate(gc, svp);
+	if (key_def == NULL)
+		return -1;
+
+	uint32_t field_count = info->field_count;
+	struct VdbeHash *hash = sql_xmalloc0(sizeof(*hash) +
+					     field_count * sizeof(hash->types[0]));
+	region_create(&hash->region, &cord()->slabc);
+	hash->bucket_mask = VDBE_HASH_MIN_BUCKETS - 1;
+	hash->buckets = sql_xmalloc0(VDBE_HASH_MIN_BUCKETS *
+				     sizeof(hash->buckets[0]));
+	hash->field_count = field_count;
+	memcpy(hash->types, info->types, field_count * sizeof(hash->types[0]));
+	cur->key_def = key_def;
+	cur->uc.pHash = hash;
+	return 0;
+}
+
+void
+sqlVdbeHashClose(struct VdbeCursor *cur)
+{
+	assert(cur->eCurType == CURTYPE_HASH);
+	struct VdbeHash *hash = cur->uc.pHash;
+	if (hash == NULL)
+		return;
+	if (hash->tuple != NULL)
+		tuple_unref(hash->tuple);
+	if (hash->iterator != NULL)
+		iterator_delete(hash->iterator);
+	if (hash->space != NULL)
+		space_delete(hash->space);
+	region_destroy(&hash->region);
+	sql_xfree(hash->buckets);
+	sql_xfree(hash->key);
+	sql_xfree(hash);
+	cur->uc.pHash = NULL;
+	if (cur->key_def != NULL) {
+		key_def_delete(cur->key_def);
+		cur->key_def = NULL;
+	}
+}
+
+/**
+ * Encode a number given as a double to @a buf in the canonical form used
+ * for hashing and return the end of the encoded data.
+ */
+static char *
+vdbe_hash_encode_double(char *buf, double value)
+{
+	double iptr;
+	if (isfinite(value) && modf(value, &iptr) != 0) {
+		/*
+		 * A double is equal to a decimal if they match in DBL_DIG
+		 * significant digits, see decimal_from_double().
+		 */
+		char str[32];
+		snprintf(str, sizeof(str), "%.*g", DBL_DIG, value);
+		value = atof(str);
+	}
+	if (isfinite(value) && modf(value, &iptr) == 0 &&
+	    value >= -exp2(63) && value < exp2(64)) {
+		/* Integral values, including -0.0, are hashed as integers. */
+		if (value >= 0)
+			return mp_encode_uint(buf, (uint64_t)value);
+		return mp_encode_int(buf, (int64_t)value);
+	}
+	return mp_encode_double(buf, value);
+}
+
+/**
+ * Encode a numeric key field to @a buf so that numbers equal in SQL
+ * comparison have the same encoding whatever their MsgPack type is.
+ * Key parts of DOUBLE type are compared as doubles, so their values
+ * are converted to double first. Return the end of the encoded data
+ * or NULL if the field isn't a number and must be hashed as is.
+ */
+static char *
+vdbe_hash_encode_number(char *buf, const char *field, enum field_type type)
+{
+	switch (mp_typeof(*field)) {
+	case MP_UINT: {
+		uint64_t value = mp_decode_uint(&field);
+		if (type == FIELD_TYPE_DOUBLE)
+			return vdbe_hash_encode_double(buf, value);
+		return mp_encode_uint(buf, value);
+	}
+	case MP_INT: {
+		int64_t value = mp_decode_int(&field);
+		if (type == FIELD_TYPE_DOUBLE)
+			return vdbe_hash_encode_double(buf, value);
+		if (value >= 0)
+			return mp_encode_uint(buf, value);
+		return mp_encode_int(buf, value);
+	}
+	case MP_FLOAT:
+		return vdbe_hash_encode_double(buf, mp_decode_float(&field));
+	case MP_DOUBLE:
+		return vdbe_hash_encode_double(buf, mp_decode_double(&field));
+	case MP_EXT: {
+		int8_t ext_type;
+		uint32_t len = mp_decode_extl(&field, &ext_type);
+		if (ext_type != MP_DECIMAL)
+			return NULL;
+		decimal_t dec;
+		VERIFY(decimal_unpack(&field, len, &dec) != NULL);
+		int64_t i;
+		uint64_t u;
+		if (type != FIELD_TYPE_DOUBLE && decimal_is_int(&dec)) {
+			if (decimal_to_uint64(&dec, &u) != NULL)
+				return mp_encode_uint(buf, u);
+			if (decimal_to_int64(&dec, &i) != NULL)
+				return mp_encode_int(buf, i);
+		}
+		return vdbe_hash_encode_double(buf, atof(decimal_str(&dec)));
+	}
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * Calculate the hash of a join key. Unlike key_hash(), it gives the same
+ * hash to all numbers that are equal in SQL comparison, e.g. to 1, 1.0
+ * and 1.0 given as a decimal, and to 0 and -0.0.
+ */
+static uint32_t
+vdbe_hash_key(const char *key, struct key_def *key_def)
+{
+	uint32_t h = VDBE_HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		struct key_part *part = &key_def->parts[i];
+		char buf[16];
+		const char *end = vdbe_hash_encode_number(buf, key, part->type);
+		if (end != NULL) {
+			const char *number = buf;
+			total_size += tuple_hash_field(&h, &carry, &number,
+						       FIELD_TYPE_ANY, NULL);
+			mp_next(&key);
+		} else {
+			total_size += tuple_hash_field(&h, &carry, &key,
+						       FIELD_TYPE_ANY,
+						       part->coll);
+		}
+	}
+	return PMurHash32_Result(h, carry, total_size);
+}
+
+/**
+ * Double the number of buckets once there are more records than buckets
+ * so that chains stay short.
+ */
+static void
+vdbe_hash_grow(struct VdbeHash *hash)
+{
+	uint32_t old_count = hash->bucket_mask + 1;
+	if (hash->count <= old_count || old_count >= (1U << 31))
+		return;
+	uint32_t new_count = old_count * 2;
+	struct vdbe_hash_entry **buckets =
+		sql_xmalloc0(new_count * sizeof(buckets[0]));
+	for (uint32_t i = 0; i < old_count; i++) {
+		struct vdbe_hash_entry *entry = hash->buckets[i];
+		while (entry != NULL) {
+			struct vdbe_hash_entry *next = entry->next;
+			struct vdbe_hash_entry **head =
+				&buckets[entry->hash & (new_count - 1)];
+			entry->next = *head;
+			*head = entry;
+			entry = next;
+		}
+	}
+	sql_xfree(hash->buckets);
+	hash->buckets = buckets;
+	hash->bucket_mask = new_count - 1;
+}
+
+/** Return the limit on the memory used by a hash table, in bytes. */
+static size_t
+vdbe_hash_memory_max(void)
+{
+	struct errinj *inj = errinj(ERRINJ_SQL_HASH_MEMORY_MAX, ERRINJ_INT);
+	if (inj != NULL && inj->iparam >= 0)
+		return inj->iparam;
+	return SQL_HASH_JOIN_MEMORY_MAX;
+}
+
+/**
+ * Insert a record into the ephemeral space of the table. The row
+ * number is appended to the record so that records with equal keys
+ * don't replace each other.
+ */
+static int
+vdbe_hash_space_insert(struct VdbeHash *hash, const char *data,
+		       uint32_t size)
+{
+	const char *fields = data;
+	mp_decode_array(&fields);
+	uint32_t fields_size = data + size - fields;
+	struct region *gc = &fiber()->gc;
+	size_t svp = region_used(gc);
+	size_t tuple_size = mp_sizeof_array(hash->field_count + 1) +
+			    fields_size + mp_sizeof_uint(hash->rowid);
+	char *tuple = xregion_alloc(gc, tuple_size);
+	char *end = mp_encode_array(tuple, hash->field_count + 1);
+	memcpy(end, fields, fields_size);
+	end = mp_encode_uint(end + fields_size, hash->rowid++);
+	int rc = tarantoolsqlEphemeralInsert(hash->space, tuple, end);
+	region_truncate(gc, svp);
+	return rc;
+}
+
+/**
+ * Move the records of the table to an ephemeral space indexed by
+ * the join key and the row number and free the memory they used.
+ */
+static int
+vdbe_hash_spill(const struct VdbeCursor *cur)
+{
+	struct VdbeHash *hash = cur->uc.pHash;
+	struct key_def *key_def = cur->key_def;
+	uint32_t field_count = hash->field_count;
+	uint32_t part_count = key_def->part_count;
+	struct sql_space_info *info =
+		sql_space_info_new(field_count + 1, part_count + 1);
+	memcpy(info->types, hash->types, field_count * sizeof(info->types[0]));
+	for (uint32_t i = 0; i < part_count; i++)
+		info->coll_ids[i] = key_def->parts[i].coll_id;
+	info->types[field_count] = FIELD_TYPE_UNSIGNED;
+	info->parts[part_count] = field_count;
+	hash->space = sql_ephemeral_space_new(info);
+	sql_xfree(info);
+	if (hash->space == NULL)
+		return -1;
+	for (uint32_t i = 0; i <= hash->bucket_mask; i++) {
+		struct vdbe_hash_entry *entry = hash->buckets[i];
+		for (; entry != NULL; entry = entry->next) {
+			if (vdbe_hash_space_insert(hash, entry->data,
+						   entry->size) != 0)
+				return -1;
+		}
+		hash->buckets[i] = NULL;
+	}
+	region_free(&hash->region);
+	return 0;
+}
+
+int
+sqlVdbeHashInsert(const struct VdbeCursor *cur, const struct Mem *record)
+{
+	assert(cur->eCurType == CURTYPE_HASH);
+	assert(mem_is_bin(record));
+	struct VdbeHash *hash = cur->uc.pHash;
+	struct key_def *key_def = cur->key_def;
+	const char *key = record->z;
+	MAYBE_UNUSED uint32_t field_count = mp_decode_array(&key);
+	assert(field_count == hash->field_count);
+	/* NULL is not equal to anything, such a record never matches. */
+	const char *field = key;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		if (mp_typeof(*field) == MP_NIL)
+			return 0;
+		mp_next(&field);
+	}
+	struct vdbe_hash_entry *entry;
+	size_t size = sizeof(*entry) + record->n;
+	if (hash->space == NULL &&
+	    region_used(&hash->region) + size +
+	    (hash->bucket_mask + 1) * sizeof(hash->buckets[0]) >
+	    vdbe_hash_memory_max() && vdbe_hash_spill(cur) != 0)
+		return -1;
+	if (hash->space != NULL)
+		return vdbe_hash_space_insert(hash, record->z, record->n);
+	entry = region_aligned_alloc(&hash->region, size, alignof(*entry));
+	if (entry == NULL) {
+		diag_set(OutOfMemory, size, "region_aligned_alloc", "entry");
+		return -1;
+	}
+	memcpy(entry->data, record->z, record->n);
+	entry->size = record->n;
+	entry->hash = vdbe_hash_key(key, key_def);
+	struct vdbe_hash_entry **head =
+		&hash->buckets[entry->hash & hash->bucket_mask];
+	entry->next = *head;
+	*head = entry;
+	hash->count++;
+	vdbe_hash_grow(hash);
+	return 0;
+}
+
+/**
+ * Starting with @a entry, find the first record in the chain with
+ * a key equal to the current probe key.
+ */
+static struct vdbe_hash_entry *
+vdbe_hash_find(const struct VdbeCursor *cur, struct vdbe_hash_entry *entry)
+{
+	struct VdbeHash *hash = cur->uc.pHash;
+	struct key_def *key_def = cur->key_def;
+	uint32_t part_count = key_def->part_count;
+	for (; entry != NULL; entry = entry->next) {
+		if (entry->hash != hash->key_hash)
+			continue;
+		const char *key = entry->data;
+		mp_decode_array(&key);
+		if (key_compare(key, part_count, HINT_NONE, hash->key,
+				part_count, HINT_NONE, key_def) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+int
+sqlVdbeHashSeek(struct VdbeCursor *cur, const struct Mem *mems,
+		uint32_t count, int *res)
+{
+	assert(cur->eCurType == CURTYPE_HASH);
+	assert(count == cur->key_def->part_count);
+	struct VdbeHash *hash = cur->uc.pHash;
+	struct region *gc = &fiber()->gc;
+	size_t svp = region_used(gc);
+	uint32_t size;
+	const char *key = mem_encode_array(mems, count, &size, gc);
+	if (key == NULL)
+		return -1;
+	const char *key_end = key + size;
+	mp_decode_array(&key);
+	size = key_end - key;
+	if (size > hash->key_capacity) {
+		hash->key = sql_xrealloc(hash->key, size);
+		hash->key_capacity = size;
+	}
+	memcpy(hash->key, key, size);
+	region_truncate(gc, svp);
+	if (hash->space != NULL) {
+		if (hash->iterator != NULL)
+			iterator_delete(hash->iterator);
+		hash->iterator = index_create_iterator(hash->space->index[0],
+						       ITER_EQ, hash->key,
+						       count);
+		if (hash->iterator == NULL)
+			return -1;
+		if (sqlVdbeHashNext(cur, res) != 0)
+			return -1;
+		return 0;
+	}
+	hash->key_hash = vdbe_hash_key(hash->key, cur->key_def);
+	hash->current = vdbe_hash_find(cur, hash->buckets[hash->key_hash &
+							  hash->bucket_mask]);
+	*res = hash->current == NULL;
+	return 0;
+}
+
+int
+sqlVdbeHashNext(struct VdbeCursor *cur, int *res)
+{
+	assert(cur->eCurType == CURTYPE_HASH);
+	struct VdbeHash *hash = cur->uc.pHash;
+	if (hash->space == NULL) {
+		if (hash->current != NULL)
+			hash->current = vdbe_hash_find(cur,
+						       hash->current->next);
+		*res = hash->current == NULL;
+		return 0;
+	}
+	assert(hash->iterator != NULL);
+	struct tuple *tuple;
+	if (iterator_next(hash->iterator, &tuple) != 0)
+		return -1;
+	if (tuple != NULL)
+		tuple_ref(tuple);
+	if (hash->tuple != NULL)
+		tuple_unref(hash->tuple);
+	hash->tuple = tuple;
+	*res = tuple == NULL;
+	return 0;
+}
+
+const char *
+sqlVdbeHashRowData(const struct VdbeCursor *cur, uint32_t *size)
+{
+	assert(cur->eCurType == CURTYPE_HASH);
+	struct VdbeHash *hash = cur->uc.pHash;
+	if (hash->space != NULL) {
+		assert(hash->tuple != NULL);
+		return tuple_data_range(hash->tuple, size);
+	}
+	assert(hash->current != NULL);
+	*size = hash->current->size;
+	return hash->current->data;
+}
+
+enum field_type
+sqlVdbeHashFieldType(const struct VdbeCursor *cur, uint32_t fieldno)
+{
+	assert(cur->eCurType == CURTYPE_HASH);
+	struct VdbeHash *hash = cur->uc.pHash;
+	assert(fieldno < hash->field_count);
+	return hash->types[fieldno];
+}
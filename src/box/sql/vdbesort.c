@@ -103,57 +103,54 @@
  * of PMAs may be created by merging existing PMAs together - for example
  * merging two or more level-0 PMAs together creates a level-1 PMA.
  *
- * The threshold for the amount of main memory to use before flushing
- * records to a PMA is roughly the same as the limit configured for the
- * page-cache of the main database. Specifically, the threshold is set to
- * the value returned by "PRAGMA main.page_size" multipled by
- * that returned by "PRAGMA main.cache_size", in bytes.
- *
- * If the sorter is running in single-threaded mode, then all PMAs generated
- * are appended to a single temporary file. Or, if the sorter is running in
- * multi-threaded mode then up to (N+1) temporary files may be opened, where
- * N is the configured number of worker threads. In this case, instead of
- * sorting the records and writing the PMA to a temporary file itself, the
- * calling thread usually launches a worker thread to do so. Except, if
- * there are already N worker threads running, the main thread does the work
- * itself.
+ * The memory used by a sorter is limited by box.cfg.sql_sort_memory. It is
+ * shared by the list of records being accumulated and the lists being
+ * written to PMAs by worker threads, so the threshold for the amount of
+ * main memory to use before flushing records to a PMA is the limit
+ * divided by the number of worker threads plus one.
+ *
+ * PMAs are written by worker threads, box.cfg.sql_sort_threads of them.
+ * Each worker thread runs jobs of its own sub-task, which owns separate
+ * temporary files. When the in-memory list is full, it is handed over to
+ * the next sub-task in turn. The worker sorts the list and appends it to
+ * the file of the sub-task as a level-0 PMA, while the calling thread
+ * goes on accumulating records in a new list. If the sub-task is still
+ * busy with the previous list, the calling thread waits for it.
  *
  * When Rewind() is called, any data remaining in memory is flushed to a
- * final PMA. So at this point the data is stored in some number of sorted
- * PMAs within temporary files on disk.
- *
- * If there are fewer than SORTER_MAX_MERGE_COUNT PMAs in total and the
- * sorter is running in single-threaded mode, then these PMAs are merged
- * incrementally as keys are retreived from the sorter by the VDBE.  The
- * MergeEngine object, described in further detail below, performs this
- * merge.
- *
- * Or, if running in multi-threaded mode, then a background thread is
- * launched to merge the existing PMAs. Once the background thread has
- * merged T bytes of data into a single sorted PMA, the main thread
- * begins reading keys from that PMA while the background thread proceeds
- * with merging the next T bytes of data. And so on.
- *
- * Parameter T is set to half the value of the memory threshold used
- * by Write() above to determine when to create a new PMA.
- *
- * If there are more than SORTER_MAX_MERGE_COUNT PMAs in total when
- * Rewind() is called, then a hierarchy of incremental-merges is used.
+ * final PMA and all the workers are waited for. So at this point the data
+ * is stored in some number of sorted PMAs within temporary files on disk.
+ *
+ * If there are no more than SORTER_MAX_MERGE_COUNT PMAs in total, then
+ * these PMAs are merged incrementally as keys are retrieved from the
+ * sorter by the VDBE. The MergeEngine object, described in further detail
+ * below, performs this merge.
+ *
+ * Otherwise, the worker threads first merge the PMAs of their sub-tasks
+ * in parallel, each into a single PMA in a new temporary file, and the
+ * VDBE reads keys from the merge of these PMAs. A worker with more than
+ * SORTER_MAX_MERGE_COUNT PMAs uses a hierarchy of incremental-merges.
  * First, T bytes of data from the first SORTER_MAX_MERGE_COUNT PMAs on
  * disk are merged together. Then T bytes of data from the second set, and
  * so on, such that no operation ever merges more than SORTER_MAX_MERGE_COUNT
- * PMAs at a time. This done is to improve locality.
+ * PMAs at a time. This done is to improve locality. Parameter T is set to
+ * half the value of the memory threshold used by Write() above to
+ * determine when to create a new PMA.
  *
- * If running in multi-threaded mode and there are more than
- * SORTER_MAX_MERGE_COUNT PMAs on disk when Rewind() is called, then more
- * than one background thread may be created. Specifically, there may be
- * one background thread for each temporary file on disk, and one background
- * thread to merge the output of each of the others to a single PMA for
- * the main thread to read from.
+ * If no data has been written to disk when Rewind() is called, the list
+ * is sorted in memory, by a worker thread if the list is big enough.
+ *
+ * While waiting for a worker thread, the calling fiber yields so that
+ * a big sort doesn't block other requests, unless it is running a
+ * transaction which would be aborted by a yield.
  */
 #include "sqlInt.h"
 #include "mem.h"
 #include "vdbeInt.h"
+#include "fiber.h"
+#include "say.h"
+
+#include <unistd.h>
 
 /*
  * Hard-coded maximum amount of data to accumulate in memory before flushing
@@ -162,6 +159,15 @@
  */
 #define SQL_MAX_PMASZ    (1<<29)
 
+/* Default memory limit of a sorter in bytes. */
+#define SQL_SORT_MEMORY_DEFAULT (16 * 1024 * 1024)
+
+/* Number of worker threads of a sorter, box.cfg.sql_sort_threads. */
+static int sql_sort_threads = 1;
+
+/* Memory limit of a sorter in bytes, box.cfg.sql_sort_memory. */
+static int64_t sql_sort_memory = SQL_SORT_MEMORY_DEFAULT;
+
 /*
  * Private objects used by the sorter
  */
@@ -272,10 +278,10 @@ struct MergeEngine {
  * This object represents a single thread of control in a sort operation.
  * Exactly VdbeSorter.nTask instances of this object are allocated
  * as part of each VdbeSorter object. Instances are never allocated any
- * other way. VdbeSorter.nTask is set to the number of worker threads allowed
- * (see SQL_CONFIG_WORKER_THREADS) plus one (the main thread).  Thus for
- * single-threaded operation, there is exactly one instance of this object
- * and for multi-threaded operation there are two or more instances.
+ * other way. VdbeSorter.nTask is set to the number of worker threads,
+ * box.cfg.sql_sort_threads. The jobs of a sub-task are run by a worker
+ * thread, one at a time, while the first sub-task is also used by the
+ * calling thread to sort in memory and to merge the final PMAs.
  *
  * Essentially, this structure contains all those fields of the VdbeSorter
  * structure for which each thread requires a separate instance. For example,
@@ -284,14 +290,23 @@ struct MergeEngine {
  */
 typedef int (*SorterCompare) (SortSubtask *, bool *, const void *,
 			      const void *);
+typedef int (*SortJob) (SortSubtask *);
 struct SortSubtask {
 	VdbeSorter *pSorter;	/* Sorter that owns this sub-task */
 	UnpackedRecord *pUnpacked;	/* Space to unpack a record */
 	SorterList list;	/* List for thread to write to a PMA */
+	int nMemory;		/* Size of list.aMemory allocation in bytes */
 	int nPMA;		/* Number of PMAs currently in file */
+	i64 nData;		/* Bytes of records in PMAs of file */
 	SorterCompare xCompare;	/* Compare function to use */
 	SorterFile file;	/* Temp file for level-0 PMAs */
 	SorterFile file2;	/* Space for other PMAs */
+	SorterFile merged;	/* Temp file for the merge of all PMAs */
+	MergeEngine *pMerger;	/* Merge tree of PMAs in file */
+	struct cord *pCord;	/* Worker thread running a job or NULL */
+	SortJob xJob;		/* Job run by the worker thread */
+	int rc;			/* Result of the last job */
+	int iErrno;		/* errno of the last job if it failed */
 };
 
 /*
@@ -316,7 +331,9 @@ struct VdbeSorter {
 	int iMemory;		/* Offset of free space in list.aMemory */
 	int nMemory;		/* Size of list.aMemory allocation in bytes */
 	u8 bUsePMA;		/* True if one or more PMAs created */
-	SortSubtask aTask;	/* A single subtask */
+	int nTask;		/* Number of sub-tasks */
+	int iTask;		/* Sub-task to hand the next list over to */
+	SortSubtask aTask[0];	/* Sub-tasks, one per worker thread */
 };
 
 /*
@@ -439,6 +456,10 @@ struct SorterRecord {
 /* Maximum number of PMAs that a single MergeEngine can merge */
 #define SORTER_MAX_MERGE_COUNT 16
 
+/* The final merge reads no more than one PMA per sub-task. */
+static_assert(SQL_SORT_THREADS_MAX <= SORTER_MAX_MERGE_COUNT,
+	      "too many sort threads to merge their PMAs at once");
+
 static int vdbeIncrSwap(IncrMerger *);
 static void vdbeIncrFree(IncrMerger *);
 
@@ -781,24 +802,30 @@ sqlVdbeSorterInit(struct VdbeCursor *pCsr)
 	int pgsz;		/* Page size of main database */
 	VdbeSorter *pSorter;	/* The new sorter */
 	int rc = 0;
+	int nTask = sql_sort_threads;
 
 	assert(pCsr->key_def != NULL);
 	assert(pCsr->eCurType == CURTYPE_SORTER);
 
-	pSorter = sql_xmalloc0(sizeof(VdbeSorter));
+	pSorter = sql_xmalloc0(sizeof(VdbeSorter) +
+			       nTask * sizeof(SortSubtask));
 	pCsr->uc.pSorter = pSorter;
 
 	pSorter->key_def = pCsr->key_def;
 	pSorter->pgsz = pgsz = 1024;
-	pSorter->aTask.pSorter = pSorter;
+	pSorter->nTask = nTask;
+	for (int i = 0; i < nTask; i++)
+		pSorter->aTask[i].pSorter = pSorter;
 
-	/* Cache size in bytes */
+	/*
+	 * The memory limit is shared by the list being accumulated and
+	 * the lists being written by the worker threads.
+	 */
 	i64 mxCache;
 	u32 szPma = sqlGlobalConfig.szPma;
 	pSorter->mnPmaSize = szPma * pgsz;
 
-	mxCache = SQL_DEFAULT_CACHE_SIZE;
-	mxCache = mxCache * -1024;
+	mxCache = sql_sort_memory / (nTask + 1);
 	mxCache = MIN(mxCache, SQL_MAX_PMASZ);
 	pSorter->mxPmaSize = MAX(pSorter->mnPmaSize, (int)mxCache);
 	assert(pSorter->iMemory == 0);
@@ -829,10 +856,12 @@ vdbeSorterRecordFree(struct SorterRecord *pRecord)
 static void
 vdbeSortSubtaskCleanup(struct SortSubtask *pTask)
 {
+	assert(pTask->pCord == NULL && pTask->pMerger == NULL);
 	sql_xfree(pTask->pUnpacked);
 
-	assert(pTask->list.aMemory == 0);
-	vdbeSorterRecordFree(pTask->list.pList);
+	if (pTask->list.aMemory == 0)
+		vdbeSorterRecordFree(pTask->list.pList);
+	free(pTask->list.aMemory);
 
 	if (pTask->file.pFd) {
 		sqlOsCloseFree(pTask->file.pFd);
@@ -840,10 +869,109 @@ vdbeSortSubtaskCleanup(struct SortSubtask *pTask)
 	if (pTask->file2.pFd) {
 		sqlOsCloseFree(pTask->file2.pFd);
 	}
+	if (pTask->merged.pFd) {
+		sqlOsCloseFree(pTask->merged.pFd);
+	}
 	memset(pTask, 0, sizeof(SortSubtask));
 }
 
-#define vdbeSorterJoinAll(x,rcin) (rcin)
+/*
+ * Return true if the calling fiber may yield while waiting for a worker
+ * thread, that is, unless it runs a transaction which can't survive a
+ * yield, e.g. a memtx transaction with MVCC disabled.
+ */
+static bool
+vdbeSorterCanYield(void)
+{
+	struct txn *txn = in_txn();
+	return txn == NULL || txn_has_flag(txn, TXN_CAN_YIELD);
+}
+
+/*
+ * Main function of a worker thread. The result of the job is stored in
+ * the sub-task, since the job reports errors with return codes only.
+ */
+static int
+vdbeSortSubtaskMain(va_list ap)
+{
+	SortSubtask *pTask = va_arg(ap, SortSubtask *);
+	pTask->rc = pTask->xJob(pTask);
+	if (pTask->rc != 0)
+		pTask->iErrno = errno;
+	return 0;
+}
+
+/*
+ * Run job xJob of sub-task pTask in a worker thread. All the memory the
+ * job needs from the SQL allocator and the temporary files must be
+ * allocated in advance. If the thread can't be started, the job is run
+ * by the calling thread.
+ */
+static void
+vdbeSortSubtaskStart(SortSubtask *pTask, SortJob xJob)
+{
+	assert(pTask->pCord == NULL);
+	pTask->xJob = xJob;
+	pTask->rc = 0;
+	pTask->pCord = xmalloc(sizeof(*pTask->pCord));
+	if (cord_costart(pTask->pCord, "sql.sort", vdbeSortSubtaskMain,
+			 pTask) != 0) {
+		diag_clear(diag_get());
+		free(pTask->pCord);
+		pTask->pCord = NULL;
+		pTask->rc = xJob(pTask);
+		if (pTask->rc != 0)
+			pTask->iErrno = errno;
+	}
+}
+
+/*
+ * Wait until the worker thread of sub-task pTask, if any, finishes its
+ * job. The result of the job is left in pTask->rc.
+ */
+static void
+vdbeSortSubtaskWait(SortSubtask *pTask)
+{
+	if (pTask->pCord == NULL)
+		return;
+	int rc = vdbeSorterCanYield() ? cord_cojoin(pTask->pCord) :
+		 cord_join(pTask->pCord);
+	if (rc != 0)
+		panic("failed to join an SQL sort thread");
+	free(pTask->pCord);
+	pTask->pCord = NULL;
+}
+
+/*
+ * Wait for the job of sub-task pTask and return 0 if it succeeded, or
+ * set the diagnostics area and return -1 otherwise.
+ */
+static int
+vdbeSortSubtaskJoin(SortSubtask *pTask)
+{
+	vdbeSortSubtaskWait(pTask);
+	if (pTask->rc == 0)
+		return 0;
+	pTask->rc = 0;
+	errno = pTask->iErrno;
+	diag_set(SystemError, "failed to sort: temporary file I/O error");
+	return -1;
+}
+
+/*
+ * Wait for the jobs of all the sub-tasks. Return rcin if all of them
+ * succeeded or -1 otherwise.
+ */
+static int
+vdbeSorterJoinAll(VdbeSorter *pSorter, int rcin)
+{
+	int rc = rcin;
+	for (int i = 0; i < pSorter->nTask; i++) {
+		if (vdbeSortSubtaskJoin(&pSorter->aTask[i]) != 0)
+			rc = -1;
+	}
+	return rc;
+}
 
 /*
  * Allocate a new MergeEngine object capable of handling up to
@@ -904,12 +1032,17 @@ vdbeIncrFree(IncrMerger * pIncr)
 void
 sqlVdbeSorterReset(struct VdbeSorter *pSorter)
 {
-	(void)vdbeSorterJoinAll(pSorter, 0);
+	/* Errors of the jobs don't matter anymore. */
+	for (int i = 0; i < pSorter->nTask; i++)
+		vdbeSortSubtaskWait(&pSorter->aTask[i]);
 	assert(pSorter->pReader == 0);
 	vdbeMergeEngineFree(pSorter->pMerger);
 	pSorter->pMerger = 0;
-	vdbeSortSubtaskCleanup(&pSorter->aTask);
-	pSorter->aTask.pSorter = pSorter;
+	for (int i = 0; i < pSorter->nTask; i++) {
+		vdbeSortSubtaskCleanup(&pSorter->aTask[i]);
+		pSorter->aTask[i].pSorter = pSorter;
+	}
+	pSorter->iTask = 0;
 	if (pSorter->list.aMemory == 0)
 		vdbeSorterRecordFree(pSorter->list.pList);
 	pSorter->list.pList = 0;
@@ -1213,6 +1346,8 @@ vdbePmaWriteVarint(PmaWriter * p, u64 iVal)
  *     * One or more records packed end-to-end in order of ascending keys.
  *       Each record consists of a varint followed by a blob of data (the
  *       key). The varint is the number of bytes in the blob of data.
+ *
+ * The temporary file must be opened by the caller.
  */
 static int
 vdbeSorterListToPMA(SortSubtask * pTask, SorterList * pList)
@@ -1230,20 +1365,11 @@ vdbeSorterListToPMA(SortSubtask * pTask, SorterList * pList)
 
 	memset(&writer, 0, sizeof(PmaWriter));
 	assert(pList->szPMA > 0);
-
-	/* If the first temporary PMA file has not been opened, open it now. */
-	if (pTask->file.pFd == 0) {
-		rc = vdbeSorterOpenTempFile(0, &pTask->file.pFd);
-		assert(rc != 0 || pTask->file.pFd);
-		assert(pTask->file.iEof == 0);
-		assert(pTask->nPMA == 0);
-	}
+	assert(pTask->file.pFd != NULL);
 
 	/* Try to get the file to memory map */
-	if (rc == 0) {
-		vdbeSorterExtendFile(pTask->file.pFd,
-				     pTask->file.iEof + pList->szPMA + 9);
-	}
+	vdbeSorterExtendFile(pTask->file.pFd,
+			     pTask->file.iEof + pList->szPMA + 9);
 
 	/* Sort the list */
 	if (rc == 0)
@@ -1256,6 +1382,7 @@ vdbeSorterListToPMA(SortSubtask * pTask, SorterList * pList)
 		vdbePmaWriterInit(pTask->file.pFd, &writer,
 				  pTask->pSorter->pgsz, pTask->file.iEof);
 		pTask->nPMA++;
+		pTask->nData += pList->szPMA;
 		vdbePmaWriteVarint(&writer, pList->szPMA);
 		for (p = pList->pList; p; p = pNext) {
 			pNext = p->u.pNext;
@@ -1358,14 +1485,64 @@ vdbeMergeEngineStep(MergeEngine * pMerger,	/* The merge engine to advance to the
 }
 
 /*
- * Flush the current contents of VdbeSorter.list to a new PMA, possibly
- * using a background thread.
+ * Job of a worker thread: sort the list of the sub-task and write it to
+ * a new PMA.
+ */
+static int
+vdbeSortSubtaskWritePMA(SortSubtask * pTask)
+{
+	return vdbeSorterListToPMA(pTask, &pTask->list);
+}
+
+/*
+ * Job of a worker thread: sort the in-memory list of the sorter.
+ */
+static int
+vdbeSortSubtaskSortList(SortSubtask * pTask)
+{
+	return vdbeSorterSort(pTask, &pTask->pSorter->list);
+}
+
+/*
+ * Flush the current contents of VdbeSorter.list to a new PMA using
+ * a worker thread. The list is handed over to the next sub-task in turn
+ * and the sorter takes the memory buffer the sub-task used before.
  */
 static int
 vdbeSorterFlushPMA(VdbeSorter * pSorter)
 {
+	SortSubtask *pTask = &pSorter->aTask[pSorter->iTask];
+	pSorter->iTask = (pSorter->iTask + 1) % pSorter->nTask;
 	pSorter->bUsePMA = 1;
-	return vdbeSorterListToPMA(&pSorter->aTask, &pSorter->list);
+
+	if (vdbeSortSubtaskJoin(pTask) != 0)
+		return -1;
+	/* If the first temporary PMA file has not been opened, open it now. */
+	if (pTask->file.pFd == 0) {
+		int rc = vdbeSorterOpenTempFile(0, &pTask->file.pFd);
+		if (rc != 0)
+			return rc;
+		assert(pTask->file.iEof == 0);
+		assert(pTask->nPMA == 0);
+	}
+	vdbeSortAllocUnpacked(pTask);
+
+	SorterList list = pTask->list;
+	int nMemory = pTask->nMemory;
+	assert(list.pList == NULL);
+	pTask->list = pSorter->list;
+	pTask->nMemory = pSorter->nMemory;
+	if (pSorter->list.aMemory != NULL && list.aMemory == NULL) {
+		nMemory = pSorter->nMemory;
+		list.aMemory = xmalloc(nMemory);
+	}
+	pSorter->list.aMemory = list.aMemory;
+	pSorter->list.pList = NULL;
+	pSorter->list.szPMA = 0;
+	pSorter->nMemory = nMemory;
+
+	vdbeSortSubtaskStart(pTask, vdbeSortSubtaskWritePMA);
+	return 0;
 }
 
 /*
@@ -1678,23 +1855,14 @@ vdbePmaReaderIncrMergeInit(PmaReader * pReadr)
 
 	rc = vdbeMergeEngineInit(pTask, pIncr->pMerger);
 
-	/* Set up the required files for pIncr. A multi-theaded IncrMerge object
-	 * requires two temp files to itself, whereas a single-threaded object
-	 * only requires a region of pTask->file2.
+	/* Set up the required files for pIncr. The object requires a region of
+	 * pTask->file2, which is opened by vdbeSortSubtaskMergeStart().
 	 */
 	if (rc == 0) {
-		int mxSz = pIncr->mxSz;
-		if (pTask->file2.pFd == 0) {
-			assert(pTask->file2.iEof > 0);
-			rc = vdbeSorterOpenTempFile(pTask->file2.iEof,
-						    &pTask->file2.pFd);
-			pTask->file2.iEof = 0;
-		}
-		if (rc == 0) {
-			pIncr->aFile[1].pFd = pTask->file2.pFd;
-			pIncr->iStartOff = pTask->file2.iEof;
-			pTask->file2.iEof += mxSz;
-		}
+		assert(pTask->file2.pFd != NULL);
+		pIncr->aFile[1].pFd = pTask->file2.pFd;
+		pIncr->iStartOff = pTask->file2.iEof;
+		pTask->file2.iEof += pIncr->mxSz;
 	}
 
 	if (rc == 0) {
@@ -1850,9 +2018,9 @@ vdbeSorterAddToTree(SortSubtask * pTask,	/* Task context */
 
 /*
  * This function is called as part of a SorterRewind() operation on a sorter
- * that has already written two or more level-0 PMAs to one or more temp
- * files. It builds a tree of MergeEngine/IncrMerger/PmaReader objects that
- * can be used to incrementally merge all PMAs on disk.
+ * sub-task that has already written two or more level-0 PMAs to its temp
+ * file. It builds a tree of MergeEngine/IncrMerger/PmaReader objects that
+ * can be used to incrementally merge all PMAs of the sub-task.
  *
  * If successful, 0 is returned and *ppOut set to point to the
  * MergeEngine object at the root of the tree before returning. Or, if an
@@ -1860,14 +2028,13 @@ vdbeSorterAddToTree(SortSubtask * pTask,	/* Task context */
  * of *ppOut is undefined.
  */
 static int
-vdbeSorterMergeTreeBuild(VdbeSorter * pSorter,	/* The VDBE cursor that implements the sort */
+vdbeSorterMergeTreeBuild(SortSubtask * pTask,	/* Sub-task to merge PMAs of */
 			 MergeEngine ** ppOut	/* Write the MergeEngine here */
     )
 {
 	MergeEngine *pMain = 0;
 	int rc = 0;
 
-	SortSubtask *pTask = &pSorter->aTask;
 	assert(pTask->nPMA > 0);
 	if (pTask->nPMA) {
 		MergeEngine *pRoot = 0;	/* Root node of tree for this task */
@@ -1922,31 +2089,155 @@ vdbeSorterMergeTreeBuild(VdbeSorter * pSorter,	/* The VDBE cursor that implement
 	return rc;
 }
 
+/*
+ * Job of a worker thread: merge all PMAs of the sub-task using the merge
+ * tree at pTask->pMerger and write the result to pTask->merged as a
+ * single PMA.
+ */
+static int
+vdbeSortSubtaskMergePMA(SortSubtask * pTask)
+{
+	MergeEngine *pMerger = pTask->pMerger;
+	PmaWriter writer;
+	int rc = vdbeMergeEngineInit(pTask, pMerger);
+	if (rc == 0) {
+		int rc2;
+		vdbePmaWriterInit(pTask->merged.pFd, &writer,
+				  pTask->pSorter->pgsz, 0);
+		vdbePmaWriteVarint(&writer, pTask->nData);
+		while (rc == 0) {
+			int dummy;
+			PmaReader *pReader =
+				&pMerger->aReadr[pMerger->aTree[1]];
+			if (pReader->pFd == 0)
+				break;
+			vdbePmaWriteVarint(&writer, pReader->nKey);
+			vdbePmaWriteBlob(&writer, pReader->aKey,
+					 pReader->nKey);
+			rc = vdbeMergeEngineStep(pMerger, &dummy);
+		}
+		rc2 = vdbePmaWriterFinish(&writer, &pTask->merged.iEof);
+		if (rc == 0)
+			rc = rc2;
+	}
+	vdbeMergeEngineFree(pMerger);
+	pTask->pMerger = NULL;
+	return rc;
+}
+
+/*
+ * Start merging all PMAs of sub-task pTask into one in a worker thread.
+ * The merge tree is built and the temporary files it needs are opened
+ * by the calling thread.
+ */
+static int
+vdbeSortSubtaskMergeStart(SortSubtask * pTask)
+{
+	assert(pTask->nPMA > 1);
+	assert(pTask->pMerger == NULL && pTask->file2.pFd == NULL);
+	int rc = vdbeSorterMergeTreeBuild(pTask, &pTask->pMerger);
+	/* Each incremental merger of the tree needs a region of file2. */
+	if (rc == 0 && pTask->file2.iEof > 0) {
+		rc = vdbeSorterOpenTempFile(pTask->file2.iEof,
+					    &pTask->file2.pFd);
+		pTask->file2.iEof = 0;
+	}
+	if (rc == 0) {
+		rc = vdbeSorterOpenTempFile(pTask->nData + 9,
+					    &pTask->merged.pFd);
+	}
+	if (rc != 0) {
+		vdbeMergeEngineFree(pTask->pMerger);
+		pTask->pMerger = NULL;
+		return rc;
+	}
+	vdbeSortSubtaskStart(pTask, vdbeSortSubtaskMergePMA);
+	return 0;
+}
+
+/*
+ * Replace the PMAs of sub-task pTask with the result of their merge.
+ */
+static void
+vdbeSortSubtaskMergeFinish(SortSubtask * pTask)
+{
+	assert(pTask->merged.pFd != NULL);
+	sqlOsCloseFree(pTask->file.pFd);
+	if (pTask->file2.pFd)
+		sqlOsCloseFree(pTask->file2.pFd);
+	pTask->file = pTask->merged;
+	memset(&pTask->file2, 0, sizeof(pTask->file2));
+	memset(&pTask->merged, 0, sizeof(pTask->merged));
+	pTask->nPMA = 1;
+}
+
 /*
  * This function is called as part of an sqlVdbeSorterRewind() operation
- * on a sorter that has written two or more PMAs to temporary files. It sets
- * up either VdbeSorter.pMerger (for single threaded sorters) or pReader
- * (for multi-threaded sorters) so that it can be used to iterate through
- * all records stored in the sorter.
+ * on a sorter that has written one or more PMAs to temporary files. It sets
+ * up VdbeSorter.pMerger so that it can be used to iterate through all
+ * records stored in the sorter.
+ *
+ * If there are too many PMAs to merge them at once, then the PMAs of each
+ * sub-task are merged into one by the worker threads first.
  *
  * 0 is returned if successful, or an sql error code otherwise.
  */
 static int
 vdbeSorterSetupMerge(VdbeSorter * pSorter)
 {
-	int rc;			/* Return code */
-	MergeEngine *pMain = 0;
-
-	rc = vdbeSorterMergeTreeBuild(pSorter, &pMain);
+	int rc = 0;		/* Return code */
+	int nPMA = 0;		/* Number of PMAs to merge */
+	int iReadr = 0;		/* Next PmaReader of pMain to set up */
+	SortSubtask *pTask;
+	MergeEngine *pMain;
+	int i, j;
+
+	for (i = 0; i < pSorter->nTask; i++)
+		nPMA += pSorter->aTask[i].nPMA;
+	if (nPMA > SORTER_MAX_MERGE_COUNT) {
+		for (i = 0; i < pSorter->nTask && rc == 0; i++) {
+			pTask = &pSorter->aTask[i];
+			if (pTask->nPMA > 1)
+				rc = vdbeSortSubtaskMergeStart(pTask);
+		}
+		rc = vdbeSorterJoinAll(pSorter, rc);
+		if (rc != 0)
+			return rc;
+		nPMA = 0;
+		for (i = 0; i < pSorter->nTask; i++) {
+			pTask = &pSorter->aTask[i];
+			if (pTask->merged.pFd != NULL)
+				vdbeSortSubtaskMergeFinish(pTask);
+			nPMA += pTask->nPMA;
+		}
+	}
+	assert(nPMA > 0 && nPMA <= SORTER_MAX_MERGE_COUNT);
+
+	pMain = vdbeMergeEngineNew(nPMA);
+	for (i = 0; i < pSorter->nTask && rc == 0; i++) {
+		i64 iOff = 0;
+		pTask = &pSorter->aTask[i];
+		for (j = 0; j < pTask->nPMA && rc == 0; j++) {
+			i64 nDummy = 0;
+			PmaReader *pReadr = &pMain->aReadr[iReadr++];
+			rc = vdbePmaReaderInit(pTask, &pTask->file, iOff,
+					       pReadr, &nDummy);
+			iOff = pReadr->iEof;
+		}
+	}
 	if (rc == 0) {
-		rc = vdbeMergeEngineInit(&pSorter->aTask, pMain);
-		pSorter->pMerger = pMain;
-		pMain = 0;
+		/* The keys are compared using the first sub-task. */
+		pTask = &pSorter->aTask[0];
+		vdbeSortAllocUnpacked(pTask);
+		pTask->xCompare = vdbeSorterGetCompare(pSorter);
+		rc = vdbeMergeEngineInit(pTask, pMain);
 	}
-
-	if (rc != 0)
+	if (rc != 0) {
 		vdbeMergeEngineFree(pMain);
-	return rc;
+		return rc;
+	}
+	pSorter->pMerger = pMain;
+	return 0;
 }
 
 /*
@@ -1970,8 +2261,14 @@ sqlVdbeSorterRewind(const VdbeCursor * pCsr, int *pbEof)
 	 */
 	if (pSorter->bUsePMA == 0) {
 		if (pSorter->list.pList) {
+			SortSubtask *pTask = &pSorter->aTask[0];
 			*pbEof = 0;
-			rc = vdbeSorterSort(&pSorter->aTask, &pSorter->list);
+			if (pSorter->list.szPMA < pSorter->mnPmaSize)
+				return vdbeSorterSort(pTask, &pSorter->list);
+			/* Don't block the thread sorting a big list. */
+			vdbeSortAllocUnpacked(pTask);
+			vdbeSortSubtaskStart(pTask, vdbeSortSubtaskSortList);
+			rc = vdbeSortSubtaskJoin(pTask);
 		} else {
 			*pbEof = 1;
 		}
@@ -2015,7 +2312,7 @@ sqlVdbeSorterNext(const struct VdbeCursor *pCsr, int *pbEof)
 	if (pSorter->bUsePMA) {
 		assert(pSorter->pReader == 0 || pSorter->pMerger == 0);
 		assert(pSorter->pMerger);
-		assert(pSorter->pMerger->pTask == &pSorter->aTask);
+		assert(pSorter->pMerger->pTask == &pSorter->aTask[0]);
 		rc = vdbeMergeEngineStep(pSorter->pMerger, pbEof);
 	} else {
 		SorterRecord *pFree = pSorter->list.pList;
@@ -2125,3 +2422,22 @@ sqlVdbeSorterCompare(const VdbeCursor * pCsr,	/* Sorter cursor */
 	*pRes = sqlVdbeRecordCompareMsgpack(pVal->z, r2);
 	return 0;
 }
+
+void
+sql_sort_set_threads(int count)
+{
+	assert(count >= 0 && count <= SQL_SORT_THREADS_MAX);
+	if (count == 0) {
+		long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+		count = cpu_count < 1 ? 1 :
+			MIN(cpu_count, SQL_SORT_THREADS_MAX);
+	}
+	sql_sort_threads = count;
+}
+
+void
+sql_sort_set_memory(int64_t size)
+{
+	assert(size >= 0);
+	sql_sort_memory = size == 0 ? SQL_SORT_MEMORY_DEFAULT : size;
+}
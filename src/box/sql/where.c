@@ -712,6 +712,51 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
 	return 1;
 }
 
+/*
+ * Return TRUE if the WHERE clause term pTerm, which can drive an automatic
+ * index, can also be used as a key of a hash join. It is so if hashes of
+ * the values of the column are consistent with their comparison.
+ */
+static bool
+termCanDriveHash(WhereTerm * pTerm, struct SrcList_item *pSrc)
+{
+	assert(pTerm->u.leftColumn >= 0);
+	switch (pSrc->space->def->fields[pTerm->u.leftColumn].type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_DOUBLE:
+	case FIELD_TYPE_STRING:
+	case FIELD_TYPE_BOOLEAN:
+	case FIELD_TYPE_VARBINARY:
+	case FIELD_TYPE_UUID:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Return TRUE if the hash table of a hash join built over the space of
+ * pSrc is estimated to fit in SQL_HASH_JOIN_MEMORY_MAX. Otherwise the
+ * records would be moved to an ephemeral space during the build, so an
+ * automatic index is cheaper. The size of a view or a subquery is not
+ * known, it is assumed to fit.
+ */
+static bool
+whereHashJoinFits(struct SrcList_item *pSrc)
+{
+	struct space *space = pSrc->space;
+	if (space->def->opts.is_view || space->index_count == 0)
+		return true;
+	uint64_t count = index_size(space->index[0]);
+	if (count == 0)
+		return true;
+	/* Average size of a record with the entry header and the bucket. */
+	uint64_t size = 24 + space_bsize(space) / count;
+	return sqlLogEst(count) + sqlLogEst(size) <=
+	       sqlLogEst(SQL_HASH_JOIN_MEMORY_MAX);
+}
+
 /**
  * Generate a code that will create a tuple, which is supposed to be inserted
  * in the ephemeral index space. The created tuple consists of rowid and
@@ -721,7 +766,8 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
  * @param key_def The index key description.
  * @param cursor Cursor of source space from which values for tuple are fetched.
  * @param reg_out Register to contain the created tuple.
- * @param reg_eph Register holding pointer to ephemeral index.
+ * @param reg_eph Register holding pointer to ephemeral index. If it is 0,
+ *        the tuple is inserted into a hash join table and has no rowid.
  */
 static void
 vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
@@ -731,14 +777,17 @@ vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
 	assert(reg_out != 0);
 	struct Vdbe *v = parse->pVdbe;
 	int col_cnt = key_def->part_count;
-	int reg_base = sqlGetTempRange(parse, col_cnt + 1);
+	int reg_cnt = reg_eph != 0 ? col_cnt + 1 : col_cnt;
+	int reg_base = sqlGetTempRange(parse, reg_cnt);
 	for (int j = 0; j < col_cnt; j++) {
 		uint32_t tabl_col = key_def->parts[j].fieldno;
 		sqlVdbeAddOp3(v, OP_Column, cursor, tabl_col, reg_base + j);
 	}
-	sqlVdbeAddOp2(v, OP_NextIdEphemeral, reg_eph, reg_base + col_cnt);
-	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, col_cnt + 1, reg_out);
-	sqlReleaseTempRange(parse, reg_base, col_cnt + 1);
+	if (reg_eph != 0)
+		sqlVdbeAddOp2(v, OP_NextIdEphemeral, reg_eph,
+			      reg_base + col_cnt);
+	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, reg_cnt, reg_out);
+	sqlReleaseTempRange(parse, reg_base, reg_cnt);
 }
 
 /*
@@ -748,6 +797,9 @@ vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
  * an "ephemeral index". The PK definition of ephemeral index contains all of
  * its fields. Also, this functions set up the WhereLevel object pLevel so
  * that the code generator makes use of ephemeral index.
+ *
+ * If the loop is a hash join, a hash table keyed by the equality columns
+ * is built instead of the ephemeral space.
  */
 static void
 constructAutomaticIndex(Parse * pParse,			/* The parsing context */
@@ -783,9 +835,11 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	nKeyCol = 0;
 	pWCEnd = &pWC->a[pWC->nTerm];
 	pLoop = pLevel->pWLoop;
+	bool is_hash = (pLoop->wsFlags & WHERE_HASH_JOIN) != 0;
 	idxCols = 0;
 	for (pTerm = pWC->a; pTerm < pWCEnd; pTerm++) {
-		if (termCanDriveIndex(pTerm, pSrc, notReady)) {
+		if (termCanDriveIndex(pTerm, pSrc, notReady) &&
+		    (!is_hash || termCanDriveHash(pTerm, pSrc))) {
 			int iCol = pTerm->u.leftColumn;
 			Bitmask cMask =
 			    iCol >= BMS ? MASKBIT(BMS - 1) : MASKBIT(iCol);
@@ -800,6 +854,8 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	pLoop->nEq = pLoop->nLTerm = nKeyCol;
 	pLoop->wsFlags = WHERE_COLUMN_EQ | WHERE_IDX_ONLY | WHERE_INDEXED
 	    | WHERE_AUTO_INDEX;
+	if (is_hash)
+		pLoop->wsFlags |= WHERE_HASH_JOIN;
 
 	/* Count the number of additional columns needed to create a
 	 * covering index.  A "covering index" is an index that contains all
@@ -826,7 +882,8 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 							 typeof(parts[0]),
 							 nKeyCol);
 	for (pTerm = pWC->a; pTerm < pWCEnd; pTerm++) {
-		if (termCanDriveIndex(pTerm, pSrc, notReady)) {
+		if (termCanDriveIndex(pTerm, pSrc, notReady) &&
+		    (!is_hash || termCanDriveHash(pTerm, pSrc))) {
 			int iCol = pTerm->u.leftColumn;
 			Bitmask cMask =
 			    iCol >= BMS ? MASKBIT(BMS - 1) : MASKBIT(iCol);
@@ -893,9 +950,10 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	/* Construct the index definition to describe this index. */
 	struct index_opts opts;
 	index_opts_create(&opts);
-	const char *idx_name = "ephemeral index";
+	const char *idx_name = is_hash ? "hash index" : "ephemeral index";
 	struct index_def *idx_def = index_def_new(space->def->id, 0, idx_name,
-						  strlen(idx_name), TREE, &opts,
+						  strlen(idx_name),
+						  is_hash ? HASH : TREE, &opts,
 						  key_def, NULL);
 	key_def_delete(key_def);
 	if (idx_def == NULL) {
@@ -907,12 +965,18 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	/* Create the automatic index */
 	assert(pLevel->iIdxCur >= 0);
 	pLevel->iIdxCur = pParse->nTab++;
-	struct sql_space_info *info = sql_space_info_new_from_index_def(idx_def,
-									true);
-	int reg_eph = sqlGetTempReg(pParse);
-	sqlVdbeAddOp4(v, OP_OpenTEphemeral, reg_eph, 0, 0, (char *)info,
-		      P4_DYNAMIC);
-	sqlVdbeAddOp3(v, OP_IteratorOpen, pLevel->iIdxCur, 0, reg_eph);
+	struct sql_space_info *info =
+		sql_space_info_new_from_index_def(idx_def, !is_hash);
+	int reg_eph = 0;
+	if (is_hash) {
+		sqlVdbeAddOp4(v, OP_HashOpen, pLevel->iIdxCur, pLoop->nEq, 0,
+			      (char *)info, P4_DYNAMIC);
+	} else {
+		reg_eph = sqlGetTempReg(pParse);
+		sqlVdbeAddOp4(v, OP_OpenTEphemeral, reg_eph, 0, 0, (char *)info,
+			      P4_DYNAMIC);
+		sqlVdbeAddOp3(v, OP_IteratorOpen, pLevel->iIdxCur, 0, reg_eph);
+	}
 	VdbeComment((v, "for %s", space->def->name));
 
 	/* Fill the automatic index with content */
@@ -923,7 +987,10 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	regRecord = sqlGetTempReg(pParse);
 	vdbe_emit_ephemeral_index_tuple(pParse, idx_def->key_def, cursor,
 					regRecord, reg_eph);
-	sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, reg_eph);
+	if (is_hash)
+		sqlVdbeAddOp2(v, OP_HashInsert, pLevel->iIdxCur, regRecord);
+	else
+		sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, reg_eph);
 	sqlVdbeAddOp2(v, OP_Next, cursor, addrTop + 1);
 	sqlVdbeChangeP5(v, SQL_STMTSTATUS_AUTOINDEX);
 	sqlVdbeJumpHere(v, addrTop);
@@ -935,6 +1002,181 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	sqlVdbeJumpHere(v, addrInit);
 }
 
+/**
+ * Set @a mem to the value of @a expr if it is known before the
+ * statement is executed: a numeric or a string literal or a parameter
+ * whose value is bound to Parse::bound_stmt.
+ */
+static bool
+where_expr_value(struct Parse *parse, const struct Expr *expr,
+		 struct Mem *mem)
+{
+	bool is_neg = false;
+	if (expr->op == TK_UMINUS) {
+		is_neg = true;
+		expr = expr->pLeft;
+	}
+	switch (expr->op) {
+	case TK_VARIABLE: {
+		if (is_neg || parse->pToplevel != NULL)
+			return false;
+		const struct Mem *var =
+			vdbe_get_bound_value(parse->bound_stmt,
+					     expr->iColumn - 1);
+		if (var == NULL || mem_is_null(var))
+			return false;
+		mem_copy_as_ephemeral(mem, var);
+		return true;
+	}
+	case TK_INTEGER: {
+		uint64_t value;
+		if (ExprHasProperty(expr, EP_IntValue)) {
+			value = expr->u.iValue;
+		} else {
+			const char *z = expr->u.zToken;
+			bool unused;
+			if (z[0] == '0' && (z[1] == 'x' || z[1] == 'X'))
+				return false;
+			if (sql_atoi64(z, (int64_t *)&value, &unused,
+				       strlen(z)) != 0)
+				return false;
+		}
+		if (!is_neg)
+			mem_set_uint(mem, value);
+		else if (value > (uint64_t)INT64_MAX + 1)
+			return false;
+		else
+			mem_set_int(mem, (int64_t)(0 - value), value != 0);
+		return true;
+	}
+	case TK_FLOAT: {
+		double value;
+		sqlAtoF(expr->u.zToken, &value, sqlStrlen30(expr->u.zToken));
+		mem_set_double(mem, is_neg ? -value : value);
+		return true;
+	}
+	case TK_STRING:
+		if (is_neg)
+			return false;
+		mem_set_str0_static(mem, expr->u.zToken);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Return the number of the parameter the bound of a constraint is, or
+ * 0 if it is not a parameter.
+ */
+static uint32_t
+where_term_param(const struct WhereTerm *term)
+{
+	const struct Expr *expr = term->pExpr->pRight;
+	return expr->op == TK_VARIABLE ? expr->iColumn : 0;
+}
+
+/**
+ * If the bounds of a constraint on the first column of an analyzed
+ * index are parameters, remember that the plan depends on their
+ * values, see struct sql_plan_probe.
+ */
+static void
+where_add_plan_probe(struct Parse *parse, const struct index_def *def,
+		     struct WhereTerm *lower, bool is_lower_inclusive,
+		     struct WhereTerm *upper, bool is_upper_inclusive)
+{
+	uint64_t unused;
+	if (parse->pToplevel != NULL || def->space_id == 0 ||
+	    sql_index_stat_range_est(def, NULL, false, NULL, false,
+				     &unused) != 0)
+		return;
+	struct sql_plan_probe probe = {
+		.space_id = def->space_id,
+		.index_id = def->iid,
+		.lower = lower != NULL ? where_term_param(lower) : 0,
+		.upper = upper != NULL ? where_term_param(upper) : 0,
+		.is_lower_inclusive = is_lower_inclusive,
+		.is_upper_inclusive = is_upper_inclusive,
+	};
+	if ((lower != NULL && probe.lower == 0) ||
+	    (upper != NULL && probe.upper == 0))
+		return;
+	sql_vdbe_add_plan_probe(parse->pVdbe, &probe);
+}
+
+/**
+ * Estimate the number of rows visited by a range scan on the first
+ * column of the index using statistics collected by ANALYZE. Only
+ * bounds with known values and without a likelihood() are supported.
+ *
+ * @retval 0 Success, *pnNew is set.
+ * @retval -1 The estimate is not available.
+ */
+static int
+whereRangeStatEst(struct Parse *pParse, struct WhereTerm *pLower,
+		  struct WhereTerm *pUpper, struct WhereLoop *pLoop,
+		  LogEst *pnNew)
+{
+	if (pLoop->nEq != 0 || pLoop->index_def == NULL)
+		return -1;
+	if ((pLower != NULL && pLower->truthProb <= 0) ||
+	    (pUpper != NULL && pUpper->truthProb <= 0))
+		return -1;
+	bool is_lower_inclusive = pLower != NULL &&
+				  (pLower->eOperator & WO_GE) != 0;
+	bool is_upper_inclusive = pUpper != NULL &&
+				  (pUpper->eOperator & WO_LE) != 0;
+	where_add_plan_probe(pParse, pLoop->index_def, pLower,
+			     is_lower_inclusive, pUpper, is_upper_inclusive);
+	struct Mem lower, upper;
+	mem_create(&lower);
+	mem_create(&upper);
+	uint64_t count;
+	int rc = -1;
+	if ((pLower == NULL ||
+	     where_expr_value(pParse, pLower->pExpr->pRight, &lower)) &&
+	    (pUpper == NULL ||
+	     where_expr_value(pParse, pUpper->pExpr->pRight, &upper))) {
+		rc = sql_index_stat_range_est(pLoop->index_def,
+					      pLower != NULL ? &lower : NULL,
+					      is_lower_inclusive,
+					      pUpper != NULL ? &upper : NULL,
+					      is_upper_inclusive, &count);
+	}
+	mem_destroy(&lower);
+	mem_destroy(&upper);
+	if (rc == 0)
+		*pnNew = sqlLogEst(count);
+	return rc;
+}
+
+/**
+ * Estimate the number of rows matching an equality constraint on the
+ * first column of the index using statistics collected by ANALYZE.
+ *
+ * @retval 0 Success, *pnOut is set.
+ * @retval -1 The estimate is not available.
+ */
+static int
+whereEqualStatEst(struct Parse *pParse, struct index_def *probe,
+		  struct WhereTerm *pTerm, LogEst *pnOut)
+{
+	if ((pTerm->eOperator & WO_EQ) == 0 || pTerm->truthProb <= 0)
+		return -1;
+	where_add_plan_probe(pParse, probe, pTerm, true, pTerm, true);
+	struct Mem value;
+	mem_create(&value);
+	uint64_t count;
+	int rc = -1;
+	if (where_expr_value(pParse, pTerm->pExpr->pRight, &value))
+		rc = sql_index_stat_eq_est(probe, &value, &count);
+	mem_destroy(&value);
+	if (rc == 0)
+		*pnOut = sqlLogEst(count);
+	return rc;
+}
+
 /*
  * If it is not NULL, pTerm is a term that provides an upper or lower
  * bound on a range scan. Without considering pTerm, it is estimated
@@ -996,31 +1238,36 @@ whereRangeAdjust(WhereTerm * pTerm, LogEst nNew)
  * rows in the index. Assuming no error occurs, *pnOut is adjusted (reduced)
  * to account for the range constraints pLower and pUpper.
  *
- * In the absence of _sql_stat4 ANALYZE data, or if such data cannot be
- * used, a single range inequality reduces the search space by a factor of 4.
- * and a pair of constraints (x>? AND x<?) reduces the expected number of
- * rows visited by a factor of 64.
+ * If the range is on the first column of the index and the values of its
+ * bounds are known, the estimate is made using statistics collected by ANALYZE.
+ * In the absence of such data, or if it cannot be used, a single range
+ * inequality reduces the search space by a factor of 4. and a pair of
+ * constraints (x>? AND x<?) reduces the expected number of rows visited
+ * by a factor of 64.
  */
 static int
-whereRangeScanEst(struct WhereTerm *pLower, struct WhereTerm *pUpper,
-		  struct WhereLoop *pLoop)
+whereRangeScanEst(struct Parse *pParse, struct WhereTerm *pLower,
+		  struct WhereTerm *pUpper, struct WhereLoop *pLoop)
 {
 	int rc = 0;
 	int nOut = pLoop->nOut;
 	LogEst nNew;
 	assert(pUpper == 0 || (pUpper->wtFlags & TERM_VNULL) == 0);
-	nNew = whereRangeAdjust(pLower, nOut);
-	nNew = whereRangeAdjust(pUpper, nNew);
-
-	/* TUNING: If there is both an upper and lower limit and neither limit
-	 * has an application-defined likelihood(), assume the range is
-	 * reduced by an additional 75%. This means that, by default, an open-ended
-	 * range query (e.g. col > ?) is assumed to match 1/4 of the rows in the
-	 * index. While a closed range (e.g. col BETWEEN ? AND ?) is estimated to
-	 * match 1/64 of the index.
-	 */
-	if (pLower && pLower->truthProb > 0 && pUpper && pUpper->truthProb > 0) {
-		nNew -= 20;
+	if (whereRangeStatEst(pParse, pLower, pUpper, pLoop, &nNew) != 0) {
+		nNew = whereRangeAdjust(pLower, nOut);
+		nNew = whereRangeAdjust(pUpper, nNew);
+		/*
+		 * TUNING: If there is both an upper and lower limit and
+		 * neither limit has an application-defined likelihood(),
+		 * assume the range is reduced by an additional 75%. This
+		 * means that, by default, an open-ended range query (e.g.
+		 * col > ?) is assumed to match 1/4 of the rows in the
+		 * index. While a closed range (e.g. col BETWEEN ? AND ?) is
+		 * estimated to match 1/64 of the index.
+		 */
+		if (pLower && pLower->truthProb > 0 && pUpper &&
+		    pUpper->truthProb > 0)
+			nNew -= 20;
 	}
 
 	nOut -= (pLower != 0) + (pUpper != 0);
@@ -1902,19 +2149,25 @@ whereLoopAddBtreeIndex(WhereLoopBuilder * pBuilder,	/* The WhereLoop factory */
 		 */
 		assert(pNew->nOut == saved_nOut);
 		if (pNew->wsFlags & WHERE_COLUMN_RANGE) {
-			/* Adjust nOut using stat4 data. Or, if there is no stat4
-			 * data, using some other estimate.
+			/* Adjust nOut using ANALYZE statistics. Or, if there
+			 * are no statistics, using some other estimate.
 			 */
-			whereRangeScanEst(pBtm, pTop, pNew);
+			whereRangeScanEst(pParse, pBtm, pTop, pNew);
 		} else {
 			int nEq = ++pNew->nEq;
 			assert(eOp & (WO_ISNULL | WO_EQ | WO_IN));
 
 			assert(pNew->nOut == saved_nOut);
+			LogEst est;
 			if (pTerm->truthProb <= 0 && probe->space_id != 0) {
 				assert((eOp & WO_IN) || nIn == 0);
 				pNew->nOut += pTerm->truthProb;
 				pNew->nOut -= nIn;
+			} else if (saved_nEq == 0 &&
+				   whereEqualStatEst(pParse, probe, pTerm,
+						     &est) == 0) {
+				if (est < pNew->nOut)
+					pNew->nOut = est;
 			} else {
 				pNew->nOut +=
 					(index_field_tuple_est(probe, nEq) -
@@ -2164,31 +2417,61 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 		/* Generate auto-index WhereLoops */
 		WhereTerm *pTerm;
 		WhereTerm *pWCEnd = pWC->a + pWC->nTerm;
-		for (pTerm = pWC->a; rc == 0 && pTerm < pWCEnd; pTerm++) {
-			if (pTerm->prereqRight & pNew->maskSelf)
-				continue;
-			if (termCanDriveIndex(pTerm, pSrc, 0)) {
+		/*
+		 * A hash join is used instead of an ephemeral index
+		 * if the column values can be hashed and the space is
+		 * small enough for the hash table to fit in memory.
+		 * Its loops have a cheaper setup, so they are added
+		 * after the index ones to keep the SETUP-INVARIANT.
+		 */
+		int hash_loops = whereHashJoinFits(pSrc) ? 2 : 1;
+		for (int is_hash = 0; is_hash < hash_loops; is_hash++) {
+			for (pTerm = pWC->a; rc == 0 && pTerm < pWCEnd;
+			     pTerm++) {
+				if (pTerm->prereqRight & pNew->maskSelf)
+					continue;
+				if (!termCanDriveIndex(pTerm, pSrc, 0) ||
+				    termCanDriveHash(pTerm, pSrc) != is_hash)
+					continue;
 				pNew->nEq = 1;
 				pNew->nSkip = 0;
 				pNew->index_def = NULL;
 				pNew->nLTerm = 1;
 				pNew->aLTerm[0] = pTerm;
-				/*
-				 * TODO: At the moment we have decided to use
-				 * this formula, but it is quite aggressive and
-				 * needs tuning.
-				 */
-				pNew->rSetup = rLogSize + rSize;
-				/* TUNING: Each index lookup yields 20 rows in the table.  This
-				 * is more than the usual guess of 10 rows, since we have no way
-				 * of knowing how selective the index will ultimately be.  It would
-				 * not be unreasonable to make this value much larger.
+				/* TUNING: Each index lookup yields 20 rows in
+				 * the table.  This is more than the usual guess
+				 * of 10 rows, since we have no way of knowing
+				 * how selective the index will ultimately be.
+				 * It would not be unreasonable to make this
+				 * value much larger.
 				 */
 				pNew->nOut = 43;
 				assert(43 == sqlLogEst(20));
-				pNew->rRun =
-				    sqlLogEstAdd(rLogSize, pNew->nOut);
-				pNew->wsFlags = WHERE_AUTO_INDEX;
+				if (is_hash) {
+					/*
+					 * Building a hash table is a single
+					 * pass over the space. A lookup
+					 * hashes the key and compares it
+					 * with the records of the bucket,
+					 * which costs about as much as a
+					 * couple of tree comparisons.
+					 */
+					pNew->rSetup = rSize;
+					pNew->rRun =
+					    sqlLogEstAdd(10, pNew->nOut);
+					pNew->wsFlags = WHERE_AUTO_INDEX |
+							WHERE_HASH_JOIN;
+				} else {
+					/*
+					 * TODO: At the moment we have decided
+					 * to use this formula, but it is quite
+					 * aggressive and needs tuning.
+					 */
+					pNew->rSetup = rLogSize + rSize;
+					pNew->rRun =
+					    sqlLogEstAdd(rLogSize, pNew->nOut);
+					pNew->wsFlags = WHERE_AUTO_INDEX;
+				}
 				pNew->prereq = mPrereq | pTerm->prereqRight;
 				rc = whereLoopInsert(pBuilder, pNew);
 			}
@@ -2209,6 +2492,9 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 		/* Such index may possibly contain not all tuples, so skip it */
 		if (pSrc->pIBIndex == NULL && probe->key_def->has_exclude_null)
 			continue;
+		/* COLUMN index supports only full scans, so skip it. */
+		if (pSrc->pIBIndex == NULL && probe->type == COLUMN)
+			continue;
 		rSize = index_field_tuple_est(probe, 0);
 		pNew->nEq = 0;
 		pNew->nBtm = 0;
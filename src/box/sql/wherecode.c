@@ -217,7 +217,9 @@ sqlWhereExplainOneScan(Parse * pParse,	/* Parse context */
 
 			assert(!(flags & WHERE_AUTO_INDEX)
 			       || (flags & WHERE_IDX_ONLY));
-			if ((flags & WHERE_AUTO_INDEX) != 0) {
+			if ((flags & WHERE_HASH_JOIN) != 0) {
+				zFmt = "HASH INDEX";
+			} else if ((flags & WHERE_AUTO_INDEX) != 0) {
 				zFmt = "EPHEMERAL INDEX";
 			} else if (idx_def->iid == 0) {
 				if (is_search)
@@ -727,6 +729,23 @@ sqlWhereCodeOneLoopStart(WhereInfo * pWInfo,	/* Complete information about the W
 		pLevel->p2 = sqlVdbeAddOp2(v, OP_Yield, regYield, addrBrk);
 		VdbeComment((v, "next row of \"%s\"", pTabItem->space->def->name));
 		pLevel->op = OP_Goto;
+	} else if (pLoop->wsFlags & WHERE_HASH_JOIN) {
+		/* A lookup in the hash table of a hash join.
+		 *
+		 *         The table is built by constructAutomaticIndex() and
+		 *         keyed by the columns of the == constraints. Records
+		 *         with an equal key are visited with OP_HashNext.
+		 */
+		assert((pLoop->wsFlags & WHERE_AUTO_INDEX) != 0);
+		assert(omitTable);
+		int iIdxCur = pLevel->iIdxCur;
+		int regBase = codeAllEqualityTerms(pParse, pLevel, 0, 0);
+		addrNxt = pLevel->addrNxt;
+		sqlVdbeAddOp4Int(v, OP_HashSeek, iIdxCur, addrNxt, regBase,
+				 pLoop->nEq);
+		pLevel->p2 = sqlVdbeCurrentAddr(v);
+		pLevel->op = OP_HashNext;
+		pLevel->p1 = iIdxCur;
 	} else if (pLoop->wsFlags & WHERE_INDEXED) {
 		/* Case 4: A scan using an index.
 		 *
@@ -31,10 +31,14 @@
 #include "sql_stmt_cache.h"
 
 #include "assoc.h"
+#include "bind.h"
 #include "error.h"
 #include "execute.h"
 #include "diag.h"
 #include "info/info.h"
+#include "schema.h"
+#include "session.h"
+#include "sql/sqlInt.h"
 
 static struct sql_stmt_cache sql_stmt_cache;
 
@@ -45,6 +49,8 @@ sql_stmt_cache_init(void)
 	sql_stmt_cache.mem_quota = 0;
 	sql_stmt_cache.mem_used = 0;
 	rlist_create(&sql_stmt_cache.gc_queue);
+	sql_stmt_cache.shared = mh_strnptr_new();
+	rlist_create(&sql_stmt_cache.shared_lru);
 }
 
 void
@@ -57,15 +63,52 @@ sql_stmt_cache_stat(struct info_handler *h)
 	mh_int_t i;
 	mh_foreach(sql_stmt_cache.hash, i)
 		entry_count++;
+	entry_count += mh_size(sql_stmt_cache.shared);
 	info_append_int(h, "stmt_count", entry_count);
 	info_table_end(h);
 	info_end(h);
 }
 
+void
+sql_stmt_cache_debug_info(struct info_handler *h)
+{
+	info_append_int(h, "sql_cache_hit_count", sql_stmt_cache.hit_count);
+	info_append_int(h, "sql_cache_miss_count",
+			sql_stmt_cache.miss_count);
+}
+
 static size_t
-sql_cache_entry_sizeof(struct Vdbe *stmt)
+sql_cache_entry_sizeof(const struct stmt_cache_entry *entry)
+{
+	size_t size = sizeof(*entry) + entry->sql_len +
+		      sql_stmt_est_size(entry->stmt);
+	for (uint32_t i = 0; i < entry->variant_count; i++)
+		size += sql_stmt_est_size(entry->variants[i]);
+	return size;
+}
+
+/** Return true if a statement of the entry executes right now. */
+static bool
+sql_cache_entry_is_busy(const struct stmt_cache_entry *entry)
+{
+	if (sql_stmt_busy(entry->stmt))
+		return true;
+	for (uint32_t i = 0; i < entry->variant_count; i++) {
+		if (sql_stmt_busy(entry->variants[i]))
+			return true;
+	}
+	return false;
+}
+
+/** Finalize plan variants of the entry. */
+static void
+sql_cache_entry_drop_variants(struct stmt_cache_entry *entry)
 {
-	return sql_stmt_est_size(stmt) + sizeof(struct stmt_cache_entry);
+	for (uint32_t i = 0; i < entry->variant_count; i++) {
+		assert(!sql_stmt_busy(entry->variants[i]));
+		sql_stmt_finalize(entry->variants[i]);
+	}
+	entry->variant_count = 0;
 }
 
 static void
@@ -73,6 +116,7 @@ sql_cache_entry_delete(struct stmt_cache_entry *entry)
 {
 	assert(entry->refs == 0);
 	assert(! sql_stmt_busy(entry->stmt));
+	sql_cache_entry_drop_variants(entry);
 	sql_stmt_finalize(entry->stmt);
 	TRASH(entry);
 	free(entry);
@@ -125,22 +169,70 @@ sql_stmt_cache_gc(void)
 	assert(rlist_empty(&sql_stmt_cache.gc_queue));
 }
 
+/**
+ * Remove shared statement entry from cache: remove it from hash
+ * and LRU list, account cache size changes and release occupied
+ * memory.
+ */
+static void
+sql_stmt_cache_shared_delete(struct stmt_cache_entry *entry)
+{
+	struct mh_strnptr_t *hash = sql_stmt_cache.shared;
+	mh_int_t i = mh_strnptr_find_str(hash, entry->sql, entry->sql_len);
+	assert(i != mh_end(hash));
+	mh_strnptr_del(hash, i, NULL);
+	sql_stmt_cache.mem_used -= entry->size;
+	rlist_del(&entry->link);
+	sql_cache_entry_delete(entry);
+}
+
+/**
+ * Release memory of the cache until at most @a limit bytes are
+ * used: delete deallocated prepared statements and then the least
+ * recently used shared statements which are not executed right now.
+ */
+static void
+sql_stmt_cache_shrink(size_t limit)
+{
+	sql_stmt_cache_gc();
+	struct stmt_cache_entry *entry, *next;
+	rlist_foreach_entry_safe(entry, &sql_stmt_cache.shared_lru,
+				 link, next) {
+		if (sql_stmt_cache.mem_used <= limit)
+			break;
+		if (!sql_cache_entry_is_busy(entry))
+			sql_stmt_cache_shared_delete(entry);
+	}
+}
+
 /**
  * Allocate new cache entry containing given prepared statement.
  * Add it to the LRU cache list. Account cache size enlargement.
+ * The normalized text of a shared statement is copied to the entry.
  */
 static struct stmt_cache_entry *
-sql_cache_entry_new(struct Vdbe *stmt)
+sql_cache_entry_new(struct Vdbe *stmt, const char *sql, uint32_t len)
 {
-	struct stmt_cache_entry *entry = malloc(sizeof(*entry));
+	size_t size = sizeof(struct stmt_cache_entry) + len;
+	struct stmt_cache_entry *entry = malloc(size);
 	if (entry == NULL) {
-		diag_set(OutOfMemory, sizeof(*entry), "malloc",
+		diag_set(OutOfMemory, size, "malloc",
 			 "struct stmt_cache_entry");
 		return NULL;
 	}
 	entry->stmt = stmt;
+	entry->variant_count = 0;
+	entry->sql = NULL;
+	entry->sql_len = len;
+	if (sql != NULL) {
+		char *str = (char *)(entry + 1);
+		memcpy(str, sql, len);
+		entry->sql = str;
+	}
+	entry->sql_flags = 0;
 	entry->link = (struct rlist) { NULL, NULL };
 	entry->refs = 0;
+	entry->size = sql_cache_entry_sizeof(entry);
 	return entry;
 }
 
@@ -154,6 +246,20 @@ sql_cache_check_new_entry_size(size_t size)
 	return (sql_stmt_cache.mem_used + size <= sql_stmt_cache.mem_quota);
 }
 
+/**
+ * Try to release memory of the cache to fit a new statement of
+ * @a size bytes into the memory quota.
+ */
+static bool
+sql_stmt_cache_reserve(size_t size)
+{
+	if (sql_cache_check_new_entry_size(size))
+		return true;
+	size_t quota = sql_stmt_cache.mem_quota;
+	sql_stmt_cache_shrink(quota > size ? quota - size : 0);
+	return sql_cache_check_new_entry_size(size);
+}
+
 static void
 sql_stmt_cache_entry_unref(struct stmt_cache_entry *entry)
 {
@@ -172,7 +278,7 @@ sql_stmt_cache_entry_unref(struct stmt_cache_entry *entry)
 		assert(i != mh_end(cache->hash));
 		mh_i32ptr_del(cache->hash, i, NULL);
 		rlist_add(&sql_stmt_cache.gc_queue, &entry->link);
-		sql_stmt_cache.mem_used -= sql_cache_entry_sizeof(entry->stmt);
+		sql_stmt_cache.mem_used -= entry->size;
 		if (sql_stmt_cache.last_found == entry)
 			sql_stmt_cache.last_found = NULL;
 	}
@@ -218,14 +324,26 @@ sql_stmt_unref(uint32_t stmt_id)
 	sql_stmt_cache_entry_unref(entry);
 }
 
+bool
+sql_stmt_cache_is_busy(uint32_t stmt_id)
+{
+	struct stmt_cache_entry *entry = stmt_cache_find_entry(stmt_id);
+	assert(entry != NULL);
+	return sql_cache_entry_is_busy(entry);
+}
+
 int
 sql_stmt_cache_update(struct Vdbe *old_stmt, struct Vdbe *new_stmt)
 {
 	const char *sql_str = sql_stmt_query_str(old_stmt);
 	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
 	struct stmt_cache_entry *entry = stmt_cache_find_entry(stmt_id);
+	sql_cache_entry_drop_variants(entry);
 	sql_stmt_finalize(entry->stmt);
 	entry->stmt = new_stmt;
+	sql_stmt_cache.mem_used -= entry->size;
+	entry->size = sql_cache_entry_sizeof(entry);
+	sql_stmt_cache.mem_used += entry->size;
 	return 0;
 }
 
@@ -234,32 +352,31 @@ sql_stmt_cache_insert(struct Vdbe *stmt)
 {
 	assert(stmt != NULL);
 	struct sql_stmt_cache *cache = &sql_stmt_cache;
-	size_t new_entry_size = sql_cache_entry_sizeof(stmt);
-
-	if (! sql_cache_check_new_entry_size(new_entry_size))
-		sql_stmt_cache_gc();
+	size_t new_entry_size = sql_stmt_est_size(stmt) +
+				sizeof(struct stmt_cache_entry);
 	/*
-	 * Test memory limit again. Raise an error if it is
-	 * still overcrowded.
+	 * Release deallocated and shared statements and test
+	 * memory limit again. Raise an error if it is still
+	 * overcrowded.
 	 */
-	if (! sql_cache_check_new_entry_size(new_entry_size)) {
+	if (! sql_stmt_cache_reserve(new_entry_size)) {
 		diag_set(ClientError, ER_SQL_PREPARE, "Memory limit for SQL "\
 			"prepared statements has been reached. Please, deallocate "\
 			"active statements or increase SQL cache size.");
 		return -1;
 	}
 	struct mh_i32ptr_t *hash = cache->hash;
-	struct stmt_cache_entry *entry = sql_cache_entry_new(stmt);
+	struct stmt_cache_entry *entry = sql_cache_entry_new(stmt, NULL, 0);
 	if (entry == NULL)
 		return -1;
 	const char *sql_str = sql_stmt_query_str(stmt);
 	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
-	assert(sql_stmt_cache_find(stmt_id) == NULL);
+	assert(stmt_cache_find_entry(stmt_id) == NULL);
 	const struct mh_i32ptr_node_t id_node = { stmt_id, entry };
 	struct mh_i32ptr_node_t *old_node = NULL;
 	mh_i32ptr_put(hash, &id_node, &old_node, NULL);
 	assert(old_node == NULL);
-	sql_stmt_cache.mem_used += sql_cache_entry_sizeof(stmt);
+	sql_stmt_cache.mem_used += entry->size;
 	return 0;
 }
 
@@ -267,16 +384,162 @@ struct Vdbe *
 sql_stmt_cache_find(uint32_t stmt_id)
 {
 	struct stmt_cache_entry *entry = stmt_cache_find_entry(stmt_id);
-	if (entry == NULL)
+	if (entry == NULL) {
+		sql_stmt_cache.miss_count++;
 		return NULL;
+	}
+	sql_stmt_cache.hit_count++;
 	return entry->stmt;
 }
 
+/**
+ * Return the variant of the entry statement compiled for the plan
+ * class of the parameters bound to the statement, compiling it if
+ * there is no such variant yet. The variant is bound to the same
+ * parameters. If the variant can't be used, the statement itself
+ * is returned.
+ */
+static struct Vdbe *
+sql_cache_entry_plan(struct stmt_cache_entry *entry,
+		     const struct sql_bind *bind, uint32_t bind_count)
+{
+	struct Vdbe *stmt = entry->stmt;
+	uint32_t plan_class;
+	if (!sql_stmt_plan_class(stmt, &plan_class))
+		return stmt;
+	struct Vdbe *variant = NULL;
+	for (uint32_t i = 0; i < entry->variant_count; i++) {
+		if (entry->variant_classes[i] == plan_class) {
+			variant = entry->variants[i];
+			break;
+		}
+	}
+	if (variant == NULL) {
+		if (entry->variant_count == SQL_STMT_VARIANT_MAX)
+			return stmt;
+		sql_stmt_cache.miss_count++;
+		const char *sql_str = sql_stmt_query_str(stmt);
+		if (sql_stmt_compile_bound(sql_str, strlen(sql_str), stmt,
+					   &variant) != 0) {
+			diag_clear(diag_get());
+			return stmt;
+		}
+		size_t size = sql_stmt_est_size(variant);
+		if (!sql_stmt_cache_reserve(size)) {
+			sql_stmt_finalize(variant);
+			return stmt;
+		}
+		entry->variants[entry->variant_count] = variant;
+		entry->variant_classes[entry->variant_count] = plan_class;
+		entry->variant_count++;
+		entry->size += size;
+		sql_stmt_cache.mem_used += size;
+	} else if (sql_stmt_busy(variant)) {
+		return stmt;
+	}
+	sql_unbind(variant);
+	if (sql_bind(variant, bind, bind_count) != 0) {
+		diag_clear(diag_get());
+		return stmt;
+	}
+	return variant;
+}
+
+struct Vdbe *
+sql_stmt_cache_plan(uint32_t stmt_id, const struct sql_bind *bind,
+		    uint32_t bind_count)
+{
+	struct stmt_cache_entry *entry = stmt_cache_find_entry(stmt_id);
+	assert(entry != NULL && entry->refs > 0);
+	return sql_cache_entry_plan(entry, bind, bind_count);
+}
+
+/**
+ * Compile a shared statement and add it to the cache. Return
+ * NULL if the statement is invalid or doesn't fit the cache.
+ */
+static struct stmt_cache_entry *
+sql_stmt_cache_shared_new(const char *sql, uint32_t len)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	cache->miss_count++;
+	struct Vdbe *stmt;
+	if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
+		return NULL;
+	size_t size = sql_stmt_est_size(stmt) +
+		      sizeof(struct stmt_cache_entry) + len;
+	struct stmt_cache_entry *entry;
+	if (!sql_stmt_cache_reserve(size) ||
+	    (entry = sql_cache_entry_new(stmt, sql, len)) == NULL) {
+		sql_stmt_finalize(stmt);
+		return NULL;
+	}
+	entry->sql_flags = current_session()->sql_flags;
+	const struct mh_strnptr_node_t node = {
+		entry->sql, len, mh_strn_hash(entry->sql, len), entry
+	};
+	mh_strnptr_put(cache->shared, &node, NULL, NULL);
+	cache->mem_used += entry->size;
+	return entry;
+}
+
+struct Vdbe *
+sql_stmt_cache_get(const char *sql, uint32_t len, const struct sql_bind *bind,
+		   uint32_t bind_count)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	if (cache->mem_quota == 0)
+		return NULL;
+	struct stmt_cache_entry *entry = NULL;
+	mh_int_t i = mh_strnptr_find_str(cache->shared, sql, len);
+	if (i != mh_end(cache->shared)) {
+		entry = mh_strnptr_node(cache->shared, i)->val;
+		if (sql_stmt_busy(entry->stmt))
+			return NULL;
+		/*
+		 * The statement is compiled again if the schema or
+		 * the SQL settings which it depends on are changed.
+		 */
+		if (sql_stmt_schema_version(entry->stmt) !=
+		    box_schema_version() ||
+		    entry->sql_flags != current_session()->sql_flags) {
+			if (sql_cache_entry_is_busy(entry))
+				return NULL;
+			sql_stmt_cache_shared_delete(entry);
+			entry = NULL;
+		}
+	}
+	if (entry == NULL) {
+		entry = sql_stmt_cache_shared_new(sql, len);
+		if (entry == NULL) {
+			diag_clear(diag_get());
+			return NULL;
+		}
+	} else {
+		cache->hit_count++;
+		rlist_del(&entry->link);
+	}
+	/*
+	 * The entry is out of the LRU list until the plan is chosen,
+	 * so it can't be evicted to store its new plan variant.
+	 */
+	struct Vdbe *stmt = entry->stmt;
+	sql_unbind(stmt);
+	if (sql_bind(stmt, bind, bind_count) != 0) {
+		diag_clear(diag_get());
+		stmt = NULL;
+	} else {
+		stmt = sql_cache_entry_plan(entry, bind, bind_count);
+	}
+	rlist_add_tail(&cache->shared_lru, &entry->link);
+	return stmt;
+}
+
 int
 sql_stmt_cache_set_size(size_t size)
 {
 	if (sql_stmt_cache.mem_used > size)
-		sql_stmt_cache_gc();
+		sql_stmt_cache_shrink(size);
 	if (sql_stmt_cache.mem_used > size) {
 		diag_set(ClientError, ER_SQL_PREPARE, "Can't reduce memory "\
 			 "limit for SQL prepared statements: please, deallocate "\
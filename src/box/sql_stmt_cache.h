@@ -30,6 +30,7 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -41,13 +42,38 @@ extern "C" {
 
 struct mh_i64ptr_t;
 struct info_handler;
+struct sql_bind;
+
+/** Maximal number of plan variants of a cached statement. */
+enum { SQL_STMT_VARIANT_MAX = 4 };
 
 struct stmt_cache_entry {
 	/** Prepared statement itself. */
 	struct Vdbe *stmt;
+	/**
+	 * The statement compiled for the parameter values of
+	 * different plan classes, see sql_stmt_plan_class().
+	 */
+	struct Vdbe *variants[SQL_STMT_VARIANT_MAX];
+	/** Plan classes of the variants. */
+	uint32_t variant_classes[SQL_STMT_VARIANT_MAX];
+	/** Number of the variants. */
+	uint32_t variant_count;
+	/** Size of memory occupied by the entry and its statements. */
+	size_t size;
+	/**
+	 * Normalized text of a shared statement, see
+	 * sql_stmt_cache_get(). NULL for prepared statements.
+	 */
+	const char *sql;
+	/** Length of the normalized text. */
+	uint32_t sql_len;
+	/** Session SQL flags a shared statement is compiled with. */
+	uint32_t sql_flags;
 	/**
 	 * Link to the next entry. All statements are to be
-	 * evicted on the next gc cycle.
+	 * evicted on the next gc cycle. Shared statements are
+	 * linked into the LRU list instead.
 	 */
 	struct rlist link;
 	/**
@@ -81,6 +107,20 @@ struct sql_stmt_cache {
 	 * times.
 	 */
 	struct stmt_cache_entry *last_found;
+	/**
+	 * Normalized query text -> struct stmt_cache_entry hash of
+	 * statements executed without preparation.
+	 */
+	struct mh_strnptr_t *shared;
+	/**
+	 * Shared statements, the least recently used first. They
+	 * are evicted when the memory is needed for other ones.
+	 */
+	struct rlist shared_lru;
+	/** Number of statements found in the cache. */
+	uint64_t hit_count;
+	/** Number of statements and plan variants compiled. */
+	uint64_t miss_count;
 };
 
 /**
@@ -97,6 +137,13 @@ sql_stmt_cache_init(void);
 void
 sql_stmt_cache_stat(struct info_handler *h);
 
+/**
+ * Append cache hit and miss counters to the statistics of
+ * SQL reported to info handler @h.
+ */
+void
+sql_stmt_cache_debug_info(struct info_handler *h);
+
 /**
  * Erase session local hash: unref statements belong to this
  * session and deallocate hash itself.
@@ -124,6 +171,13 @@ sql_stmt_calculate_id(const char *sql_str, size_t len);
 void
 sql_stmt_unref(uint32_t stmt_id);
 
+/**
+ * Return true if prepared statement @a stmt_id or one of its plan
+ * variants executes right now.
+ */
+bool
+sql_stmt_cache_is_busy(uint32_t stmt_id);
+
 /** Update prepared statement in the prepared statement cache. */
 int
 sql_stmt_cache_update(struct Vdbe *old_stmt, struct Vdbe *new_stmt);
@@ -141,6 +195,35 @@ sql_stmt_cache_insert(struct Vdbe *stmt);
 struct Vdbe *
 sql_stmt_cache_find(uint32_t stmt_id);
 
+/**
+ * Choose the plan to execute prepared statement @a stmt_id with.
+ * The parameters @a bind must be already bound to the statement.
+ * If the plan of the statement depends on the parameter values,
+ * the statement compiled for their plan class is found or compiled
+ * and bound to the same parameters. Otherwise, or if the variant
+ * can't be used right now, the prepared statement itself is
+ * returned.
+ */
+struct Vdbe *
+sql_stmt_cache_plan(uint32_t stmt_id, const struct sql_bind *bind,
+		    uint32_t bind_count);
+
+/**
+ * Find or compile a statement executed without preparation and
+ * bind the parameters to it. The statement is shared by all
+ * sessions with the same SQL settings, so @a sql is expected to be
+ * normalized with sql_normalize(). Shared statements use the memory
+ * quota of prepared statements and are evicted in LRU order.
+ *
+ * @retval NULL The statement can't be cached or executed right now,
+ *         or it or its parameters are invalid. The diagnostics area
+ *         is not set, the caller should compile the statement itself.
+ * @retval Statement to execute, it is left in the cache.
+ */
+struct Vdbe *
+sql_stmt_cache_get(const char *sql, uint32_t len, const struct sql_bind *bind,
+		   uint32_t bind_count);
+
 
 /** Set prepared cache size limit. */
 int
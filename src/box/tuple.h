@@ -403,6 +403,12 @@ enum tuple_flag {
 	 * immediately while a snapshot is in progress.
 	 */
 	TUPLE_IS_TEMPORARY = 2,
+	/**
+	 * Some fields of the tuple are stored in the MP_COMPRESSION
+	 * MsgPack extension so the tuple must be decompressed before
+	 * it is returned to the user.
+	 */
+	TUPLE_IS_COMPRESSED = 3,
 	tuple_flag_MAX,
 };
 
@@ -781,7 +787,7 @@ tuple_format(struct tuple *tuple)
 static inline bool
 tuple_is_compressed(struct tuple *tuple)
 {
-        return tuple_format(tuple)->is_compressed;
+	return tuple_has_flag(tuple, TUPLE_IS_COMPRESSED);
 }
 
 /**
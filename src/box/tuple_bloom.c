@@ -163,6 +163,7 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 	}
 
 	bloom->is_legacy = false;
+	bloom->version = BLOOM_VERSION_SPLIT_BLOCK;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
@@ -180,7 +181,8 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 		for (uint32_t j = 0; j < i; j++)
 			part_fpr /= bloom_fpr(&bloom->parts[j], count);
 		part_fpr = MIN(part_fpr, 0.5);
-		if (bloom_create(&bloom->parts[i], count, part_fpr) != 0) {
+		if (bloom_create(&bloom->parts[i], count, part_fpr,
+				 bloom->version) != 0) {
 			diag_set(OutOfMemory, 0, "bloom_create",
 				 "tuple bloom part");
 			tuple_bloom_delete(bloom);
@@ -282,13 +284,15 @@ tuple_bloom_encode_part(const struct bloom *part, char *buf)
 }
 
 static int
-tuple_bloom_decode_part(struct bloom *part, const char **data)
+tuple_bloom_decode_part(struct bloom *part, const char **data,
+			enum bloom_version version)
 {
 	memset(part, 0, sizeof(*part));
 	if (mp_decode_array(data) != 3)
 		unreachable();
 	part->table_size = mp_decode_uint(data);
 	part->hash_count = mp_decode_uint(data);
+	part->version = version;
 	size_t store_size = mp_decode_binl(data);
 	assert(store_size == bloom_store_size(part));
 	if (bloom_load_table(part, *data) != 0) {
@@ -320,7 +324,7 @@ tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf)
 }
 
 struct tuple_bloom *
-tuple_bloom_decode(const char **data)
+tuple_bloom_decode(const char **data, enum bloom_version version)
 {
 	uint32_t part_count = mp_decode_array(data);
 	struct tuple_bloom *bloom = malloc(sizeof(*bloom) +
@@ -333,10 +337,12 @@ tuple_bloom_decode(const char **data)
 	}
 
 	bloom->is_legacy = false;
+	bloom->version = version;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
-		if (tuple_bloom_decode_part(&bloom->parts[i], data) != 0) {
+		if (tuple_bloom_decode_part(&bloom->parts[i], data,
+					    version) != 0) {
 			tuple_bloom_delete(bloom);
 			return NULL;
 		}
@@ -357,6 +363,7 @@ tuple_bloom_decode_legacy(const char **data)
 	}
 
 	bloom->is_legacy = true;
+	bloom->version = BLOOM_VERSION_BLOCKED;
 	bloom->part_count = 1;
 
 	if (mp_decode_array(data) != 4)
@@ -366,6 +373,7 @@ tuple_bloom_decode_legacy(const char **data)
 
 	bloom->parts[0].table_size = mp_decode_uint(data);
 	bloom->parts[0].hash_count = mp_decode_uint(data);
+	bloom->parts[0].version = BLOOM_VERSION_BLOCKED;
 
 	size_t store_size = mp_decode_binl(data);
 	assert(store_size == bloom_store_size(&bloom->parts[0]));
@@ -58,6 +58,8 @@ struct tuple_bloom {
 	 * (see tuple_bloom_decode_legacy).
 	 */
 	bool is_legacy;
+	/** Table layout of the bloom filters, see enum bloom_version. */
+	enum bloom_version version;
 	/** Number of key parts. */
 	uint32_t part_count;
 	/** Array of bloom filters, one per each partial key. */
@@ -214,10 +216,11 @@ tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf);
  * Decode a tuple bloom filter from MsgPack.
  * @param data - pointer to buffer storing encoded bloom filter;
  *  on success it is advanced by the number of decoded bytes
+ * @param version - table layout of the encoded bloom filter
  * @return the decoded bloom on success or NULL on OOM
  */
 struct tuple_bloom *
-tuple_bloom_decode(const char **data);
+tuple_bloom_decode(const char **data, enum bloom_version version);
 
 /**
  * Decode a legacy bloom filter from MsgPack.
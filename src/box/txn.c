@@ -42,9 +42,12 @@
 #include "session.h"
 #include "wal_ext.h"
 #include "rmean.h"
+#include "latency_histogram.h"
 
 double too_long_threshold;
 
+struct latency_histogram txn_wal_latency;
+
 /**
  * Incremental counter for psn (prepare sequence number) of a transaction.
  * The next prepared transaction will get psn == txn_next_psn++.
@@ -831,6 +834,7 @@ txn_on_journal_write(struct journal_entry *entry)
 	}
 	double stop_tm = ev_monotonic_now(loop());
 	double delta = stop_tm - txn->start_tm;
+	latency_histogram_collect(&txn_wal_latency, delta * 1e9);
 	if (delta > too_long_threshold) {
 		int n_rows = txn->n_new_rows + txn->n_applier_rows;
 		say_warn_ratelimited("too long WAL write: %d rows at LSN %lld: "
@@ -59,6 +59,7 @@ struct space;
 struct tuple;
 struct xrow_header;
 struct Vdbe;
+struct latency_histogram;
 
 enum txn_flag {
 	/** Transaction has been processed. */
@@ -369,6 +370,9 @@ struct txn_ro_savepoint {
 
 extern double too_long_threshold;
 
+/** Latency of WAL writes, collected in the tx thread. */
+extern struct latency_histogram txn_wal_latency;
+
 /**
  * An element of list of autogenerated ids, being returned as SQL
  * response metadata.
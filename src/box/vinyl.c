@@ -299,7 +299,14 @@ vy_info_append_memory(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "tuple", env->stmt_env.sum_tuple_size);
 	info_append_int(h, "tuple_cache", env->cache_env.mem_used);
 	info_append_int(h, "page_index", env->lsm_env.page_index_size);
-	info_append_int(h, "bloom_filter", env->lsm_env.bloom_size);
+	/*
+	 * If the bloom filter memory is limited, bloom filters may be
+	 * freed so report the size of those that are loaded.
+	 */
+	size_t bloom_size = env->run_env.bloom_memory_limit > 0 ?
+			    env->run_env.bloom_memory_used :
+			    env->lsm_env.bloom_size;
+	info_append_int(h, "bloom_filter", bloom_size);
 	info_table_end(h); /* memory */
 }
 
@@ -433,6 +440,8 @@ vinyl_index_stat(struct index *index, struct info_handler *h)
 	info_table_begin(h, "cache");
 	vy_info_append_stmt_counter(h, NULL, &cache_stat->count);
 	info_append_int(h, "lookup", cache_stat->lookup);
+	info_append_int(h, "hit", cache_stat->hit);
+	info_append_int(h, "miss", cache_stat->lookup - cache_stat->hit);
 	vy_info_append_stmt_counter(h, "get", &cache_stat->get);
 	vy_info_append_stmt_counter(h, "put", &cache_stat->put);
 	vy_info_append_stmt_counter(h, "invalidate", &cache_stat->invalidate);
@@ -495,6 +504,7 @@ vinyl_index_reset_stat(struct index *index)
 
 	/* Cache */
 	cache_stat->lookup = 0;
+	cache_stat->hit = 0;
 	vy_stmt_counter_reset(&cache_stat->get);
 	vy_stmt_counter_reset(&cache_stat->put);
 	vy_stmt_counter_reset(&cache_stat->invalidate);
@@ -678,6 +688,15 @@ vinyl_space_check_index_def(struct space *space, struct index_def *index_def)
 			 "hint is only reasonable with memtx tree index");
 		return -1;
 	}
+	if (index_def->opts.adaptive_hash_size > 0 &&
+	    recovery_state == FINISHED_RECOVERY) {
+		/* Silenced during recovery for the same reason as hint. */
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "adaptive hash is only reasonable with memtx tree "
+			 "index");
+		return -1;
+	}
 
 	struct key_def *key_def = index_def->key_def;
 
@@ -923,6 +942,7 @@ vinyl_index_update_def(struct index *index)
 {
 	struct vy_lsm *lsm = vy_lsm(index);
 	lsm->opts = index->def->opts;
+	lsm->cache.mem_quota = lsm->opts.cache_size;
 	/*
 	 * Sic: We copy key definitions in-place instead of reallocating them
 	 * because they may be used by read iterators by pointer, for example,
@@ -2755,6 +2775,13 @@ vinyl_engine_set_cache(struct engine *engine, size_t quota)
 	vy_cache_env_set_quota(&env->cache_env, quota);
 }
 
+void
+vinyl_engine_set_bloom_memory(struct engine *engine, size_t limit)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_bloom_memory_limit(&env->run_env, limit);
+}
+
 int
 vinyl_engine_set_memory(struct engine *engine, size_t size)
 {
@@ -57,6 +57,12 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *handler);
 void
 vinyl_engine_set_cache(struct engine *engine, size_t quota);
 
+/**
+ * Update max size of memory used by vinyl bloom filters.
+ */
+void
+vinyl_engine_set_bloom_memory(struct engine *engine, size_t limit);
+
 /**
  * Update vinyl memory size.
  */
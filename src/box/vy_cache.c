@@ -50,13 +50,17 @@ enum {
 	/* Max number of deletes that are made by cleanup action per one
 	 * cache operation */
 	VY_CACHE_CLEANUP_MAX_STEPS = 10,
+	/* Max size of the protected LRU segment, in percent of quota */
+	VY_CACHE_PROTECTED_PERCENT = 80,
 };
 
 void
 vy_cache_env_create(struct vy_cache_env *e, struct slab_cache *slab_cache)
 {
 	rlist_create(&e->cache_lru);
+	rlist_create(&e->protected_lru);
 	e->mem_used = 0;
+	e->protected_mem_used = 0;
 	e->mem_quota = 0;
 	mempool_create(&e->cache_node_mempool, slab_cache,
 		       sizeof(struct vy_cache_node));
@@ -104,8 +108,12 @@ vy_cache_node_new(struct vy_cache_env *env, struct vy_cache *cache,
 	node->flags = 0;
 	node->left_boundary_level = cache->cmp_def->part_count;
 	node->right_boundary_level = cache->cmp_def->part_count;
+	node->is_protected = false;
 	rlist_add(&env->cache_lru, &node->in_lru);
-	env->mem_used += vy_cache_node_size(node);
+	rlist_add(&cache->lru, &node->in_cache_lru);
+	size_t size = vy_cache_node_size(node);
+	env->mem_used += size;
+	cache->mem_used += size;
 	vy_stmt_counter_acct_tuple(&cache->stat.count, entry.stmt);
 	return node;
 }
@@ -113,16 +121,49 @@ vy_cache_node_new(struct vy_cache_env *env, struct vy_cache *cache,
 static void
 vy_cache_node_delete(struct vy_cache_env *env, struct vy_cache_node *node)
 {
-	vy_stmt_counter_unacct_tuple(&node->cache->stat.count,
-				     node->entry.stmt);
-	assert(env->mem_used >= vy_cache_node_size(node));
-	env->mem_used -= vy_cache_node_size(node);
+	struct vy_cache *cache = node->cache;
+	vy_stmt_counter_unacct_tuple(&cache->stat.count, node->entry.stmt);
+	size_t size = vy_cache_node_size(node);
+	assert(env->mem_used >= size);
+	assert(cache->mem_used >= size);
+	env->mem_used -= size;
+	cache->mem_used -= size;
+	if (node->is_protected) {
+		assert(env->protected_mem_used >= size);
+		env->protected_mem_used -= size;
+	}
 	tuple_unref(node->entry.stmt);
 	rlist_del(&node->in_lru);
+	rlist_del(&node->in_cache_lru);
 	TRASH(node);
 	mempool_free(&env->cache_node_mempool, node);
 }
 
+/**
+ * Move a node to the head of the protected LRU segment. If the
+ * segment gets too big, its oldest nodes are moved back to the
+ * probation segment.
+ */
+static void
+vy_cache_node_promote(struct vy_cache_env *env, struct vy_cache_node *node)
+{
+	rlist_move(&env->protected_lru, &node->in_lru);
+	rlist_move(&node->cache->lru, &node->in_cache_lru);
+	if (node->is_protected)
+		return;
+	node->is_protected = true;
+	env->protected_mem_used += vy_cache_node_size(node);
+	size_t quota = env->mem_quota / 100 * VY_CACHE_PROTECTED_PERCENT;
+	while (env->protected_mem_used > quota) {
+		struct vy_cache_node *victim =
+			rlist_last_entry(&env->protected_lru,
+					 struct vy_cache_node, in_lru);
+		victim->is_protected = false;
+		env->protected_mem_used -= vy_cache_node_size(victim);
+		rlist_move(&env->cache_lru, &victim->in_lru);
+	}
+}
+
 static void *
 vy_cache_tree_page_alloc(void *ctx)
 {
@@ -151,6 +192,9 @@ vy_cache_create(struct vy_cache *cache, struct vy_cache_env *env,
 	cache->cmp_def = cmp_def;
 	cache->is_primary = is_primary;
 	cache->version = 1;
+	rlist_create(&cache->lru);
+	cache->mem_used = 0;
+	cache->mem_quota = 0;
 	vy_cache_tree_create(&cache->cache_tree, cmp_def,
 			     vy_cache_tree_page_alloc,
 			     vy_cache_tree_page_free, env, NULL);
@@ -172,12 +216,10 @@ vy_cache_destroy(struct vy_cache *cache)
 	vy_cache_tree_destroy(&cache->cache_tree);
 }
 
+/** Remove a node from its cache and free it. */
 static void
-vy_cache_gc_step(struct vy_cache_env *env)
+vy_cache_node_evict(struct vy_cache_node *node)
 {
-	struct rlist *lru = &env->cache_lru;
-	struct vy_cache_node *node =
-		rlist_last_entry(lru, struct vy_cache_node, in_lru);
 	struct vy_cache *cache = node->cache;
 	struct vy_cache_tree *tree = &cache->cache_tree;
 	if (node->flags & (VY_CACHE_LEFT_LINKED | VY_CACHE_RIGHT_LINKED)) {
@@ -209,6 +251,17 @@ vy_cache_gc_step(struct vy_cache_env *env)
 	vy_cache_node_delete(cache->env, node);
 }
 
+static void
+vy_cache_gc_step(struct vy_cache_env *env)
+{
+	/* Nodes of the probation segment are evicted first. */
+	struct rlist *lru = &env->cache_lru;
+	if (rlist_empty(lru))
+		lru = &env->protected_lru;
+	vy_cache_node_evict(rlist_last_entry(lru, struct vy_cache_node,
+					     in_lru));
+}
+
 static void
 vy_cache_gc(struct vy_cache_env *env)
 {
@@ -219,6 +272,26 @@ vy_cache_gc(struct vy_cache_env *env)
 	}
 }
 
+/**
+ * Evict the least recently used nodes of the given cache until
+ * a node of the given size fits in its own quota. Returns false
+ * if it still doesn't fit.
+ */
+static bool
+vy_cache_gc_own(struct vy_cache *cache, size_t size)
+{
+	for (uint32_t i = 0; i < VY_CACHE_CLEANUP_MAX_STEPS; i++) {
+		if (cache->mem_used + size <= cache->mem_quota)
+			return true;
+		if (rlist_empty(&cache->lru))
+			return false;
+		vy_cache_node_evict(rlist_last_entry(&cache->lru,
+						     struct vy_cache_node,
+						     in_cache_lru));
+	}
+	return cache->mem_used + size <= cache->mem_quota;
+}
+
 void
 vy_cache_env_set_quota(struct vy_cache_env *env, size_t quota)
 {
@@ -263,6 +336,14 @@ vy_cache_add(struct vy_cache *cache, struct vy_entry curr,
 		return;
 	}
 
+	/*
+	 * If the current statement is set, it was read by the caller,
+	 * so if it's already in the cache, it's a cache hit. Otherwise
+	 * the search has ended and prev is added to the cache again to
+	 * update its boundary level.
+	 */
+	bool is_access = curr.stmt != NULL;
+
 	int direction = iterator_direction(order);
 	/**
 	 * Let's determine boundary_level (left/right) of the new record
@@ -301,6 +382,26 @@ vy_cache_add(struct vy_cache *cache, struct vy_entry curr,
 	}
 	TRASH(&order);
 
+	size_t node_size = sizeof(struct vy_cache_node);
+	if (cache->is_primary)
+		node_size += tuple_size(curr.stmt);
+	if (cache->mem_quota != 0 &&
+	    cache->mem_used + node_size > cache->mem_quota) {
+		/*
+		 * The cache is over its own quota so make room for
+		 * the new node by evicting its own oldest nodes. Move
+		 * the accessed node to the head of the LRU list first
+		 * so that it isn't evicted.
+		 */
+		struct vy_cache_node **node = NULL;
+		if (is_access)
+			node = vy_cache_tree_find(&cache->cache_tree, curr);
+		if (node != NULL)
+			vy_cache_node_promote(cache->env, *node);
+		if (!vy_cache_gc_own(cache, node_size))
+			return;
+	}
+
 	assert(vy_stmt_type(curr.stmt) == IPROTO_INSERT ||
 	       vy_stmt_type(curr.stmt) == IPROTO_REPLACE);
 	assert(prev.stmt == NULL ||
@@ -328,7 +429,10 @@ vy_cache_add(struct vy_cache *cache, struct vy_entry curr,
 		node->flags = replaced->flags;
 		node->left_boundary_level = replaced->left_boundary_level;
 		node->right_boundary_level = replaced->right_boundary_level;
+		bool is_protected = replaced->is_protected;
 		vy_cache_node_delete(cache->env, replaced);
+		if (is_access || is_protected)
+			vy_cache_node_promote(cache->env, node);
 	}
 	if (direction > 0 && boundary_level < node->left_boundary_level)
 		node->left_boundary_level = boundary_level;
@@ -414,7 +518,10 @@ vy_cache_add(struct vy_cache *cache, struct vy_entry curr,
 		prev_node->flags = replaced->flags;
 		prev_node->left_boundary_level = replaced->left_boundary_level;
 		prev_node->right_boundary_level = replaced->right_boundary_level;
+		bool is_protected = replaced->is_protected;
 		vy_cache_node_delete(cache->env, replaced);
+		if (is_protected)
+			vy_cache_node_promote(cache->env, prev_node);
 	}
 
 	/* Set proper flags */
@@ -728,14 +835,17 @@ vy_cache_iterator_next(struct vy_cache_iterator *itr,
 		itr->search_started = true;
 		itr->version = itr->cache->version;
 		*stop = vy_cache_iterator_seek(itr, vy_entry_none());
+		vy_cache_iterator_skip_to_read_view(itr, stop);
+		if (itr->curr.stmt != NULL)
+			itr->cache->stat.hit++;
 	} else {
 		assert(itr->version == itr->cache->version);
 		if (itr->curr.stmt == NULL)
 			return 0;
 		*stop = vy_cache_iterator_step(itr);
+		vy_cache_iterator_skip_to_read_view(itr, stop);
 	}
 
-	vy_cache_iterator_skip_to_read_view(itr, stop);
 	if (itr->curr.stmt != NULL) {
 		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
 					   itr->curr.stmt);
@@ -768,6 +878,7 @@ vy_cache_iterator_skip(struct vy_cache_iterator *itr, struct vy_entry last,
 	vy_cache_iterator_skip_to_read_view(itr, stop);
 
 	if (itr->curr.stmt != NULL) {
+		itr->cache->stat.hit++;
 		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
 					   itr->curr.stmt);
 		return vy_history_append_stmt(history, itr->curr);
@@ -794,6 +905,8 @@ vy_cache_iterator_restore(struct vy_cache_iterator *itr, struct vy_entry last,
 		 */
 		*stop = vy_cache_iterator_seek(itr, last);
 		vy_cache_iterator_skip_to_read_view(itr, stop);
+		if (itr->curr.stmt != NULL)
+			itr->cache->stat.hit++;
 		pos_changed = true;
 	} else {
 		/*
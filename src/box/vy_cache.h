@@ -56,8 +56,10 @@ struct vy_cache_node {
 	struct vy_cache *cache;
 	/* Statement in cache */
 	struct vy_entry entry;
-	/* Link in LRU list */
+	/* Link in LRU list of the segment the node belongs to */
 	struct rlist in_lru;
+	/* Link in vy_cache::lru */
+	struct rlist in_cache_lru;
 	/* VY_CACHE_LEFT_LINKED and/or VY_CACHE_RIGHT_LINKED, see
 	 * description of them for more information */
 	uint32_t flags;
@@ -65,6 +67,8 @@ struct vy_cache_node {
 	uint8_t left_boundary_level;
 	/* Number of parts in key when the value was the last in EQ search */
 	uint8_t right_boundary_level;
+	/* Set if the node is in the protected LRU segment */
+	bool is_protected;
 };
 
 /**
@@ -113,14 +117,33 @@ vy_cache_tree_key_cmp(struct vy_cache_node *a, struct vy_entry b,
 
 /**
  * Environment of the cache
+ *
+ * The cache is evicted by the segmented LRU policy, which makes it
+ * resistant to scans. A new node is added to the probation segment.
+ * A node that is read again while it is in the cache is moved to
+ * the protected segment. Nodes are evicted from the probation
+ * segment first, so a scan of data that isn't read otherwise can't
+ * wash out the working set. The protected segment is limited to
+ * a part of the quota: the oldest protected nodes are moved back to
+ * the probation segment to make room for new ones.
  */
 struct vy_cache_env {
-	/** Common LRU list of read cache. The first element is the newest */
+	/**
+	 * LRU list of the probation segment of read cache.
+	 * The first element is the newest.
+	 */
 	struct rlist cache_lru;
+	/**
+	 * LRU list of the protected segment of read cache.
+	 * The first element is the newest.
+	 */
+	struct rlist protected_lru;
 	/** Common mempool for vy_cache_node struct */
 	struct mempool cache_node_mempool;
 	/** Size of memory occupied by cached tuples */
 	size_t mem_used;
+	/** Size of memory occupied by the protected segment */
+	size_t protected_mem_used;
 	/** Max memory size that can be used for cache */
 	size_t mem_quota;
 };
@@ -168,6 +191,17 @@ struct vy_cache {
 	uint32_t version;
 	/* Saved pointer to common cache environment */
 	struct vy_cache_env *env;
+	/* LRU list of nodes of this cache, most recently used first */
+	struct rlist lru;
+	/* Size of memory occupied by nodes of this cache */
+	size_t mem_used;
+	/*
+	 * Max memory size that can be used by this cache, 0 means
+	 * that it's limited only by the common quota. When this cache
+	 * exceeds the limit, its least recently used nodes are evicted
+	 * to make room for new ones.
+	 */
+	size_t mem_quota;
 	/* Cache statistics. */
 	struct vy_cache_stat stat;
 };
@@ -212,6 +212,7 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 	lsm->dump_lsn = -1;
 	lsm->commit_lsn = -1;
 	vy_cache_create(&lsm->cache, cache_env, cmp_def, index_def->iid == 0);
+	lsm->cache.mem_quota = index_def->opts.cache_size;
 	rlist_create(&lsm->sealed);
 	vy_range_tree_new(&lsm->range_tree);
 	vy_range_heap_create(&lsm->range_heap);
@@ -733,6 +734,9 @@ vy_lsm_add_run(struct vy_lsm *lsm, struct vy_run *run)
 	size_t bloom_size = vy_run_bloom_size(run);
 	size_t page_index_size = run->page_index_size;
 
+	vy_run_enable_bloom_eviction(run, env->path, lsm->space_id,
+				     lsm->index_id);
+
 	assert(rlist_empty(&run->in_lsm));
 	rlist_add_entry(&lsm->runs, run, in_lsm);
 	lsm->run_count++;
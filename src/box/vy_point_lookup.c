@@ -84,6 +84,7 @@ vy_point_lookup_scan_cache(struct vy_lsm *lsm, const struct vy_read_view **rv,
 	    (!is_prepared_ok && vy_stmt_is_prepared(entry.stmt)))
 		return 0;
 
+	lsm->cache.stat.hit++;
 	vy_stmt_counter_acct_tuple(&lsm->cache.stat.get, entry.stmt);
 	return vy_history_append_stmt(history, entry);
 }
@@ -515,6 +515,55 @@ vy_range_needs_split(struct vy_range *range, int64_t range_size,
 	return true;
 }
 
+int
+vy_range_compaction_split_keys(struct vy_range *range, int64_t range_size,
+			       int max_parts, const char **split_keys)
+{
+	/* Find the oldest slice to compact, which is the biggest one. */
+	struct vy_slice *slice;
+	int n = range->compaction_priority;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		if (--n == 0)
+			break;
+	}
+	assert(n == 0);
+
+	/* Let each part be at least range_size in size. */
+	int64_t part_count = slice->count.bytes / range_size;
+	uint32_t page_count = slice->last_page_no - slice->first_page_no + 1;
+	part_count = MIN(part_count, max_parts);
+	part_count = MIN(part_count, page_count);
+	if (part_count < 2)
+		return 0;
+
+	/*
+	 * Split the slice at the min keys of evenly spaced pages.
+	 * A page may start with the same key as the previous split
+	 * page or the slice begin (see vy_range_needs_split()), in
+	 * which case we skip it so that no part is empty.
+	 */
+	int key_count = 0;
+	struct vy_page_info *prev_page = vy_run_page_info(slice->run,
+						slice->first_page_no);
+	for (int i = 1; i < part_count; i++) {
+		struct vy_page_info *page = vy_run_page_info(slice->run,
+				slice->first_page_no + page_count * i /
+				part_count);
+		if (vy_key_compare(prev_page->min_key, prev_page->min_key_hint,
+				   page->min_key, page->min_key_hint,
+				   range->cmp_def) >= 0)
+			continue;
+		if (slice->begin.stmt != NULL &&
+		    vy_entry_compare_with_raw_key(slice->begin, page->min_key,
+						  page->min_key_hint,
+						  range->cmp_def) >= 0)
+			continue;
+		split_keys[key_count++] = page->min_key;
+		prev_page = page;
+	}
+	return key_count;
+}
+
 /**
  * Check if a range should be coalesced with one or more its neighbors.
  * If it should, return true and set @p_first and @p_last to the first
@@ -266,6 +266,29 @@ bool
 vy_range_needs_split(struct vy_range *range, int64_t range_size,
 		     const char **p_split_key);
 
+/**
+ * Check if compaction of a range should be split by key into
+ * several parts that can be executed in parallel.
+ *
+ * Only the slices selected for compaction (compaction_priority
+ * newest ones) are taken into account. The split keys are taken
+ * from the page index of the oldest of them so that each part
+ * is roughly range_size in size.
+ *
+ * @param range             The range.
+ * @param range_size        Target range size.
+ * @param max_parts         Max number of parts.
+ * @param[out] split_keys   Keys to split the compaction by, in
+ *                          ascending order. Must have room for
+ *                          max_parts - 1 keys.
+ *
+ * @retval                  Number of split keys, 0 if compaction
+ *                          shouldn't be split.
+ */
+int
+vy_range_compaction_split_keys(struct vy_range *range, int64_t range_size,
+			       int max_parts, const char **split_keys);
+
 /**
  * Check if a range needs to be coalesced with adjacent
  * ranges in a range tree.
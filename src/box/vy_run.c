@@ -38,6 +38,7 @@
 #include "cbus.h"
 #include "memory.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 
 #include "replication.h"
 #include "tuple_bloom.h"
@@ -95,6 +96,11 @@ struct vy_page_read_task {
 	struct vy_page_info *page_info;
 	/** vy_run with fd - ref. counted */
 	struct vy_run *run;
+	/**
+	 * Raw page data if it has already been read from the file
+	 * in tx with io_uring, NULL otherwise.
+	 */
+	const char *data;
 	/** key to lookup within the page */
 	struct vy_entry key;
 	/** iterator type (needed for for key lookup) */
@@ -189,6 +195,7 @@ vy_run_env_create(struct vy_run_env *env, int read_threads)
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
 		       sizeof(struct vy_page_read_task));
 	env->initial_join = false;
+	rlist_create(&env->bloom_lru);
 }
 
 /**
@@ -254,6 +261,7 @@ vy_page_info_create(struct vy_page_info *page_info, uint64_t offset,
 	memset(page_info, 0, sizeof(*page_info));
 	page_info->offset = offset;
 	page_info->unpacked_size = 0;
+	page_info->restart_interval = 1;
 	page_info->min_key = vy_key_dup(min_key);
 	if (page_info->min_key == NULL)
 		return -1;
@@ -262,6 +270,36 @@ vy_page_info_create(struct vy_page_info *page_info, uint64_t offset,
 	return page_info->min_key == NULL ? -1 : 0;
 }
 
+/**
+ * Set the max key of a page.
+ *
+ * @retval 0 for Success
+ * @retval -1 for error
+ */
+static int
+vy_page_info_set_max_key(struct vy_page_info *page_info,
+			 const char *max_key, struct key_def *cmp_def)
+{
+	assert(page_info->max_key == NULL);
+	page_info->max_key = vy_key_dup(max_key);
+	if (page_info->max_key == NULL)
+		return -1;
+	uint32_t part_count = mp_decode_array(&max_key);
+	page_info->max_key_hint = key_hint(max_key, part_count, cmp_def);
+	return 0;
+}
+
+/**
+ * Return the number of restart points, i.e. the size of the row
+ * index, of a page.
+ */
+static inline uint32_t
+vy_page_info_restart_count(const struct vy_page_info *page_info)
+{
+	return DIV_ROUND_UP(page_info->row_count,
+			    page_info->restart_interval);
+}
+
 /**
  * Destroy page info struct
  */
@@ -270,6 +308,8 @@ vy_page_info_destroy(struct vy_page_info *page_info)
 {
 	if (page_info->min_key != NULL)
 		free(page_info->min_key);
+	if (page_info->max_key != NULL)
+		free(page_info->max_key);
 }
 
 struct vy_run *
@@ -288,6 +328,7 @@ vy_run_new(struct vy_run_env *env, int64_t id)
 	run->refs = 1;
 	rlist_create(&run->in_lsm);
 	rlist_create(&run->in_unused);
+	rlist_create(&run->in_bloom_lru);
 	return run;
 }
 
@@ -303,10 +344,17 @@ vy_run_clear(struct vy_run *run)
 	run->page_info = NULL;
 	run->page_index_size = 0;
 	run->info.page_count = 0;
+	if (!rlist_empty(&run->in_bloom_lru)) {
+		rlist_del_entry(run, in_bloom_lru);
+		run->env->bloom_memory_used -= run->bloom_size;
+	}
 	if (run->info.bloom != NULL) {
 		tuple_bloom_delete(run->info.bloom);
 		run->info.bloom = NULL;
 	}
+	free(run->index_path);
+	run->index_path = NULL;
+	run->bloom_size = 0;
 	free(run->info.min_key);
 	run->info.min_key = NULL;
 	free(run->info.max_key);
@@ -327,7 +375,62 @@ vy_run_delete(struct vy_run *run)
 size_t
 vy_run_bloom_size(struct vy_run *run)
 {
-	return run->info.bloom == NULL ? 0 : tuple_bloom_size(run->info.bloom);
+	if (run->info.bloom != NULL)
+		return tuple_bloom_size(run->info.bloom);
+	/* The bloom filter may be freed, see vy_run_env::bloom_lru. */
+	return run->bloom_size;
+}
+
+/**
+ * Free least recently used bloom filters until the bloom filter
+ * memory limit is satisfied. The bloom filter of the given run
+ * (may be NULL) is never freed.
+ */
+static void
+vy_run_env_evict_blooms(struct vy_run_env *env, struct vy_run *keep)
+{
+	if (env->bloom_memory_limit == 0)
+		return;
+	while (env->bloom_memory_used > env->bloom_memory_limit &&
+	       !rlist_empty(&env->bloom_lru)) {
+		struct vy_run *run = rlist_last_entry(&env->bloom_lru,
+						      struct vy_run,
+						      in_bloom_lru);
+		if (run == keep)
+			break;
+		assert(run->info.bloom != NULL);
+		assert(run->index_path != NULL);
+		rlist_del_entry(run, in_bloom_lru);
+		env->bloom_memory_used -= run->bloom_size;
+		tuple_bloom_delete(run->info.bloom);
+		run->info.bloom = NULL;
+	}
+}
+
+void
+vy_run_env_set_bloom_memory_limit(struct vy_run_env *env, size_t limit)
+{
+	env->bloom_memory_limit = limit;
+	vy_run_env_evict_blooms(env, NULL);
+}
+
+void
+vy_run_enable_bloom_eviction(struct vy_run *run, const char *dir,
+			     uint32_t space_id, uint32_t iid)
+{
+	if (run->info.bloom == NULL || run->index_path != NULL)
+		return;
+	char path[PATH_MAX];
+	vy_run_snprint_path(path, sizeof(path), dir, space_id, iid,
+			    run->id, VY_FILE_INDEX);
+	run->index_path = strdup(path);
+	if (run->index_path == NULL)
+		return; /* keep the bloom filter in memory */
+	struct vy_run_env *env = run->env;
+	run->bloom_size = tuple_bloom_size(run->info.bloom);
+	rlist_add_entry(&env->bloom_lru, run, in_bloom_lru);
+	env->bloom_memory_used += run->bloom_size;
+	vy_run_env_evict_blooms(env, NULL);
 }
 
 /**
@@ -580,6 +683,16 @@ vy_page_info_decode(struct vy_page_info *page, const struct xrow_header *xrow,
 		case VY_PAGE_INFO_ROW_INDEX_OFFSET:
 			page->row_index_offset = mp_decode_uint(&pos);
 			break;
+		case VY_PAGE_INFO_RESTART_INTERVAL:
+			page->restart_interval = mp_decode_uint(&pos);
+			break;
+		case VY_PAGE_INFO_MAX_KEY:
+			key_beg = pos;
+			mp_next(&pos);
+			if (vy_page_info_set_max_key(page, key_beg,
+						     cmp_def) != 0)
+				return -1;
+			break;
 		default:
 			mp_next(&pos); /* unknown key, ignore */
 			break;
@@ -593,7 +706,9 @@ vy_page_info_decode(struct vy_page_info *page, const struct xrow_header *xrow,
 				    vy_page_info_key_name(key)));
 		return -1;
 	}
-
+	/* Pages written without prefix compression. */
+	if (page->restart_interval == 0)
+		page->restart_interval = 1;
 	return 0;
 }
 
@@ -681,7 +796,14 @@ vy_run_info_decode(struct vy_run_info *run_info,
 				return -1;
 			break;
 		case VY_RUN_INFO_BLOOM_FILTER:
-			run_info->bloom = tuple_bloom_decode(&pos);
+			run_info->bloom = tuple_bloom_decode(
+				&pos, BLOOM_VERSION_BLOCKED);
+			if (run_info->bloom == NULL)
+				return -1;
+			break;
+		case VY_RUN_INFO_BLOOM_FILTER_SPLIT:
+			run_info->bloom = tuple_bloom_decode(
+				&pos, BLOOM_VERSION_SPLIT_BLOCK);
 			if (run_info->bloom == NULL)
 				return -1;
 			break;
@@ -715,9 +837,16 @@ vy_page_new(const struct vy_page_info *page_info)
 	}
 	page->unpacked_size = page_info->unpacked_size;
 	page->row_count = page_info->row_count;
-	page->row_index = calloc(page_info->row_count, sizeof(uint32_t));
+	page->restart_interval = page_info->restart_interval;
+	page->row_no = UINT32_MAX;
+	page->row_end = 0;
+	page->row_buf = NULL;
+	page->row_buf_size = 0;
+	page->row_buf_capacity = 0;
+	uint32_t restart_count = vy_page_info_restart_count(page_info);
+	page->row_index = calloc(restart_count, sizeof(uint32_t));
 	if (page->row_index == NULL) {
-		diag_set(OutOfMemory, page_info->row_count * sizeof(uint32_t),
+		diag_set(OutOfMemory, restart_count * sizeof(uint32_t),
 			 "malloc", "page->row_index");
 		free(page);
 		return NULL;
@@ -739,26 +868,156 @@ vy_page_delete(struct vy_page *page)
 {
 	uint32_t *row_index = page->row_index;
 	char *data = page->data;
+	char *row_buf = page->row_buf;
 #if !defined(NDEBUG)
-	memset(row_index, '#', sizeof(uint32_t) * page->row_count);
+	memset(row_index, '#', sizeof(uint32_t) *
+	       DIV_ROUND_UP(page->row_count, page->restart_interval));
 	memset(data, '#', page->unpacked_size);
 	memset(page, '#', sizeof(*page));
 #endif /* !defined(NDEBUG) */
 	free(row_index);
 	free(data);
+	free(row_buf);
 	free(page);
 }
 
+/**
+ * Decode a VY_RUN_ROW_DELTA row: restore the type of the statement
+ * stored in it and return the size of the body prefix shared with
+ * the previous statement, which body size is @a prev_body_size, and
+ * the rest of the body.
+ */
+static int
+vy_row_delta_decode(struct xrow_header *xrow, uint32_t prev_body_size,
+		    uint32_t *prefix_size, const char **suffix,
+		    uint32_t *suffix_size)
+{
+	assert(xrow->type == VY_RUN_ROW_DELTA);
+	uint64_t key_map = (1ULL << VY_ROW_DELTA_TYPE) |
+			   (1ULL << VY_ROW_DELTA_PREFIX_SIZE) |
+			   (1ULL << VY_ROW_DELTA_SUFFIX);
+	const char *pos = xrow->body->iov_base;
+	if (xrow->bodycnt == 0 || mp_typeof(*pos) != MP_MAP)
+		goto error;
+	uint32_t map_size = mp_decode_map(&pos);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*pos) != MP_UINT)
+			goto error;
+		uint64_t key = mp_decode_uint(&pos);
+		uint64_t value;
+		if (key < 64)
+			key_map &= ~(1ULL << key);
+		switch (key) {
+		case VY_ROW_DELTA_TYPE:
+			if (mp_typeof(*pos) != MP_UINT)
+				goto error;
+			xrow->type = mp_decode_uint(&pos);
+			break;
+		case VY_ROW_DELTA_PREFIX_SIZE:
+			if (mp_typeof(*pos) != MP_UINT)
+				goto error;
+			value = mp_decode_uint(&pos);
+			if (value > prev_body_size)
+				goto error;
+			*prefix_size = value;
+			break;
+		case VY_ROW_DELTA_SUFFIX:
+			if (mp_typeof(*pos) != MP_BIN)
+				goto error;
+			*suffix = mp_decode_bin(&pos, suffix_size);
+			break;
+		default:
+			mp_next(&pos); /* unknown key, ignore */
+			break;
+		}
+	}
+	if (key_map != 0 || xrow->type == VY_RUN_ROW_DELTA)
+		goto error;
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 "Can't decode prefix-compressed statement");
+	return -1;
+}
+
+/**
+ * Decode the statement at page->row_end and make it the last
+ * decoded statement of the page.
+ */
+static int
+vy_page_decode_next_row(struct vy_page *page)
+{
+	const char *data = page->data + page->row_end;
+	const char *data_end = page->data + page->unpacked_size;
+	struct xrow_header *xrow = &page->row;
+	if (xrow_header_decode(xrow, &data, data_end, false) != 0)
+		return -1;
+	uint32_t prefix_size = 0;
+	const char *suffix = NULL;
+	uint32_t suffix_size = 0;
+	if (xrow->type == VY_RUN_ROW_DELTA) {
+		if (vy_row_delta_decode(xrow, page->row_buf_size, &prefix_size,
+					&suffix, &suffix_size) != 0)
+			return -1;
+	} else if (xrow->bodycnt > 0) {
+		suffix = xrow->body->iov_base;
+		suffix_size = xrow->body->iov_len;
+	}
+	uint32_t size = prefix_size + suffix_size;
+	if (size > page->row_buf_capacity) {
+		uint32_t capacity = MAX(page->row_buf_capacity * 2, size);
+		char *buf = realloc(page->row_buf, capacity);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, capacity, "realloc",
+				 "page->row_buf");
+			return -1;
+		}
+		page->row_buf = buf;
+		page->row_buf_capacity = capacity;
+	}
+	if (suffix_size > 0)
+		memcpy(page->row_buf + prefix_size, suffix, suffix_size);
+	page->row_buf_size = size;
+	xrow->body->iov_base = page->row_buf;
+	xrow->body->iov_len = size;
+	xrow->bodycnt = size > 0 ? 1 : 0;
+	page->row_end = data - page->data;
+	page->row_no++;
+	return 0;
+}
+
 static int
 vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	     struct xrow_header *xrow)
 {
 	assert(stmt_no < page->row_count);
-	const char *data = page->data + page->row_index[stmt_no];
-	const char *data_end = stmt_no + 1 < page->row_count ?
-			       page->data + page->row_index[stmt_no + 1] :
-			       page->data + page->unpacked_size;
-	return xrow_header_decode(xrow, &data, data_end, false);
+	if (page->restart_interval == 1) {
+		const char *data = page->data + page->row_index[stmt_no];
+		const char *data_end = stmt_no + 1 < page->row_count ?
+				       page->data + page->row_index[stmt_no + 1] :
+				       page->data + page->unpacked_size;
+		return xrow_header_decode(xrow, &data, data_end, false);
+	}
+	uint32_t restart_no = stmt_no / page->restart_interval;
+	uint32_t restart_row_no = restart_no * page->restart_interval;
+	if (page->row_no == UINT32_MAX || page->row_no > stmt_no ||
+	    page->row_no < restart_row_no) {
+		/*
+		 * Start over from the restart point. Note, row_no
+		 * wraps around to 0 for the first restart point.
+		 */
+		page->row_no = restart_row_no - 1;
+		page->row_end = page->row_index[restart_no];
+		page->row_buf_size = 0;
+	}
+	while (page->row_no != stmt_no) {
+		if (vy_page_decode_next_row(page) != 0) {
+			page->row_no = UINT32_MAX;
+			return -1;
+		}
+	}
+	*xrow = page->row;
+	return 0;
 }
 
 /* {{{ vy_run_iterator vy_run_iterator support functions */
@@ -793,6 +1052,11 @@ vy_page_stmt(struct vy_page *page, uint32_t stmt_no,
  * In terms of STL, makes lower_bound for EQ,GE,LT and upper_bound for GT,LE
  * Additionally *equal_key argument is set to true if the found value is
  * equal to given key (set to false otherwise).
+ *
+ * The binary search is done over restart points, which are stored
+ * in full, then statements that follow the found restart point are
+ * scanned sequentially.
+ *
  * @retval position in the page
  */
 static uint32_t
@@ -800,18 +1064,19 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 		 struct key_def *cmp_def, struct tuple_format *format,
 		 enum iterator_type iterator_type, bool *equal_key)
 {
+	uint32_t interval = page->restart_interval;
 	uint32_t beg = 0;
-	uint32_t end = page->row_count;
+	uint32_t end = DIV_ROUND_UP(page->row_count, interval);
 	*equal_key = false;
 	/* for upper bound we change zero comparison result to -1 */
 	int zero_cmp = (iterator_type == ITER_GT ||
 			iterator_type == ITER_LE ? -1 : 0);
 	while (beg != end) {
 		uint32_t mid = beg + (end - beg) / 2;
-		struct vy_entry fnd_key = vy_page_stmt(page, mid, cmp_def,
-						       format);
+		struct vy_entry fnd_key = vy_page_stmt(page, mid * interval,
+						       cmp_def, format);
 		if (fnd_key.stmt == NULL)
-			return end;
+			return MIN(end * interval, page->row_count);
 		int cmp = vy_entry_compare(fnd_key, key, cmp_def);
 		cmp = cmp ? cmp : zero_cmp;
 		*equal_key = *equal_key || cmp == 0;
@@ -821,7 +1086,27 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 			end = mid;
 		tuple_unref(fnd_key.stmt);
 	}
-	return end;
+	if (end == 0)
+		return 0;
+	/*
+	 * The statement we're looking for is either the restart
+	 * point found above or follows the previous restart point.
+	 */
+	uint32_t pos = (end - 1) * interval + 1;
+	uint32_t pos_end = MIN(end * interval, page->row_count);
+	for (; pos < pos_end; pos++) {
+		struct vy_entry fnd_key = vy_page_stmt(page, pos,
+						       cmp_def, format);
+		if (fnd_key.stmt == NULL)
+			return pos;
+		int cmp = vy_entry_compare(fnd_key, key, cmp_def);
+		cmp = cmp ? cmp : zero_cmp;
+		*equal_key = *equal_key || cmp == 0;
+		tuple_unref(fnd_key.stmt);
+		if (cmp >= 0)
+			break;
+	}
+	return pos;
 }
 
 /**
@@ -842,33 +1127,73 @@ vy_run_iterator_stop(struct vy_run_iterator *itr)
 	}
 }
 
+/**
+ * Return the number of rows between restart points stored in
+ * a row index.
+ */
+static uint32_t
+vy_row_index_restart_interval(const struct xrow_header *xrow)
+{
+	assert(xrow->type == VY_RUN_ROW_INDEX);
+	const char *pos = xrow->body->iov_base;
+	uint32_t map_size = mp_decode_map(&pos);
+	for (uint32_t i = 0; i < map_size; i++) {
+		uint32_t key = mp_decode_uint(&pos);
+		if (key == VY_ROW_INDEX_RESTART_INTERVAL) {
+			uint32_t interval = mp_decode_uint(&pos);
+			return interval > 0 ? interval : 1;
+		}
+		mp_next(&pos);
+	}
+	return 1;
+}
+
 static int
 vy_row_index_decode(uint32_t *row_index, uint32_t row_count,
-		    struct xrow_header *xrow)
+		    uint32_t restart_interval, struct xrow_header *xrow)
 {
 	assert(xrow->type == VY_RUN_ROW_INDEX);
 	const char *pos = xrow->body->iov_base;
 	uint32_t map_size = mp_decode_map(&pos);
 	uint32_t map_item;
 	uint32_t size = 0;
+	const char *data = NULL;
+	uint64_t interval = 1;
 	for (map_item = 0; map_item < map_size; ++map_item) {
 		uint32_t key = mp_decode_uint(&pos);
 		switch (key) {
 		case VY_ROW_INDEX_DATA:
 			size = mp_decode_binl(&pos);
+			data = pos;
+			pos += size;
+			break;
+		case VY_ROW_INDEX_RESTART_INTERVAL:
+			interval = mp_decode_uint(&pos);
+			break;
+		default:
+			mp_next(&pos);
 			break;
 		}
 	}
-	if (size != sizeof(uint32_t) * row_count) {
+	if (interval != restart_interval) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Wrong row index restart interval "
+				    "(expected %u, got %llu)",
+				    (unsigned)restart_interval,
+				    (unsigned long long)interval));
+		return -1;
+	}
+	uint32_t restart_count = DIV_ROUND_UP(row_count, restart_interval);
+	if (size != sizeof(uint32_t) * restart_count) {
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 tt_sprintf("Wrong row index size "
 				    "(expected %zu, got %u",
-				    sizeof(uint32_t) * row_count,
+				    sizeof(uint32_t) * restart_count,
 				    (unsigned)size));
 		return -1;
 	}
-	for (uint32_t i = 0; i < row_count; ++i) {
-		row_index[i] = mp_load_u32(&pos);
+	for (uint32_t i = 0; i < restart_count; ++i) {
+		row_index[i] = mp_load_u32(&data);
 	}
 	assert(pos == xrow->body->iov_base + xrow->body->iov_len);
 	return 0;
@@ -883,36 +1208,57 @@ vy_run_filename(struct vy_run *run)
 	return buf;
 }
 
+/** Log a page read error. */
+static void
+vy_page_read_log_error(const struct vy_page_info *page_info,
+		       struct vy_run *run)
+{
+	diag_log();
+	say_error("error reading %s@%llu:%u", vy_run_filename(run),
+		  (unsigned long long)page_info->offset,
+		  (unsigned)page_info->size);
+}
+
 /**
  * Read a page requests from vinyl xlog data file.
  *
+ * If @a raw_data is not NULL, it contains the raw page data that
+ * has already been read from the file by the caller, and only
+ * decoding is done.
+ *
  * @retval 0 on success
  * @retval -1 on error, check diag
  */
 static int
 vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
-	     struct vy_run *run, ZSTD_DStream *zdctx)
+	     struct vy_run *run, const char *raw_data, ZSTD_DStream *zdctx)
 {
-	/* read xlog tx from xlog file */
 	size_t region_svp = region_used(&fiber()->gc);
-	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	const char *data = raw_data;
 	if (data == NULL) {
-		diag_set(OutOfMemory, page_info->size, "region gc", "page");
-		return -1;
-	}
-	ssize_t readen = fio_pread(run->fd, data, page_info->size,
-				   page_info->offset);
-	ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
-		readen = -1;
-		errno = EIO;});
-	if (readen < 0) {
-		diag_set(SystemError, "failed to read from file");
-		goto error;
-	}
-	if (readen != (ssize_t)page_info->size) {
-		diag_set(ClientError, ER_INVALID_RUN_FILE,
-			 "Unexpected end of file");
-		goto error;
+		/* read xlog tx from xlog file */
+		char *buf = (char *)region_alloc(&fiber()->gc,
+						 page_info->size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, page_info->size, "region gc",
+				 "page");
+			return -1;
+		}
+		ssize_t readen = fio_pread(run->fd, buf, page_info->size,
+					   page_info->offset);
+		ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
+			readen = -1;
+			errno = EIO;});
+		if (readen < 0) {
+			diag_set(SystemError, "failed to read from file");
+			goto error;
+		}
+		if (readen != (ssize_t)page_info->size) {
+			diag_set(ClientError, ER_INVALID_RUN_FILE,
+				 "Unexpected end of file");
+			goto error;
+		}
+		data = buf;
 	}
 
 	struct errinj *inj = errinj(ERRINJ_VY_READ_PAGE_TIMEOUT, ERRINJ_DOUBLE);
@@ -923,7 +1269,7 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 
 	/* decode xlog tx */
 	const char *data_pos = data;
-	const char *data_end = data + readen;
+	const char *data_end = data + page_info->size;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
 	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
@@ -941,7 +1287,8 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
 		goto error;
 	}
-	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
+	if (vy_row_index_decode(page->row_index, page->row_count,
+				page->restart_interval, &xrow) != 0)
 		goto error;
 	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
@@ -950,10 +1297,7 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 	return 0;
 error:
 	region_truncate(&fiber()->gc, region_svp);
-	diag_log();
-	say_error("error reading %s@%llu:%u", vy_run_filename(run),
-		  (unsigned long long)page_info->offset,
-		  (unsigned)page_info->size);
+	vy_page_read_log_error(page_info, run);
 	return -1;
 }
 
@@ -986,7 +1330,8 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run->env);
 	if (zdctx == NULL)
 		return -1;
-	if (vy_page_read(task->page, task->page_info, task->run, zdctx) != 0)
+	if (vy_page_read(task->page, task->page_info, task->run,
+			 task->data, zdctx) != 0)
 		return -1;
 	if (task->key.stmt != NULL) {
 		task->pos_in_page = vy_page_find_key(task->page, task->key,
@@ -997,6 +1342,60 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	return 0;
 }
 
+/**
+ * Read a page with io_uring right in tx, bypassing reader threads.
+ * Only decompression, if the page is compressed, is offloaded to
+ * a reader thread. Uncompressed pages are decoded in tx.
+ */
+static int
+vy_page_read_uring(struct vy_run_env *env, struct vy_page_read_task *task)
+{
+	const struct vy_page_info *page_info = task->page_info;
+	size_t region_svp = region_used(&fiber()->gc);
+	char *data = NULL;
+	if (page_info->size < XLOG_FIXHEADER_SIZE) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Unexpected end of file");
+		goto error;
+	}
+	data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, page_info->size, "region gc", "page");
+		return -1;
+	}
+	size_t readen = 0;
+	while (readen < page_info->size) {
+		ssize_t rc = coio_uring_pread(task->run->fd, data + readen,
+					      page_info->size - readen,
+					      page_info->offset + readen);
+		ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
+			rc = -1;
+			errno = EIO;});
+		if (rc < 0) {
+			diag_set(SystemError, "failed to read from file");
+			goto error;
+		}
+		if (rc == 0) {
+			diag_set(ClientError, ER_INVALID_RUN_FILE,
+				 "Unexpected end of file");
+			goto error;
+		}
+		readen += rc;
+	}
+	task->data = data;
+	int rc;
+	if (xlog_tx_is_compressed(data))
+		rc = vy_run_env_coio_call(env, &task->base, vy_page_read_cb);
+	else
+		rc = vy_page_read_cb(&task->base);
+	region_truncate(&fiber()->gc, region_svp);
+	return rc;
+error:
+	region_truncate(&fiber()->gc, region_svp);
+	vy_page_read_log_error(page_info, task->run);
+	return -1;
+}
+
 /**
  * Read a page from disk given its number.
  * The function caches two most recently read pages.
@@ -1049,6 +1448,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	task->run = slice->run;
 	task->page_info = page_info;
 	task->page = page;
+	task->data = NULL;
 	task->key = key;
 	task->iterator_type = iterator_type;
 	task->cmp_def = itr->cmp_def;
@@ -1056,7 +1456,11 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	task->pos_in_page = 0;
 	task->equal_found = false;
 
-	int rc = vy_run_env_coio_call(env, &task->base, vy_page_read_cb);
+	int rc;
+	if (coio_uring_is_enabled())
+		rc = vy_page_read_uring(env, task);
+	else
+		rc = vy_run_env_coio_call(env, &task->base, vy_page_read_cb);
 
 	*pos_in_page = task->pos_in_page;
 	*equal_found = task->equal_found;
@@ -1127,11 +1531,58 @@ vy_run_iterator_search(struct vy_run_iterator *itr,
 		       enum iterator_type iterator_type, struct vy_entry key,
 		       struct vy_run_iterator_pos *pos, bool *equal_key)
 {
-	pos->page_no = vy_page_index_find_page(itr->slice->run, key,
-					       itr->cmp_def, iterator_type,
-					       equal_key);
-	if (pos->page_no == itr->slice->run->info.page_count)
+	struct vy_run *run = itr->slice->run;
+	if (run->info.page_count == 0)
 		return 1;
+	/*
+	 * Check the key against the run boundaries so as not to
+	 * read the first or the last page of the run only to find
+	 * out that there's no matching statement in it.
+	 */
+	int cmp;
+	switch (iterator_type) {
+	case ITER_EQ:
+		if (vy_entry_compare_with_raw_key(key, run->info.min_key,
+						  HINT_NONE,
+						  itr->cmp_def) < 0)
+			return 1;
+		FALLTHROUGH;
+	case ITER_GE:
+	case ITER_GT:
+		cmp = vy_entry_compare_with_raw_key(key, run->info.max_key,
+						    HINT_NONE, itr->cmp_def);
+		if (cmp > 0 || (cmp == 0 && iterator_type == ITER_GT))
+			return 1;
+		break;
+	default:
+		assert(iterator_type == ITER_LE || iterator_type == ITER_LT);
+		cmp = vy_entry_compare_with_raw_key(key, run->info.min_key,
+						    HINT_NONE, itr->cmp_def);
+		if (cmp < 0 || (cmp == 0 && iterator_type == ITER_LT))
+			return 1;
+		break;
+	}
+	pos->page_no = vy_page_index_find_page(run, key, itr->cmp_def,
+					       iterator_type, equal_key);
+	if (pos->page_no == run->info.page_count)
+		return 1;
+	/*
+	 * The page found by the page index may end before the key.
+	 * If so, the search continues from the next page, and the
+	 * max key of the page lets us learn it without reading it.
+	 */
+	struct vy_page_info *page_info = vy_run_page_info(run, pos->page_no);
+	if (page_info->max_key != NULL && iterator_type != ITER_LE &&
+	    iterator_type != ITER_LT) {
+		cmp = vy_entry_compare_with_raw_key(key, page_info->max_key,
+						    page_info->max_key_hint,
+						    itr->cmp_def);
+		if (cmp > 0 || (cmp == 0 && iterator_type == ITER_GT)) {
+			pos->page_no++;
+			pos->pos_in_page = 0;
+			return 0;
+		}
+	}
 	bool equal_in_page;
 	struct vy_page *page;
 	int rc = vy_run_iterator_load_page(itr, pos->page_no, key,
@@ -1332,6 +1783,97 @@ vy_run_iterator_do_seek(struct vy_run_iterator *itr,
 	}
 }
 
+/** Task to load a run bloom filter from the index file. */
+struct vy_bloom_load_task {
+	/** parent */
+	struct cbus_call_msg base;
+	/** Path to the run index file. */
+	const char *path;
+	/** [out] Loaded bloom filter or NULL. */
+	struct tuple_bloom *bloom;
+};
+
+/**
+ * Load a run bloom filter from the run info stored at the
+ * beginning of the index file.
+ *
+ * This function is called from a reader thread.
+ */
+static int
+vy_bloom_load_cb(struct cbus_call_msg *base)
+{
+	struct vy_bloom_load_task *task = (struct vy_bloom_load_task *)base;
+	struct xlog_cursor cursor;
+	if (xlog_cursor_open(&cursor, task->path) != 0)
+		return -1;
+	struct xrow_header xrow;
+	int rc = xlog_cursor_next_tx(&cursor);
+	if (rc == 0)
+		rc = xlog_cursor_next_row(&cursor, &xrow);
+	if (rc > 0) {
+		diag_set(ClientError, ER_INVALID_INDEX_FILE,
+			 task->path, "Unexpected end of file");
+		rc = -1;
+	}
+	if (rc == 0 && xrow.type != VY_INDEX_RUN_INFO) {
+		diag_set(ClientError, ER_INVALID_INDEX_FILE, task->path,
+			 tt_sprintf("Wrong xrow type (expected %d, got %u)",
+				    VY_INDEX_RUN_INFO, (unsigned)xrow.type));
+		rc = -1;
+	}
+	struct vy_run_info info;
+	if (rc == 0) {
+		rc = vy_run_info_decode(&info, &xrow, task->path);
+		task->bloom = info.bloom;
+		free(info.min_key);
+		free(info.max_key);
+	}
+	xlog_cursor_close(&cursor, false);
+	return rc;
+}
+
+/**
+ * Return the bloom filter of a run or NULL if the run doesn't
+ * have one. If the bloom filter was freed to satisfy the bloom
+ * filter memory limit, it's loaded back from the index file in
+ * a reader thread. If loading fails, NULL is returned, which
+ * means that the bloom filter check should be skipped.
+ */
+static struct tuple_bloom *
+vy_run_bloom_get(struct vy_run *run)
+{
+	struct vy_run_env *env = run->env;
+	if (run->info.bloom != NULL) {
+		if (!rlist_empty(&run->in_bloom_lru))
+			rlist_move_entry(&env->bloom_lru, run, in_bloom_lru);
+		return run->info.bloom;
+	}
+	if (run->index_path == NULL || run->is_bloom_loading)
+		return NULL;
+	struct vy_bloom_load_task task;
+	task.path = run->index_path;
+	task.bloom = NULL;
+	run->is_bloom_loading = true;
+	int rc = vy_run_env_coio_call(env, &task.base, vy_bloom_load_cb);
+	run->is_bloom_loading = false;
+	if (rc != 0 || task.bloom == NULL) {
+		if (rc != 0) {
+			struct error *e = diag_last_error(diag_get());
+			say_warn_ratelimited("failed to load bloom filter "
+					     "from `%s': %s", run->index_path,
+					     e->errmsg);
+		}
+		if (task.bloom != NULL)
+			tuple_bloom_delete(task.bloom);
+		return NULL;
+	}
+	run->info.bloom = task.bloom;
+	rlist_add_entry(&env->bloom_lru, run, in_bloom_lru);
+	env->bloom_memory_used += run->bloom_size;
+	vy_run_env_evict_blooms(env, run);
+	return run->info.bloom;
+}
+
 /**
  * Position the iterator to the first statement satisfying
  * the iterator search criteria and following the given key
@@ -1343,7 +1885,6 @@ vy_run_iterator_seek(struct vy_run_iterator *itr, struct vy_entry last,
 {
 	struct key_def *cmp_def = itr->cmp_def;
 	struct vy_slice *slice = itr->slice;
-	struct tuple_bloom *bloom = slice->run->info.bloom;
 	struct vy_entry key = itr->key;
 	enum iterator_type iterator_type = itr->iterator_type;
 
@@ -1351,8 +1892,10 @@ vy_run_iterator_seek(struct vy_run_iterator *itr, struct vy_entry last,
 	assert(itr->search_started);
 
 	/* Check the bloom filter on the first iteration. */
-	bool check_bloom = (itr->iterator_type == ITER_EQ &&
-			    itr->curr.stmt == NULL && bloom != NULL);
+	struct tuple_bloom *bloom = NULL;
+	if (itr->iterator_type == ITER_EQ && itr->curr.stmt == NULL)
+		bloom = vy_run_bloom_get(slice->run);
+	bool check_bloom = bloom != NULL;
 	if (check_bloom && !vy_bloom_maybe_has(bloom, itr->key, itr->key_def)) {
 		vy_run_iterator_stop(itr);
 		itr->stat->bloom_hit++;
@@ -1649,6 +2192,11 @@ vy_run_acct_page(struct vy_run *run, struct vy_page_info *page)
 	mp_next(&min_key_end);
 	run->page_index_size += sizeof(struct vy_page_info);
 	run->page_index_size += min_key_end - page->min_key;
+	if (page->max_key != NULL) {
+		const char *max_key_end = page->max_key;
+		mp_next(&max_key_end);
+		run->page_index_size += max_key_end - page->max_key;
+	}
 	run->count.rows += page->row_count;
 	run->count.bytes += page->unpacked_size;
 	run->count.bytes_compressed += page->size;
@@ -1779,11 +2327,70 @@ vy_run_recover(struct vy_run *run, const char *dir,
 	return -1;
 }
 
+/**
+ * Replace a statement encoded in @a xrow with a VY_RUN_ROW_DELTA
+ * row storing only the difference between its body and the body of
+ * the previous statement, which is stored in @a prev_body_buf, if
+ * it makes the row smaller. Then save the statement body in
+ * @a prev_body_buf. The row is left as is if @a is_restart is set.
+ */
+static int
+vy_row_delta_encode(struct xrow_header *xrow, struct ibuf *prev_body_buf,
+		    bool is_restart)
+{
+	assert(xrow->bodycnt == 1);
+	const char *body = xrow->body->iov_base;
+	uint32_t body_size = xrow->body->iov_len;
+	const char *prev_body = prev_body_buf->rpos;
+	uint32_t prev_body_size = ibuf_used(prev_body_buf);
+	uint32_t prefix_size = 0;
+	if (!is_restart) {
+		uint32_t max_size = MIN(body_size, prev_body_size);
+		while (prefix_size < max_size &&
+		       body[prefix_size] == prev_body[prefix_size])
+			prefix_size++;
+	}
+	uint32_t suffix_size = body_size - prefix_size;
+	size_t size = mp_sizeof_map(3) +
+		      mp_sizeof_uint(VY_ROW_DELTA_TYPE) +
+		      mp_sizeof_uint(xrow->type) +
+		      mp_sizeof_uint(VY_ROW_DELTA_PREFIX_SIZE) +
+		      mp_sizeof_uint(prefix_size) +
+		      mp_sizeof_uint(VY_ROW_DELTA_SUFFIX) +
+		      mp_sizeof_bin(suffix_size);
+	if (size < body_size) {
+		char *pos = region_alloc(&fiber()->gc, size);
+		if (pos == NULL) {
+			diag_set(OutOfMemory, size, "region", "row delta");
+			return -1;
+		}
+		xrow->body->iov_base = pos;
+		pos = mp_encode_map(pos, 3);
+		pos = mp_encode_uint(pos, VY_ROW_DELTA_TYPE);
+		pos = mp_encode_uint(pos, xrow->type);
+		pos = mp_encode_uint(pos, VY_ROW_DELTA_PREFIX_SIZE);
+		pos = mp_encode_uint(pos, prefix_size);
+		pos = mp_encode_uint(pos, VY_ROW_DELTA_SUFFIX);
+		pos = mp_encode_bin(pos, body + prefix_size, suffix_size);
+		xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
+		assert(xrow->body->iov_len == size);
+		xrow->type = VY_RUN_ROW_DELTA;
+	}
+	ibuf_reset(prev_body_buf);
+	char *buf = ibuf_alloc(prev_body_buf, body_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, body_size, "ibuf", "row body");
+		return -1;
+	}
+	memcpy(buf, body, body_size);
+	return 0;
+}
+
 /* dump statement to the run page buffers (stmt header and data) */
 static int
 vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
 		 struct vy_page_info *info, struct key_def *key_def,
-		 bool is_primary)
+		 bool is_primary, struct ibuf *prev_body_buf, bool is_restart)
 {
 	struct xrow_header xrow;
 	int rc = (is_primary ?
@@ -1793,6 +2400,9 @@ vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
 					   &xrow));
 	if (rc != 0)
 		return -1;
+	if (prev_body_buf != NULL &&
+	    vy_row_delta_encode(&xrow, prev_body_buf, is_restart) != 0)
+		return -1;
 
 	ssize_t row_size;
 	if ((row_size = xlog_write_row(data_xlog, &xrow)) < 0)
@@ -1808,27 +2418,38 @@ vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
  *
  * @param row_index row index
  * @param row_count size of row index
+ * @param restart_interval number of rows between restart points
  * @param[out] xrow xrow to fill.
  * @retval 0 for success
  * @retval -1 for error
  */
 static int
 vy_row_index_encode(const uint32_t *row_index, uint32_t row_count,
-		    struct xrow_header *xrow)
+		    uint32_t restart_interval, struct xrow_header *xrow)
 {
 	memset(xrow, 0, sizeof(*xrow));
 	xrow->type = VY_RUN_ROW_INDEX;
 
-	size_t size = mp_sizeof_map(1) +
+	/* The restart interval is omitted for pages without restarts. */
+	uint32_t map_size = restart_interval > 1 ? 2 : 1;
+	size_t size = mp_sizeof_map(map_size) +
 		      mp_sizeof_uint(VY_ROW_INDEX_DATA) +
 		      mp_sizeof_bin(sizeof(uint32_t) * row_count);
+	if (restart_interval > 1) {
+		size += mp_sizeof_uint(VY_ROW_INDEX_RESTART_INTERVAL) +
+			mp_sizeof_uint(restart_interval);
+	}
 	char *pos = region_alloc(&fiber()->gc, size);
 	if (pos == NULL) {
 		diag_set(OutOfMemory, size, "region", "row index");
 		return -1;
 	}
 	xrow->body->iov_base = pos;
-	pos = mp_encode_map(pos, 1);
+	pos = mp_encode_map(pos, map_size);
+	if (restart_interval > 1) {
+		pos = mp_encode_uint(pos, VY_ROW_INDEX_RESTART_INTERVAL);
+		pos = mp_encode_uint(pos, restart_interval);
+	}
 	pos = mp_encode_uint(pos, VY_ROW_INDEX_DATA);
 	pos = mp_encode_binl(pos, sizeof(uint32_t) * row_count);
 	for (uint32_t i = 0; i < row_count; ++i)
@@ -1883,10 +2504,27 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	mp_next(&tmp);
 	min_key_size = tmp - page_info->min_key;
 
+	uint32_t max_key_size = 0;
+	if (page_info->max_key != NULL) {
+		tmp = page_info->max_key;
+		mp_next(&tmp);
+		max_key_size = tmp - page_info->max_key;
+	}
+
+	/*
+	 * The restart interval is omitted for pages without restarts,
+	 * the max key is omitted unless page fences are enabled.
+	 */
+	uint32_t map_size = 6;
+	if (page_info->restart_interval > 1)
+		map_size++;
+	if (page_info->max_key != NULL)
+		map_size++;
+
 	/* calc tuple size */
 	uint32_t size;
 	/* 3 items: page offset, size, and map */
-	size = mp_sizeof_map(6) +
+	size = mp_sizeof_map(map_size) +
 	       mp_sizeof_uint(VY_PAGE_INFO_OFFSET) +
 	       mp_sizeof_uint(page_info->offset) +
 	       mp_sizeof_uint(VY_PAGE_INFO_SIZE) +
@@ -1899,6 +2537,12 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	       mp_sizeof_uint(page_info->unpacked_size) +
 	       mp_sizeof_uint(VY_PAGE_INFO_ROW_INDEX_OFFSET) +
 	       mp_sizeof_uint(page_info->row_index_offset);
+	if (page_info->restart_interval > 1) {
+		size += mp_sizeof_uint(VY_PAGE_INFO_RESTART_INTERVAL) +
+			mp_sizeof_uint(page_info->restart_interval);
+	}
+	if (page_info->max_key != NULL)
+		size += mp_sizeof_uint(VY_PAGE_INFO_MAX_KEY) + max_key_size;
 
 	char *pos = region_alloc(region, size);
 	if (pos == NULL) {
@@ -1909,7 +2553,7 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	memset(xrow, 0, sizeof(*xrow));
 	/* encode page */
 	xrow->body->iov_base = pos;
-	pos = mp_encode_map(pos, 6);
+	pos = mp_encode_map(pos, map_size);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_OFFSET);
 	pos = mp_encode_uint(pos, page_info->offset);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_SIZE);
@@ -1923,6 +2567,15 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	pos = mp_encode_uint(pos, page_info->unpacked_size);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_ROW_INDEX_OFFSET);
 	pos = mp_encode_uint(pos, page_info->row_index_offset);
+	if (page_info->restart_interval > 1) {
+		pos = mp_encode_uint(pos, VY_PAGE_INFO_RESTART_INTERVAL);
+		pos = mp_encode_uint(pos, page_info->restart_interval);
+	}
+	if (page_info->max_key != NULL) {
+		pos = mp_encode_uint(pos, VY_PAGE_INFO_MAX_KEY);
+		memcpy(pos, page_info->max_key, max_key_size);
+		pos += max_key_size;
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 
@@ -1965,6 +2618,19 @@ vy_stmt_stat_encode(const struct vy_stmt_stat *stat, char *buf)
 	return buf;
 }
 
+/**
+ * Return the run info key to store a bloom filter with.
+ * Blocked and split block bloom filters are stored under different
+ * keys so that older versions ignore bloom filters they can't read.
+ */
+static enum vy_run_info_key
+vy_run_info_bloom_key(const struct tuple_bloom *bloom)
+{
+	assert(!bloom->is_legacy);
+	return bloom->version == BLOOM_VERSION_SPLIT_BLOCK ?
+	       VY_RUN_INFO_BLOOM_FILTER_SPLIT : VY_RUN_INFO_BLOOM_FILTER;
+}
+
 /**
  * Encode vy_run_info as xrow
  * Allocates using region alloc
@@ -2000,9 +2666,11 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 		mp_sizeof_uint(run_info->max_lsn);
 	size += mp_sizeof_uint(VY_RUN_INFO_PAGE_COUNT) +
 		mp_sizeof_uint(run_info->page_count);
-	if (run_info->bloom != NULL)
-		size += mp_sizeof_uint(VY_RUN_INFO_BLOOM_FILTER) +
-			tuple_bloom_size(run_info->bloom);
+	if (run_info->bloom != NULL) {
+		enum vy_run_info_key key =
+			vy_run_info_bloom_key(run_info->bloom);
+		size += mp_sizeof_uint(key) + tuple_bloom_size(run_info->bloom);
+	}
 	size += mp_sizeof_uint(VY_RUN_INFO_STMT_STAT) +
 		vy_stmt_stat_sizeof(&run_info->stmt_stat);
 
@@ -2028,7 +2696,8 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	pos = mp_encode_uint(pos, VY_RUN_INFO_PAGE_COUNT);
 	pos = mp_encode_uint(pos, run_info->page_count);
 	if (run_info->bloom != NULL) {
-		pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM_FILTER);
+		pos = mp_encode_uint(pos,
+				     vy_run_info_bloom_key(run_info->bloom));
 		pos = tuple_bloom_encode(run_info->bloom, pos);
 	}
 	pos = mp_encode_uint(pos, VY_RUN_INFO_STMT_STAT);
@@ -2109,7 +2778,9 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression)
+		     uint64_t page_size, double bloom_fpr,
+		     uint32_t restart_interval, bool page_fences,
+		     bool no_compression)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->run = run;
@@ -2120,6 +2791,8 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->key_def = key_def;
 	writer->page_size = page_size;
 	writer->bloom_fpr = bloom_fpr;
+	writer->restart_interval = MAX(restart_interval, 1);
+	writer->page_fences = page_fences;
 	writer->no_compression = no_compression;
 	if (bloom_fpr < 1) {
 		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
@@ -2129,6 +2802,7 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	xlog_clear(&writer->data_xlog);
 	ibuf_create(&writer->row_index_buf, &cord()->slabc,
 		    4096 * sizeof(uint32_t));
+	ibuf_create(&writer->prev_body_buf, &cord()->slabc, 4096);
 	run->info.min_lsn = INT64_MAX;
 	run->info.max_lsn = -1;
 	assert(run->page_info == NULL);
@@ -2162,6 +2836,22 @@ vy_run_writer_create_xlog(struct vy_run_writer *writer)
 	return 0;
 }
 
+/**
+ * Return the key of a statement written by a run writer.
+ * The key is allocated on the fiber region unless the statement
+ * is a key itself. Returns NULL on memory error.
+ */
+static const char *
+vy_run_writer_extract_key(struct vy_run_writer *writer,
+			  struct vy_entry entry)
+{
+	if (vy_stmt_is_key(entry.stmt))
+		return tuple_data(entry.stmt);
+	return tuple_extract_key(entry.stmt, writer->cmp_def,
+				 vy_entry_multikey_idx(entry, writer->cmp_def),
+				 NULL);
+}
+
 /**
  * Start a new page with a min_key stored in @a first_entry.
  * @param writer Run writer.
@@ -2178,12 +2868,7 @@ vy_run_writer_start_page(struct vy_run_writer *writer,
 	if (run->info.page_count >= writer->page_info_capacity &&
 	    vy_run_alloc_page_info(run, &writer->page_info_capacity) != 0)
 		return -1;
-	const char *key = vy_stmt_is_key(first_entry.stmt) ?
-			  tuple_data(first_entry.stmt) :
-			  tuple_extract_key(first_entry.stmt, writer->cmp_def,
-					    vy_entry_multikey_idx(first_entry,
-								  writer->cmp_def),
-					    NULL);
+	const char *key = vy_run_writer_extract_key(writer, first_entry);
 	if (key == NULL)
 		return -1;
 	if (run->info.page_count == 0) {
@@ -2196,6 +2881,7 @@ vy_run_writer_start_page(struct vy_run_writer *writer,
 	if (vy_page_info_create(page, writer->data_xlog.offset,
 				key, writer->cmp_def) != 0)
 		return -1;
+	page->restart_interval = writer->restart_interval;
 	xlog_tx_begin(&writer->data_xlog);
 	return 0;
 }
@@ -2220,15 +2906,21 @@ vy_run_writer_write_to_page(struct vy_run_writer *writer, struct vy_entry entry)
 	vy_stmt_ref_if_possible(entry.stmt);
 	struct vy_run *run = writer->run;
 	struct vy_page_info *page = run->page_info + run->info.page_count;
-	uint32_t *offset = (uint32_t *)ibuf_alloc(&writer->row_index_buf,
-						  sizeof(uint32_t));
-	if (offset == NULL) {
-		diag_set(OutOfMemory, sizeof(uint32_t), "ibuf", "row index");
-		return -1;
+	bool is_restart = page->row_count % page->restart_interval == 0;
+	if (is_restart) {
+		uint32_t *offset = (uint32_t *)ibuf_alloc(
+				&writer->row_index_buf, sizeof(uint32_t));
+		if (offset == NULL) {
+			diag_set(OutOfMemory, sizeof(uint32_t),
+				 "ibuf", "row index");
+			return -1;
+		}
+		*offset = page->unpacked_size;
 	}
-	*offset = page->unpacked_size;
 	if (vy_run_dump_stmt(entry, &writer->data_xlog, page,
-			     writer->cmp_def, writer->iid == 0) != 0)
+			     writer->cmp_def, writer->iid == 0,
+			     page->restart_interval > 1 ?
+			     &writer->prev_body_buf : NULL, is_restart) != 0)
 		return -1;
 	int64_t lsn = vy_stmt_lsn(entry.stmt);
 	run->info.min_lsn = MIN(run->info.min_lsn, lsn);
@@ -2250,12 +2942,21 @@ vy_run_writer_end_page(struct vy_run_writer *writer)
 	struct vy_page_info *page = run->page_info + run->info.page_count;
 
 	assert(page->row_count > 0);
+	if (writer->page_fences) {
+		const char *key = vy_run_writer_extract_key(writer,
+							    writer->last);
+		if (key == NULL ||
+		    vy_page_info_set_max_key(page, key, writer->cmp_def) != 0)
+			return -1;
+	}
+	uint32_t restart_count = vy_page_info_restart_count(page);
 	assert(ibuf_used(&writer->row_index_buf) ==
-	       sizeof(uint32_t) * page->row_count);
+	       sizeof(uint32_t) * restart_count);
 
 	struct xrow_header xrow;
 	uint32_t *row_index = (uint32_t *)writer->row_index_buf.rpos;
-	if (vy_row_index_encode(row_index, page->row_count, &xrow) < 0)
+	if (vy_row_index_encode(row_index, restart_count,
+				page->restart_interval, &xrow) < 0)
 		return -1;
 	ssize_t written = xlog_write_row(&writer->data_xlog, &xrow);
 	if (written < 0)
@@ -2311,6 +3012,7 @@ vy_run_writer_destroy(struct vy_run_writer *writer)
 	if (writer->bloom != NULL)
 		tuple_bloom_builder_delete(writer->bloom);
 	ibuf_destroy(&writer->row_index_buf);
+	ibuf_destroy(&writer->prev_body_buf);
 }
 
 int
@@ -2331,12 +3033,7 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 	}
 
 	assert(writer->last.stmt != NULL);
-	const char *key = vy_stmt_is_key(writer->last.stmt) ?
-		          tuple_data(writer->last.stmt) :
-			  tuple_extract_key(writer->last.stmt, writer->cmp_def,
-					    vy_entry_multikey_idx(writer->last,
-								  writer->cmp_def),
-					    NULL);
+	const char *key = vy_run_writer_extract_key(writer, writer->last);
 	if (key == NULL)
 		goto out;
 
@@ -2380,6 +3077,36 @@ vy_run_writer_abort(struct vy_run_writer *writer)
 	vy_run_writer_destroy(writer);
 }
 
+/**
+ * Restore the body of a statement stored in a VY_RUN_ROW_DELTA row
+ * given the body of the previous statement. The restored body is
+ * allocated on the fiber region.
+ */
+static int
+vy_run_rebuild_row_body(struct xrow_header *xrow, const char *prev_body,
+			uint32_t prev_body_size)
+{
+	uint32_t prefix_size = 0;
+	const char *suffix = NULL;
+	uint32_t suffix_size = 0;
+	if (vy_row_delta_decode(xrow, prev_body_size, &prefix_size,
+				&suffix, &suffix_size) != 0)
+		return -1;
+	size_t size = prefix_size + suffix_size;
+	char *body = region_alloc(&fiber()->gc, size);
+	if (body == NULL) {
+		diag_set(OutOfMemory, size, "region", "row body");
+		return -1;
+	}
+	if (prefix_size > 0)
+		memcpy(body, prev_body, prefix_size);
+	memcpy(body + prefix_size, suffix, suffix_size);
+	xrow->body->iov_base = body;
+	xrow->body->iov_len = size;
+	xrow->bodycnt = 1;
+	return 0;
+}
+
 int
 vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		     uint32_t space_id, uint32_t iid,
@@ -2427,15 +3154,28 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 			goto close_err;
 		uint32_t page_row_count = 0;
 		uint64_t page_row_index_offset = 0;
+		uint32_t page_restart_interval = 1;
 		uint64_t row_offset = xlog_cursor_tx_pos(&cursor);
+		const char *prev_body = NULL;
+		uint32_t prev_body_size = 0;
 
 		struct xrow_header xrow;
 		while ((rc = xlog_cursor_next_row(&cursor, &xrow)) == 0) {
 			if (xrow.type == VY_RUN_ROW_INDEX) {
 				page_row_index_offset = row_offset;
+				page_restart_interval =
+					vy_row_index_restart_interval(&xrow);
 				row_offset = xlog_cursor_tx_pos(&cursor);
 				continue;
 			}
+			if (xrow.type == VY_RUN_ROW_DELTA &&
+			    vy_run_rebuild_row_body(&xrow, prev_body,
+						    prev_body_size) != 0)
+				goto close_err;
+			if (xrow.bodycnt > 0) {
+				prev_body = xrow.body->iov_base;
+				prev_body_size = xrow.body->iov_len;
+			}
 			++page_row_count;
 			struct tuple *tuple = vy_stmt_decode(&xrow, format);
 			if (tuple == NULL)
@@ -2481,6 +3221,12 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		info->size = next_page_offset - page_offset;
 		info->unpacked_size = xlog_cursor_tx_pos(&cursor);
 		info->row_index_offset = page_row_index_offset;
+		info->restart_interval = page_restart_interval;
+		if (opts->page_fences && key != NULL &&
+		    vy_page_info_set_max_key(info, key, cmp_def) != 0) {
+			vy_page_info_destroy(info);
+			goto close_err;
+		}
 		++run->info.page_count;
 		vy_run_acct_page(run, info);
 
@@ -2612,7 +3358,7 @@ vy_slice_stream_read_page(struct vy_slice_stream *stream)
 	if (stream->page == NULL)
 		return -1;
 
-	if (vy_page_read(stream->page, page_info, run, zdctx) != 0) {
+	if (vy_page_read(stream->page, page_info, run, NULL, zdctx) != 0) {
 		vy_page_delete(stream->page);
 		stream->page = NULL;
 		return -1;
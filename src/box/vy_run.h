@@ -74,6 +74,21 @@ struct vy_run_env {
 	 * unconditionally remove unused runs' files in-place.
 	 */
 	bool initial_join;
+	/**
+	 * Max size of memory that can be used by bloom filters of
+	 * runs that can be reloaded from index files. When it's
+	 * exceeded, least recently used bloom filters are freed and
+	 * loaded back from disk on demand. 0 means unlimited.
+	 */
+	size_t bloom_memory_limit;
+	/** Size of memory used by bloom filters linked in @bloom_lru. */
+	size_t bloom_memory_used;
+	/**
+	 * List of runs with loaded bloom filters that can be freed,
+	 * linked by vy_run::in_bloom_lru. The most recently used
+	 * run is at the head.
+	 */
+	struct rlist bloom_lru;
 };
 
 /**
@@ -112,8 +127,21 @@ struct vy_page_info {
 	char *min_key;
 	/** Comparison hint of the min key. */
 	hint_t min_key_hint;
+	/**
+	 * Maximal key stored in the page or NULL if the page
+	 * index was written without page fences.
+	 */
+	char *max_key;
+	/** Comparison hint of the max key. */
+	hint_t max_key_hint;
 	/** Offset of the row index in the page. */
 	uint32_t row_index_offset;
+	/**
+	 * Number of statements between restart points of the page,
+	 * see struct vy_page. 1 means that every statement is stored
+	 * in full (the format used before prefix compression).
+	 */
+	uint32_t restart_interval;
 };
 
 /**
@@ -173,6 +201,20 @@ struct vy_run {
 	struct rlist in_unused;
 	/** Link in vy_lsm::runs list. */
 	struct rlist in_lsm;
+	/**
+	 * Size of the bloom filter. Remains set while the bloom
+	 * filter is freed, see vy_run_env::bloom_lru.
+	 */
+	size_t bloom_size;
+	/**
+	 * Path to the index file to load the bloom filter from or
+	 * NULL if the bloom filter can't be freed.
+	 */
+	char *index_path;
+	/** Link in vy_run_env::bloom_lru. */
+	struct rlist in_bloom_lru;
+	/** Set while the bloom filter is being loaded from disk. */
+	bool is_bloom_loading;
 };
 
 /**
@@ -290,6 +332,18 @@ struct vy_run_iterator {
 
 /**
  * Vinyl page stored in memory.
+ *
+ * Statements of a page may be prefix-compressed: every
+ * restart_interval-th statement (a restart point) is stored
+ * in full while a statement between restart points may be
+ * stored as a VY_RUN_ROW_DELTA row, which contains only the
+ * difference between the statement body and the body of the
+ * previous statement. The row index contains offsets of restart
+ * points so that a binary search can be done without decoding
+ * statements between them. Statements of a restart interval
+ * are decoded one by one into a buffer; the last decoded
+ * statement is remembered so that sequential access doesn't
+ * need to start over from the restart point.
  */
 struct vy_page {
 	/** Page position in the run file. */
@@ -298,10 +352,27 @@ struct vy_page {
 	uint32_t unpacked_size;
 	/** Number of statements in the page. */
 	uint32_t row_count;
-	/** Array of row offsets. */
+	/** Number of statements between restart points. */
+	uint32_t restart_interval;
+	/** Array of restart point offsets. */
 	uint32_t *row_index;
 	/** Pointer to the page data. */
 	char *data;
+	/**
+	 * Number of the last decoded statement or UINT32_MAX if
+	 * no statement has been decoded yet.
+	 */
+	uint32_t row_no;
+	/** Offset of the statement following the decoded one. */
+	uint32_t row_end;
+	/** The last decoded statement, its body points to row_buf. */
+	struct xrow_header row;
+	/** Buffer storing the body of the last decoded statement. */
+	char *row_buf;
+	/** Size of the body stored in row_buf. */
+	uint32_t row_buf_size;
+	/** Size of memory allocated for row_buf. */
+	uint32_t row_buf_capacity;
 };
 
 /**
@@ -335,12 +406,31 @@ vy_run_env_destroy(struct vy_run_env *env);
 void
 vy_run_env_enable_coio(struct vy_run_env *env);
 
+/**
+ * Set the max size of memory that can be used by bloom filters.
+ * Frees least recently used bloom filters if the new limit is
+ * exceeded.
+ */
+void
+vy_run_env_set_bloom_memory_limit(struct vy_run_env *env, size_t limit);
+
 /**
  * Return the size of a run bloom filter.
  */
 size_t
 vy_run_bloom_size(struct vy_run *run);
 
+/**
+ * Allow to free the bloom filter of a run when the bloom filter
+ * memory limit is exceeded. The bloom filter is loaded back from
+ * the run index file stored in the given directory on demand.
+ * Does nothing if the run doesn't have a bloom filter or its
+ * bloom filter may already be freed.
+ */
+void
+vy_run_enable_bloom_eviction(struct vy_run *run, const char *dir,
+			     uint32_t space_id, uint32_t iid);
+
 static inline struct vy_page_info *
 vy_run_page_info(struct vy_run *run, uint32_t pos)
 {
@@ -635,11 +725,23 @@ struct vy_run_writer {
 	double bloom_fpr;
 	/** Bloom filter. */
 	struct tuple_bloom_builder *bloom;
-	/** Buffer of a current page row offsets. */
+	/**
+	 * Number of statements between restart points of a page,
+	 * see struct vy_page.
+	 */
+	uint32_t restart_interval;
+	/** Store max keys of pages in the page index. */
+	bool page_fences;
+	/** Buffer of a current page restart point offsets. */
 	struct ibuf row_index_buf;
+	/**
+	 * Body of the last written statement, used for prefix
+	 * compression of the next one.
+	 */
+	struct ibuf prev_body_buf;
 	/**
 	 * Remember a last written statement to use it as a source
-	 * of max key of a finished run.
+	 * of max key of a finished page and run.
 	 */
 	struct vy_entry last;
 };
@@ -649,7 +751,9 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression);
+		     uint64_t page_size, double bloom_fpr,
+		     uint32_t restart_interval, bool page_fences,
+		     bool no_compression);
 
 /**
  * Write a specified statement into a run.
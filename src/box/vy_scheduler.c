@@ -79,6 +79,12 @@ static const struct cmsg_hop vy_task_complete_route[] = {
 	{ vy_task_complete_f, NULL },
 };
 
+/**
+ * Max number of parts compaction of a range can be split into,
+ * see vy_task_compaction_split().
+ */
+enum { VY_COMPACTION_PARTS_MAX = 16 };
+
 struct vy_task;
 
 /** Vinyl worker thread. */
@@ -205,6 +211,8 @@ struct vy_task {
 	 */
 	double bloom_fpr;
 	int64_t page_size;
+	int64_t page_restart_interval;
+	bool page_fences;
 	/**
 	 * Deferred DELETE handler passed to the write iterator.
 	 * It sends deferred DELETE statements generated during
@@ -218,6 +226,29 @@ struct vy_task {
 	 * and not yet processed.
 	 */
 	int deferred_delete_in_progress;
+	/**
+	 * Compaction of a big range may be split by key into several
+	 * parts, see vy_task_compaction_split(). Each part writes its
+	 * own run on its own worker and becomes a separate range on
+	 * completion. The first part is executed by the compaction
+	 * task itself, the others by auxiliary tasks linked in this
+	 * list.
+	 */
+	struct vy_task *next_part;
+	/** Compaction task this auxiliary task is a part of. */
+	struct vy_task *parent;
+	/**
+	 * Number of parts of the task, including the task itself,
+	 * that haven't been returned by workers yet.
+	 */
+	int parts_in_progress;
+	/** Key interval compacted by this part: [begin, end). */
+	struct vy_entry begin, end;
+	/**
+	 * Slices of the compacted runs cut by the part's key interval,
+	 * read by the part's write iterator. Linked by in_range.
+	 */
+	struct rlist part_slices;
 	/** Link in vy_scheduler::processed_tasks. */
 	struct stailq_entry in_processed;
 };
@@ -253,6 +284,10 @@ vy_task_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	vy_lsm_ref(lsm);
 	diag_create(&task->diag);
 	task->deferred_delete_handler.iface = &vy_task_deferred_delete_iface;
+	task->parts_in_progress = 1;
+	task->begin = vy_entry_none();
+	task->end = vy_entry_none();
+	rlist_create(&task->part_slices);
 	return task;
 }
 
@@ -262,6 +297,13 @@ vy_task_delete(struct vy_task *task)
 {
 	assert(task->deferred_delete_batch == NULL);
 	assert(task->deferred_delete_in_progress == 0);
+	assert(rlist_empty(&task->part_slices));
+	if (task->next_part != NULL)
+		vy_task_delete(task->next_part);
+	if (task->begin.stmt != NULL)
+		tuple_unref(task->begin.stmt);
+	if (task->end.stmt != NULL)
+		tuple_unref(task->end.stmt);
 	key_def_delete(task->cmp_def);
 	key_def_delete(task->key_def);
 	vy_lsm_unref(task->lsm);
@@ -1115,7 +1157,8 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 				 lsm->space_id, lsm->index_id,
 				 task->cmp_def, task->key_def,
 				 task->page_size, task->bloom_fpr,
-				 no_compression) != 0)
+				 task->page_restart_interval,
+				 task->page_fences, no_compression) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
@@ -1444,6 +1487,8 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	task->page_restart_interval = lsm->opts.page_restart_interval;
+	task->page_fences = lsm->opts.page_fences;
 
 	lsm->is_dumping = true;
 	vy_scheduler_update_lsm(scheduler, lsm);
@@ -1485,9 +1530,37 @@ vy_task_compaction_execute(struct vy_task *task)
 	return vy_task_write_run(task, false);
 }
 
+/**
+ * Close the write iterators of a compaction task and all its parts
+ * and delete the slices they were reading. The iterators have been
+ * cleaned up in workers. Safe to call more than once.
+ */
+static void
+vy_task_compaction_close(struct vy_task *task)
+{
+	for (struct vy_task *part = task; part != NULL;
+	     part = part->next_part) {
+		if (part->wi != NULL) {
+			part->wi->iface->close(part->wi);
+			part->wi = NULL;
+		}
+		struct vy_slice *slice, *next_slice;
+		rlist_foreach_entry_safe(slice, &part->part_slices,
+					 in_range, next_slice)
+			vy_slice_delete(slice);
+		rlist_create(&part->part_slices);
+	}
+}
+
+static int
+vy_task_split_compaction_complete(struct vy_task *task);
+
 static int
 vy_task_compaction_complete(struct vy_task *task)
 {
+	if (task->next_part != NULL)
+		return vy_task_split_compaction_complete(task);
+
 	struct vy_scheduler *scheduler = task->scheduler;
 	struct vy_lsm *lsm = task->lsm;
 	struct vy_range *range = task->range;
@@ -1640,8 +1713,7 @@ vy_task_compaction_complete(struct vy_task *task)
 		vy_slice_delete(slice);
 	}
 out:
-	/* The iterator has been cleaned up in worker. */
-	task->wi->iface->close(task->wi);
+	vy_task_compaction_close(task);
 
 	assert(heap_node_is_stray(&range->heap_node));
 	vy_range_heap_insert(&lsm->range_heap, range);
@@ -1652,6 +1724,216 @@ vy_task_compaction_complete(struct vy_task *task)
 	return 0;
 }
 
+/**
+ * Complete a compaction task split in parts. The compacted range is
+ * replaced with new ranges, one per part, each of which gets a slice
+ * of the run written by the part instead of the compacted slices and
+ * slices of the rest of the range runs cut by the part boundaries.
+ * All of this is logged in one vylog transaction.
+ */
+static int
+vy_task_split_compaction_complete(struct vy_task *task)
+{
+	struct vy_scheduler *scheduler = task->scheduler;
+	struct vy_lsm *lsm = task->lsm;
+	struct vy_range *range = task->range;
+	double compaction_time = ev_monotonic_now(loop()) - task->start_time;
+	struct vy_disk_stmt_counter compaction_output;
+	struct vy_disk_stmt_counter compaction_input;
+	struct vy_slice *first_slice = task->first_slice;
+	struct vy_slice *last_slice = task->last_slice;
+	struct vy_range *parts[VY_COMPACTION_PARTS_MAX] = { NULL };
+	int part_count = 0;
+	struct vy_slice *slice, *new_slice;
+	struct vy_task *part;
+	struct vy_run *run;
+
+	/*
+	 * Slices read by the parts must be deleted before looking
+	 * for unused runs, because they are accounted in the run
+	 * slice counters.
+	 */
+	vy_task_compaction_close(task);
+
+	/* See the comment in vy_task_compaction_complete(). */
+	if (lsm->is_dropped) {
+		for (part = task; part != NULL; part = part->next_part)
+			vy_run_unref(part->new_run);
+		goto out;
+	}
+
+	/*
+	 * Allocate new ranges, one per part. Iterate over the slices
+	 * backward, because vy_range_add_slice() adds a slice to the
+	 * list head.
+	 */
+	for (part = task; part != NULL; part = part->next_part) {
+		struct vy_range *new_range = vy_range_new(vy_log_next_id(),
+							  part->begin,
+							  part->end,
+							  lsm->cmp_def);
+		if (new_range == NULL)
+			goto fail;
+		parts[part_count++] = new_range;
+		bool is_compacted = false;
+		rlist_foreach_entry_reverse(slice, &range->slices, in_range) {
+			if (slice == last_slice)
+				is_compacted = true;
+			if (!is_compacted) {
+				/* Not compacted slice, cut it. */
+				if (vy_slice_cut(slice, vy_log_next_id(),
+						 new_range->begin,
+						 new_range->end, lsm->cmp_def,
+						 &new_slice) != 0)
+					goto fail;
+				if (new_slice != NULL)
+					vy_range_add_slice(new_range,
+							   new_slice);
+				continue;
+			}
+			/* Replace the compacted slices with the new run. */
+			if (slice != first_slice)
+				continue;
+			is_compacted = false;
+			if (vy_run_is_empty(part->new_run))
+				continue;
+			new_slice = vy_slice_new(vy_log_next_id(),
+						 part->new_run,
+						 vy_entry_none(),
+						 vy_entry_none(), lsm->cmp_def);
+			if (new_slice == NULL)
+				goto fail;
+			vy_range_add_slice(new_range, new_slice);
+		}
+		new_range->n_compactions = range->n_compactions + 1;
+		vy_range_update_compaction_priority(new_range, &lsm->opts);
+		vy_range_update_dumps_per_compaction(new_range);
+	}
+
+	/*
+	 * Build the list of runs that became unused
+	 * as a result of compaction.
+	 */
+	RLIST_HEAD(unused_runs);
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
+		slice->run->compacted_slice_count++;
+		if (slice == last_slice)
+			break;
+	}
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
+		run = slice->run;
+		if (run->compacted_slice_count == run->slice_count)
+			rlist_add_entry(&unused_runs, run, in_unused);
+		slice->run->compacted_slice_count = 0;
+		if (slice == last_slice)
+			break;
+	}
+
+	/*
+	 * Log change in metadata.
+	 */
+	vy_log_tx_begin();
+	rlist_foreach_entry(slice, &range->slices, in_range)
+		vy_log_delete_slice(slice->id);
+	vy_log_delete_range(range->id);
+	rlist_foreach_entry(run, &unused_runs, in_unused)
+		vy_log_drop_run(run->id, VY_LOG_GC_LSN_CURRENT);
+	for (part = task; part != NULL; part = part->next_part) {
+		run = part->new_run;
+		if (!vy_run_is_empty(run))
+			vy_log_create_run(lsm->id, run->id, run->dump_lsn,
+					  run->dump_count);
+	}
+	for (int i = 0; i < part_count; i++) {
+		struct vy_range *new_range = parts[i];
+		vy_log_insert_range(lsm->id, new_range->id,
+				    tuple_data_or_null(new_range->begin.stmt),
+				    tuple_data_or_null(new_range->end.stmt));
+		rlist_foreach_entry(slice, &new_range->slices, in_range)
+			vy_log_insert_slice(new_range->id, slice->run->id,
+					    slice->id,
+					    tuple_data_or_null(slice->begin.stmt),
+					    tuple_data_or_null(slice->end.stmt));
+	}
+	if (vy_log_tx_commit() < 0)
+		goto fail;
+
+	/* See the comment in vy_task_compaction_complete(). */
+	rlist_foreach_entry(run, &unused_runs, in_unused) {
+		if (run->dump_lsn > vy_log_signature() ||
+		    scheduler->run_env->initial_join)
+			vy_run_remove_files(lsm->env->path, lsm->space_id,
+					    lsm->index_id, run->id);
+	}
+
+	/*
+	 * Account the new runs that are not empty,
+	 * discard the rest.
+	 */
+	vy_disk_stmt_counter_reset(&compaction_output);
+	for (part = task; part != NULL; part = part->next_part) {
+		run = part->new_run;
+		vy_disk_stmt_counter_add(&compaction_output, &run->count);
+		if (!vy_run_is_empty(run)) {
+			vy_lsm_add_run(lsm, run);
+			/* Drop the reference held by the task. */
+			vy_run_unref(run);
+		} else {
+			vy_run_discard(run);
+		}
+	}
+
+	/*
+	 * Replace the compacted range with the new ranges in
+	 * the LSM tree. vy_lsm_remove_range() expects the range
+	 * to be in the heap, from which it was removed when the
+	 * task was scheduled.
+	 */
+	vy_disk_stmt_counter_reset(&compaction_input);
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
+		vy_disk_stmt_counter_add(&compaction_input, &slice->count);
+		if (slice == last_slice)
+			break;
+	}
+	vy_lsm_unacct_range(lsm, range);
+	vy_range_heap_insert(&lsm->range_heap, range);
+	vy_lsm_remove_range(lsm, range);
+	for (int i = 0; i < part_count; i++) {
+		vy_lsm_add_range(lsm, parts[i]);
+		vy_lsm_acct_range(lsm, parts[i]);
+	}
+	lsm->range_tree_version++;
+	vy_lsm_acct_compaction(lsm, compaction_time,
+			       &compaction_input, &compaction_output);
+	scheduler->stat.compaction_input += compaction_input.bytes;
+	scheduler->stat.compaction_output += compaction_output.bytes;
+	scheduler->stat.compaction_time += compaction_time;
+
+	say_info("%s: completed compacting range %s in %d parts",
+		 vy_lsm_name(lsm), vy_range_str(range), part_count);
+
+	/*
+	 * Unaccount unused runs and delete the compacted range
+	 * along with its slices.
+	 */
+	rlist_foreach_entry(run, &unused_runs, in_unused)
+		vy_lsm_remove_run(lsm, run);
+	rlist_foreach_entry(slice, &range->slices, in_range)
+		vy_slice_wait_pinned(slice);
+	vy_range_delete(range);
+	vy_scheduler_update_lsm(scheduler, lsm);
+	return 0;
+out:
+	assert(heap_node_is_stray(&range->heap_node));
+	vy_range_heap_insert(&lsm->range_heap, range);
+	vy_scheduler_update_lsm(scheduler, lsm);
+	return 0;
+fail:
+	for (int i = 0; i < part_count; i++)
+		vy_range_delete(parts[i]);
+	return -1;
+}
+
 static void
 vy_task_compaction_abort(struct vy_task *task)
 {
@@ -1659,21 +1941,143 @@ vy_task_compaction_abort(struct vy_task *task)
 	struct vy_lsm *lsm = task->lsm;
 	struct vy_range *range = task->range;
 
-	/* The iterator has been cleaned up in worker. */
-	task->wi->iface->close(task->wi);
+	vy_task_compaction_close(task);
 
 	struct error *e = diag_last_error(&task->diag);
 	error_log(e);
 	say_error("%s: failed to compact range %s",
 		  vy_lsm_name(lsm), vy_range_str(range));
 
-	vy_run_discard(task->new_run);
+	for (struct vy_task *part = task; part != NULL; part = part->next_part)
+		vy_run_discard(part->new_run);
 
 	assert(heap_node_is_stray(&range->heap_node));
 	vy_range_heap_insert(&lsm->range_heap, range);
 	vy_scheduler_update_lsm(scheduler, lsm);
 }
 
+/**
+ * Split compaction of a big range by key into several parts to be
+ * executed by idle compaction workers in parallel. The parts other
+ * than the first one are auxiliary tasks linked to @task, each of
+ * which takes a worker from the pool.
+ */
+static int
+vy_task_compaction_split(struct vy_task *task)
+{
+	static struct vy_task_ops compaction_part_ops = {
+		.execute = vy_task_compaction_execute,
+	};
+
+	struct vy_scheduler *scheduler = task->scheduler;
+	struct vy_lsm *lsm = task->lsm;
+	struct vy_range *range = task->range;
+
+	struct vy_worker *workers[VY_COMPACTION_PARTS_MAX - 1];
+	int worker_count = 0;
+	while (worker_count < VY_COMPACTION_PARTS_MAX - 1) {
+		struct vy_worker *worker =
+			vy_worker_pool_get(&scheduler->compaction_pool);
+		if (worker == NULL)
+			break;
+		workers[worker_count++] = worker;
+	}
+	const char *split_keys[VY_COMPACTION_PARTS_MAX - 1];
+	int key_count = vy_range_compaction_split_keys(range,
+					vy_lsm_range_size(lsm),
+					worker_count + 1, split_keys);
+	int i = key_count;
+	if (key_count == 0)
+		goto out;
+
+	task->begin = range->begin;
+	if (task->begin.stmt != NULL)
+		tuple_ref(task->begin.stmt);
+	struct vy_task *prev = task;
+	for (i = 0; i < key_count; i++) {
+		struct vy_entry key = vy_entry_key_from_msgpack(
+				lsm->env->key_format, lsm->cmp_def,
+				split_keys[i]);
+		if (key.stmt == NULL)
+			goto fail;
+		prev->end = key;
+		struct vy_task *part = vy_task_new(scheduler, workers[i], lsm,
+						   &compaction_part_ops);
+		if (part == NULL)
+			goto fail;
+		tuple_ref(key.stmt);
+		part->begin = key;
+		part->parent = task;
+		prev->next_part = part;
+		prev = part;
+		task->parts_in_progress++;
+	}
+	prev->end = range->end;
+	if (prev->end.stmt != NULL)
+		tuple_ref(prev->end.stmt);
+out:
+	/* Return the workers that turned out to be unneeded. */
+	for (; i < worker_count; i++)
+		vy_worker_pool_put(workers[i]);
+	return 0;
+fail:
+	for (; i < worker_count; i++)
+		vy_worker_pool_put(workers[i]);
+	return -1;
+}
+
+/**
+ * Prepare a part of a compaction task for execution: allocate a run
+ * for it and create a write iterator over the compacted slices, cut
+ * by the part's key interval if the compaction is split.
+ */
+static int
+vy_task_compaction_prepare(struct vy_task *task, struct vy_task *part,
+			   bool is_last_level, int64_t dump_lsn,
+			   uint32_t dump_count)
+{
+	struct vy_scheduler *scheduler = task->scheduler;
+	struct vy_lsm *lsm = task->lsm;
+
+	part->bloom_fpr = task->bloom_fpr;
+	part->page_size = task->page_size;
+	part->page_restart_interval = task->page_restart_interval;
+	part->page_fences = task->page_fences;
+	part->new_run = vy_run_prepare(scheduler->run_env, lsm);
+	if (part->new_run == NULL)
+		return -1;
+	part->new_run->dump_lsn = dump_lsn;
+	part->new_run->dump_count = dump_count;
+	part->wi = vy_write_iterator_new(part->cmp_def, lsm->index_id == 0,
+					 is_last_level, scheduler->read_views,
+					 lsm->index_id > 0 ? NULL :
+					 &part->deferred_delete_handler);
+	if (part->wi == NULL)
+		return -1;
+
+	struct vy_slice *slice = task->first_slice;
+	while (true) {
+		struct vy_slice *part_slice = slice;
+		if (task->next_part != NULL) {
+			if (vy_slice_cut(slice, vy_log_next_id(), part->begin,
+					 part->end, lsm->cmp_def,
+					 &part_slice) != 0)
+				return -1;
+			if (part_slice != NULL)
+				rlist_add_tail_entry(&part->part_slices,
+						     part_slice, in_range);
+		}
+		if (part_slice != NULL &&
+		    vy_write_iterator_new_slice(part->wi, part_slice,
+						lsm->disk_format) != 0)
+			return -1;
+		if (slice == task->last_slice)
+			break;
+		slice = rlist_next_entry(slice, in_range);
+	}
+	return 0;
+}
+
 static int
 vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		       struct vy_lsm *lsm, struct vy_task **p_task)
@@ -1699,28 +2103,13 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	if (task == NULL)
 		goto err_task;
 
-	struct vy_run *new_run = vy_run_prepare(scheduler->run_env, lsm);
-	if (new_run == NULL)
-		goto err_run;
-
-	struct vy_stmt_stream *wi;
 	bool is_last_level = (range->compaction_priority == range->slice_count);
-	wi = vy_write_iterator_new(task->cmp_def, lsm->index_id == 0,
-				   is_last_level, scheduler->read_views,
-				   lsm->index_id > 0 ? NULL :
-				   &task->deferred_delete_handler);
-	if (wi == NULL)
-		goto err_wi;
-
 	struct vy_slice *slice;
+	int64_t dump_lsn = -1;
 	int32_t dump_count = 0;
 	int n = range->compaction_priority;
 	rlist_foreach_entry(slice, &range->slices, in_range) {
-		if (vy_write_iterator_new_slice(wi, slice,
-						lsm->disk_format) != 0)
-			goto err_wi_sub;
-		new_run->dump_lsn = MAX(new_run->dump_lsn,
-					slice->run->dump_lsn);
+		dump_lsn = MAX(dump_lsn, slice->run->dump_lsn);
 		dump_count += slice->run->dump_count;
 		/* Remember the slices we are compacting. */
 		if (task->first_slice == NULL)
@@ -1731,7 +2120,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 			break;
 	}
 	assert(n == 0);
-	assert(new_run->dump_lsn >= 0);
+	assert(dump_lsn >= 0);
 	if (range->compaction_priority == range->slice_count)
 		dump_count -= slice->run->dump_count;
 	/*
@@ -1740,17 +2129,24 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	 * such as splitting/coalescing ranges for no good reason.
 	 */
 	if (range->needs_compaction)
-		new_run->dump_count = slice->run->dump_count;
-	else
-		new_run->dump_count = dump_count;
-
-	range->needs_compaction = false;
+		dump_count = slice->run->dump_count;
 
 	task->range = range;
-	task->new_run = new_run;
-	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	task->page_restart_interval = lsm->opts.page_restart_interval;
+	task->page_fences = lsm->opts.page_fences;
+
+	if (vy_task_compaction_split(task) != 0)
+		goto err_prepare;
+	for (struct vy_task *part = task; part != NULL;
+	     part = part->next_part) {
+		if (vy_task_compaction_prepare(task, part, is_last_level,
+					       dump_lsn, dump_count) != 0)
+			goto err_prepare;
+	}
+
+	range->needs_compaction = false;
 
 	/*
 	 * Remove the range we are going to compact from the heap
@@ -1759,17 +2155,28 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	vy_range_heap_delete(&lsm->range_heap, range);
 	vy_scheduler_update_lsm(scheduler, lsm);
 
-	say_info("%s: started compacting range %s, runs %d/%d",
-		 vy_lsm_name(lsm), vy_range_str(range),
-                 range->compaction_priority, range->slice_count);
+	if (task->next_part == NULL) {
+		say_info("%s: started compacting range %s, runs %d/%d",
+			 vy_lsm_name(lsm), vy_range_str(range),
+			 range->compaction_priority, range->slice_count);
+	} else {
+		say_info("%s: started compacting range %s, runs %d/%d, "
+			 "parts %d", vy_lsm_name(lsm), vy_range_str(range),
+			 range->compaction_priority, range->slice_count,
+			 task->parts_in_progress);
+	}
 	*p_task = task;
 	return 0;
 
-err_wi_sub:
-	task->wi->iface->close(wi);
-err_wi:
-	vy_run_discard(new_run);
-err_run:
+err_prepare:
+	vy_task_compaction_close(task);
+	for (struct vy_task *part = task; part != NULL;
+	     part = part->next_part) {
+		if (part->new_run != NULL)
+			vy_run_discard(part->new_run);
+		if (part->parent != NULL)
+			vy_worker_pool_put(part->worker);
+	}
 	vy_task_delete(task);
 err_task:
 	diag_log();
@@ -1842,8 +2249,20 @@ static void
 vy_task_complete_f(struct cmsg *cmsg)
 {
 	struct vy_task *task = container_of(cmsg, struct vy_task, cmsg);
-	stailq_add_tail_entry(&task->scheduler->processed_tasks,
-			      task, in_processed);
+	if (task->parent != NULL) {
+		/*
+		 * A part of a split compaction task is done. Release
+		 * its worker right away and complete the whole task
+		 * once all its parts are done.
+		 */
+		vy_worker_pool_put(task->worker);
+		task->worker = NULL;
+		task = task->parent;
+	}
+	if (--task->parts_in_progress == 0) {
+		stailq_add_tail_entry(&task->scheduler->processed_tasks,
+				      task, in_processed);
+	}
 	fiber_cond_signal(&task->scheduler->scheduler_cond);
 }
 
@@ -2032,6 +2451,14 @@ vy_task_complete(struct vy_task *task)
 		assert(!diag_is_empty(diag));
 		goto fail; /* ->execute fialed */
 	}
+	for (struct vy_task *part = task->next_part; part != NULL;
+	     part = part->next_part) {
+		if (part->is_failed) {
+			assert(!diag_is_empty(&part->diag));
+			diag_move(&part->diag, diag);
+			goto fail; /* ->execute of a part failed */
+		}
+	}
 	ERROR_INJECT(ERRINJ_VY_TASK_COMPLETE, {
 			diag_set(ClientError, ER_INJECTION,
 			       "vinyl task completion");
@@ -2116,9 +2543,12 @@ vy_scheduler_f(va_list va)
 			continue;
 		}
 
-		/* Queue the task for execution. */
-		cmsg_init(&task->cmsg, vy_task_execute_route);
-		cpipe_push(&task->worker->worker_pipe, &task->cmsg);
+		/* Queue the task and all its parts for execution. */
+		for (struct vy_task *part = task; part != NULL;
+		     part = part->next_part) {
+			cmsg_init(&part->cmsg, vy_task_execute_route);
+			cpipe_push(&part->worker->worker_pipe, &part->cmsg);
+		}
 
 		fiber_reschedule();
 		continue;
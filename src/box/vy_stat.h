@@ -187,6 +187,8 @@ struct vy_cache_stat {
 	struct vy_stmt_counter count;
 	/** Number of lookups in the cache. */
 	int64_t lookup;
+	/** Number of lookups that found a statement in the cache. */
+	int64_t hit;
 	/** Number of reads from the cache. */
 	struct vy_stmt_counter get;
 	/** Number of writes to the cache. */
@@ -162,6 +162,11 @@ struct wal_writer
 	bool checkpoint_triggered;
 	/** The current WAL file. */
 	struct xlog current_wal;
+	/**
+	 * Pool of threads compressing WAL blocks in background or
+	 * NULL if blocks are compressed by the WAL thread itself.
+	 */
+	struct xlog_compress_pool *compress_pool;
 	/**
 	 * Used if there was a WAL I/O error and we need to
 	 * keep adding all incoming requests to the rollback
@@ -420,6 +425,7 @@ static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 		  const char *wal_dirname, int64_t wal_max_size,
 		  double wal_retention_period,
+		  struct xlog_compress_pool *compress_pool,
 		  const struct tt_uuid *instance_uuid,
 		  wal_on_garbage_collection_f on_garbage_collection,
 		  wal_on_checkpoint_threshold_f on_checkpoint_threshold)
@@ -435,6 +441,8 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	struct xlog_opts opts = xlog_opts_default;
 	opts.sync_is_async = true;
+	opts.compress_pool = compress_pool;
+	writer->compress_pool = compress_pool;
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid, &opts);
 	/*
 	 * wal_retention_period must be set before gc is woken up.
@@ -468,6 +476,8 @@ static void
 wal_writer_destroy(struct wal_writer *writer)
 {
 	xdir_destroy(&writer->wal_dir);
+	if (writer->compress_pool != NULL)
+		xlog_compress_pool_delete(writer->compress_pool);
 }
 
 /** WAL writer thread routine. */
@@ -546,14 +556,22 @@ wal_open(struct wal_writer *writer)
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 int64_t wal_max_size, double wal_retention_period,
-	 const struct tt_uuid *instance_uuid,
+	 int compression_threads, const struct tt_uuid *instance_uuid,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold)
 {
+	assert(compression_threads >= 0);
+	struct xlog_compress_pool *compress_pool = NULL;
+	if (wal_mode != WAL_NONE && compression_threads > 0) {
+		compress_pool = xlog_compress_pool_new(compression_threads);
+		if (compress_pool == NULL)
+			return -1;
+	}
+
 	/* Initialize the state. */
 	struct wal_writer *writer = &wal_writer_singleton;
 	wal_writer_create(writer, wal_mode, wal_dirname, wal_max_size,
-			  wal_retention_period, instance_uuid,
+			  wal_retention_period, compress_pool, instance_uuid,
 			  on_garbage_collection, on_checkpoint_threshold);
 
 	/* Start WAL thread. */
@@ -102,13 +102,20 @@ typedef void (*wal_on_garbage_collection_f)(const struct vclock *vclock);
  */
 typedef void (*wal_on_checkpoint_threshold_f)(void);
 
+/** Max value of box.cfg.wal_compression_threads. */
+enum { WAL_COMPRESSION_THREADS_MAX = 64 };
+
 /**
  * Start WAL thread and initialize WAL writer.
+ *
+ * If @a compression_threads is not 0, WAL blocks are compressed by
+ * a pool of that many threads so that compression of a batch overlaps
+ * with writing the blocks of the batch that are already compressed.
  */
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 int64_t wal_max_size, double wal_retention_period,
-	 const struct tt_uuid *instance_uuid,
+	 int compression_threads, const struct tt_uuid *instance_uuid,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold);
 
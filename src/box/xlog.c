@@ -49,6 +49,7 @@
 #include "salad/grp_alloc.h"
 #include "trivia/util.h"
 #include "retention_period.h"
+#include "tt_pthread.h"
 
 /*
  * FALLOC_FL_KEEP_SIZE flag has existed since fallocate() was
@@ -90,6 +91,18 @@ enum {
 	 * Maybe this should be a configuration option.
 	 */
 	XLOG_TX_COMPRESS_THRESHOLD = 2 * 1024,
+	/**
+	 * Used instead of XLOG_TX_AUTOCOMMIT_THRESHOLD when a
+	 * compression pool is used, so that a write batch is split
+	 * into several blocks compressed in parallel with each other
+	 * and with writing the blocks compressed before.
+	 */
+	XLOG_TX_COMPRESS_BLOCK_SIZE = 32 * 1024,
+	/**
+	 * Max number of written blocks kept by an xlog for reuse
+	 * when a compression pool is used.
+	 */
+	XLOG_FREE_BLOCKS_MAX = 16,
 };
 
 const struct xlog_opts xlog_opts_default = {
@@ -98,6 +111,7 @@ const struct xlog_opts xlog_opts_default = {
 	.free_cache = false,
 	.sync_is_async = false,
 	.no_compression = false,
+	.compress_pool = NULL,
 };
 
 /* {{{ struct xlog_meta */
@@ -777,8 +791,304 @@ xdir_add_vclock(struct xdir *xdir, const struct vclock *vclock)
 /* }}} */
 
 
+/* {{{ xlog compression pool */
+
+/**
+ * Encode an xlog tx fixheader for @a len bytes of data following it.
+ */
+static void
+xlog_encode_fixheader(char *fixheader, log_magic_t magic, size_t len,
+		      uint32_t crc32c)
+{
+	memcpy(fixheader, &magic, sizeof(log_magic_t));
+	char *data = fixheader + sizeof(log_magic_t);
+	data = mp_encode_uint(data, len);
+	/* Encode crc32 for previous row */
+	data = mp_encode_uint(data, 0);
+	/* Encode crc32 for current row */
+	data = mp_encode_uint(data, crc32c);
+	/*
+	 * Encode a padding, to ensure the resulting
+	 * fixheader always has the same size.
+	 */
+	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
+	if (padding > 0) {
+		data = mp_encode_strl(data, padding - 1);
+		if (padding > 1) {
+			memset(data, 0, padding - 1);
+			data += padding - 1;
+		}
+	}
+}
+
+/**
+ * A block of rows forming a single xlog tx, submitted to
+ * a compression pool.
+ */
+struct xlog_block {
+	/** Link in xlog::pending_blocks or xlog::free_blocks. */
+	struct stailq_entry in_log;
+	/** Link in xlog_compress_pool::queue. */
+	struct stailq_entry in_pool;
+	/**
+	 * Encoded rows, starting with a space reserved for
+	 * the fixheader, like xlog::obuf.
+	 */
+	struct obuf obuf;
+	/** Number of rows in the block. */
+	int64_t tx_rows;
+	/**
+	 * Buffer with the compressed block, including the fixheader,
+	 * ready to be written to the file.
+	 */
+	char *zbuf;
+	/** Size of the compressed block or 0 if it is not compressed. */
+	size_t zsize;
+	/** Size of memory allocated for zbuf. */
+	size_t zbuf_capacity;
+	/** Compression error, NULL on success. */
+	const char *error;
+	/**
+	 * Set when the block is ready to be written.
+	 * Protected by xlog_compress_pool::mutex.
+	 */
+	bool is_ready;
+};
+
+struct xlog_compress_pool {
+	/** Protects the queue and xlog_block::is_ready. */
+	pthread_mutex_t mutex;
+	/** Signaled when a block is queued or the pool is stopped. */
+	pthread_cond_t queue_cond;
+	/** Signaled when a block is compressed. */
+	pthread_cond_t ready_cond;
+	/** Blocks waiting to be compressed, linked by in_pool. */
+	struct stailq queue;
+	/** Set when the threads are requested to exit. */
+	bool is_stopped;
+	/** Number of threads in the pool. */
+	int thread_count;
+	/** Compression threads. */
+	struct cord threads[0];
+};
+
+/**
+ * Compress a block of rows into a single zstd frame prepended with
+ * a fixheader, like xlog_tx_write_zstd() does. Runs in a compression
+ * thread so it must not use diag or fiber memory.
+ */
+static void
+xlog_block_compress(struct xlog_block *block, ZSTD_CCtx *zctx)
+{
+	struct obuf *obuf = &block->obuf;
+	struct iovec *iov;
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	size_t zmax_size = XLOG_FIXHEADER_SIZE;
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
+		zmax_size += ZSTD_compressBound(iov->iov_len - offset);
+		offset = 0;
+	}
+	if (block->zbuf_capacity < zmax_size) {
+		block->zbuf = xrealloc(block->zbuf, zmax_size);
+		block->zbuf_capacity = zmax_size;
+	}
+	char *zdst = block->zbuf + XLOG_FIXHEADER_SIZE;
+	char *zdst_end = block->zbuf + zmax_size;
+	uint32_t crc32c = 0;
+	/* 3 is compression level. */
+	ZSTD_compressBegin(zctx, 3);
+	offset = XLOG_FIXHEADER_SIZE;
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
+		size_t (*fcompress)(ZSTD_CCtx *, void *, size_t,
+				    const void *, size_t);
+		/*
+		 * If it's the last iov or the last
+		 * log has 0 bytes, end the stream.
+		 */
+		if (iov == obuf->iov + obuf->pos || !(iov + 1)->iov_len)
+			fcompress = ZSTD_compressEnd;
+		else
+			fcompress = ZSTD_compressContinue;
+		size_t zsize = fcompress(zctx, zdst, zdst_end - zdst,
+					 (char *)iov->iov_base + offset,
+					 iov->iov_len - offset);
+		if (ZSTD_isError(zsize)) {
+			block->error = ZSTD_getErrorName(zsize);
+			return;
+		}
+		crc32c = crc32_calc(crc32c, zdst, zsize);
+		zdst += zsize;
+		offset = 0;
+	}
+	xlog_encode_fixheader(block->zbuf, zrow_marker,
+			      zdst - block->zbuf - XLOG_FIXHEADER_SIZE,
+			      crc32c);
+	block->zsize = zdst - block->zbuf;
+}
+
+/** Compression thread main loop. */
+static void *
+xlog_compress_pool_f(void *arg)
+{
+	struct xlog_compress_pool *pool = arg;
+	ZSTD_CCtx *zctx = ZSTD_createCCtx();
+	if (zctx == NULL)
+		panic("failed to create zstd compression context");
+	tt_pthread_mutex_lock(&pool->mutex);
+	while (true) {
+		while (stailq_empty(&pool->queue) && !pool->is_stopped)
+			tt_pthread_cond_wait(&pool->queue_cond, &pool->mutex);
+		if (stailq_empty(&pool->queue))
+			break;
+		struct xlog_block *block = stailq_shift_entry(
+			&pool->queue, struct xlog_block, in_pool);
+		tt_pthread_mutex_unlock(&pool->mutex);
+		xlog_block_compress(block, zctx);
+		tt_pthread_mutex_lock(&pool->mutex);
+		block->is_ready = true;
+		tt_pthread_cond_broadcast(&pool->ready_cond);
+	}
+	tt_pthread_mutex_unlock(&pool->mutex);
+	ZSTD_freeCCtx(zctx);
+	return NULL;
+}
+
+/** Stop and join the first @a thread_count threads of a pool. */
+static void
+xlog_compress_pool_stop(struct xlog_compress_pool *pool, int thread_count)
+{
+	tt_pthread_mutex_lock(&pool->mutex);
+	pool->is_stopped = true;
+	tt_pthread_cond_broadcast(&pool->queue_cond);
+	tt_pthread_mutex_unlock(&pool->mutex);
+	for (int i = 0; i < thread_count; i++) {
+		if (cord_join(&pool->threads[i]) != 0)
+			panic("failed to join xlog compression thread");
+	}
+}
+
+/** Free a compression pool with all its threads stopped. */
+static void
+xlog_compress_pool_free(struct xlog_compress_pool *pool)
+{
+	assert(stailq_empty(&pool->queue));
+	tt_pthread_cond_destroy(&pool->ready_cond);
+	tt_pthread_cond_destroy(&pool->queue_cond);
+	tt_pthread_mutex_destroy(&pool->mutex);
+	free(pool);
+}
+
+struct xlog_compress_pool *
+xlog_compress_pool_new(int thread_count)
+{
+	assert(thread_count > 0);
+	struct xlog_compress_pool *pool = xcalloc(1, sizeof(*pool) +
+			thread_count * sizeof(pool->threads[0]));
+	tt_pthread_mutex_init(&pool->mutex, NULL);
+	tt_pthread_cond_init(&pool->queue_cond, NULL);
+	tt_pthread_cond_init(&pool->ready_cond, NULL);
+	stailq_create(&pool->queue);
+	pool->thread_count = thread_count;
+	for (int i = 0; i < thread_count; i++) {
+		if (cord_start(&pool->threads[i], "wal_compress",
+			       xlog_compress_pool_f, pool) != 0) {
+			xlog_compress_pool_stop(pool, i);
+			xlog_compress_pool_free(pool);
+			return NULL;
+		}
+	}
+	return pool;
+}
+
+void
+xlog_compress_pool_delete(struct xlog_compress_pool *pool)
+{
+	xlog_compress_pool_stop(pool, pool->thread_count);
+	xlog_compress_pool_free(pool);
+}
+
+/**
+ * Queue a block for compression or mark it as ready to be written
+ * right away if it doesn't need to be compressed.
+ */
+static void
+xlog_compress_pool_submit(struct xlog_compress_pool *pool,
+			  struct xlog_block *block, bool needs_compression)
+{
+	block->zsize = 0;
+	block->error = NULL;
+	tt_pthread_mutex_lock(&pool->mutex);
+	block->is_ready = !needs_compression;
+	if (needs_compression) {
+		stailq_add_tail_entry(&pool->queue, block, in_pool);
+		tt_pthread_cond_signal(&pool->queue_cond);
+	}
+	tt_pthread_mutex_unlock(&pool->mutex);
+}
+
+/** Wait until a submitted block is ready to be written. */
+static void
+xlog_compress_pool_wait(struct xlog_compress_pool *pool,
+			struct xlog_block *block)
+{
+	tt_pthread_mutex_lock(&pool->mutex);
+	while (!block->is_ready)
+		tt_pthread_cond_wait(&pool->ready_cond, &pool->mutex);
+	tt_pthread_mutex_unlock(&pool->mutex);
+}
+
+static struct xlog_block *
+xlog_block_new(void)
+{
+	struct xlog_block *block = xcalloc(1, sizeof(*block));
+	obuf_create(&block->obuf, &cord()->slabc,
+		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	return block;
+}
+
+static void
+xlog_block_delete(struct xlog_block *block)
+{
+	obuf_destroy(&block->obuf);
+	free(block->zbuf);
+	free(block);
+}
+
+/**
+ * Free all blocks of an xlog, waiting for the pending ones
+ * to be processed by the compression pool first.
+ */
+static void
+xlog_free_blocks(struct xlog *log)
+{
+	struct xlog_block *block, *tmp;
+	stailq_foreach_entry_safe(block, tmp, &log->pending_blocks, in_log) {
+		xlog_compress_pool_wait(log->opts.compress_pool, block);
+		xlog_block_delete(block);
+	}
+	stailq_create(&log->pending_blocks);
+	stailq_foreach_entry_safe(block, tmp, &log->free_blocks, in_log)
+		xlog_block_delete(block);
+	stailq_create(&log->free_blocks);
+	log->free_block_count = 0;
+}
+
+/* }}} */
+
 /* {{{ struct xlog */
 
+/**
+ * Return the size of the write buffer after which the buffered
+ * rows are written or, if a compression pool is used, submitted
+ * to the pool.
+ */
+static inline size_t
+xlog_tx_autocommit_threshold(const struct xlog *log)
+{
+	return log->opts.compress_pool != NULL ?
+	       XLOG_TX_COMPRESS_BLOCK_SIZE : XLOG_TX_AUTOCOMMIT_THRESHOLD;
+}
+
 int
 xlog_materialize(struct xlog *l)
 {
@@ -816,6 +1126,8 @@ xlog_init(struct xlog *xlog, const struct xlog_opts *opts)
 	xlog->is_autocommit = true;
 	obuf_create(&xlog->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	obuf_create(&xlog->zbuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	stailq_create(&xlog->pending_blocks);
+	stailq_create(&xlog->free_blocks);
 	if (!opts->no_compression) {
 		xlog->zctx = ZSTD_createCCtx();
 		if (xlog->zctx == NULL) {
@@ -844,6 +1156,7 @@ xlog_free(struct xlog *xlog)
 	assert(xlog->fd < 0);
 	assert(xlog->obuf.slabc == &cord()->slabc);
 	assert(xlog->zbuf.slabc == &cord()->slabc);
+	xlog_free_blocks(xlog);
 	obuf_destroy(&xlog->obuf);
 	obuf_destroy(&xlog->zbuf);
 	ZSTD_freeCCtx(xlog->zctx);
@@ -1092,62 +1405,43 @@ xlog_fallocate(struct xlog *log, size_t len)
 }
 
 /**
- * Write a sequence of uncompressed xrow objects.
+ * Write a sequence of uncompressed xrow objects stored in @a obuf.
  *
  * @retval -1 error
  * @retval >= 0 the number of bytes written
  */
 static off_t
-xlog_tx_write_plain(struct xlog *log)
+xlog_tx_write_plain(struct xlog *log, struct obuf *obuf)
 {
 	/**
 	 * We created an obuf savepoint at start of xlog_tx,
 	 * now populate it with data.
 	 */
-	char *fixheader = (char *)log->obuf.iov[0].iov_base;
-	memcpy(fixheader, &row_marker, sizeof(log_magic_t));
-	char *data = fixheader + sizeof(log_magic_t);
-
-	data = mp_encode_uint(data,
-			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
+	char *fixheader = (char *)obuf->iov[0].iov_base;
 	uint32_t crc32c = 0;
 	struct iovec *iov;
 	size_t offset = XLOG_FIXHEADER_SIZE;
-	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
 		crc32c = crc32_calc(crc32c,
 				    (char *)iov->iov_base + offset,
 				    iov->iov_len - offset);
 		offset = 0;
 	}
-	data = mp_encode_uint(data, crc32c);
-	/*
-	 * Encode a padding, to ensure the resulting
-	 * fixheader always has the same size.
-	 */
-	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_encode_fixheader(fixheader, row_marker,
+			      obuf_size(obuf) - XLOG_FIXHEADER_SIZE, crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
 		return -1;
 	});
 
-	ssize_t written = fio_writevn(log->fd, log->obuf.iov, log->obuf.pos + 1);
+	ssize_t written = fio_writevn(log->fd, obuf->iov, obuf->pos + 1);
 	if (written < 0) {
 		diag_set(SystemError, "failed to write to '%s' file",
 			 log->filename);
 		return -1;
 	}
-	return obuf_size(&log->obuf);
+	return obuf_size(obuf);
 }
 
 /**
@@ -1208,25 +1502,9 @@ xlog_tx_write_zstd(struct xlog *log)
 		offset = 0;
 	}
 
-	memcpy(fixheader, &zrow_marker, sizeof(log_magic_t));
-	char *data;
-	data = fixheader + sizeof(log_magic_t);
-	data = mp_encode_uint(data,
-			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
-	data = mp_encode_uint(data, crc32c);
-	/* Encode padding */
-	ssize_t padding;
-	padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_encode_fixheader(fixheader, zrow_marker,
+			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
@@ -1255,46 +1533,31 @@ xlog_tx_write_zstd(struct xlog *log)
 #define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
 
 /**
- * Writes xlog batch to file
+ * Truncate the file to the best known good write position after
+ * a write failure to simplify recovery.
  */
-static ssize_t
-xlog_tx_write(struct xlog *log)
+static void
+xlog_tx_write_rollback(struct xlog *log)
 {
-	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
-		return 0;
-	ssize_t written;
-
-	if (!log->opts.no_compression &&
-	    obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
-		written = xlog_tx_write_zstd(log);
-	} else {
-		written = xlog_tx_write_plain(log);
-	}
-	ERROR_INJECT(ERRINJ_WAL_WRITE, {
-		diag_set(ClientError, ER_INJECTION, "xlog write injection");
-		written = -1;
-	});
+	if (lseek(log->fd, log->offset, SEEK_SET) < 0 ||
+	    ftruncate(log->fd, log->offset) != 0)
+		panic_syserror("failed to truncate xlog after write error");
+	log->allocated = 0;
+}
 
-	obuf_reset(&log->obuf);
-	/*
-	 * Simplify recovery after a temporary write failure:
-	 * truncate the file to the best known good write
-	 * position.
-	 */
-	if (written < 0) {
-		if (lseek(log->fd, log->offset, SEEK_SET) < 0 ||
-		    ftruncate(log->fd, log->offset) != 0)
-			panic_syserror("failed to truncate xlog after write error");
-		log->allocated = 0;
-		return -1;
-	}
-	if (log->allocated > (size_t)written)
+/**
+ * Account @a written bytes containing @a tx_rows rows that have
+ * just been appended to the file and sync the file if needed.
+ */
+static void
+xlog_tx_write_complete(struct xlog *log, size_t written, int64_t tx_rows)
+{
+	if (log->allocated > written)
 		log->allocated -= written;
 	else
 		log->allocated = 0;
 	log->offset += written;
-	log->rows += log->tx_rows;
-	log->tx_rows = 0;
+	log->rows += tx_rows;
 	if ((log->opts.sync_interval && log->offset >=
 	    (off_t)(log->synced_size + log->opts.sync_interval)) ||
 	    (log->opts.rate_limit && log->offset >=
@@ -1333,9 +1596,174 @@ xlog_tx_write(struct xlog *log)
 		}
 		log->synced_size = log->offset;
 	}
+}
+
+static void
+xlog_tx_submit(struct xlog *log);
+
+/**
+ * Writes xlog batch to file
+ */
+static ssize_t
+xlog_tx_write(struct xlog *log)
+{
+	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
+		return 0;
+	if (log->opts.compress_pool != NULL) {
+		/* The rows will be written by xlog_flush(). */
+		xlog_tx_submit(log);
+		return 0;
+	}
+	ssize_t written;
+
+	if (!log->opts.no_compression &&
+	    obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
+		written = xlog_tx_write_zstd(log);
+	} else {
+		written = xlog_tx_write_plain(log, &log->obuf);
+	}
+	ERROR_INJECT(ERRINJ_WAL_WRITE, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		written = -1;
+	});
+
+	obuf_reset(&log->obuf);
+	if (written < 0) {
+		xlog_tx_write_rollback(log);
+		return -1;
+	}
+	xlog_tx_write_complete(log, written, log->tx_rows);
+	log->tx_rows = 0;
+	return written;
+}
+
+/**
+ * Hand the buffered rows over to the compression pool as a new
+ * block, see xlog_opts::compress_pool.
+ */
+static void
+xlog_tx_submit(struct xlog *log)
+{
+	struct xlog_block *block;
+	if (stailq_empty(&log->free_blocks)) {
+		block = xlog_block_new();
+	} else {
+		block = stailq_shift_entry(&log->free_blocks,
+					   struct xlog_block, in_log);
+		log->free_block_count--;
+	}
+	/* Swap the buffers to avoid copying the rows. */
+	struct obuf obuf = block->obuf;
+	block->obuf = log->obuf;
+	log->obuf = obuf;
+	block->tx_rows = log->tx_rows;
+	log->tx_rows = 0;
+	bool needs_compression = !log->opts.no_compression &&
+		obuf_size(&block->obuf) >= XLOG_TX_COMPRESS_THRESHOLD;
+	xlog_compress_pool_submit(log->opts.compress_pool, block,
+				  needs_compression);
+	stailq_add_tail_entry(&log->pending_blocks, block, in_log);
+}
+
+/** Write a block processed by the compression pool to the file. */
+static ssize_t
+xlog_block_write(struct xlog *log, struct xlog_block *block)
+{
+	ssize_t written;
+	if (block->error != NULL) {
+		diag_set(ClientError, ER_COMPRESSION, block->error);
+		return -1;
+	} else if (block->zsize == 0) {
+		written = xlog_tx_write_plain(log, &block->obuf);
+	} else {
+		ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
+			diag_set(ClientError, ER_INJECTION,
+				 "xlog write injection");
+			return -1;
+		});
+		if (fio_writen(log->fd, block->zbuf, block->zsize) < 0) {
+			diag_set(SystemError, "failed to write to '%s' file",
+				 log->filename);
+			return -1;
+		}
+		written = block->zsize;
+	}
+	ERROR_INJECT(ERRINJ_WAL_WRITE, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		written = -1;
+	});
 	return written;
 }
 
+/** Return a written or discarded block to the free list. */
+static void
+xlog_block_release(struct xlog *log, struct xlog_block *block)
+{
+	if (log->free_block_count >= XLOG_FREE_BLOCKS_MAX) {
+		xlog_block_delete(block);
+		return;
+	}
+	obuf_reset(&block->obuf);
+	stailq_add_entry(&log->free_blocks, block, in_log);
+	log->free_block_count++;
+}
+
+/**
+ * Discard all blocks submitted to the compression pool without
+ * writing them, waiting for the pool to finish with them first.
+ */
+static void
+xlog_discard_pending(struct xlog *log)
+{
+	struct xlog_block *block;
+	while (!stailq_empty(&log->pending_blocks)) {
+		block = stailq_shift_entry(&log->pending_blocks,
+					   struct xlog_block, in_log);
+		xlog_compress_pool_wait(log->opts.compress_pool, block);
+		xlog_block_release(log, block);
+	}
+}
+
+/**
+ * Write all blocks submitted to the compression pool to the file
+ * in order. While a block is being written, the following ones are
+ * still being compressed by the pool.
+ *
+ * Since none of the rows are reported as written until all of them
+ * are, on failure the file is truncated to the position it had
+ * before the first block was written.
+ */
+static ssize_t
+xlog_write_pending(struct xlog *log)
+{
+	struct xlog_compress_pool *pool = log->opts.compress_pool;
+	off_t offset = log->offset;
+	int64_t rows = log->rows;
+	ssize_t total = 0;
+	struct xlog_block *block;
+	while (!stailq_empty(&log->pending_blocks)) {
+		block = stailq_shift_entry(&log->pending_blocks,
+					   struct xlog_block, in_log);
+		xlog_compress_pool_wait(pool, block);
+		ssize_t written = xlog_block_write(log, block);
+		int64_t tx_rows = block->tx_rows;
+		xlog_block_release(log, block);
+		if (written < 0)
+			goto fail;
+		xlog_tx_write_complete(log, written, tx_rows);
+		total += written;
+	}
+	return total;
+fail:
+	xlog_discard_pending(log);
+	log->offset = offset;
+	log->rows = rows;
+	if (log->synced_size > (uint64_t)offset)
+		log->synced_size = offset;
+	xlog_tx_write_rollback(log);
+	return -1;
+}
+
 /*
  * Add a row to a log and possibly flush the log.
  *
@@ -1393,7 +1821,7 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 
 	size_t row_size = obuf_size(&log->obuf) - page_offset;
 	if (log->is_autocommit &&
-	    obuf_size(&log->obuf) >= XLOG_TX_AUTOCOMMIT_THRESHOLD &&
+	    obuf_size(&log->obuf) >= xlog_tx_autocommit_threshold(log) &&
 	    xlog_tx_write(log) < 0)
 		return -1;
 
@@ -1423,7 +1851,7 @@ ssize_t
 xlog_tx_commit(struct xlog *log)
 {
 	log->is_autocommit = true;
-	if (obuf_size(&log->obuf) >= XLOG_TX_AUTOCOMMIT_THRESHOLD) {
+	if (obuf_size(&log->obuf) >= xlog_tx_autocommit_threshold(log)) {
 		return xlog_tx_write(log);
 	}
 	return 0;
@@ -1438,6 +1866,12 @@ xlog_tx_rollback(struct xlog *log)
 	log->is_autocommit = true;
 	log->tx_rows = 0;
 	obuf_reset(&log->obuf);
+	/*
+	 * The rows submitted to the compression pool belong to
+	 * the same WAL write batch, which is rolled back as a whole.
+	 */
+	if (log->opts.compress_pool != NULL)
+		xlog_discard_pending(log);
 }
 
 /**
@@ -1448,6 +1882,11 @@ ssize_t
 xlog_flush(struct xlog *log)
 {
 	assert(log->is_autocommit);
+	if (log->opts.compress_pool != NULL) {
+		if (log->obuf.used != 0)
+			xlog_tx_write(log);
+		return xlog_write_pending(log);
+	}
 	if (log->obuf.used == 0)
 		return 0;
 	return xlog_tx_write(log);
@@ -1754,6 +2193,12 @@ xlog_fixheader_decode(struct xlog_fixheader *fixheader,
 	return 0;
 }
 
+bool
+xlog_tx_is_compressed(const char *data)
+{
+	return load_u32(data) == zrow_marker;
+}
+
 int
 xlog_tx_decode(const char *data, const char *data_end,
 	       char *rows, char *rows_end, ZSTD_DStream *zdctx)
@@ -41,9 +41,11 @@
 
 #include "small/ibuf.h"
 #include "small/obuf.h"
+#include "salad/stailq.h"
 
 struct iovec;
 struct xrow_header;
+struct xlog_compress_pool;
 
 #if defined(__cplusplus)
 extern "C" {
@@ -82,10 +84,45 @@ struct xlog_opts {
 	 * to be read frequently, e.g. L1 run files in Vinyl.
 	 */
 	bool no_compression;
+	/**
+	 * If set, xlog tx blocks are compressed by the threads of
+	 * this pool in background while the writer keeps encoding
+	 * new rows. Compressed blocks are written to the file in
+	 * order by xlog_flush(), so nothing is reported as written
+	 * until then.
+	 *
+	 * Rows are split into blocks of about 32 KB, so compression
+	 * overlaps with writing only for batches bigger than that.
+	 * Rows of a single xlog_tx_begin()/xlog_tx_commit() are never
+	 * split, so a big transaction is compressed by one thread.
+	 *
+	 * This option is useful for WAL files, which are written
+	 * in large batches.
+	 */
+	struct xlog_compress_pool *compress_pool;
 };
 
 extern const struct xlog_opts xlog_opts_default;
 
+/* {{{ xlog compression pool */
+
+/**
+ * Creates a pool of @a thread_count threads for compressing xlog tx
+ * blocks in background, see xlog_opts::compress_pool.
+ * Returns NULL and sets diag on error.
+ */
+struct xlog_compress_pool *
+xlog_compress_pool_new(int thread_count);
+
+/**
+ * Stops all threads of a compression pool and frees it. There must
+ * not be any xlogs using the pool.
+ */
+void
+xlog_compress_pool_delete(struct xlog_compress_pool *pool);
+
+/* }}} */
+
 /* {{{ log dir */
 
 /**
@@ -443,6 +480,15 @@ struct xlog {
 	 * Compressed output buffer
 	 */
 	struct obuf zbuf;
+	/**
+	 * Blocks of rows submitted to xlog_opts::compress_pool and
+	 * not written to the file yet, in the order of submission.
+	 */
+	struct stailq pending_blocks;
+	/** Blocks that have been written and can be reused. */
+	struct stailq free_blocks;
+	/** Number of blocks in free_blocks. */
+	int free_block_count;
 	/**
 	 * Synced file size
 	 */
@@ -566,7 +612,8 @@ ssize_t
 xlog_tx_commit(struct xlog *log);
 
 /**
- * Discard xlog row buffer
+ * Discard xlog row buffer and the blocks submitted to
+ * the compression pool, if any.
  */
 void
 xlog_tx_rollback(struct xlog *log);
@@ -725,6 +772,13 @@ xlog_tx_decode(const char *data, const char *data_end,
 	       char *rows, char *rows_end,
 	       ZSTD_DStream *zdctx);
 
+/**
+ * Check if the raw tx buffer holds zstd compressed rows. The
+ * buffer must be at least XLOG_FIXHEADER_SIZE bytes long.
+ */
+bool
+xlog_tx_is_compressed(const char *data);
+
 /* }}} */
 
 /* {{{ xlog_cursor - read rows from a log file */
@@ -34,6 +34,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
 /* Check whether CPU supports SSE 4.2 (needed to compute CRC32 in hardware).
  *
  * @param	feature		indetifier (see above) of the target feature
@@ -42,6 +46,12 @@
  */
 bool sse42_enabled_cpu();
 
+/* Check whether CPU and OS support AVX2 (used by SIMD bloom filter lookups).
+ *
+ * @return	true if feature is available, false if unavailable.
+ */
+bool avx2_enabled_cpu();
+
 #if defined (__x86_64__) || defined (__i386__)
 /* Hardware-calculate CRC32 for the given data buffer.
  *
@@ -55,5 +65,9 @@ bool sse42_enabled_cpu();
 uint32_t crc32c_hw(uint32_t crc, const char *buf, unsigned int len);
 #endif
 
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
 #endif /* TARANTOOL_CPU_FEATURES_H */
 
@@ -0,0 +1,85 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "latency_histogram.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+enum {
+	USEC_PER_SEC = 1000000,
+};
+
+uint64_t
+latency_histogram_bucket_max(int bucket)
+{
+	assert(bucket >= 0 && bucket < LATENCY_HISTOGRAM_BUCKET_COUNT);
+	if (bucket < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+		return bucket;
+	int group = bucket / LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+	int sub = bucket % LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+	int shift = group - 1;
+	uint64_t min = (uint64_t)(LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + sub) <<
+		       shift;
+	return min + (1ULL << shift) - 1;
+}
+
+void
+latency_histogram_reset(struct latency_histogram *hist)
+{
+	__atomic_store_n(&hist->max, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&hist->sum, 0, __ATOMIC_RELAXED);
+	for (int i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++)
+		__atomic_store_n(&hist->buckets[i], 0, __ATOMIC_RELAXED);
+}
+
+void
+latency_histogram_merge(struct latency_histogram *dst,
+			const struct latency_histogram *src)
+{
+	uint64_t max = __atomic_load_n(&src->max, __ATOMIC_RELAXED);
+	if (max > dst->max)
+		dst->max = max;
+	dst->sum += __atomic_load_n(&src->sum, __ATOMIC_RELAXED);
+	for (int i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+		dst->buckets[i] += __atomic_load_n(&src->buckets[i],
+						   __ATOMIC_RELAXED);
+	}
+}
+
+uint64_t
+latency_histogram_count(const struct latency_histogram *hist)
+{
+	uint64_t count = 0;
+	for (int i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++)
+		count += __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+	return count;
+}
+
+double
+latency_histogram_percentile(const struct latency_histogram *hist,
+			     double pct)
+{
+	uint64_t count = latency_histogram_count(hist);
+	if (count == 0)
+		return 0;
+	uint64_t rank = ceil(count * pct / 100);
+	if (rank == 0)
+		rank = 1;
+	uint64_t max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+	uint64_t seen = 0;
+	for (int i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+		seen += __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+		if (seen >= rank) {
+			uint64_t value = latency_histogram_bucket_max(i);
+			/* The bucket bound may exceed the max value. */
+			if (value > max)
+				value = max;
+			return (double)value / USEC_PER_SEC;
+		}
+	}
+	return (double)max / USEC_PER_SEC;
+}
@@ -0,0 +1,120 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/** log2 of the number of buckets per power of two. */
+	LATENCY_HISTOGRAM_SUB_BUCKET_BITS = 4,
+	/** Number of buckets per power of two. */
+	LATENCY_HISTOGRAM_SUB_BUCKET_COUNT =
+		1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS,
+	/**
+	 * Values are stored in microseconds. Values greater than
+	 * 2^LATENCY_HISTOGRAM_VALUE_BITS (more than an hour) are
+	 * accounted in the last bucket.
+	 */
+	LATENCY_HISTOGRAM_VALUE_BITS = 32,
+	/** Total number of buckets. */
+	LATENCY_HISTOGRAM_BUCKET_COUNT = LATENCY_HISTOGRAM_SUB_BUCKET_COUNT *
+		(LATENCY_HISTOGRAM_VALUE_BITS -
+		 LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1),
+};
+
+/**
+ * Log-linear latency histogram, in the spirit of HdrHistogram.
+ *
+ * Values below LATENCY_HISTOGRAM_SUB_BUCKET_COUNT microseconds have
+ * a bucket each. Greater values are split into powers of two, each
+ * of which is split into LATENCY_HISTOGRAM_SUB_BUCKET_COUNT equal
+ * buckets, so the relative error of a percentile doesn't exceed
+ * 1 / LATENCY_HISTOGRAM_SUB_BUCKET_COUNT.
+ *
+ * The histogram has a fixed size and doesn't allocate memory.
+ * It must be updated by a single thread, but may be read by any
+ * thread at any time without locking: counters are accessed with
+ * relaxed atomics, so a reader may observe a histogram that is
+ * being updated, but never a torn counter.
+ */
+struct latency_histogram {
+	/** Max observed value, in microseconds. */
+	uint64_t max;
+	/** Sum of all observed values, in microseconds. */
+	uint64_t sum;
+	/** Number of observations per bucket. */
+	uint64_t buckets[LATENCY_HISTOGRAM_BUCKET_COUNT];
+};
+
+/** Returns the index of the bucket for a value, in microseconds. */
+static inline int
+latency_histogram_bucket(uint64_t value)
+{
+	if (value < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+		return value;
+	if (value >= (1ULL << LATENCY_HISTOGRAM_VALUE_BITS))
+		return LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+	/* Position of the most significant bit. */
+	int msb = 63 - __builtin_clzll(value);
+	int shift = msb - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+	int group = shift + 1;
+	int sub = (value >> shift) - LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+	return group * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + sub;
+}
+
+/**
+ * Returns the greatest value, in microseconds, accounted in
+ * the given bucket.
+ */
+uint64_t
+latency_histogram_bucket_max(int bucket);
+
+/** Reset a histogram. Must be called by the writer thread. */
+void
+latency_histogram_reset(struct latency_histogram *hist);
+
+/**
+ * Account a new observation in a histogram.
+ * @value is the observed latency, in nanoseconds.
+ */
+static inline void
+latency_histogram_collect(struct latency_histogram *hist, uint64_t value)
+{
+	value /= 1000;
+	uint64_t *bucket = &hist->buckets[latency_histogram_bucket(value)];
+	__atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&hist->sum, hist->sum + value, __ATOMIC_RELAXED);
+	if (value > hist->max)
+		__atomic_store_n(&hist->max, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Add the observations of @src to @dst. @src may be updated by
+ * another thread concurrently, @dst may not.
+ */
+void
+latency_histogram_merge(struct latency_histogram *dst,
+			const struct latency_histogram *src);
+
+/** Returns the number of observations in a histogram. */
+uint64_t
+latency_histogram_count(const struct latency_histogram *hist);
+
+/**
+ * Returns a percentile of a histogram, in seconds, i.e. a value
+ * below which the given percentage of observations fall. Returns 0
+ * if there were no observations.
+ */
+double
+latency_histogram_percentile(const struct latency_histogram *hist,
+			     double pct);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
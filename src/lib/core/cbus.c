@@ -33,6 +33,16 @@
 #include <limits.h>
 #include "fiber.h"
 #include "trigger.h"
+#include "tweaks.h"
+
+/**
+ * How many times the consumer polls the endpoint for new messages
+ * after it has delivered a batch before going to sleep. Spinning
+ * saves a wakeup per batch when messages keep coming while an idle
+ * consumer doesn't burn CPU. Zero disables spinning.
+ */
+static uint64_t cbus_loop_spin_count = 1000;
+TWEAK_UINT(cbus_loop_spin_count);
 
 /**
  * Cord interconnect.
@@ -94,6 +104,7 @@ cpipe_create(struct cpipe *pipe, const char *consumer)
 
 	pipe->n_input = 0;
 	pipe->max_input = INT_MAX;
+	pipe->input_limit = INT_MAX;
 	pipe->producer = cord()->loop;
 
 	ev_async_init(&pipe->flush_input, cpipe_flush_cb);
@@ -112,6 +123,37 @@ cpipe_create(struct cpipe *pipe, const char *consumer)
 	tt_pthread_mutex_unlock(&cbus.mutex);
 }
 
+/**
+ * Push a batch of messages to the endpoint output. Safe to call
+ * from any number of producer cords concurrently.
+ *
+ * @retval true if the output was empty before the push, i.e. the
+ *         consumer may need to be woken up.
+ */
+static bool
+cbus_endpoint_push(struct cbus_endpoint *endpoint, struct stailq *input)
+{
+	assert(!stailq_empty(input));
+	/* The output is a stack, so link the batch in reverse order. */
+	struct stailq_entry *first = NULL;
+	struct stailq_entry *last = NULL;
+	while (!stailq_empty(input)) {
+		struct stailq_entry *item = stailq_shift(input);
+		item->next.value = first;
+		if (first == NULL)
+			last = item;
+		first = item;
+	}
+	struct stailq_entry *head = __atomic_load_n(&endpoint->output,
+						    __ATOMIC_RELAXED);
+	do {
+		last->next.value = head;
+	} while (!__atomic_compare_exchange_n(&endpoint->output, &head, first,
+					      /*weak=*/true, __ATOMIC_SEQ_CST,
+					      __ATOMIC_RELAXED));
+	return head == NULL;
+}
+
 struct cmsg_poison {
 	struct cmsg msg;
 	struct cbus_endpoint *endpoint;
@@ -149,11 +191,11 @@ cpipe_destroy(struct cpipe *pipe)
 	 * delivered.
 	 */
 	tt_pthread_mutex_lock(&endpoint->mutex);
+	/* Add the pipe shutdown message as the last one. */
+	stailq_add_tail_entry(&pipe->input, poison, msg.fifo);
 	/* Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
+	cbus_endpoint_push(endpoint, &pipe->input);
 	pipe->n_input = 0;
-	/* Add the pipe shutdown message as the last one. */
-	stailq_add_tail_entry(&endpoint->output, poison, msg.fifo);
 	/* Count statistics */
 	rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 	/*
@@ -215,7 +257,8 @@ cbus_endpoint_create(struct cbus_endpoint *endpoint, const char *name,
 	endpoint->n_pipes = 0;
 	fiber_cond_create(&endpoint->cond);
 	tt_pthread_mutex_init(&endpoint->mutex, NULL);
-	stailq_create(&endpoint->output);
+	endpoint->output = NULL;
+	endpoint->is_spinning = false;
 	ev_async_init(&endpoint->async,
 		      (void (*)(ev_loop *, struct ev_async *, int)) fetch_cb);
 	endpoint->async.data = fetch_data;
@@ -249,7 +292,8 @@ cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 	while (true) {
 		if (process_cb)
 			process_cb(endpoint);
-		if (endpoint->n_pipes == 0 && stailq_empty(&endpoint->output))
+		if (endpoint->n_pipes == 0 &&
+		    __atomic_load_n(&endpoint->output, __ATOMIC_ACQUIRE) == NULL)
 			break;
 		 fiber_cond_wait(&endpoint->cond);
 	}
@@ -267,6 +311,25 @@ cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 	return 0;
 }
 
+/**
+ * Adjust the flush threshold of a pipe with max_input set, see
+ * cpipe::input_limit.
+ */
+static inline void
+cpipe_adjust_input_limit(struct cpipe *pipe, bool output_was_empty)
+{
+	if (pipe->max_input == INT_MAX)
+		return;
+	if (output_was_empty) {
+		int min_input = MIN(CPIPE_MIN_INPUT, pipe->max_input);
+		pipe->input_limit = MAX(pipe->input_limit / 2, min_input);
+	} else if (pipe->input_limit <= pipe->max_input / 2) {
+		pipe->input_limit *= 2;
+	} else {
+		pipe->input_limit = pipe->max_input;
+	}
+}
+
 static void
 cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 {
@@ -279,16 +342,18 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 
 	trigger_run(&pipe->on_flush, pipe);
 	/* Trigger task processing when the queue becomes non-empty. */
-	bool output_was_empty;
-
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	output_was_empty = stailq_empty(&endpoint->output);
-	/** Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-
+	bool output_was_empty = cbus_endpoint_push(endpoint, &pipe->input);
 	pipe->n_input = 0;
-	if (output_was_empty) {
+	cpipe_adjust_input_limit(pipe, output_was_empty);
+	/*
+	 * A spinning consumer will notice the messages itself. Both
+	 * the push and the load are sequentially consistent, so if
+	 * we see that the consumer isn't spinning anymore, it is
+	 * either asleep or still going to check the output, see
+	 * cbus_endpoint_spin().
+	 */
+	if (output_was_empty &&
+	    !__atomic_load_n(&endpoint->is_spinning, __ATOMIC_SEQ_CST)) {
 		/* Count statistics */
 		rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 
@@ -590,26 +655,79 @@ cbus_unpair(struct cpipe *dest_pipe, struct cpipe *src_pipe,
 	cpipe_destroy(dest_pipe);
 }
 
-void
-cbus_process(struct cbus_endpoint *endpoint)
+/**
+ * Fetch and deliver all incoming messages.
+ * Returns the number of delivered messages.
+ */
+static int
+cbus_process_count(struct cbus_endpoint *endpoint)
 {
 	struct stailq output;
 	stailq_create(&output);
 	cbus_endpoint_fetch(endpoint, &output);
+	int count = 0;
 	struct cmsg *msg, *msg_next;
-	stailq_foreach_entry_safe(msg, msg_next, &output, fifo)
+	stailq_foreach_entry_safe(msg, msg_next, &output, fifo) {
 		cmsg_deliver(msg);
+		count++;
+	}
+	return count;
+}
+
+void
+cbus_process(struct cbus_endpoint *endpoint)
+{
+	cbus_process_count(endpoint);
+}
+
+/**
+ * Poll the endpoint output for a while waiting for new messages.
+ * Producers don't send wakeups to the endpoint while it spins.
+ *
+ * @retval true if there are new messages.
+ * @retval false if the output is empty and the consumer may sleep:
+ *         the next producer is going to wake it up.
+ */
+static bool
+cbus_endpoint_spin(struct cbus_endpoint *endpoint)
+{
+	uint64_t spin_count = __atomic_load_n(&cbus_loop_spin_count,
+					      __ATOMIC_RELAXED);
+	if (spin_count == 0)
+		return false;
+	__atomic_store_n(&endpoint->is_spinning, true, __ATOMIC_SEQ_CST);
+	for (uint64_t i = 0; i < spin_count; i++) {
+		if (__atomic_load_n(&endpoint->output,
+				    __ATOMIC_RELAXED) != NULL)
+			break;
+	}
+	__atomic_store_n(&endpoint->is_spinning, false, __ATOMIC_SEQ_CST);
+	/*
+	 * A producer may have seen the flag set and skipped the
+	 * wakeup, so look at the output once again after clearing
+	 * the flag.
+	 */
+	return __atomic_load_n(&endpoint->output, __ATOMIC_SEQ_CST) != NULL;
 }
 
 void
 cbus_loop(struct cbus_endpoint *endpoint)
 {
 	while (true) {
-		cbus_process(endpoint);
+		int count = cbus_process_count(endpoint);
 		fiber_check_gc();
 		if (fiber_is_cancelled())
 			break;
-		fiber_yield();
+		/*
+		 * Spin only after a busy round so that an idle
+		 * consumer doesn't burn CPU. Reschedule instead of
+		 * delivering right away to let the other fibers of
+		 * the cord and the event loop run.
+		 */
+		if (count > 0 && cbus_endpoint_spin(endpoint))
+			fiber_reschedule();
+		else
+			fiber_yield();
 	}
 }
 
@@ -118,9 +118,19 @@ struct cpipe {
 	/**
 	 * When pushing messages, keep the staged input size under
 	 * this limit (speeds up message delivery and reduces
-	 * latency, while still keeping the bus mutex cold enough).
+	 * latency, while still keeping the endpoint queue cold
+	 * enough).
 	 */
 	int max_input;
+	/**
+	 * The staged input size at which it is flushed. If max_input
+	 * is set, it is adjusted on each flush between
+	 * CPIPE_MIN_INPUT and max_input: halved when the consumer has
+	 * drained its queue, so that it gets new messages sooner, and
+	 * doubled when the consumer lags behind, so that messages are
+	 * flushed in bigger batches. Otherwise it equals max_input.
+	 */
+	int input_limit;
 	/**
 	 * Rather than flushing input into the pipe
 	 * whenever a single message or a batch is
@@ -142,6 +152,9 @@ struct cpipe {
 	struct rlist on_flush;
 };
 
+/** The lower bound of cpipe::input_limit. */
+enum { CPIPE_MIN_INPUT = 16 };
+
 /**
  * Initialize a pipe and connect it to the consumer.
  * Must be called by the producer. The call returns
@@ -164,16 +177,14 @@ cpipe_destroy(struct cpipe *pipe);
  * whenever the area has more messages than the cap, and also once
  * per event loop.
  * Otherwise, the messages flushed once per event loop iteration.
- *
- * @todo: collect bus stats per second and adjust max_input once
- * a second to keep the mutex cold regardless of the message load,
- * while still keeping the latency low if there are few
- * long-to-process messages.
+ * The actual flush threshold adapts to the consumer load, see
+ * cpipe::input_limit.
  */
 static inline void
 cpipe_set_max_input(struct cpipe *pipe, int max_input)
 {
 	pipe->max_input = max_input;
+	pipe->input_limit = max_input;
 }
 
 static inline void
@@ -194,7 +205,7 @@ cpipe_flush_input(struct cpipe *pipe)
 
 	/** Flush may be called with no input. */
 	if (pipe->n_input > 0) {
-		if (pipe->n_input < pipe->max_input) {
+		if (pipe->n_input < pipe->input_limit) {
 			/*
 			 * Not much input, can deliver all
 			 * messages at the end of the event loop
@@ -225,7 +236,7 @@ cpipe_push_input(struct cpipe *pipe, struct cmsg *msg)
 
 	stailq_add_tail_entry(&pipe->input, msg, fifo);
 	pipe->n_input++;
-	if (pipe->n_input >= pipe->max_input)
+	if (pipe->n_input >= pipe->input_limit)
 		ev_invoke(pipe->producer, &pipe->flush_input, EV_CUSTOM);
 }
 
@@ -239,7 +250,7 @@ static inline void
 cpipe_push(struct cpipe *pipe, struct cmsg *msg)
 {
 	cpipe_push_input(pipe, msg);
-	assert(pipe->n_input < pipe->max_input);
+	assert(pipe->n_input < pipe->input_limit);
 	if (pipe->n_input == 1)
 		ev_feed_event(pipe->producer, &pipe->flush_input, EV_CUSTOM);
 }
@@ -255,10 +266,26 @@ struct cbus_endpoint {
 	char name[FIBER_NAME_MAX];
 	/** Member of cbus->endpoints */
 	struct rlist in_cbus;
-	/** The lock around the pipe. */
+	/**
+	 * The lock held by a pipe while it pushes its poison
+	 * message, see cpipe_destroy(). Message delivery is
+	 * lock-free.
+	 */
 	pthread_mutex_t mutex;
-	/** A queue with incoming messages. */
-	struct stailq output;
+	/**
+	 * A lock-free stack of incoming messages linked through
+	 * cmsg::fifo, the most recently pushed message first.
+	 * Producers push whole batches with one compare-and-swap
+	 * while the consumer only ever takes all messages at once,
+	 * so the stack isn't subject to the ABA problem.
+	 */
+	struct stailq_entry *output;
+	/**
+	 * Set while the consumer polls the output for new messages
+	 * instead of sleeping, see cbus_loop(). Producers don't
+	 * wake up a spinning consumer.
+	 */
+	bool is_spinning;
 	/** Consumer cord loop */
 	ev_loop *consumer;
 	/** Async to notify the consumer */
@@ -275,9 +302,17 @@ struct cbus_endpoint {
 static inline void
 cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output)
 {
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	stailq_concat(output, &endpoint->output);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
+	struct stailq_entry *item = __atomic_exchange_n(&endpoint->output,
+							NULL, __ATOMIC_ACQUIRE);
+	/* Reverse the stack to restore the order of messages. */
+	struct stailq batch;
+	stailq_create(&batch);
+	while (item != NULL) {
+		struct stailq_entry *next = item->next.value;
+		stailq_add(&batch, item);
+		item = next;
+	}
+	stailq_concat(output, &batch);
 }
 
 /** Initialize the global singleton bus. */
@@ -30,6 +30,7 @@
  */
 #include "coio_file.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 #include "fiber.h"
 #include "say.h"
 #include "fio.h"
@@ -175,10 +176,15 @@ coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 			chunk = 1;
 		});
 
-		req = eio_write(fd, (char *)buf + pos, chunk,
-				offset + pos, EIO_PRI_DEFAULT,
-				coio_complete, &eio);
-		res = coio_wait_done(req, &eio);
+		if (coio_uring_is_enabled()) {
+			res = coio_uring_pwrite(fd, (char *)buf + pos, chunk,
+						offset + pos);
+		} else {
+			req = eio_write(fd, (char *)buf + pos, chunk,
+					offset + pos, EIO_PRI_DEFAULT,
+					coio_complete, &eio);
+			res = coio_wait_done(req, &eio);
+		}
 		if (res < 0) {
 			pos = -1;
 			break;
@@ -193,6 +199,8 @@ coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 ssize_t
 coio_pread(int fd, void *buf, size_t count, off_t offset)
 {
+	if (coio_uring_is_enabled())
+		return coio_uring_pread(fd, buf, count, offset);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_read(fd, buf, count,
 				offset, 0, coio_complete, &eio);
@@ -535,6 +543,8 @@ coio_sync(void)
 int
 coio_fsync(int fd)
 {
+	if (coio_uring_is_enabled())
+		return coio_uring_fsync(fd, false);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fsync(fd, 0, coio_complete, &eio);
 	return coio_wait_done(req, &eio);
@@ -543,6 +553,8 @@ coio_fsync(int fd)
 int
 coio_fdatasync(int fd)
 {
+	if (coio_uring_is_enabled())
+		return coio_uring_fsync(fd, true);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fdatasync(fd, 0, coio_complete, &eio);
 	return coio_wait_done(req, &eio);
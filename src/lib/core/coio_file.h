@@ -45,6 +45,10 @@ extern "C" {
  *
  * It follows the error reporting convention of the respective
  * system calls, i.e. it doesn't throw exceptions either.
+ *
+ * Positional reads and writes and fsync go through io_uring
+ * instead of the thread pool if it's enabled in the current
+ * cord, see coio_uring.h.
  */
 
 int     coio_file_open(const char *path, int flags, mode_t mode);
@@ -0,0 +1,441 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "coio_uring.h"
+
+#include <errno.h>
+
+#include "diag.h"
+#include "trivia/config.h"
+
+#if defined(HAVE_LINUX_IO_URING_H)
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "fiber.h"
+#include "fiber_cond.h"
+#include "say.h"
+#include "trivia/util.h"
+
+/* The syscall numbers are the same on all architectures. */
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+/** A request submitted to the ring. Lives on the fiber stack. */
+struct coio_uring_req {
+	/** Fiber waiting for the request completion. */
+	struct fiber *fiber;
+	/** Result of the request: >= 0 on success, -errno on error. */
+	int res;
+	/** Set when the completion is received. */
+	bool done;
+};
+
+/** An io_uring instance of a cord. */
+struct coio_uring {
+	/** Ring file descriptor. */
+	int fd;
+	/** Eventfd signalled by the kernel on request completion. */
+	int efd;
+	/** Mapped submission and completion queue rings. */
+	void *sq_ring;
+	size_t sq_ring_size;
+	void *cq_ring;
+	size_t cq_ring_size;
+	/** Mapped submission queue entries. */
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	/** Pointers into the submission queue ring. */
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_array;
+	unsigned sq_mask;
+	unsigned sq_entries;
+	/** Pointers into the completion queue ring. */
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	struct io_uring_cqe *cqes;
+	unsigned cq_mask;
+	/** Number of queued requests not passed to the kernel yet. */
+	unsigned to_submit;
+	/**
+	 * Number of requests queued but not completed yet. It never
+	 * exceeds the submission queue size, which guarantees that
+	 * the completion queue (twice as big) can't overflow.
+	 */
+	unsigned in_progress;
+	/** Signalled when a slot for a new request becomes free. */
+	struct fiber_cond slot_cond;
+	/** Submits the queued requests before the loop blocks. */
+	struct ev_prepare submit_event;
+	/** Reaps completions when the eventfd becomes readable. */
+	struct ev_io complete_event;
+};
+
+/** Ring of the current cord or NULL if io_uring isn't used. */
+static __thread struct coio_uring *coio_uring;
+
+static int
+sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+		   unsigned flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+static int
+sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+	return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/**
+ * Passes the queued requests to the kernel. On a transient
+ * failure the requests are left queued until the next attempt.
+ */
+static void
+coio_uring_submit(struct coio_uring *ring)
+{
+	while (ring->to_submit > 0) {
+		int rc = sys_io_uring_enter(ring->fd, ring->to_submit, 0, 0);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EBUSY)
+				say_syserror("io_uring_enter");
+			return;
+		}
+		assert((unsigned)rc <= ring->to_submit);
+		ring->to_submit -= rc;
+		if (rc == 0)
+			return;
+	}
+}
+
+static void
+coio_uring_on_prepare(ev_loop *loop, ev_prepare *watcher, int revents)
+{
+	(void)revents;
+	struct coio_uring *ring = watcher->data;
+	coio_uring_submit(ring);
+	if (ring->to_submit == 0)
+		ev_prepare_stop(loop, watcher);
+}
+
+/** Wakes up the fibers whose requests have completed. */
+static void
+coio_uring_reap(struct coio_uring *ring)
+{
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	if (head == tail)
+		return;
+	for (; head != tail; head++) {
+		struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+		struct coio_uring_req *req =
+			(struct coio_uring_req *)(uintptr_t)cqe->user_data;
+		req->res = cqe->res;
+		req->done = true;
+		fiber_wakeup(req->fiber);
+		assert(ring->in_progress > 0);
+		ring->in_progress--;
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	fiber_cond_broadcast(&ring->slot_cond);
+}
+
+static void
+coio_uring_on_complete(ev_loop *loop, ev_io *watcher, int revents)
+{
+	(void)loop;
+	(void)revents;
+	struct coio_uring *ring = watcher->data;
+	uint64_t value;
+	/* Reset the counter. Failure means it's already zero. */
+	(void)!read(ring->efd, &value, sizeof(value));
+	coio_uring_reap(ring);
+}
+
+/**
+ * Queues a request and yields until it completes. Returns the
+ * request result or -1 with errno set.
+ */
+static int
+coio_uring_call(uint8_t opcode, int fd, struct iovec *iov, off_t offset,
+		uint32_t fsync_flags)
+{
+	struct coio_uring *ring = coio_uring;
+	assert(ring != NULL);
+	while (ring->in_progress >= ring->sq_entries)
+		fiber_cond_wait(&ring->slot_cond);
+	/*
+	 * The kernel consumes all submitted entries in io_uring_enter,
+	 * so a free submission slot is guaranteed here unless entries
+	 * are still queued from the previous failed attempts.
+	 */
+	unsigned tail = *ring->sq_tail;
+	unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	if (tail - head >= ring->sq_entries) {
+		coio_uring_submit(ring);
+		head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+		if (tail - head >= ring->sq_entries) {
+			errno = EAGAIN;
+			return -1;
+		}
+	}
+	struct coio_uring_req req = {
+		.fiber = fiber(),
+		.res = 0,
+		.done = false,
+	};
+	unsigned index = tail & ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->off = offset;
+	if (iov != NULL) {
+		sqe->addr = (uintptr_t)iov;
+		sqe->len = 1;
+	}
+	sqe->fsync_flags = fsync_flags;
+	sqe->user_data = (uintptr_t)&req;
+	ring->sq_array[index] = index;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+	ring->in_progress++;
+	ev_prepare_start(loop(), &ring->submit_event);
+	while (!req.done)
+		fiber_yield();
+	if (req.res < 0) {
+		errno = -req.res;
+		return -1;
+	}
+	return req.res;
+}
+
+int
+coio_uring_init(unsigned entries)
+{
+	assert(coio_uring == NULL);
+	struct coio_uring *ring = xcalloc(1, sizeof(*ring));
+	ring->fd = -1;
+	ring->efd = -1;
+	ring->sq_ring = MAP_FAILED;
+	ring->cq_ring = MAP_FAILED;
+	ring->sqes = MAP_FAILED;
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	ring->fd = sys_io_uring_setup(entries, &p);
+	if (ring->fd < 0) {
+		diag_set(SystemError, "io_uring_setup");
+		goto fail;
+	}
+	ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ring->cq_ring_size = p.cq_off.cqes +
+			     p.cq_entries * sizeof(struct io_uring_cqe);
+	if ((p.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+		ring->sq_ring_size = MAX(ring->sq_ring_size,
+					 ring->cq_ring_size);
+	}
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+			     MAP_SHARED | MAP_POPULATE, ring->fd,
+			     IORING_OFF_SQ_RING);
+	if (ring->sq_ring == MAP_FAILED) {
+		diag_set(SystemError, "failed to map io_uring");
+		goto fail;
+	}
+	if ((p.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+		ring->cq_ring = mmap(NULL, ring->cq_ring_size,
+				     PROT_READ | PROT_WRITE,
+				     MAP_SHARED | MAP_POPULATE, ring->fd,
+				     IORING_OFF_CQ_RING);
+		if (ring->cq_ring == MAP_FAILED) {
+			diag_set(SystemError, "failed to map io_uring");
+			goto fail;
+		}
+	}
+	ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, ring->fd,
+			  IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		diag_set(SystemError, "failed to map io_uring");
+		goto fail;
+	}
+	char *sq = ring->sq_ring;
+	char *cq = ring->cq_ring != MAP_FAILED ? ring->cq_ring : sq;
+	ring->sq_head = (unsigned *)(sq + p.sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	ring->sq_array = (unsigned *)(sq + p.sq_off.array);
+	ring->sq_mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+	ring->sq_entries = p.sq_entries;
+	ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+	ring->cq_mask = *(unsigned *)(cq + p.cq_off.ring_mask);
+
+	ring->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (ring->efd < 0) {
+		diag_set(SystemError, "eventfd");
+		goto fail;
+	}
+	if (sys_io_uring_register(ring->fd, IORING_REGISTER_EVENTFD,
+				  &ring->efd, 1) != 0) {
+		diag_set(SystemError, "failed to register io_uring eventfd");
+		goto fail;
+	}
+	fiber_cond_create(&ring->slot_cond);
+	ev_prepare_init(&ring->submit_event, coio_uring_on_prepare);
+	ring->submit_event.data = ring;
+	ev_io_init(&ring->complete_event, coio_uring_on_complete,
+		   ring->efd, EV_READ);
+	ring->complete_event.data = ring;
+	ev_io_start(loop(), &ring->complete_event);
+	coio_uring = ring;
+	return 0;
+fail:
+	if (ring->efd >= 0)
+		close(ring->efd);
+	if (ring->sqes != MAP_FAILED)
+		munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring != MAP_FAILED)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	if (ring->sq_ring != MAP_FAILED)
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	if (ring->fd >= 0)
+		close(ring->fd);
+	free(ring);
+	return -1;
+}
+
+void
+coio_uring_free(void)
+{
+	struct coio_uring *ring = coio_uring;
+	/*
+	 * The kernel may still write to the buffers of the requests
+	 * in progress, so the ring must stay alive.
+	 */
+	if (ring == NULL || ring->in_progress > 0)
+		return;
+	ev_prepare_stop(loop(), &ring->submit_event);
+	ev_io_stop(loop(), &ring->complete_event);
+	fiber_cond_destroy(&ring->slot_cond);
+	close(ring->efd);
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring != MAP_FAILED)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	munmap(ring->sq_ring, ring->sq_ring_size);
+	close(ring->fd);
+	free(ring);
+	coio_uring = NULL;
+}
+
+bool
+coio_uring_is_enabled(void)
+{
+	return coio_uring != NULL;
+}
+
+ssize_t
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset)
+{
+	struct iovec iov = {.iov_base = buf, .iov_len = count};
+	return coio_uring_call(IORING_OP_READV, fd, &iov, offset, 0);
+}
+
+ssize_t
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset)
+{
+	struct iovec iov = {.iov_base = (void *)buf, .iov_len = count};
+	return coio_uring_call(IORING_OP_WRITEV, fd, &iov, offset, 0);
+}
+
+int
+coio_uring_fsync(int fd, bool datasync)
+{
+	return coio_uring_call(IORING_OP_FSYNC, fd, NULL, 0,
+			       datasync ? IORING_FSYNC_DATASYNC : 0);
+}
+
+#else /* !defined(HAVE_LINUX_IO_URING_H) */
+
+#include "trivia/util.h"
+
+int
+coio_uring_init(unsigned entries)
+{
+	(void)entries;
+	diag_set(IllegalParams, "io_uring is not supported");
+	return -1;
+}
+
+void
+coio_uring_free(void)
+{
+}
+
+bool
+coio_uring_is_enabled(void)
+{
+	return false;
+}
+
+ssize_t
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset)
+{
+	(void)fd;
+	(void)buf;
+	(void)count;
+	(void)offset;
+	unreachable();
+	errno = ENOTSUP;
+	return -1;
+}
+
+ssize_t
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset)
+{
+	(void)fd;
+	(void)buf;
+	(void)count;
+	(void)offset;
+	unreachable();
+	errno = ENOTSUP;
+	return -1;
+}
+
+int
+coio_uring_fsync(int fd, bool datasync)
+{
+	(void)fd;
+	(void)datasync;
+	unreachable();
+	errno = ENOTSUP;
+	return -1;
+}
+
+#endif /* !defined(HAVE_LINUX_IO_URING_H) */
@@ -0,0 +1,67 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+/**
+ * File I/O backed by Linux io_uring.
+ *
+ * A ring is created per cord. Requests issued by fibers during
+ * an event loop iteration are submitted to the kernel with a
+ * single system call right before the loop blocks, and their
+ * completions are delivered to the loop via an eventfd, so no
+ * thread pool is involved.
+ *
+ * All functions below follow the coio_file conventions: they
+ * yield the calling fiber until the request completes and
+ * return -1 with errno set on error. The requests can't be
+ * cancelled.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Create a ring with the given number of submission queue
+ * entries for the current cord. Returns -1 and sets diag if
+ * io_uring isn't supported by the build or the kernel.
+ */
+int
+coio_uring_init(unsigned entries);
+
+/**
+ * Destroy the ring of the current cord, if any. The ring is left
+ * alone if there are requests in progress.
+ */
+void
+coio_uring_free(void);
+
+/** Check if the current cord has an io_uring ring. */
+bool
+coio_uring_is_enabled(void);
+
+/** pread(2) via the ring of the current cord. */
+ssize_t
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset);
+
+/** pwrite(2) via the ring of the current cord. */
+ssize_t
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset);
+
+/**
+ * fsync(2) or, if @a datasync is set, fdatasync(2) via the ring
+ * of the current cord.
+ */
+int
+coio_uring_fsync(int fd, bool datasync);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -0,0 +1,189 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2021, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#if defined(ENABLE_TUPLE_COMPRESSION)
+# error unimplemented
+#endif
+
+#include "mp_compression.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mp_extension_types.h"
+#include "msgpuck.h"
+
+/** Max size of the MP_EXT header of the MP_COMPRESSION extension. */
+static inline uint32_t
+mp_compression_header_max(size_t src_size, enum compression_type type)
+{
+	return mp_sizeof_extl(UINT32_MAX) + mp_sizeof_uint(type) +
+	       mp_sizeof_uint(src_size);
+}
+
+size_t
+mp_compress_bound(size_t src_size, enum compression_type type)
+{
+	assert(type != COMPRESSION_TYPE_NONE && type < compression_type_MAX);
+	return mp_compression_header_max(src_size, type) +
+	       tt_compress_bound(type, src_size);
+}
+
+char *
+mp_compress(char *dst, const char *src, size_t src_size,
+	    enum compression_type type)
+{
+	assert(type != COMPRESSION_TYPE_NONE && type < compression_type_MAX);
+	if (src_size > UINT32_MAX)
+		return NULL;
+	/*
+	 * The size of the extension header depends on the size of
+	 * the compressed data so compress the data at the max header
+	 * offset first and then move it right after the real header.
+	 */
+	uint32_t header_max = mp_compression_header_max(src_size, type);
+	char *data = dst + header_max;
+	size_t data_size = tt_compress(type, data,
+				       tt_compress_bound(type, src_size),
+				       src, src_size);
+	if (data_size == 0)
+		return NULL;
+	uint32_t len = mp_sizeof_uint(type) + mp_sizeof_uint(src_size) +
+		       data_size;
+	if (mp_sizeof_extl(len) + len >= src_size)
+		return NULL;
+	char *pos = mp_encode_extl(dst, MP_COMPRESSION, len);
+	pos = mp_encode_uint(pos, type);
+	pos = mp_encode_uint(pos, src_size);
+	assert(pos <= data);
+	memmove(pos, data, data_size);
+	return pos + data_size;
+}
+
+/**
+ * Decodes the MP_COMPRESSION extension payload of @a len bytes at @a data.
+ * On success returns 0, sets @a type and @a raw_size, and advances @a data
+ * to the compressed data, which is @a data_size bytes long.
+ */
+static int
+mp_compression_unpack(const char **data, uint32_t len,
+		      enum compression_type *type, uint32_t *raw_size,
+		      uint32_t *data_size)
+{
+	const char *end = *data + len;
+	const char *pos = *data;
+	if (pos >= end || mp_typeof(*pos) != MP_UINT ||
+	    mp_check_uint(pos, end) > 0)
+		return -1;
+	uint64_t t = mp_decode_uint(&pos);
+	if (t == COMPRESSION_TYPE_NONE || t >= compression_type_MAX)
+		return -1;
+	if (pos >= end || mp_typeof(*pos) != MP_UINT ||
+	    mp_check_uint(pos, end) > 0)
+		return -1;
+	uint64_t size = mp_decode_uint(&pos);
+	if (size > UINT32_MAX)
+		return -1;
+	*type = (enum compression_type)t;
+	*raw_size = size;
+	*data_size = end - pos;
+	*data = pos;
+	return 0;
+}
+
+ssize_t
+mp_decompressed_size(const char *data)
+{
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(&data, &ext_type);
+	if (ext_type != MP_COMPRESSION)
+		return -1;
+	enum compression_type type;
+	uint32_t raw_size, data_size;
+	if (mp_compression_unpack(&data, len, &type, &raw_size,
+				  &data_size) != 0)
+		return -1;
+	return raw_size;
+}
+
+ssize_t
+mp_decompress(const char **src, char *dst, size_t dst_size)
+{
+	const char *data = *src;
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(&data, &ext_type);
+	if (ext_type != MP_COMPRESSION)
+		return -1;
+	const char *end = data + len;
+	enum compression_type type;
+	uint32_t raw_size, data_size;
+	if (mp_compression_unpack(&data, len, &type, &raw_size,
+				  &data_size) != 0)
+		return -1;
+	if (raw_size > dst_size)
+		return -1;
+	if (tt_decompress(type, dst, raw_size, data, data_size) != 0)
+		return -1;
+	/* Decompressed data must be a single valid MsgPack value. */
+	const char *check = dst;
+	if (mp_check(&check, dst + raw_size) != 0 || check != dst + raw_size)
+		return -1;
+	*src = end;
+	return raw_size;
+}
+
+/**
+ * Decompresses the MP_COMPRESSION extension payload of @a len bytes
+ * at @a data to a newly allocated buffer. Returns NULL on error.
+ * The buffer must be freed by the caller.
+ */
+static char *
+mp_compression_unpack_raw(const char **data, uint32_t len, uint32_t *size)
+{
+	const char *end = *data + len;
+	enum compression_type type;
+	uint32_t raw_size, data_size;
+	if (mp_compression_unpack(data, len, &type, &raw_size,
+				  &data_size) != 0)
+		return NULL;
+	char *raw = xmalloc(raw_size > 0 ? raw_size : 1);
+	const char *check = raw;
+	if (tt_decompress(type, raw, raw_size, *data, data_size) != 0 ||
+	    mp_check(&check, raw + raw_size) != 0 ||
+	    check != raw + raw_size) {
+		free(raw);
+		return NULL;
+	}
+	*data = end;
+	*size = raw_size;
+	return raw;
+}
+
+int
+mp_snprint_compression(char *buf, int size, const char **data, uint32_t len)
+{
+	uint32_t raw_size;
+	char *raw = mp_compression_unpack_raw(data, len, &raw_size);
+	if (raw == NULL)
+		return -1;
+	const char *pos = raw;
+	int rc = mp_snprint(buf, size, pos);
+	free(raw);
+	return rc;
+}
+
+int
+mp_fprint_compression(FILE *file, const char **data, uint32_t len)
+{
+	uint32_t raw_size;
+	char *raw = mp_compression_unpack_raw(data, len, &raw_size);
+	if (raw == NULL)
+		return -1;
+	const char *pos = raw;
+	int rc = mp_fprint(file, pos);
+	free(raw);
+	return rc;
+}
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/types.h>
 #include "tt_compression.h"
 #include <trivia/util.h>
 
@@ -20,48 +21,62 @@
 extern "C" {
 #endif
 
-static inline char *
+/**
+ * Data compressed with a compression_type other than NONE is stored in
+ * the MP_COMPRESSION MsgPack extension:
+ *
+ * +--------+------------------+-----------------+------------------+
+ * | MP_EXT | compression type | raw data size   | compressed data  |
+ * |        | (MP_UINT)        | (MP_UINT)       |                  |
+ * +--------+------------------+-----------------+------------------+
+ */
+
+/**
+ * Returns the max size of the MP_COMPRESSION extension storing
+ * @a src_size bytes of MsgPack compressed with @a type.
+ */
+size_t
+mp_compress_bound(size_t src_size, enum compression_type type);
+
+/**
+ * Compresses @a src_size bytes of MsgPack @a src and encodes the result
+ * in the MP_COMPRESSION extension to @a dst, which must be at least
+ * mp_compress_bound() bytes long.
+ *
+ * Returns a pointer to the end of the encoded data or NULL if the data
+ * couldn't be compressed or compression doesn't save any space, in which
+ * case the caller is supposed to store @a src as is.
+ */
+char *
 mp_compress(char *dst, const char *src, size_t src_size,
-	    enum compression_type type)
-{
-        (void)dst;
-        (void)src;
-        (void)src_size;
-        (void)type;
-        unreachable();
-        return NULL;
-}
+	    enum compression_type type);
 
-static inline size_t
-mp_decompress(const char **src, char *dst, size_t dst_size)
-{
-        (void)src;
-        (void)dst;
-        (void)dst_size;
-        unreachable();
-        return 0;
-}
+/**
+ * Returns the size of MsgPack stored in the MP_COMPRESSION extension
+ * at @a data after decompression or -1 if the extension is malformed.
+ */
+ssize_t
+mp_decompressed_size(const char *data);
 
-static inline int
-mp_snprint_compression(char *buf, int size, const char **data, uint32_t len)
-{
-        (void)buf;
-        (void)size;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
-}
+/**
+ * Decompresses MsgPack stored in the MP_COMPRESSION extension at @a src
+ * to @a dst, which must be at least mp_decompressed_size() bytes long,
+ * and advances @a src. Returns the size of the decompressed data or -1
+ * if the data is corrupted. Doesn't set diag.
+ */
+ssize_t
+mp_decompress(const char **src, char *dst, size_t dst_size);
+
+/**
+ * Prints the decompressed value stored in the MP_COMPRESSION extension
+ * payload of @a len bytes at @a data.
+ */
+int
+mp_snprint_compression(char *buf, int size, const char **data, uint32_t len);
 
-static inline int
-mp_fprint_compression(FILE *file, const char **data, uint32_t len)
-{
-        (void)file;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
-}
+/** Same as mp_snprint_compression(), but prints to a file. */
+int
+mp_fprint_compression(FILE *file, const char **data, uint32_t len);
 
 #if defined(__cplusplus)
 } /* extern "C" */
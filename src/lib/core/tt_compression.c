@@ -9,6 +9,146 @@
 # error unimplemented
 #endif
 
+#include "tt_compression.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zstd.h>
+
+#include "say.h"
+#include "trivia/util.h"
+
 const char *compression_type_strs[] = {
         "none",
+        "zstd",
+};
+
+static_assert(lengthof(compression_type_strs) == compression_type_MAX,
+	      "compression_type_strs must cover all compression types");
+
+/**
+ * Compression level used for zstd. Tuples are compressed in the tx thread
+ * on every write so we prefer speed to compression ratio.
+ */
+enum { TT_COMPRESSION_ZSTD_LEVEL = 1 };
+
+/**
+ * Thread-local compression contexts. Creating a zstd context is expensive
+ * so we create one per thread on demand and reuse it.
+ */
+struct tt_compression_ctx {
+	/** Zstd compression context. */
+	ZSTD_CCtx *zcctx;
+	/** Zstd decompression context. */
+	ZSTD_DCtx *zdctx;
 };
+
+/** Key of the thread-local tt_compression_ctx. */
+static pthread_key_t tt_compression_ctx_key;
+
+/** Guard for tt_compression_ctx_key creation. */
+static pthread_once_t tt_compression_ctx_key_once = PTHREAD_ONCE_INIT;
+
+/** Destructor of the thread-local tt_compression_ctx. */
+static void
+tt_compression_ctx_delete(void *arg)
+{
+	struct tt_compression_ctx *ctx = arg;
+	ZSTD_freeCCtx(ctx->zcctx);
+	ZSTD_freeDCtx(ctx->zdctx);
+	free(ctx);
+}
+
+static void
+tt_compression_ctx_key_create(void)
+{
+	if (pthread_key_create(&tt_compression_ctx_key,
+			       tt_compression_ctx_delete) != 0)
+		panic("failed to create compression context key");
+}
+
+/** Returns the compression context of the current thread. */
+static struct tt_compression_ctx *
+tt_compression_ctx(void)
+{
+	pthread_once(&tt_compression_ctx_key_once,
+		     tt_compression_ctx_key_create);
+	struct tt_compression_ctx *ctx =
+		pthread_getspecific(tt_compression_ctx_key);
+	if (ctx == NULL) {
+		ctx = xcalloc(1, sizeof(*ctx));
+		if (pthread_setspecific(tt_compression_ctx_key, ctx) != 0)
+			panic("failed to set compression context");
+	}
+	return ctx;
+}
+
+size_t
+tt_compress_bound(enum compression_type type, size_t size)
+{
+	switch (type) {
+	case COMPRESSION_TYPE_NONE:
+		return size;
+	case COMPRESSION_TYPE_ZSTD:
+		return ZSTD_compressBound(size);
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+size_t
+tt_compress(enum compression_type type, char *dst, size_t dst_size,
+	    const char *src, size_t src_size)
+{
+	switch (type) {
+	case COMPRESSION_TYPE_NONE:
+		if (src_size > dst_size)
+			return 0;
+		memcpy(dst, src, src_size);
+		return src_size;
+	case COMPRESSION_TYPE_ZSTD: {
+		struct tt_compression_ctx *ctx = tt_compression_ctx();
+		if (ctx->zcctx == NULL) {
+			ctx->zcctx = ZSTD_createCCtx();
+			if (ctx->zcctx == NULL)
+				return 0;
+		}
+		size_t rc = ZSTD_compressCCtx(ctx->zcctx, dst, dst_size,
+					      src, src_size,
+					      TT_COMPRESSION_ZSTD_LEVEL);
+		return ZSTD_isError(rc) ? 0 : rc;
+	}
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+int
+tt_decompress(enum compression_type type, char *dst, size_t dst_size,
+	      const char *src, size_t src_size)
+{
+	switch (type) {
+	case COMPRESSION_TYPE_NONE:
+		if (src_size != dst_size)
+			return -1;
+		memcpy(dst, src, src_size);
+		return 0;
+	case COMPRESSION_TYPE_ZSTD: {
+		struct tt_compression_ctx *ctx = tt_compression_ctx();
+		if (ctx->zdctx == NULL) {
+			ctx->zdctx = ZSTD_createDCtx();
+			if (ctx->zdctx == NULL)
+				return -1;
+		}
+		size_t rc = ZSTD_decompressDCtx(ctx->zdctx, dst, dst_size,
+						src, src_size);
+		return ZSTD_isError(rc) || rc != dst_size ? -1 : 0;
+	}
+	default:
+		return -1;
+	}
+}
@@ -21,11 +21,38 @@ extern "C" {
 
 enum compression_type {
         COMPRESSION_TYPE_NONE = 0,
+        COMPRESSION_TYPE_ZSTD = 1,
         compression_type_MAX
 };
 
 extern const char *compression_type_strs[];
 
+/**
+ * Returns the max size of @a size bytes of data compressed with
+ * the given compression type.
+ */
+size_t
+tt_compress_bound(enum compression_type type, size_t size);
+
+/**
+ * Compresses @a src_size bytes of @a src into @a dst, which is @a dst_size
+ * bytes long. Returns the size of the compressed data or 0 if the data
+ * couldn't be compressed, e.g. because it doesn't fit in @a dst. Doesn't
+ * set diag.
+ */
+size_t
+tt_compress(enum compression_type type, char *dst, size_t dst_size,
+	    const char *src, size_t src_size);
+
+/**
+ * Decompresses @a src_size bytes of @a src into @a dst. The size of
+ * the decompressed data must be equal to @a dst_size.
+ * Returns 0 on success, -1 if the data is corrupted. Doesn't set diag.
+ */
+int
+tt_decompress(enum compression_type type, char *dst, size_t dst_size,
+	      const char *src, size_t src_size);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -39,10 +39,188 @@
 #include <assert.h>
 #include <string.h>
 
+const uint32_t bloom_split_salt[BLOOM_SPLIT_BLOCK_WORDS] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+bool
+bloom_split_check_generic(const struct bloom_split_block *block,
+			  bloom_hash_t hash)
+{
+	for (int i = 0; i < BLOOM_SPLIT_BLOCK_WORDS; i++) {
+		uint32_t bit_no = (hash * bloom_split_salt[i]) >> 27;
+		if ((block->words[i] & (1U << bit_no)) == 0)
+			return false;
+	}
+	return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+/**
+ * AVX2 implementation of bloom_split_check_f: computes the masks for
+ * all eight words at once and tests them against the block with a
+ * single instruction.
+ */
+__attribute__((target("avx2")))
+static bool
+bloom_split_check_avx2(const struct bloom_split_block *block,
+		       bloom_hash_t hash)
+{
+	const __m256i salt = _mm256_loadu_si256((const __m256i *)
+						bloom_split_salt);
+	__m256i bit_no = _mm256_mullo_epi32(_mm256_set1_epi32(hash), salt);
+	bit_no = _mm256_srli_epi32(bit_no, 27);
+	__m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bit_no);
+	__m256i bits = _mm256_load_si256((const __m256i *)block->words);
+	/* Check that (~bits & mask) == 0. */
+	return _mm256_testc_si256(bits, mask) != 0;
+}
+
+#endif /* defined(__x86_64__) || defined(__i386__) */
+
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+/**
+ * NEON implementation of bloom_split_check_f. NEON is mandatory
+ * on AArch64 so it doesn't need a runtime check.
+ */
+static bool
+bloom_split_check_neon(const struct bloom_split_block *block,
+		       bloom_hash_t hash)
+{
+	uint32x4_t h = vdupq_n_u32(hash);
+	uint32x4_t one = vdupq_n_u32(1);
+	uint32x4_t bit_no_lo = vshrq_n_u32(
+		vmulq_u32(h, vld1q_u32(bloom_split_salt)), 27);
+	uint32x4_t bit_no_hi = vshrq_n_u32(
+		vmulq_u32(h, vld1q_u32(bloom_split_salt + 4)), 27);
+	uint32x4_t mask_lo = vshlq_u32(one, vreinterpretq_s32_u32(bit_no_lo));
+	uint32x4_t mask_hi = vshlq_u32(one, vreinterpretq_s32_u32(bit_no_hi));
+	/* Bits set in the mask, but not in the block. */
+	uint32x4_t missing = vorrq_u32(
+		vbicq_u32(mask_lo, vld1q_u32(block->words)),
+		vbicq_u32(mask_hi, vld1q_u32(block->words + 4)));
+	return vmaxvq_u32(missing) == 0;
+}
+
+bloom_split_check_f bloom_split_check = bloom_split_check_neon;
+
+#else /* !defined(__aarch64__) */
+
+bloom_split_check_f bloom_split_check = bloom_split_check_generic;
+
+#endif /* !defined(__aarch64__) */
+
+void
+bloom_init(bool avx2_enabled)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	bloom_split_check = avx2_enabled ? bloom_split_check_avx2 :
+			    bloom_split_check_generic;
+#else
+	(void)avx2_enabled;
+#endif
+}
+
+/**
+ * Expected false positive rate of a split block bloom filter.
+ * Unlike a classic bloom filter, the load of each block follows
+ * the Poisson distribution, and lightly loaded blocks don't make up
+ * for heavily loaded ones, so take it into account.
+ */
+static double
+bloom_split_fpr(uint32_t block_count, uint32_t number_of_values)
+{
+	const uint32_t word_bits = sizeof(uint32_t) * CHAR_BIT;
+	double lambda = (double)number_of_values / block_count;
+	if (lambda == 0)
+		return 0;
+	double fpr = 0;
+	uint32_t max = lambda + 10 * sqrt(lambda) + 10;
+	for (uint32_t i = 0; i <= max; i++) {
+		/* Probability of a block to store i values. */
+		double p = exp(i * log(lambda) - lambda - lgamma(i + 1));
+		/* Probability of a bit in a word to be set. */
+		double q = 1 - pow(1 - 1.0 / word_bits, i);
+		fpr += p * pow(q, BLOOM_SPLIT_BLOCK_WORDS);
+	}
+	return fpr;
+}
+
+/**
+ * Calculate the minimal number of blocks of a split block bloom
+ * filter that yields the given false positive rate.
+ */
+static uint32_t
+bloom_split_block_count(uint32_t number_of_values,
+			double false_positive_rate)
+{
+	/* The fpr decreases as the table grows so use binary search. */
+	uint32_t lo = 1;
+	uint32_t hi = number_of_values > 0 ? number_of_values : 1;
+	while (bloom_split_fpr(hi, number_of_values) > false_positive_rate) {
+		if (hi > UINT32_MAX / 2)
+			return hi;
+		lo = hi;
+		hi *= 2;
+	}
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (bloom_split_fpr(mid, number_of_values) >
+		    false_positive_rate)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return hi;
+}
+
+/**
+ * Size of a table block of a bloom filter.
+ */
+static inline size_t
+bloom_block_size(const struct bloom *bloom)
+{
+	return bloom->version == BLOOM_VERSION_SPLIT_BLOCK ?
+	       sizeof(struct bloom_split_block) : sizeof(struct bloom_block);
+}
+
+/**
+ * Allocate the table of a split block bloom filter. Blocks are
+ * aligned to the cache line so that each of them fits in one.
+ */
+static int
+bloom_split_alloc(struct bloom *bloom)
+{
+	void *table;
+	if (posix_memalign(&table, BLOOM_CACHE_LINE,
+			   bloom_store_size(bloom)) != 0)
+		return -1;
+	bloom->split_table = table;
+	return 0;
+}
+
 int
 bloom_create(struct bloom *bloom, uint32_t number_of_values,
-	     double false_positive_rate)
+	     double false_positive_rate, enum bloom_version version)
 {
+	if (version == BLOOM_VERSION_SPLIT_BLOCK) {
+		bloom->version = version;
+		bloom->hash_count = BLOOM_SPLIT_BLOCK_WORDS;
+		bloom->table_size = bloom_split_block_count(
+			number_of_values, false_positive_rate);
+		if (bloom_split_alloc(bloom) != 0)
+			return -1;
+		memset(bloom->split_table, 0, bloom_store_size(bloom));
+		return 0;
+	}
+
 	/* Optimal hash_count and bit count calculation */
 	uint16_t hash_count = ceil(log(false_positive_rate) / log(0.5));
 	uint64_t bit_count = ceil(number_of_values * hash_count / log(2));
@@ -55,6 +233,7 @@ bloom_create(struct bloom *bloom, uint32_t number_of_values,
 
 	bloom->table_size = block_count;
 	bloom->hash_count = hash_count;
+	bloom->version = version;
 	return 0;
 }
 
@@ -67,6 +246,8 @@ bloom_destroy(struct bloom *bloom)
 double
 bloom_fpr(const struct bloom *bloom, uint32_t number_of_values)
 {
+	if (bloom->version == BLOOM_VERSION_SPLIT_BLOCK)
+		return bloom_split_fpr(bloom->table_size, number_of_values);
 	/* Number of hash functions. */
 	uint16_t k = bloom->hash_count;
 	/* Number of bits. */
@@ -80,7 +261,7 @@ bloom_fpr(const struct bloom *bloom, uint32_t number_of_values)
 size_t
 bloom_store_size(const struct bloom *bloom)
 {
-	return bloom->table_size * sizeof(struct bloom_block);
+	return bloom->table_size * bloom_block_size(bloom);
 }
 
 char *
@@ -94,10 +275,15 @@ bloom_store(const struct bloom *bloom, char *table)
 int
 bloom_load_table(struct bloom *bloom, const char *table)
 {
-	size_t size = bloom->table_size * sizeof(struct bloom_block);
-	bloom->table = malloc(size);
-	if (bloom->table == NULL)
-		return -1;
+	size_t size = bloom_store_size(bloom);
+	if (bloom->version == BLOOM_VERSION_SPLIT_BLOCK) {
+		if (bloom_split_alloc(bloom) != 0)
+			return -1;
+	} else {
+		bloom->table = malloc(size);
+		if (bloom->table == NULL)
+			return -1;
+	}
 	memcpy(bloom->table, table, size);
 	return 0;
 }
@@ -41,6 +41,12 @@
  *  "Less Hashing, Same Performance: Building a Better Bloom Filter"
  *   https://www.eecs.harvard.edu/~michaelm/postscripts/tr-02-05.pdf
  * 3) Using only one hash value that is splitted into several independent parts
+ *
+ * A split block layout is supported as well (see enum bloom_version):
+ *  Putze, F.; Sanders, P.; Singler, J. (2007), section 3 "Blocked Bloom
+ *  Filters", the "split" variant as used by Apache Impala and Parquet.
+ * Each value sets exactly one bit in each 32-bit word of a 256-bit block,
+ * so a lookup is a single SIMD compare instead of a loop over probes.
  */
 
 #include <stdint.h>
@@ -56,6 +62,24 @@ extern "C" {
 enum {
 	/* Expected cache line of target processor */
 	BLOOM_CACHE_LINE = 64,
+	/* Number of 32-bit words in a split block */
+	BLOOM_SPLIT_BLOCK_WORDS = 8,
+};
+
+/**
+ * Layout of the bloom filter table.
+ */
+enum bloom_version {
+	/**
+	 * Each value sets hash_count bits at pseudo-random positions
+	 * of a cache-line-size block.
+	 */
+	BLOOM_VERSION_BLOCKED = 0,
+	/**
+	 * Each value sets one bit in each word of a 256-bit block
+	 * so hash_count is always BLOOM_SPLIT_BLOCK_WORDS.
+	 */
+	BLOOM_VERSION_SPLIT_BLOCK = 1,
 };
 
 typedef uint32_t bloom_hash_t;
@@ -67,6 +91,13 @@ struct bloom_block {
 	unsigned char bits[BLOOM_CACHE_LINE];
 };
 
+/**
+ * Block of a split block bloom filter.
+ */
+struct bloom_split_block {
+	uint32_t words[BLOOM_SPLIT_BLOCK_WORDS];
+} __attribute__((aligned(32)));
+
 /**
  * Bloom filter data structure
  */
@@ -75,23 +106,56 @@ struct bloom {
 	uint32_t table_size;
 	/* Number of hash function per value */
 	uint16_t hash_count;
+	/* Table layout, see enum bloom_version */
+	uint8_t version;
 	/* Bit field table */
-	struct bloom_block *table;
+	union {
+		/* BLOOM_VERSION_BLOCKED */
+		struct bloom_block *table;
+		/* BLOOM_VERSION_SPLIT_BLOCK */
+		struct bloom_split_block *split_table;
+	};
 };
 
+/**
+ * Check if all bits of a value are set in a split block.
+ * @param block - the block to check
+ * @param hash - hash of the value, see bloom_split_hash()
+ * @return true if all bits are set
+ */
+typedef bool
+(*bloom_split_check_f)(const struct bloom_split_block *block,
+		       bloom_hash_t hash);
+
+/*
+ * Pointer to an architecture-specific implementation of
+ * the split block check, see bloom_init().
+ */
+extern bloom_split_check_f bloom_split_check;
+
 /* {{{ API declaration */
 
+/**
+ * Select the split block check implementation. Until it's called,
+ * the portable implementation is used (NEON on AArch64).
+ *
+ * @param avx2_enabled - whether the CPU supports AVX2
+ */
+void
+bloom_init(bool avx2_enabled);
+
 /**
  * Allocate and initialize an instance of bloom filter
  *
  * @param bloom - structure to initialize
  * @param number_of_values - estimated number of values to be added
  * @param false_positive_rate - desired false positive rate
+ * @param version - table layout
  * @return 0 - OK, -1 - memory error
  */
 int
 bloom_create(struct bloom *bloom, uint32_t number_of_values,
-	     double false_positive_rate);
+	     double false_positive_rate, enum bloom_version version);
 
 /**
  * Free resources of the bloom filter
@@ -149,7 +213,7 @@ bloom_store(const struct bloom *bloom, char *table);
 
 /**
  * Allocate table and load it from given buffer.
- * Other struct bloom members must be loaded manually.
+ * Other struct bloom members (including version) must be loaded manually.
  *
  * @param bloom - structure to load to
  * @param table - data to load
@@ -162,9 +226,55 @@ bloom_load_table(struct bloom *bloom, const char *table);
 
 /* {{{ API definition */
 
+/**
+ * Salts used to derive the bit number in each word of a split block,
+ * taken from the Parquet specification.
+ */
+extern const uint32_t bloom_split_salt[BLOOM_SPLIT_BLOCK_WORDS];
+
+/**
+ * Portable implementation of bloom_split_check_f.
+ */
+bool
+bloom_split_check_generic(const struct bloom_split_block *block,
+			  bloom_hash_t hash);
+
+/**
+ * Find the block of a split block bloom filter for a value and
+ * return the hash to use for setting bits in the block.
+ */
+static inline bloom_hash_t
+bloom_split_hash(const struct bloom *bloom, bloom_hash_t hash,
+		 uint32_t *pos)
+{
+	/* Map the hash to [0, table_size) without division. */
+	*pos = ((uint64_t)hash * bloom->table_size) >> 32;
+	/*
+	 * The block number depends on the upper bits of the hash
+	 * mostly, so mix it up (MurmurHash3 finalizer) to get
+	 * independent bit numbers within the block.
+	 */
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35U;
+	hash ^= hash >> 16;
+	return hash;
+}
+
 static inline void
 bloom_add(struct bloom *bloom, bloom_hash_t hash)
 {
+	if (bloom->version == BLOOM_VERSION_SPLIT_BLOCK) {
+		uint32_t pos;
+		hash = bloom_split_hash(bloom, hash, &pos);
+		struct bloom_split_block *block = &bloom->split_table[pos];
+		for (int i = 0; i < BLOOM_SPLIT_BLOCK_WORDS; i++) {
+			uint32_t bit_no = (hash * bloom_split_salt[i]) >> 27;
+			block->words[i] |= 1U << bit_no;
+		}
+		return;
+	}
 	/* Using lower part of the has for finding a block */
 	bloom_hash_t pos = hash % bloom->table_size;
 	hash = hash / bloom->table_size;
@@ -185,6 +295,11 @@ bloom_add(struct bloom *bloom, bloom_hash_t hash)
 static inline bool
 bloom_maybe_has(const struct bloom *bloom, bloom_hash_t hash)
 {
+	if (bloom->version == BLOOM_VERSION_SPLIT_BLOCK) {
+		uint32_t pos;
+		hash = bloom_split_hash(bloom, hash, &pos);
+		return bloom_split_check(&bloom->split_table[pos], hash);
+	}
 	/* Using lower part of the has for finding a block */
 	bloom_hash_t pos = hash % bloom->table_size;
 	hash = hash / bloom->table_size;
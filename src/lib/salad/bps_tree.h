@@ -315,6 +315,26 @@
  * #define BPS_BLOCK_LINEAR_SEARCH
  */
 
+/**
+ * Optional comparison hints of elements and keys. A hint is a 64-bit
+ * unsigned integer such that if hint(a) < hint(b) then a < b and if
+ * hint(a) > hint(b) then a > b, where a and b are elements or keys.
+ * UINT64_MAX means that the hint is undefined. If the hints are
+ * defined, a block is searched for a key by comparing the key hint
+ * with the hints of all elements of the block in one branchless pass,
+ * which the compiler vectorizes, and only the elements whose hints
+ * are equal to the key hint are compared with BPS_TREE_COMPARE_KEY.
+ * #define BPS_TREE_ELEM_HINT(elem) (elem).hint
+ * #define BPS_TREE_KEY_HINT(key, arg) (key)->hint
+ */
+
+/**
+ * A switch to make leaf blocks store the hints of their elements
+ * (see BPS_TREE_ELEM_HINT) in a separate array, so that they are
+ * scanned contiguously on search. Reduces the leaf block capacity.
+ * #define BPS_LEAF_HINTS
+ */
+
 /**
  * A switch to make the tree store the cardinality of each of its
  * child blocks in an array. A block cardinality is the amount of
@@ -348,6 +368,13 @@ typedef uint32_t bps_tree_block_id_t;
 typedef int64_t bps_tree_block_card_t;
 /* }}} */
 
+#if defined(BPS_LEAF_HINTS) && !defined(BPS_TREE_ELEM_HINT)
+#error "BPS_LEAF_HINTS requires BPS_TREE_ELEM_HINT"
+#endif
+#if defined(BPS_TREE_ELEM_HINT) != defined(BPS_TREE_KEY_HINT)
+#error "BPS_TREE_ELEM_HINT and BPS_TREE_KEY_HINT must be defined together"
+#endif
+
 /* {{{ Compile time utils */
 /**
  * Concatenation of name at compile time
@@ -499,6 +526,8 @@ typedef int64_t bps_tree_block_card_t;
 #define bps_tree_root _bps_tree(root)
 #define bps_tree_touch_block _bps_tree(touch_block)
 #define bps_tree_calc_path_offset _bps_tree(calc_path_offset)
+#define bps_tree_hint_range _bps_tree(hint_range)
+#define bps_tree_leaf_update_hints _bps_tree(leaf_update_hints)
 #define bps_tree_find_ins_point_key _bps_tree(find_ins_point_key)
 #define bps_tree_find_ins_point_elem _bps_tree(find_ins_point_elem)
 #define bps_tree_find_ins_point_offset _bps_tree(find_ins_point_offset)
@@ -1410,7 +1439,11 @@ enum bps_tree_max_sizes {
 	BPS_TREE_MAX_COUNT_IN_LEAF =
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
 		 - 2 * sizeof(bps_tree_block_id_t) )
-		/ sizeof(bps_tree_elem_t),
+		/ (sizeof(bps_tree_elem_t)
+#ifdef BPS_LEAF_HINTS
+		   + sizeof(uint64_t)
+#endif
+		),
 	BPS_TREE_MAX_COUNT_IN_INNER =
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
 #ifdef BPS_INNER_CARD
@@ -1444,6 +1477,10 @@ struct bps_leaf {
 	bps_tree_block_id_t prev_id;
 	/* Ordered array of elements */
 	bps_tree_elem_t elems[BPS_TREE_MAX_COUNT_IN_LEAF];
+#ifdef BPS_LEAF_HINTS
+	/* Hints of the elements, see BPS_TREE_ELEM_HINT */
+	uint64_t hints[BPS_TREE_MAX_COUNT_IN_LEAF];
+#endif
 };
 
 /**
@@ -1620,6 +1657,21 @@ bps_tree_create(struct bps_tree *t, bps_tree_arg_t arg,
 #endif
 }
 
+/**
+ * @brief Update the hints of a leaf after its elements are changed,
+ * see BPS_LEAF_HINTS.
+ */
+static inline void
+bps_tree_leaf_update_hints(struct bps_leaf *leaf)
+{
+#ifdef BPS_LEAF_HINTS
+	for (bps_tree_pos_t i = 0; i < leaf->header.size; i++)
+		leaf->hints[i] = BPS_TREE_ELEM_HINT(leaf->elems[i]);
+#else
+	(void)leaf;
+#endif
+}
+
 /**
  * @brief Fills a new (asserted) tree with values from sorted array.
  *  Elements are copied from the array. Array is not checked to be sorted!
@@ -1696,6 +1748,7 @@ bps_tree_build(struct bps_tree *t, bps_tree_elem_t *sorted_array,
 		prev_leaf_id = id;
 		memmove(leaf->elems, current,
 			leaf->header.size * sizeof(*current));
+		bps_tree_leaf_update_hints(leaf);
 
 		bps_tree_block_id_t insert_id = id;
 		for (bps_tree_block_id_t i = 0; i < depth - 1; i++) {
@@ -1999,23 +2052,105 @@ bps_tree_calc_path_offset(struct bps_tree_common *tree,
 
 #endif
 
+#ifdef BPS_LEAF_HINTS
+#define BPS_TREE_LEAF_HINTS(leaf) ((leaf)->hints)
+#else
+#define BPS_TREE_LEAF_HINTS(leaf) NULL
+#endif
+
+#ifdef BPS_TREE_ELEM_HINT
+
+/**
+ * @brief Find the range of a sorted array that contains the elements
+ * that may be equal to a key judging by comparison hints: all elements
+ * before the range are less than the key, all elements after the range
+ * are greater than the key. See BPS_TREE_ELEM_HINT.
+ * @param arr - array of elements
+ * @param hints - hints of the elements, or NULL to take them from
+ *                the elements
+ * @param size - size of the array
+ * @param key_hint - hint of the key
+ * @param begin - receives the position of the first element of the range
+ * @param end - receives the position following the last element of
+ *              the range
+ * @return false if a hint is undefined, in which case the range is
+ *         not set
+ */
+static inline bool
+bps_tree_hint_range(const bps_tree_elem_t *arr, const uint64_t *hints,
+		    size_t size, uint64_t key_hint, size_t *begin, size_t *end)
+{
+	if (key_hint == UINT64_MAX)
+		return false;
+	/*
+	 * Count the elements in one branchless pass instead of doing
+	 * a binary search so that the loop can be vectorized.
+	 */
+	size_t less = 0;
+	size_t less_or_equal = 0;
+	size_t undefined = 0;
+	if (hints != NULL) {
+		for (size_t i = 0; i < size; i++) {
+			uint64_t hint = hints[i];
+			less += hint < key_hint;
+			less_or_equal += hint <= key_hint;
+			undefined += hint == UINT64_MAX;
+		}
+	} else {
+		for (size_t i = 0; i < size; i++) {
+			uint64_t hint = BPS_TREE_ELEM_HINT(arr[i]);
+			less += hint < key_hint;
+			less_or_equal += hint <= key_hint;
+			undefined += hint == UINT64_MAX;
+		}
+	}
+	if (undefined != 0)
+		return false;
+	*begin = less;
+	*end = less_or_equal;
+	return true;
+}
+
+#endif /* BPS_TREE_ELEM_HINT */
+
+/**
+ * @brief Narrow the range of a sorted array to search a key in
+ * using comparison hints, if they are defined.
+ */
+#ifdef BPS_TREE_ELEM_HINT
+#define BPS_TREE_HINT_RANGE(tree, arr, hints, size, key, begin, end) do {     \
+	size_t hint_begin, hint_end;					      \
+	if (bps_tree_hint_range(arr, hints, size,			      \
+				BPS_TREE_KEY_HINT(key, (tree)->arg),	      \
+				&hint_begin, &hint_end)) {		      \
+		(begin) = (arr) + hint_begin;				      \
+		(end) = (arr) + hint_end;				      \
+	}								      \
+} while (0)
+#else
+#define BPS_TREE_HINT_RANGE(tree, arr, hints, size, key, begin, end) \
+	((void)(hints))
+#endif
+
 /**
  * @brief Find the lowest element in sorted array that is >= than the key
  * @param tree - pointer to a tree
  * @param arr - array of elements
+ * @param hints - hints of the elements (see BPS_LEAF_HINTS) or NULL
  * @param size - size of the array
  * @param key - key to find
  * @param exact - point to bool that receives true if equal element was found
  */
 static inline bps_tree_pos_t
 bps_tree_find_ins_point_key(const struct bps_tree_common *tree,
-			    bps_tree_elem_t *arr, size_t size,
-			    bps_tree_key_t key, bool *exact)
+			    bps_tree_elem_t *arr, const uint64_t *hints,
+			    size_t size, bps_tree_key_t key, bool *exact)
 {
 	(void)tree;
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+	BPS_TREE_HINT_RANGE(tree, arr, hints, size, key, begin, end);
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -2135,6 +2270,7 @@ bps_tree_find_ins_point_offset(const struct bps_tree_common *tree,
  * than the key.
  * @param tree - pointer to a tree
  * @param arr - array of elements
+ * @param hints - hints of the elements (see BPS_LEAF_HINTS) or NULL
  * @param size - size of the array
  * @param key - key to find
  * @param exact - point to bool that receives true if equal
@@ -2142,12 +2278,13 @@ bps_tree_find_ins_point_offset(const struct bps_tree_common *tree,
  */
 static inline bps_tree_pos_t
 bps_tree_find_after_ins_point_key(const struct bps_tree_common *tree,
-				  bps_tree_elem_t *arr, size_t size,
-				  bps_tree_key_t key, bool *exact)
+				  bps_tree_elem_t *arr, const uint64_t *hints,
+				  size_t size, bps_tree_key_t key, bool *exact)
 {
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+	BPS_TREE_HINT_RANGE(tree, arr, hints, size, key, begin, end);
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -2431,7 +2568,7 @@ bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos;
-		pos = bps_tree_find_ins_point_key(tree, inner->elems,
+		pos = bps_tree_find_ins_point_key(tree, inner->elems, NULL,
 						  inner->header.size - 1,
 						  key, exact);
 		block_id = inner->child_ids[pos];
@@ -2440,8 +2577,9 @@ bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos;
-	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
-					  key, exact);
+	pos = bps_tree_find_ins_point_key(tree, leaf->elems,
+					  BPS_TREE_LEAF_HINTS(leaf),
+					  leaf->header.size, key, exact);
 	if (pos >= leaf->header.size) {
 		res.block_id = leaf->next_id;
 		res.pos = 0;
@@ -2497,6 +2635,7 @@ bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos;
 		pos = bps_tree_find_after_ins_point_key(tree, inner->elems,
+							NULL,
 							inner->header.size - 1,
 							key, &exact_test);
 		if (exact_test)
@@ -2508,6 +2647,7 @@ bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos;
 	pos = bps_tree_find_after_ins_point_key(tree, leaf->elems,
+						BPS_TREE_LEAF_HINTS(leaf),
 						leaf->header.size,
 						key, &exact_test);
 	if (exact_test)
@@ -2700,7 +2840,8 @@ bps_tree_lower_bound_get_offset_impl(const struct bps_tree_common *tree,
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos = bps_tree_find_ins_point_key(
-			tree, inner->elems, inner->header.size - 1, key, exact);
+			tree, inner->elems, NULL, inner->header.size - 1,
+			key, exact);
 		offset += bps_tree_get_first_children_card(tree, inner, pos);
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
@@ -2708,8 +2849,9 @@ bps_tree_lower_bound_get_offset_impl(const struct bps_tree_common *tree,
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos;
-	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
-					  key, exact);
+	pos = bps_tree_find_ins_point_key(tree, leaf->elems,
+					  BPS_TREE_LEAF_HINTS(leaf),
+					  leaf->header.size, key, exact);
 	if (pos >= leaf->header.size) {
 		res.block_id = leaf->next_id;
 		res.pos = 0;
@@ -2769,6 +2911,7 @@ bps_tree_upper_bound_get_offset_impl(const struct bps_tree_common *tree,
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos;
 		pos = bps_tree_find_after_ins_point_key(tree, inner->elems,
+							NULL,
 							inner->header.size - 1,
 							key, &exact_test);
 		if (exact_test)
@@ -2781,6 +2924,7 @@ bps_tree_upper_bound_get_offset_impl(const struct bps_tree_common *tree,
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos;
 	pos = bps_tree_find_after_ins_point_key(tree, leaf->elems,
+						BPS_TREE_LEAF_HINTS(leaf),
 						leaf->header.size,
 						key, &exact_test);
 	if (exact_test)
@@ -2996,12 +3140,13 @@ bps_tree_approximate_count(const struct bps_tree *t, bps_tree_key_t key)
 		struct bps_inner *lower_inner = (struct bps_inner *)lower_block;
 		bps_tree_pos_t lower_pos =
 			bps_tree_find_ins_point_key(tree, lower_inner->elems,
+						    NULL,
 						    lower_inner->header.size - 1,
 						    key, &exact);
 		struct bps_inner *upper_inner = (struct bps_inner *)upper_block;
 		bps_tree_pos_t upper_pos =
 			bps_tree_find_after_ins_point_key(tree,
-							  upper_inner->elems,
+							  upper_inner->elems, NULL,
 							  upper_inner->header.size - 1,
 							  key, &exact);
 
@@ -3026,12 +3171,14 @@ bps_tree_approximate_count(const struct bps_tree *t, bps_tree_key_t key)
 	struct bps_leaf *lower_leaf = (struct bps_leaf *)lower_block;
 	bps_tree_pos_t lower_pos =
 		bps_tree_find_ins_point_key(tree, lower_leaf->elems,
+					    BPS_TREE_LEAF_HINTS(lower_leaf),
 					    lower_leaf->header.size,
 					    key, &exact);
 
 	struct bps_leaf *upper_leaf = (struct bps_leaf *)upper_block;
 	bps_tree_pos_t upper_pos =
 		bps_tree_find_after_ins_point_key(tree, upper_leaf->elems,
+						  BPS_TREE_LEAF_HINTS(upper_leaf),
 						  upper_leaf->header.size,
 						  key, &exact);
 
@@ -3228,7 +3375,7 @@ bps_tree_find_impl(const struct bps_tree_common *tree, bps_tree_key_t key)
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos;
-		pos = bps_tree_find_ins_point_key(tree, inner->elems,
+		pos = bps_tree_find_ins_point_key(tree, inner->elems, NULL,
 						  inner->header.size - 1,
 						  key, &exact);
 		block = bps_tree_restore_block(tree, inner->child_ids[pos]);
@@ -3236,8 +3383,9 @@ bps_tree_find_impl(const struct bps_tree_common *tree, bps_tree_key_t key)
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos;
-	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
-					  key, &exact);
+	pos = bps_tree_find_ins_point_key(tree, leaf->elems,
+					  BPS_TREE_LEAF_HINTS(leaf),
+					  leaf->header.size, key, &exact);
 	if (exact)
 		return leaf->elems + pos;
 	else
@@ -3275,7 +3423,7 @@ bps_tree_find_get_offset_impl(struct bps_tree_common *tree, bps_tree_key_t key,
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos;
-		pos = bps_tree_find_ins_point_key(tree, inner->elems,
+		pos = bps_tree_find_ins_point_key(tree, inner->elems, NULL,
 						  inner->header.size - 1,
 						  key, &exact);
 		offset += bps_tree_get_first_children_card(tree, inner, pos);
@@ -3284,8 +3432,9 @@ bps_tree_find_get_offset_impl(struct bps_tree_common *tree, bps_tree_key_t key,
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos;
-	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
-					  key, &exact);
+	pos = bps_tree_find_ins_point_key(tree, leaf->elems,
+					  BPS_TREE_LEAF_HINTS(leaf),
+					  leaf->header.size, key, &exact);
 	offset += pos;
 	if (exact) {
 		*offset_arg = offset;
@@ -3441,6 +3590,7 @@ bps_tree_insert_first_elem(struct bps_tree_common *tree,
 		return -1;
 	leaf->header.size = 1;
 	leaf->elems[0] = new_elem;
+	bps_tree_leaf_update_hints(leaf);
 	tree->first_id = tree->root_id;
 	tree->last_id = tree->root_id;
 	leaf->prev_id = (bps_tree_block_id_t)(-1);
@@ -3574,6 +3724,7 @@ bps_tree_process_replace(struct bps_tree_common *tree,
 		*replaced = leaf->elems[leaf_path_elem->insertion_point];
 
 	leaf->elems[leaf_path_elem->insertion_point] = new_elem;
+	bps_tree_leaf_update_hints(leaf);
 	if (leaf_path_elem->insertion_point == leaf->header.size - 1) {
 		bps_tree_touch_leaf_path_max_elem(tree, leaf_path_elem);
 		*leaf_path_elem->max_elem_copy =
@@ -3896,6 +4047,7 @@ bps_tree_insert_into_leaf(struct bps_tree_common *tree,
 		*leaf_path_elem->max_elem_copy = leaf->elems[leaf->header.size];
 	}
 	leaf->header.size++;
+	bps_tree_leaf_update_hints(leaf);
 	BPS_TREE_CARD_UP_LEAF(leaf_path_elem, +1);
 	tree->size++;
 }
@@ -3959,6 +4111,7 @@ bps_tree_delete_from_leaf(struct bps_tree_common *tree,
 			  leaf->header.size - 1 - pos, leaf, leaf);
 
 	leaf->header.size--;
+	bps_tree_leaf_update_hints(leaf);
 	BPS_TREE_CARD_UP_LEAF(leaf_path_elem, -1);
 
 	if (leaf->header.size > 0 && pos == leaf->header.size) {
@@ -4036,6 +4189,8 @@ bps_tree_move_elems_to_right_leaf(struct bps_tree_common *tree,
 
 	a->header.size -= num;
 	b->header.size += num;
+	bps_tree_leaf_update_hints(a);
+	bps_tree_leaf_update_hints(b);
 	BPS_TREE_CARD_UP_LEAF(a_leaf_path_elem, -num);
 	BPS_TREE_CARD_UP_LEAF(b_leaf_path_elem, +num);
 
@@ -4124,6 +4279,8 @@ bps_tree_move_elems_to_left_leaf(struct bps_tree_common *tree,
 
 	a->header.size += num;
 	b->header.size -= num;
+	bps_tree_leaf_update_hints(a);
+	bps_tree_leaf_update_hints(b);
 	BPS_TREE_CARD_UP_LEAF(a_leaf_path_elem, +num);
 	BPS_TREE_CARD_UP_LEAF(b_leaf_path_elem, -num);
 	*a_leaf_path_elem->max_elem_copy = a->elems[a->header.size - 1];
@@ -4238,6 +4395,8 @@ bps_tree_insert_and_move_elems_to_right_leaf(
 
 	a->header.size -= (num - 1);
 	b->header.size += num;
+	bps_tree_leaf_update_hints(a);
+	bps_tree_leaf_update_hints(b);
 	BPS_TREE_CARD_UP_LEAF(a_leaf_path_elem, -(num - 1));
 	BPS_TREE_CARD_UP_LEAF(b_leaf_path_elem, +num);
 	if (!move_all)
@@ -4455,6 +4614,8 @@ bps_tree_insert_and_move_elems_to_left_leaf(
 
 	a->header.size += num;
 	b->header.size -= (num - 1);
+	bps_tree_leaf_update_hints(a);
+	bps_tree_leaf_update_hints(b);
 	BPS_TREE_CARD_UP_LEAF(a_leaf_path_elem, +num);
 	BPS_TREE_CARD_UP_LEAF(b_leaf_path_elem, -(num - 1));
 	*a_leaf_path_elem->max_elem_copy = a->elems[a->header.size - 1];
@@ -6287,6 +6448,12 @@ bps_tree_debug_check_block(const struct bps_tree_common *tree,
 			if (BPS_TREE_COMPARE(leaf->elems[i - 1],
 					     leaf->elems[i], tree->arg) >= 0)
 				result |= 0x400;
+#ifdef BPS_LEAF_HINTS
+		for (bps_tree_pos_t i = 0; i < block->size; i++)
+			if (leaf->hints[i] !=
+			    BPS_TREE_ELEM_HINT(leaf->elems[i]))
+				result |= 0x800;
+#endif
 		return result;
 	} else {
 		struct bps_inner *inner = (struct bps_inner *)(block);
@@ -7956,6 +8123,10 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_root
 #undef bps_tree_touch_block
 #undef bps_tree_calc_path_offset
+#undef BPS_TREE_LEAF_HINTS
+#undef BPS_TREE_HINT_RANGE
+#undef bps_tree_hint_range
+#undef bps_tree_leaf_update_hints
 #undef bps_tree_find_ins_point_key
 #undef bps_tree_find_ins_point_elem
 #undef bps_tree_find_ins_point_offset
@@ -54,6 +54,8 @@
 #include "cbus.h"
 #include "coio_task.h"
 #include <crc32.h>
+#include <cpu_feature.h>
+#include "salad/bloom.h"
 #include "memory.h"
 #include <say.h>
 #include <rmean.h>
@@ -989,6 +991,7 @@ main(int argc, char **argv)
 	random_init();
 
 	crc32_init();
+	bloom_init(avx2_enabled_cpu());
 	memory_init();
 
 	main_argc = argc;
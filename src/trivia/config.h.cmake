@@ -200,6 +200,11 @@
 
 #cmakedefine HAVE_PRCTL_H 1
 
+/*
+ * Defined if Linux io_uring(7) headers are available.
+ */
+#cmakedefine HAVE_LINUX_IO_URING_H 1
+
 #cmakedefine HAVE_UUIDGEN 1
 #cmakedefine HAVE_CLOCK_GETTIME 1
 #cmakedefine HAVE_CLOCK_GETTIME_DECL 1
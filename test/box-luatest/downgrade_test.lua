@@ -1042,3 +1042,20 @@ g.test_downgrade_func_trigger = function(cg)
         end
     end)
 end
+
+g.test_downgrade_sql_stat = function(cg)
+    cg.server:exec(function()
+        local helper = require('test.box-luatest.downgrade_helper')
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY);]])
+        box.execute([[INSERT INTO t VALUES (1);]])
+        box.execute([[ANALYZE t;]])
+        t.assert_equals(box.space._sql_stat:count(), 1)
+        local prev_version = helper.prev_version('3.1.0')
+        t.assert_equals(box.schema.downgrade_issues(prev_version), {})
+        -- 2 for idempotence.
+        for _ = 1, 2 do
+            box.schema.downgrade(prev_version)
+            t.assert_equals(box.space._sql_stat, nil)
+        end
+    end)
+end
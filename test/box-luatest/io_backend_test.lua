@@ -0,0 +1,89 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {io_backend = 'io_uring'}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.io_backend, 'io_uring')
+        t.assert_error_msg_equals(
+            "Can't set option 'io_backend' dynamically",
+            box.cfg, {io_backend = 'thread'})
+    end)
+end
+
+g.test_fio = function(cg)
+    cg.server:exec(function()
+        local fio = require('fio')
+        local fiber = require('fiber')
+        local path = fio.pathjoin(box.cfg.work_dir, 'io_backend_test')
+        local f = fio.open(path, {'O_RDWR', 'O_CREAT', 'O_TRUNC'},
+                           tonumber('644', 8))
+        t.assert(f)
+        for i = 0, 99 do
+            t.assert(f:pwrite(string.format('%08d', i), i * 8))
+        end
+        t.assert(f:fsync())
+        t.assert(f:fdatasync())
+        -- Concurrent reads are submitted to the ring in a batch.
+        local fibers = {}
+        for i = 0, 99 do
+            local fib = fiber.new(function()
+                return f:pread(8, i * 8)
+            end)
+            fib:set_joinable(true)
+            fibers[i] = fib
+        end
+        for i = 0, 99 do
+            t.assert_equals({fibers[i]:join()},
+                            {true, string.format('%08d', i)})
+        end
+        t.assert_equals(f:pread(100, 800), '')
+        f:close()
+        fio.unlink(path)
+    end)
+end
+
+g.test_vinyl = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {page_size = 1024})
+        local data = string.rep('x', 100)
+        box.begin()
+        for i = 1, 1000 do
+            s:insert({i, data})
+        end
+        box.commit()
+        box.snapshot()
+    end)
+    -- Restart to make sure the data is read from disk.
+    cg.server:restart()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        local data = string.rep('x', 100)
+        local fibers = {}
+        for i = 1, 1000, 10 do
+            local fib = fiber.new(function()
+                return s:get(i)
+            end)
+            fib:set_joinable(true)
+            fibers[i] = fib
+        end
+        for i = 1, 1000, 10 do
+            t.assert_equals({fibers[i]:join()}, {true, {i, data}})
+        end
+        t.assert_equals(s:count(), 1000)
+        t.assert_gt(s.index.pk:stat().disk.iterator.read.pages, 0)
+        s:drop()
+    end)
+end
@@ -0,0 +1,93 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.schema.user.grant('guest', 'super')
+        for i = 1, 100 do
+            -- Mix tuples that are copied with tuples that are referenced.
+            local size = i % 3 == 0 and 10 or i * 1000
+            s:insert({i, string.rep(string.char(65 + i % 26), size)})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        require('internal.tweaks').iproto_zero_copy_threshold = 4096
+    end)
+end)
+
+local function check_select(cg, c)
+    local expected = cg.server:exec(function()
+        return box.space.test:select()
+    end)
+    t.assert_equals(c.space.test:select(), expected)
+    t.assert_equals(c.space.test:select({50}), {expected[50]})
+    t.assert_equals(c.space.test:select({50}, {iterator = 'GE', limit = 10}),
+                    {unpack(expected, 50, 59)})
+    local tuples, pos = c.space.test:select({}, {limit = 5,
+                                                 fetch_pos = true})
+    t.assert_equals(tuples, {unpack(expected, 1, 5)})
+    tuples = c.space.test:select({}, {limit = 5, after = pos})
+    t.assert_equals(tuples, {unpack(expected, 6, 10)})
+end
+
+g.test_select = function(cg)
+    local c = net.connect(cg.server.net_box_uri)
+    check_select(cg, c)
+    -- Zero-copy is disabled.
+    cg.server:exec(function()
+        require('internal.tweaks').iproto_zero_copy_threshold = 0
+    end)
+    check_select(cg, c)
+    -- All tuples are referenced.
+    cg.server:exec(function()
+        require('internal.tweaks').iproto_zero_copy_threshold = 1
+    end)
+    check_select(cg, c)
+    c:close()
+end
+
+-- Many concurrent big responses that don't fit in the socket buffer
+-- are written in parts.
+g.test_concurrent = function(cg)
+    local c = net.connect(cg.server.net_box_uri)
+    local expected = cg.server:exec(function()
+        return box.space.test:select()
+    end)
+    local futures = {}
+    for i = 1, 20 do
+        futures[i] = c.space.test:select({}, {is_async = true})
+    end
+    c:ping()
+    for i = 1, 20 do
+        t.assert_equals(futures[i]:wait_result(), expected)
+    end
+    c:close()
+end
+
+-- The output of a closed connection is discarded.
+g.test_close = function(cg)
+    local c = net.connect(cg.server.net_box_uri)
+    for _ = 1, 10 do
+        c.space.test:select({}, {is_async = true})
+    end
+    c:close()
+    fiber.sleep(0.01)
+    c = net.connect(cg.server.net_box_uri)
+    t.assert_equals(#c.space.test:select(), 100)
+    c:close()
+end
@@ -0,0 +1,254 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_create = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'i', type = 'integer'},
+            {name = 'd', type = 'double'},
+            {name = 's', type = 'string'},
+            {name = 'a', type = 'array'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        t.assert_error_msg_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "primary key must be unique",
+            s.create_index, s, 'pk', {type = 'column'})
+        s:create_index('pk')
+        t.assert_error_msg_equals(
+            "Can't create or modify index 'col' in space 'test': " ..
+            "COLUMN index can not be unique",
+            s.create_index, s, 'col', {type = 'column', unique = true})
+        t.assert_error_msg_equals(
+            "Can't create or modify index 'col' in space 'test': " ..
+            "COLUMN index field type must be UNSIGNED or INTEGER or DOUBLE",
+            s.create_index, s, 'col', {type = 'column', parts = {'s'}})
+        t.assert_error_msg_equals(
+            "Can't create or modify index 'col' in space 'test': " ..
+            "COLUMN index cannot be multikey",
+            s.create_index, s, 'col',
+            {type = 'column', parts = {{'a[*]', 'unsigned'}}})
+        t.assert_error_msg_equals(
+            "Can't create or modify index 'col' in space 'test': " ..
+            "COLUMN index can not use JSON paths",
+            s.create_index, s, 'col',
+            {type = 'column', parts = {{'a[1]', 'unsigned'}}})
+        t.assert_error_msg_equals(
+            "COLUMN does not support nullable parts",
+            s.create_index, s, 'col',
+            {type = 'column', parts = {{'i', 'integer', is_nullable = true}}})
+        t.assert_error_msg_equals(
+            "COLUMN does not support nullable parts",
+            s.create_index, s, 'col',
+            {type = 'column', parts = {{'i', 'integer', is_nullable = true,
+                                        exclude_null = true}}})
+        local v = box.schema.space.create('test2', {engine = 'vinyl'})
+        v:create_index('pk')
+        t.assert_error_msg_equals(
+            "Unsupported index type supplied for index 'col' " ..
+            "in space 'test2'",
+            v.create_index, v, 'col', {type = 'column'})
+        v:drop()
+        local i = s:create_index('col', {type = 'column',
+                                         parts = {'id', 'i', 'd'}})
+        t.assert_equals(i.type, 'COLUMN')
+        t.assert_equals(i.unique, false)
+        t.assert_error_msg_content_equals(
+            "Index 'pk' (TREE) of space 'test' (memtx) " ..
+            "does not support aggregate",
+            s.index.pk.aggregate, s.index.pk, 'sum', 'id')
+    end)
+end
+
+g.test_aggregate = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'i', type = 'integer'},
+            {name = 'd', type = 'double'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        local i = s:create_index('col', {type = 'column',
+                                         parts = {'id', 'i', 'd'}})
+        t.assert_equals(i:aggregate('count'), 0)
+        t.assert_equals(i:aggregate('sum', 'i'), 0)
+        t.assert_equals(i:aggregate('min', 'i'), nil)
+        t.assert_equals(i:aggregate('max', 'd'), nil)
+        for id = 1, 3000 do
+            s:insert({id, id % 2 == 0 and id or -id, id / 2})
+        end
+        t.assert_equals(i:len(), 3000)
+        t.assert_equals(i:count(), 3000)
+        t.assert_equals(i:aggregate('count'), 3000)
+        t.assert_equals(i:aggregate('sum', 'id'), 3000 * 3001 / 2)
+        t.assert_equals(i:aggregate('sum', 2), 1500)
+        t.assert_equals(i:aggregate('sum', 'd'), 3000 * 3001 / 4)
+        t.assert_equals(i:aggregate('min', 'i'), -2999)
+        t.assert_equals(i:aggregate('max', 'i'), 3000)
+        t.assert_equals(i:aggregate('min', 'd'), 0.5)
+        t.assert_equals(i:aggregate('max', 'd'), 1500)
+        t.assert_equals(i:aggregate('count', nil, {{'>', 'i', 0}}), 1500)
+        t.assert_equals(i:aggregate('sum', 'id', {{'<=', 'id', 10},
+                                                  {'~=', 'id', 5}}), 50)
+        t.assert_equals(i:aggregate('max', 'd', {{'<', 'd', 10}}), 9.5)
+        t.assert_equals(i:aggregate('min', 'i', {{'=', 'i', 100}}), 100)
+        t.assert_equals(i:aggregate('min', 'i', {{'>=', 'd', 2000}}), nil)
+
+        -- Tuples are removed and replaced.
+        s:delete(1)
+        s:replace({2, 10, 0})
+        s:update(3, {{'=', 'i', 100}})
+        t.assert_equals(i:aggregate('count'), 2999)
+        t.assert_equals(i:aggregate('max', 'i', {{'<', 'id', 4}}), 100)
+        t.assert_equals(i:aggregate('min', 'd'), 0)
+        t.assert_equals(#i:select(), 2999)
+        local sum = 0
+        for _, tuple in i:pairs() do
+            sum = sum + tuple.id
+        end
+        t.assert_equals(sum, 3000 * 3001 / 2 - 1)
+
+        -- Integer overflow.
+        s:truncate()
+        s:insert({1, 2^62, 0})
+        s:insert({2, 2^62, 0})
+        t.assert_equals(tonumber(i:aggregate('sum', 'i', {{'=', 'id', 1}})),
+                        2^62)
+        t.assert_error_msg_equals("Integer overflow",
+                                  i.aggregate, i, 'sum', 'i')
+        s:replace({2, -2^62, 0})
+        t.assert_equals(i:aggregate('sum', 'i'), 0)
+    end)
+end
+
+g.test_sql = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'i', type = 'integer'},
+            {name = 'd', type = 'double'},
+            {name = 'v', type = 'unsigned'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        s:create_index('col', {type = 'column', parts = {'i', 'd'}})
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        local function plan(sql)
+            return box.execute('EXPLAIN QUERY PLAN ' .. sql).rows[1][4]
+        end
+        local sql = [[SELECT COUNT(*), COUNT(i), SUM(i), MIN(i), MAX(d),
+                             SUM(d) FROM test]]
+        t.assert_equals(plan(sql), 'SCAN TABLE test USING COLUMN INDEX col')
+        t.assert_equals(box.execute(sql).rows,
+                        {{0, 0, box.NULL, box.NULL, box.NULL, box.NULL}})
+        box.begin()
+        for id = 1, 1000 do
+            s:insert({id, id % 2 == 0 and id or -id, id / 2, id % 7})
+        end
+        box.commit()
+        t.assert_equals(box.execute(sql).rows,
+                        {{1000, 1000, 500, -999, 500, 1000 * 1001 / 4}})
+        -- The WHERE clause is not pushed down to the index.
+        local where = sql .. ' WHERE id > 0'
+        t.assert_not_str_contains(plan(where), 'COLUMN INDEX')
+        t.assert_equals(box.execute(where).rows, box.execute(sql).rows)
+        -- Aggregates of fields that are not in the index.
+        t.assert_equals(plan([[SELECT SUM(v) FROM test]]),
+                        'BATCH SCAN TABLE test')
+        t.assert_equals(plan([[SELECT SUM(i), SUM(v) FROM test]]),
+                        'BATCH SCAN TABLE test')
+        -- Full scan is still forbidden unless allowed.
+        box.execute([[SET SESSION "sql_seq_scan" = false;]])
+        local _, err = box.execute(sql)
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        t.assert_equals(err.message, "Scanning is not allowed for 'test'")
+        -- Integer overflow.
+        s:truncate()
+        s:insert({1, 2^62, 0, 0})
+        s:insert({2, 2^62, 0, 0})
+        _, err = box.execute([[SELECT SUM(i) FROM test]])
+        t.assert_equals(err.message, "Failed to execute SQL statement: " ..
+                                     "integer is overflowed")
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'i', type = 'integer'},
+            {name = 'd', type = 'double'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        local i = s:create_index('col', {type = 'column', parts = {'i', 'd'}})
+        t.assert_error_msg_equals(
+            "unknown aggregate function 'avg'",
+            i.aggregate, i, 'avg', 'i')
+        t.assert_error_msg_equals(
+            "field id is not indexed by index 'col'",
+            i.aggregate, i, 'sum', 'id')
+        t.assert_error_msg_equals(
+            "unknown operator '=='",
+            i.aggregate, i, 'sum', 'i', {{'==', 'i', 1}})
+        t.assert_error_msg_equals(
+            "conditions must be an array of {operator, field, value}",
+            i.aggregate, i, 'sum', 'i', {{'=', 'i'}})
+        t.assert_error_msg_equals(
+            "Supplied key type of part 0 does not match index part type: " ..
+            "expected integer",
+            i.aggregate, i, 'sum', 'i', {{'=', 'i', 'x'}})
+        t.assert_error_msg_equals(
+            "COLUMN index does not support integer values greater than " ..
+            "INT64_MAX",
+            s.insert, s, {1, 2^63, 0})
+        t.assert_equals(s:select(), {})
+        t.assert_error_msg_content_equals(
+            "Index 'col' (COLUMN) of space 'test' (memtx) " ..
+            "does not support requested iterator type",
+            i.select, i, {1}, {iterator = 'EQ'})
+    end)
+end
+
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('col', {type = 'column', parts = {2, 'unsigned'}})
+        for id = 1, 100 do
+            s:insert({id, id})
+        end
+        box.snapshot()
+        for id = 101, 200 do
+            s:insert({id, id})
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local i = box.space.test.index.col
+        t.assert_equals(i:aggregate('count'), 200)
+        t.assert_equals(i:aggregate('sum', 2), 200 * 201 / 2)
+        t.assert_equals(i:aggregate('max', 2, {{'<', 2, 150}}), 149)
+    end)
+end
@@ -0,0 +1,86 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({sort_threads = {1, 4}}))
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {memtx_sort_threads = cg.params.sort_threads},
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that secondary indexes of all kinds are built correctly
+-- on recovery when hints are calculated in threads.
+g.test_recovery = function(cg)
+    local COUNT = 10000
+    cg.server:exec(function(count)
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('str', {parts = {2, 'string'}})
+        s:create_index('num', {parts = {3, 'unsigned'}, unique = false})
+        s:create_index('nohint', {parts = {2, 'string'}, hint = false})
+        s:create_index('json', {parts = {{'[4].a', 'unsigned'}}})
+        s:create_index('multikey', {parts = {{'[5][*]', 'unsigned'}},
+                                    unique = false})
+        box.begin()
+        for i = 1, count do
+            s:insert({i, tostring(count - i), i % 10, {a = count - i},
+                      {i % 7, i % 11}})
+        end
+        box.commit()
+        box.snapshot()
+    end, {COUNT})
+    cg.server:restart()
+    cg.server:exec(function(count)
+        local s = box.space.test
+        local function check_order(index, key)
+            local prev
+            local n = 0
+            for _, tuple in index:pairs() do
+                if prev ~= nil then
+                    t.assert_le(key(prev), key(tuple))
+                end
+                prev = tuple
+                n = n + 1
+            end
+            return n
+        end
+        local function str(tuple) return tuple[2] end
+        t.assert_equals(check_order(s.index.str, str), count)
+        t.assert_equals(check_order(s.index.nohint, str), count)
+        t.assert_equals(check_order(s.index.num, function(tuple)
+            return tuple[3]
+        end), count)
+        t.assert_equals(check_order(s.index.json, function(tuple)
+            return tuple[4].a
+        end), count)
+        -- Equal keys of the same tuple are stored once.
+        local multikey_count = 0
+        for i = 1, count do
+            multikey_count = multikey_count + (i % 7 == i % 11 and 1 or 2)
+        end
+        t.assert_equals(s.index.multikey:len(), multikey_count)
+        for i = 1, count, 97 do
+            local tuple = s:get(i)
+            t.assert_equals(s.index.str:get(tostring(count - i)), tuple)
+            t.assert_equals(s.index.json:get(count - i), tuple)
+            t.assert_equals(s.index.nohint:get(tostring(count - i)), tuple)
+            t.assert_items_include(s.index.num:select(i % 10), {tuple})
+            t.assert_items_include(s.index.multikey:select(i % 11),
+                                   {tuple})
+        end
+    end, {COUNT})
+end
@@ -0,0 +1,91 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s1 = box.schema.space.create('test1')
+        s1:create_index('pk')
+        s1:create_index('sk', {parts = {2, 'string'}})
+        local s2 = box.schema.space.create('test2')
+        s2:create_index('pk')
+        local padding = string.rep('x', 1000)
+        box.begin()
+        for i = 1, 5000 do
+            s1:insert({i, tostring(i), padding})
+            s2:insert({i, padding})
+        end
+        box.commit()
+        box.snapshot()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_recovery = function(cg)
+    cg.server:restart({box_cfg = {memtx_recovery_read_ahead = 4}})
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_recovery_read_ahead, 4)
+        t.assert_error_msg_equals(
+            "Can't set option 'memtx_recovery_read_ahead' dynamically",
+            box.cfg, {memtx_recovery_read_ahead = 8})
+        local s1 = box.space.test1
+        local s2 = box.space.test2
+        t.assert_equals(s1:count(), 5000)
+        t.assert_equals(s2:count(), 5000)
+        t.assert_equals(s1.index.sk:get('4242')[1], 4242)
+        t.assert_equals(s2:get(4242)[1], 4242)
+    end)
+end
+
+local g_corrupted = t.group('corrupted')
+
+g_corrupted.before_all(function(cg)
+    cg.server = server:new({
+        alias = 'corrupted',
+        box_cfg = {memtx_recovery_read_ahead = 4},
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local padding = string.rep('x', 1000)
+        box.begin()
+        for i = 1, 10000 do
+            s:insert({i, padding})
+        end
+        box.commit()
+        box.snapshot()
+    end)
+    cg.server:stop()
+end)
+
+g_corrupted.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g_corrupted.test_recovery = function(cg)
+    local fio = require('fio')
+    local s = cg.server
+    local snaps = fio.glob(fio.pathjoin(s.workdir, '*.snap'))
+    table.sort(snaps)
+    local path = snaps[#snaps]
+    -- Break a block in the middle of the snapshot so that the reader
+    -- thread fails after it has read a part of a batch.
+    local fh = fio.open(path, {'O_RDWR'})
+    t.assert(fh:pwrite(string.rep('\0', 64),
+                       math.floor(fh:stat().size / 2)))
+    fh:close()
+    s:start({wait_until_ready = false})
+    local log = fio.pathjoin(s.workdir, s.alias .. '.log')
+    t.helpers.retrying({timeout = 60}, function()
+        t.assert_not_equals(s:grep_log("can't initialize storage", nil,
+                                       {filename = log}), nil)
+        t.assert_not(s.process:is_alive())
+    end)
+end
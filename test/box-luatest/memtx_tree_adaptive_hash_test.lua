@@ -0,0 +1,209 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({mvcc = {false, true}}))
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {memtx_use_mvcc_engine = cg.params.mvcc},
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_option = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_error_msg_equals(
+            'Wrong index options: adaptive_hash_size must be greater ' ..
+            'than or equal to 0 and less than or equal to 4294967295',
+            s.create_index, s, 'pk', {adaptive_hash_size = -1})
+        local msg = "Can't create or modify index 'pk' in space 'test': " ..
+                    "adaptive hash is only reasonable with unique " ..
+                    "non-nullable memtx tree index"
+        t.assert_error_msg_equals(msg, s.create_index, s, 'pk',
+                                  {type = 'hash', adaptive_hash_size = 10})
+        s:create_index('pk')
+        t.assert_equals(s.index.pk.adaptive_hash_size, nil)
+        t.assert_equals(s.index.pk:stat(), {})
+        msg = "Can't create or modify index 'sk' in space 'test': " ..
+              "adaptive hash is only reasonable with unique " ..
+              "non-nullable memtx tree index"
+        t.assert_error_msg_equals(msg, s.create_index, s, 'sk', {
+            parts = {2, 'unsigned'}, unique = false, adaptive_hash_size = 10,
+        })
+        t.assert_error_msg_equals(msg, s.create_index, s, 'sk', {
+            parts = {{2, 'unsigned', is_nullable = true}},
+            adaptive_hash_size = 10,
+        })
+        s.index.pk:alter({adaptive_hash_size = 10})
+        t.assert_equals(s.index.pk.adaptive_hash_size, 10)
+        s.index.pk:alter({adaptive_hash_size = 0})
+        t.assert_equals(s.index.pk.adaptive_hash_size, nil)
+    end)
+end
+
+g.test_vinyl = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        local msg = "Can't create or modify index 'pk' in space 'test': " ..
+                    "adaptive hash is only reasonable with memtx tree index"
+        t.assert_error_msg_equals(msg, s.create_index, s, 'pk',
+                                  {adaptive_hash_size = 10})
+        s:create_index('pk')
+        t.assert_error_msg_equals(msg, s.index.pk.alter, s.index.pk,
+                                  {adaptive_hash_size = 10})
+        t.assert_equals(s.index.pk.adaptive_hash_size, nil)
+    end)
+end
+
+g.test_lookup = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {adaptive_hash_size = 100})
+        s:create_index('sk', {parts = {2, 'string'},
+                              adaptive_hash_size = 100})
+        for i = 1, 10 do
+            s:insert({i, 'v' .. i})
+        end
+        local function stat(index)
+            return index:stat().adaptive_hash
+        end
+        t.assert_equals(stat(s.index.pk).count, 0)
+
+        -- The first lookup misses, the next one hits.
+        for _ = 1, 2 do
+            for i = 1, 10 do
+                t.assert_equals(s:get(i), {i, 'v' .. i})
+                t.assert_equals(s.index.sk:get('v' .. i), {i, 'v' .. i})
+            end
+        end
+        for _, index in ipairs({s.index.pk, s.index.sk}) do
+            local st = stat(index)
+            t.assert_equals(st.count, 10)
+            t.assert_gt(st.bytes, 0)
+            t.assert_equals(st.lookup, 20)
+            t.assert_equals(st.hit, 10)
+            t.assert_equals(st.evict, 0)
+        end
+        t.assert_ge(s.index.pk:bsize(), stat(s.index.pk).bytes)
+
+        -- Missing keys aren't cached.
+        t.assert_equals(s:get(11), nil)
+        t.assert_equals(s.index.sk:get('v11'), nil)
+        t.assert_equals(stat(s.index.pk).count, 10)
+
+        -- Cached tuples are kept in sync with the tree.
+        s:replace({1, 'v1', 'replaced'})
+        s:update(2, {{'=', 3, 'updated'}})
+        s:update(3, {{'=', 2, 'w3'}})
+        s:delete(4)
+        s:insert({4, 'v4', 'inserted'})
+        s:delete(5)
+        for _ = 1, 2 do
+            t.assert_equals(s:get(1), {1, 'v1', 'replaced'})
+            t.assert_equals(s.index.sk:get('v1'), {1, 'v1', 'replaced'})
+            t.assert_equals(s:get(2), {2, 'v2', 'updated'})
+            t.assert_equals(s.index.sk:get('v2'), {2, 'v2', 'updated'})
+            t.assert_equals(s:get(3), {3, 'w3'})
+            t.assert_equals(s.index.sk:get('v3'), nil)
+            t.assert_equals(s.index.sk:get('w3'), {3, 'w3'})
+            t.assert_equals(s:get(4), {4, 'v4', 'inserted'})
+            t.assert_equals(s.index.sk:get('v4'), {4, 'v4', 'inserted'})
+            t.assert_equals(s:get(5), nil)
+            t.assert_equals(s.index.sk:get('v5'), nil)
+        end
+        t.assert_equals(s:select(), {
+            {1, 'v1', 'replaced'}, {2, 'v2', 'updated'}, {3, 'w3'},
+            {4, 'v4', 'inserted'}, {6, 'v6'}, {7, 'v7'}, {8, 'v8'},
+            {9, 'v9'}, {10, 'v10'},
+        })
+
+        -- Rolled back changes are reverted in the cache too.
+        box.begin()
+        s:replace({6, 'v6', 'rolled back'})
+        s:delete(7)
+        box.rollback()
+        t.assert_equals(s:get(6), {6, 'v6'})
+        t.assert_equals(s:get(7), {7, 'v7'})
+        t.assert_equals(s.index.sk:get('v7'), {7, 'v7'})
+
+        -- Statistics are reset with box.stat.reset().
+        box.stat.reset()
+        local st = stat(s.index.pk)
+        t.assert_equals(st.lookup, 0)
+        t.assert_equals(st.hit, 0)
+        t.assert_gt(st.count, 0)
+
+        -- Altering the option drops the cache.
+        s.index.pk:alter({adaptive_hash_size = 50})
+        t.assert_equals(stat(s.index.pk).count, 0)
+        t.assert_equals(s:get(1), {1, 'v1', 'replaced'})
+        t.assert_equals(stat(s.index.pk).count, 1)
+        s.index.pk:alter({adaptive_hash_size = 0})
+        t.assert_equals(s.index.pk:stat(), {})
+        t.assert_equals(s:get(1), {1, 'v1', 'replaced'})
+    end)
+end
+
+g.test_eviction = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {adaptive_hash_size = 10})
+        for i = 1, 100 do
+            s:insert({i})
+        end
+        for _ = 1, 3 do
+            for i = 1, 100 do
+                t.assert_equals(s:get(i), {i})
+            end
+        end
+        local st = s.index.pk:stat().adaptive_hash
+        t.assert_equals(st.count, 10)
+        t.assert_equals(st.lookup, 300)
+        t.assert_equals(st.evict, 300 - st.hit - 10)
+    end)
+end
+
+g.test_mvcc = function(cg)
+    t.skip_if(not cg.params.mvcc, 'MVCC is disabled')
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {adaptive_hash_size = 100})
+        s:insert({1, 'old'})
+        t.assert_equals(s:get(1), {1, 'old'})
+
+        -- A transaction doesn't see changes of concurrent ones
+        -- even if the key is cached.
+        local cond = fiber.cond()
+        local f = fiber.new(function()
+            box.begin()
+            local old = s:get(1)
+            cond:wait()
+            local ret = {old, s:get(1)}
+            box.commit()
+            return ret
+        end)
+        f:set_joinable(true)
+        fiber.yield()
+        s:replace({1, 'new'})
+        t.assert_equals(s:get(1), {1, 'new'})
+        cond:signal()
+        local ok, ret = f:join()
+        t.assert(ok)
+        t.assert_equals(ret, {{1, 'old'}, {1, 'old'}})
+        t.assert_equals(s:get(1), {1, 'new'})
+    end)
+end
@@ -0,0 +1,104 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_vinyl_unsupported = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'data', type = 'string', compression = 'zstd'},
+        }
+        t.assert_error_msg_equals(
+            "Vinyl does not support compression",
+            box.schema.space.create, 'test',
+            {engine = 'vinyl', format = format})
+    end)
+end
+
+g.test_indexed_field = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned', compression = 'zstd'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        t.assert_error_msg_content_equals(
+            "Indexed field does not support compression",
+            s.create_index, s, 'pk')
+    end)
+end
+
+g.test_compression = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'data', type = 'string', compression = 'zstd'},
+            {name = 'map', type = 'map', compression = 'zstd'},
+            {name = 'short', type = 'string', compression = 'zstd'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        local data = string.rep('abcdefgh', 1000)
+        local map = {a = data, b = {1, 2, 3}}
+        for i = 1, 100 do
+            t.assert_equals(s:insert({i, data, map, 'x'}),
+                            {i, data, map, 'x'})
+        end
+        -- Compressed tuples take less memory than the raw data.
+        t.assert_lt(s:bsize(), 100 * #data)
+        t.assert_equals(s:get(1), {1, data, map, 'x'})
+        t.assert_equals(s:select({}, {limit = 1, iterator = 'GT'}),
+                        {{1, data, map, 'x'}})
+        t.assert_equals(s:count(), 100)
+        t.assert_equals(s:update(1, {{'=', 'short', 'y'}}),
+                        {1, data, map, 'y'})
+        t.assert_equals(s:replace({2, 'z', {}, 'z'}), {2, 'z', {}, 'z'})
+        t.assert_equals(s:delete(3), {3, data, map, 'x'})
+        t.assert_equals(s:pairs():take(2):totable(),
+                        {{1, data, map, 'y'}, {2, 'z', {}, 'z'}})
+    end)
+end
+
+g.test_snapshot = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'data', type = 'string', compression = 'zstd'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        local data = string.rep('abcdefgh', 1000)
+        for i = 1, 100 do
+            s:insert({i, data})
+        end
+        box.snapshot()
+        s:insert({101, data})
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        local data = string.rep('abcdefgh', 1000)
+        t.assert_equals(s:count(), 101)
+        t.assert_lt(s:bsize(), 100 * #data)
+        for i = 1, 101 do
+            t.assert_equals(s:get(i), {i, data})
+        end
+    end)
+end
@@ -0,0 +1,127 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {memtx_use_mvcc_engine = true}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        require('internal.tweaks').memtx_tx_gc_bulk_threshold = 10000
+        box.space.test:drop()
+    end)
+end)
+
+g.test_bulk = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local tweaks = require('internal.tweaks')
+        local s = box.space.test
+        tweaks.memtx_tx_gc_bulk_threshold = 1000000000
+        for i = 1, 100 do
+            s:replace({i, 0})
+        end
+        box.internal.memtx_tx_gc(1000)
+        local gc = box.stat.memtx.tx().mvcc.gc
+        t.assert_equals(gc.debt, {total = 0, count = 0})
+        local bulk_count = gc.bulk.count
+        local bulk_stories = gc.bulk.stories
+
+        -- Send a transaction to a read view and make it retain a lot of
+        -- stories.
+        local cond = fiber.cond()
+        local f = fiber.new(function()
+            box.begin()
+            s:get(1)
+            cond:wait()
+            box.commit()
+        end)
+        f:set_joinable(true)
+        fiber.yield()
+        for j = 1, 10 do
+            for i = 1, 100 do
+                s:replace({i, j})
+            end
+        end
+        box.internal.memtx_tx_gc(10000)
+        local stat = box.stat.memtx.tx().mvcc
+        local read_view = stat.tuples.read_view.stories
+        t.assert_gt(read_view.count, 500)
+        t.assert_equals(stat.gc.debt, {total = 0, count = 0})
+
+        -- The stories become garbage once the read view is closed.
+        cond:signal()
+        t.assert(f:join())
+        stat = box.stat.memtx.tx().mvcc
+        t.assert_equals(stat.gc.debt, stat.tuples.read_view.stories)
+        local debt = stat.gc.debt
+        t.assert_gt(debt.count, 0)
+
+        -- And they are deleted at once by the next write.
+        tweaks.memtx_tx_gc_bulk_threshold = 100
+        s:replace({1, 100})
+        stat = box.stat.memtx.tx().mvcc
+        t.assert_equals(stat.gc.debt, {total = 0, count = 0})
+        t.assert_equals(stat.tuples.read_view.stories,
+                        {total = 0, count = 0})
+        t.assert_equals(stat.gc.bulk.count, bulk_count + 1)
+        t.assert_ge(stat.gc.bulk.stories - bulk_stories, debt.count)
+        t.assert_equals(s:count(), 100)
+        t.assert_equals(s:get(1), {1, 100})
+        t.assert_equals(s:get(2), {2, 10})
+        t.assert_equals(s.index.sk:count({10}), 99)
+    end)
+end
+
+g.test_incremental = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        for i = 1, 100 do
+            s:replace({i, 0})
+        end
+        local cond = fiber.cond()
+        local f = fiber.new(function()
+            box.begin()
+            s:get(1)
+            cond:wait()
+            box.commit()
+        end)
+        f:set_joinable(true)
+        fiber.yield()
+        for i = 1, 100 do
+            s:replace({i, 1})
+        end
+        box.internal.memtx_tx_gc(1000)
+        cond:signal()
+        t.assert(f:join())
+        local stat = box.stat.memtx.tx().mvcc
+        local bulk_count = stat.gc.bulk.count
+        t.assert_gt(stat.gc.debt.count, 0)
+        -- There are too few stories for a bulk pass, so the debt is paid
+        -- off by the incremental garbage collector.
+        s:replace({1, 2})
+        stat = box.stat.memtx.tx().mvcc
+        t.assert_equals(stat.gc.bulk.count, bulk_count)
+        box.internal.memtx_tx_gc(1000)
+        stat = box.stat.memtx.tx().mvcc
+        t.assert_equals(stat.gc.debt, {total = 0, count = 0})
+        t.assert_equals(stat.tuples.read_view.stories,
+                        {total = 0, count = 0})
+    end)
+end
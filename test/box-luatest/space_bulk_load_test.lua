@@ -0,0 +1,237 @@
+local msgpack = require('msgpack')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({engine = {'memtx', 'vinyl'}}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'string'}})
+    end, {cg.params.engine})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+g.test_invalid_args = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_error_msg_equals(
+            'Use space:bulk_load(...) instead of space.bulk_load(...)',
+            s.bulk_load, {})
+        t.assert_error_msg_equals(
+            'Illegal parameters, source must be a string, a table or ' ..
+            'a function', s.bulk_load, s, 1)
+        t.assert_error_msg_equals(
+            'Illegal parameters, batch_size must be a positive integer',
+            s.bulk_load, s, {}, {batch_size = 0})
+        t.assert_error_msg_equals(
+            'Illegal parameters, batch_size must be a positive integer',
+            s.bulk_load, s, {}, {batch_size = 1.5})
+        t.assert_error_msg_equals(
+            "Illegal parameters, mode must be either 'insert' or 'replace'",
+            s.bulk_load, s, {}, {mode = 'upsert'})
+        t.assert_error_msg_contains(
+            "unexpected option 'foo'", s.bulk_load, s, {}, {foo = 1})
+        box.begin()
+        t.assert_error_msg_equals(
+            'Operation is not permitted when there is an active transaction ',
+            s.bulk_load, s, {})
+        box.rollback()
+    end)
+end
+
+-- Loads tuples from the source returned by make_source(tuples) and checks
+-- that they are committed in batches.
+local function check_load(cg, make_source)
+    cg.server:exec(function(make_source_str)
+        local s = box.space.test
+        local make_source = loadstring(make_source_str)
+        local tuples = {}
+        for i = 1, 25 do
+            table.insert(tuples, {i, 'v' .. i})
+        end
+        local txns = {}
+        local function on_replace()
+            txns[box.txn_id()] = true
+        end
+        s:on_replace(on_replace)
+        t.assert_equals(s:bulk_load(make_source(tuples), {batch_size = 10}),
+                        25)
+        s:on_replace(nil, on_replace)
+        local txn_count = 0
+        for _ in pairs(txns) do
+            txn_count = txn_count + 1
+        end
+        t.assert_equals(txn_count, 3)
+        t.assert_equals(s:select(), tuples)
+        t.assert_equals(s.index.sk:select({'v7'}), {{7, 'v7'}})
+
+        -- Duplicates are rejected unless the replace mode is used.
+        -- The failed batch is rolled back, the previous ones stay.
+        local more = {}
+        for i = 26, 35 do
+            table.insert(more, {i, 'v' .. i})
+        end
+        table.insert(more, {1, 'dup'})
+        t.assert_error_msg_contains(
+            'Duplicate key exists in unique index "pk"', s.bulk_load, s,
+            make_source(more), {batch_size = 5})
+        t.assert_equals(s:count(), 35)
+        t.assert_equals(s:get(1), {1, 'v1'})
+
+        t.assert_equals(s:bulk_load(make_source({{1, 'w1'}, {2, 'w2'}}),
+                                    {mode = 'replace'}), 2)
+        t.assert_equals(s:get(1), {1, 'w1'})
+        t.assert_equals(s.index.sk:select({'v1'}), {})
+        t.assert_equals(s:count(), 35)
+
+        t.assert_equals(s:bulk_load(make_source({})), 0)
+        t.assert_equals(box.is_in_txn(), false)
+    end, {string.dump(make_source)})
+end
+
+g.test_table = function(cg)
+    check_load(cg, function(tuples)
+        return tuples
+    end)
+end
+
+g.test_function = function(cg)
+    check_load(cg, function(tuples)
+        local fiber = require('fiber')
+        local i = 0
+        return function()
+            -- The source may yield.
+            fiber.yield()
+            i = i + 1
+            return tuples[i]
+        end
+    end)
+end
+
+g.test_msgpack = function(cg)
+    check_load(cg, function(tuples)
+        local msgpack = require('msgpack')
+        local data = {}
+        for _, tuple in ipairs(tuples) do
+            table.insert(data, msgpack.encode(tuple))
+        end
+        return table.concat(data)
+    end)
+end
+
+g.test_invalid_msgpack = function(cg)
+    cg.server:exec(function(valid, not_array)
+        local s = box.space.test
+        t.assert_error_msg_equals(
+            'Tuple/Key must be MsgPack array', s.bulk_load, s,
+            valid .. not_array, {batch_size = 1})
+        -- A load into an empty memtx space is all or nothing.
+        if s.engine == 'memtx' then
+            t.assert_equals(s:select(), {})
+            s:insert({1, 'v1'})
+        end
+        t.assert_equals(s:select(), {{1, 'v1'}})
+        t.assert_error_msg_equals(
+            'Invalid MsgPack - bulk load data', s.bulk_load, s,
+            valid:sub(1, -2), {mode = 'replace'})
+        t.assert_equals(s:select(), {{1, 'v1'}})
+    end, {msgpack.encode({1, 'v1'}), msgpack.encode(1)})
+end
+
+local g_memtx = t.group('memtx')
+
+g_memtx.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g_memtx.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g_memtx.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'string'}})
+        s:create_index('nu', {parts = {3, 'unsigned'}, unique = false})
+    end)
+end)
+
+g_memtx.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+-- The secondary indexes of an empty memtx space are built after
+-- the tuples are inserted into the primary index.
+g_memtx.test_deferred_indexes = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local indexes = box.space._index:select({s.id})
+        local has_sk = {}
+        local function on_replace()
+            table.insert(has_sk, s.index.sk ~= nil)
+        end
+        s:on_replace(on_replace)
+        local tuples = {}
+        for i = 1, 1000 do
+            table.insert(tuples, {i, 'v' .. i, i % 10})
+        end
+        t.assert_equals(s:bulk_load(tuples, {batch_size = 100}), 1000)
+        s:on_replace(nil, on_replace)
+        t.assert_equals(#has_sk, 1000)
+        t.assert_not(has_sk[1] or has_sk[1000])
+        t.assert_equals(box.space._index:select({s.id}), indexes)
+        t.assert_equals(s.index.sk:get({'v42'}), {42, 'v42', 2})
+        t.assert_equals(s.index.nu:count({7}), 100)
+        -- The space isn't empty anymore, tuples are inserted into
+        -- all the indexes.
+        t.assert_equals(s:bulk_load({{1001, 'v1001', 1}}), 1)
+        t.assert_equals(s.index.sk:get({'v1001'}), {1001, 'v1001', 1})
+    end)
+end
+
+g_memtx.test_deferred_indexes_duplicate = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local indexes = box.space._index:select({s.id})
+        local tuples = {}
+        for i = 1, 100 do
+            table.insert(tuples, {i, 'v' .. i, i})
+        end
+        table.insert(tuples, {101, 'v42', 101})
+        t.assert_error_msg_contains(
+            'Duplicate key exists in unique index "sk"',
+            s.bulk_load, s, tuples, {batch_size = 10})
+        t.assert_equals(s:count(), 0)
+        t.assert_equals(box.space._index:select({s.id}), indexes)
+        -- A failure of the primary index is handled in the same way.
+        tuples[101] = {1, 'dup', 1}
+        t.assert_error_msg_contains(
+            'Duplicate key exists in unique index "pk"',
+            s.bulk_load, s, tuples, {batch_size = 10})
+        t.assert_equals(s:count(), 0)
+        t.assert_equals(box.space._index:select({s.id}), indexes)
+        tuples[101] = {101, 'v101', 101}
+        t.assert_equals(s:bulk_load(tuples), 101)
+        t.assert_equals(s.index.sk:get({'v101'}), {101, 'v101', 101})
+    end)
+end
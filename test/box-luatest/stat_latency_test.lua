@@ -0,0 +1,77 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.schema.user.grant('guest', 'super')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:truncate()
+        box.stat.reset()
+    end)
+end)
+
+g.test_latency = function(cg)
+    local c = net.connect(cg.server.net_box_uri)
+    for i = 1, 10 do
+        c.space.test:insert({i})
+    end
+    for i = 1, 5 do
+        c.space.test:select({i})
+    end
+    c.space.test:delete({1})
+    c:close()
+
+    cg.server:exec(function()
+        local function check_latency(stat, count)
+            t.assert_equals(stat.count, count)
+            t.assert_ge(stat.p50, 0)
+            t.assert_le(stat.p50, stat.p99)
+            t.assert_le(stat.p99, stat.p999)
+            t.assert_le(stat.p999, stat.max)
+        end
+        local stat = box.stat.latency()
+        t.assert_equals(stat.request.UPDATE, nil)
+        for _, k in ipairs({'net', 'queue', 'tx'}) do
+            check_latency(stat.request.INSERT[k], 10)
+            check_latency(stat.request.DELETE[k], 1)
+        end
+        t.assert_ge(stat.request.SELECT.net.count, 5)
+        t.assert_ge(stat.wal.count, 11)
+        check_latency(stat.wal, stat.wal.count)
+        check_latency(stat.space.test.INSERT, 10)
+        check_latency(stat.space.test.SELECT, 5)
+        check_latency(stat.space.test.DELETE, 1)
+        t.assert_equals(stat.space.test.REPLACE, nil)
+
+        -- Statistics survive space alter.
+        box.space.test:format({{'id', 'unsigned'}})
+        stat = box.stat.latency()
+        check_latency(stat.space.test.INSERT, 10)
+
+        -- Requests made from Lua aren't accounted.
+        box.space.test:insert({100})
+        stat = box.stat.latency()
+        check_latency(stat.space.test.INSERT, 10)
+
+        box.stat.reset()
+        stat = box.stat.latency()
+        t.assert_equals(stat.request, {})
+        t.assert_equals(stat.space, {})
+        check_latency(stat.wal, 0)
+    end)
+end
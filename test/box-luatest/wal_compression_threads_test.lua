@@ -0,0 +1,157 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {wal_compression_threads = 2}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.wal_compression_threads, 2)
+        t.assert_error_msg_equals(
+            "Can't set option 'wal_compression_threads' dynamically",
+            box.cfg, {wal_compression_threads = 4})
+    end)
+end
+
+g.test_write = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        -- A large transaction is written as a single xlog block,
+        -- small ones are batched by the WAL thread and split into
+        -- several blocks.
+        local data = string.rep('abcdefgh', 512)
+        box.begin()
+        for i = 1, 1000 do
+            s:insert({i, data})
+        end
+        box.commit()
+        local fibers = {}
+        for i = 1001, 2000 do
+            local f = fiber.new(function()
+                s:insert({i, tostring(i)})
+            end)
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        for _, f in ipairs(fibers) do
+            t.assert(f:join())
+        end
+        t.assert_equals(s:count(), 2000)
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        local data = string.rep('abcdefgh', 512)
+        t.assert_equals(s:count(), 2000)
+        for i = 1, 1000 do
+            t.assert_equals(s:get(i), {i, data})
+        end
+        for i = 1001, 2000 do
+            t.assert_equals(s:get(i), {i, tostring(i)})
+        end
+    end)
+end
+
+g.test_write_error = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test_error')
+        s:create_index('pk')
+        -- The error is injected after a block is written to the file,
+        -- so the file must be truncated to drop the blocks of the batch
+        -- written before the error.
+        local data = string.rep('abcdefgh', 128)
+        box.error.injection.set('ERRINJ_WAL_WRITE', true)
+        local fibers = {}
+        for i = 1, 200 do
+            local f = fiber.new(function()
+                return pcall(s.insert, s, {i, data})
+            end)
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        for _, f in ipairs(fibers) do
+            local _, ok = f:join()
+            t.assert_not(ok)
+        end
+        box.error.injection.set('ERRINJ_WAL_WRITE', false)
+        t.assert_equals(s:count(), 0)
+        for i = 201, 210 do
+            s:insert({i, data})
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test_error
+        local data = string.rep('abcdefgh', 128)
+        local expected = {}
+        for i = 201, 210 do
+            table.insert(expected, {i, data})
+        end
+        t.assert_equals(s:select(), expected)
+    end)
+end
+
+g.test_write_partial_error = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test_partial')
+        s:create_index('pk')
+        -- Small transactions are submitted to the compression pool in
+        -- blocks of 32 KB while the big one fails to be encoded. The
+        -- whole batch is rolled back, so the submitted blocks must be
+        -- discarded rather than written with the next batch.
+        local data = string.rep('abcdefgh', 128)
+        box.error.injection.set('ERRINJ_WAL_WRITE_PARTIAL', 48 * 1024)
+        local fibers = {}
+        for i = 1, 100 do
+            local f = fiber.new(function()
+                return pcall(s.insert, s, {i, data})
+            end)
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        local f = fiber.new(function()
+            return pcall(function()
+                box.begin()
+                for i = 101, 200 do
+                    s:insert({i, data})
+                end
+                box.commit()
+            end)
+        end)
+        f:set_joinable(true)
+        table.insert(fibers, f)
+        for _, f in ipairs(fibers) do
+            local _, ok = f:join()
+            t.assert_not(ok)
+        end
+        box.error.injection.set('ERRINJ_WAL_WRITE_PARTIAL', -1)
+        t.assert_equals(s:count(), 0)
+        for i = 201, 210 do
+            s:insert({i, data})
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test_partial
+        local data = string.rep('abcdefgh', 128)
+        local expected = {}
+        for i = 201, 210 do
+            table.insert(expected, {i, data})
+        end
+        t.assert_equals(s:select(), expected)
+    end)
+end
@@ -6,7 +6,7 @@ local socket = require('socket')
 local fio = require('fio')
 local uuid = require('uuid')
 local msgpack = require('msgpack')
-test:plan(111)
+test:plan(120)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -48,11 +48,20 @@ invalid('vinyl_run_count_per_level', 0)
 invalid('vinyl_run_size_ratio', 1)
 invalid('vinyl_bloom_fpr', 0)
 invalid('vinyl_bloom_fpr', 1.1)
+invalid('vinyl_bloom_memory', -1)
 invalid('wal_queue_max_size', -1)
 invalid('memtx_sort_threads', 'all')
 invalid('memtx_sort_threads', -1)
 invalid('memtx_sort_threads', 0)
 invalid('memtx_sort_threads', 257)
+invalid('sql_sort_threads', -1)
+invalid('sql_sort_threads', 17)
+invalid('sql_sort_memory', -1)
+invalid('memtx_recovery_read_ahead', -1)
+invalid('memtx_recovery_read_ahead', 1025)
+invalid('wal_compression_threads', -1)
+invalid('wal_compression_threads', 65)
+invalid('io_backend', 'aio')
 
 local function invalid_combinations(name, val)
     local status, result = pcall(box.cfg, val)
@@ -135,6 +135,8 @@ g.test_defaults = function()
     local exp = {
         fiber = {
             io_collect_interval = box.NULL,
+            io_backend = box.NULL,
+        io_backend = box.NULL,
             too_long_threshold = 0.5,
             worker_pool_threads = 4,
             slice = {
@@ -158,6 +160,8 @@ g.test_defaults = function()
         } or nil,
         sql = {
             cache_size = 5242880,
+            sort_threads = box.NULL,
+            sort_memory = box.NULL,
         },
         log = {
             to = 'stderr',
@@ -202,6 +206,7 @@ g.test_defaults = function()
             dir = 'var/lib/{{ instance_name }}',
             max_tuple_size = 1048576,
             bloom_fpr = 0.05,
+            bloom_memory = 0,
             page_size = 8192,
             range_size = box.NULL,
             run_count_per_level = 2,
@@ -233,6 +238,7 @@ g.test_defaults = function()
             sync_lag = 10,
             synchro_quorum = 'N / 2 + 1',
             skip_conflict = false,
+            parallel_apply = false,
             election_mode = box.NULL,
             election_timeout = 5,
             election_fencing_mode = 'soft',
@@ -245,6 +251,7 @@ g.test_defaults = function()
             dir_rescan_delay = 2,
             queue_max_size = 16777216,
             cleanup_delay = 14400,
+            compression_threads = box.NULL,
             retention_period = is_enterprise and 0 or nil,
         },
         console = {
@@ -259,6 +266,7 @@ g.test_defaults = function()
             min_tuple_size = 16,
             max_tuple_size = 1048576,
             sort_threads = box.NULL,
+            recovery_read_ahead = box.NULL,
         },
         config = {
             reload = 'auto',
@@ -213,6 +213,7 @@ g.test_fiber = function()
     local iconfig = {
         fiber = {
             io_collect_interval = 1,
+            io_backend = 'io_uring',
             too_long_threshold = 1,
             worker_pool_threads = 1,
             slice = {
@@ -229,6 +230,7 @@ g.test_fiber = function()
 
     local exp = {
         io_collect_interval = box.NULL,
+        io_backend = box.NULL,
         too_long_threshold = 0.5,
         worker_pool_threads = 4,
         slice = {
@@ -940,6 +942,8 @@ g.test_sql = function()
     local iconfig = {
         sql = {
             cache_size = 1,
+            sort_threads = 1,
+            sort_memory = 1,
         },
     }
     instance_config:validate(iconfig)
@@ -947,6 +951,8 @@ g.test_sql = function()
 
     local exp = {
         cache_size = 5242880,
+        sort_threads = box.NULL,
+        sort_memory = box.NULL,
     }
     local res = instance_config:apply_default({}).sql
     t.assert_equals(res, exp)
@@ -962,6 +968,7 @@ g.test_memtx = function()
             min_tuple_size = 1,
             max_tuple_size = 1,
             sort_threads = 1,
+            recovery_read_ahead = 1,
         },
     }
     instance_config:validate(iconfig)
@@ -975,6 +982,7 @@ g.test_memtx = function()
         min_tuple_size = 16,
         max_tuple_size = 1048576,
         sort_threads = box.NULL,
+        recovery_read_ahead = box.NULL,
     }
     local res = instance_config:apply_default({}).memtx
     t.assert_equals(res, exp)
@@ -986,6 +994,7 @@ g.test_vinyl = function()
             dir = 'one',
             max_tuple_size = 1,
             bloom_fpr = 0.1,
+            bloom_memory = 12,
             page_size = 123,
             range_size = 321,
             run_count_per_level = 11,
@@ -1005,6 +1014,7 @@ g.test_vinyl = function()
         dir = 'var/lib/{{ instance_name }}',
         max_tuple_size = 1048576,
         bloom_fpr = 0.05,
+        bloom_memory = 0,
         page_size = 8192,
         range_size = box.NULL,
         run_count_per_level = 2,
@@ -1030,6 +1040,7 @@ g.test_wal = function()
             dir_rescan_delay = 1,
             queue_max_size = 1,
             cleanup_delay = 1,
+            compression_threads = 1,
         },
     }
     instance_config:validate(iconfig)
@@ -1042,6 +1053,7 @@ g.test_wal = function()
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
         cleanup_delay = 14400,
+        compression_threads = box.NULL,
     }
     local res = instance_config:apply_default({}).wal
     t.assert_equals(res, exp)
@@ -1057,6 +1069,7 @@ g.test_wal_enterprise = function()
             dir_rescan_delay = 1,
             queue_max_size = 1,
             cleanup_delay = 1,
+            compression_threads = 1,
             retention_period = 1,
             ext = {
                 old = true,
@@ -1080,6 +1093,7 @@ g.test_wal_enterprise = function()
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
         cleanup_delay = 14400,
+        compression_threads = box.NULL,
         retention_period = 0,
     }
     local res = instance_config:apply_default({}).wal
@@ -1128,6 +1142,7 @@ g.test_replication = function()
             sync_lag = 1,
             synchro_quorum = 1,
             skip_conflict = true,
+            parallel_apply = true,
             election_mode = 'off',
             election_timeout = 1,
             election_fencing_mode = 'off',
@@ -1149,6 +1164,7 @@ g.test_replication = function()
         sync_lag = 10,
         synchro_quorum = 'N / 2 + 1',
         skip_conflict = false,
+        parallel_apply = false,
         election_mode = box.NULL,
         election_timeout = 5,
         election_fencing_mode = 'soft',
@@ -0,0 +1,186 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new{}
+    cg.master = cg.replica_set:build_and_add_server{
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    }
+    cg.replica = cg.replica_set:build_and_add_server{
+        alias = 'replica',
+        box_cfg = {
+            read_only = true,
+            replication = server.build_listen_uri('master', cg.replica_set.id),
+            replication_timeout = 0.1,
+            replication_parallel_apply = true,
+        },
+    }
+    cg.replica_set:start()
+    cg.master:exec(function()
+        -- Row dependencies are tracked by the primary key.
+        local s = box.schema.space.create('vinyl', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        -- Row dependencies are tracked by the whole space, because
+        -- of the unique secondary index.
+        s = box.schema.space.create('vinyl_uniq', {engine = 'vinyl'})
+        s:create_index('pk', {parts = {1, 'string'}})
+        s:create_index('sk', {parts = {2, 'unsigned'}})
+        -- Transactions can't yield, applied in order.
+        s = box.schema.space.create('memtx')
+        s:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.replica:exec(function()
+        t.assert_equals(box.cfg.replication_parallel_apply, true)
+        box.cfg{replication_parallel_apply = false}
+        t.assert_equals(box.cfg.replication_parallel_apply, false)
+        box.cfg{replication_parallel_apply = true}
+        t.assert_error_msg_contains(
+            "should be of type boolean",
+            box.cfg, {replication_parallel_apply = 1})
+    end)
+end
+
+g.test_apply = function(cg)
+    cg.master:exec(function()
+        local fiber = require('fiber')
+        local v = box.space.vinyl
+        local vu = box.space.vinyl_uniq
+        local m = box.space.memtx
+        -- Make the replica read from disk while applying rows.
+        for i = 1, 100 do
+            v:replace({i, i, 0})
+            vu:replace({tostring(i), i})
+        end
+        box.snapshot()
+        local fibers = {}
+        for f = 1, 20 do
+            local fib = fiber.new(function()
+                for i = 1, 50 do
+                    local k = (f * 7 + i * 13) % 100 + 1
+                    -- Concurrent vinyl transactions may conflict.
+                    pcall(box.atomic, function()
+                        v:upsert({k, k, 1}, {{'+', 3, 1}})
+                        if i % 5 == 0 then
+                            v:delete(100 - k + 1)
+                        end
+                        if i % 3 == 0 then
+                            vu:delete(tostring(k))
+                            vu:replace({tostring(k), k + 1000})
+                        end
+                    end)
+                    m:upsert({k, 1}, {{'+', 2, 1}})
+                    if i % 7 == 0 then
+                        v:replace({k, k, f})
+                    end
+                end
+            end)
+            fib:set_joinable(true)
+            table.insert(fibers, fib)
+        end
+        for _, fib in ipairs(fibers) do
+            t.assert(fib:join())
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    local function dump(server)
+        return server:exec(function()
+            return {
+                box.space.vinyl:select(),
+                box.space.vinyl.index.sk:select(),
+                box.space.vinyl_uniq:select(),
+                box.space.memtx:select(),
+            }
+        end)
+    end
+    t.assert_equals(dump(cg.replica), dump(cg.master))
+    cg.replica:assert_follows_upstream(cg.master:get_instance_id())
+end
+
+local g_quota = t.group('quota')
+
+g_quota.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.replica_set = replica_set:new{}
+    cg.master = cg.replica_set:build_and_add_server{
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    }
+    cg.replica = cg.replica_set:build_and_add_server{
+        alias = 'replica',
+        box_cfg = {
+            read_only = true,
+            replication = server.build_listen_uri('master', cg.replica_set.id),
+            replication_timeout = 0.1,
+            replication_parallel_apply = true,
+            vinyl_memory = 1024 * 1024,
+            vinyl_timeout = 0.01,
+        },
+    }
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g_quota.after_all(function(cg)
+    if cg.replica_set ~= nil then
+        cg.replica_set:drop()
+    end
+end)
+
+-- Replicated transactions wait for vinyl memory quota without
+-- a timeout, so replication doesn't stop under memory pressure.
+g_quota.test_quota = function(cg)
+    cg.replica:exec(function()
+        box.error.injection.set('ERRINJ_VY_DUMP_DELAY', true)
+    end)
+    cg.master:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        local padding = string.rep('x', 1000)
+        local fibers = {}
+        for f = 1, 10 do
+            local fib = fiber.new(function()
+                for i = 1, 300 do
+                    s:replace({f * 1000 + i, padding})
+                end
+            end)
+            fib:set_joinable(true)
+            table.insert(fibers, fib)
+        end
+        for _, fib in ipairs(fibers) do
+            t.assert(fib:join())
+        end
+    end)
+    cg.replica:exec(function(id)
+        local fiber = require('fiber')
+        -- Let the appliers wait for quota longer than vinyl_timeout.
+        fiber.sleep(0.5)
+        t.assert_equals(box.info.replication[id].upstream.status, 'follow')
+        box.error.injection.set('ERRINJ_VY_DUMP_DELAY', false)
+    end, {cg.master:get_instance_id()})
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:assert_follows_upstream(cg.master:get_instance_id())
+    cg.replica:exec(function()
+        t.assert_equals(box.space.test:count(), 3000)
+    end)
+end
@@ -0,0 +1,181 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'analyze'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT);]])
+        box.execute([[CREATE INDEX ia ON t(a);]])
+        box.execute([[CREATE INDEX ib ON t(b);]])
+        box.begin()
+        -- Values of a are skewed: almost all rows have a = 1.
+        for i = 1, 1000 do
+            box.space.t:insert({i, i <= 990 and 1 or i, i % 100})
+        end
+        box.commit()
+        box.execute([[ANALYZE;]])
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_stat = function(cg)
+    cg.server:exec(function()
+        local space_id = box.space.t.id
+        local stat = box.space._sql_stat
+        t.assert_not_equals(stat, nil)
+        t.assert_equals(stat.id, box.schema.SQL_STAT_ID)
+        local pk = stat:get({space_id, 0})
+        t.assert_equals(pk.tuple_count, 1000)
+        t.assert_equals(pk.distinct, {1000})
+        local ia = stat:get({space_id, box.space.t.index.ia.id})
+        t.assert_equals(ia.tuple_count, 1000)
+        t.assert_equals(ia.distinct, {11})
+        -- The most frequent value is sampled with its exact count.
+        t.assert_equals(ia.samples[1], {1, 0, 990})
+        local ib = stat:get({space_id, box.space.t.index.ib.id})
+        t.assert_equals(ib.distinct, {100})
+        t.assert_le(#ib.samples, 24)
+        -- Statistics are refreshed by the next ANALYZE.
+        box.space.t:delete({1000})
+        box.execute([[ANALYZE t;]])
+        t.assert_equals(stat:get({space_id, 0}).tuple_count, 999)
+        box.space.t:insert({1000, 1000, 0})
+        box.execute([[ANALYZE t;]])
+    end)
+end
+
+g.test_explain = function(cg)
+    cg.server:exec(function()
+        local function plan(sql)
+            local res = box.execute('EXPLAIN QUERY PLAN ' .. sql)
+            return res.rows[1][4]
+        end
+        t.assert_str_contains(plan([[SELECT * FROM t WHERE a = 1
+                                     AND b = 5;]]), 'USING INDEX ib')
+        t.assert_str_contains(plan([[SELECT * FROM t WHERE a = 995
+                                     AND b = 5;]]), 'USING INDEX ia')
+        t.assert_str_contains(plan([[SELECT * FROM t WHERE a < 2
+                                     AND b = 5;]]), 'USING INDEX ib')
+        t.assert_str_contains(plan([[SELECT * FROM t WHERE a > 1
+                                     AND b < 50;]]), 'USING INDEX ia')
+        -- Results do not depend on the chosen index.
+        local res = box.execute([[SELECT COUNT(*) FROM t WHERE a = 1
+                                  AND b = 5;]])
+        t.assert_equals(res.rows[1][1], 10)
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local _, err = box.execute([[ANALYZE no_such_table;]])
+        t.assert_equals(err.message,
+                        "Space 'no_such_table' does not exist")
+        box.execute([[CREATE VIEW v AS SELECT * FROM t;]])
+        _, err = box.execute([[ANALYZE v;]])
+        t.assert_equals(err.message,
+                        "Failed to execute SQL statement: can not analyze " ..
+                        "space 'v' because space is a view")
+        box.execute([[DROP VIEW v;]])
+    end)
+end
+
+g.test_drop = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE INDEX i2 ON t2(a);]])
+        for i = 1, 10 do
+            box.space.t2:insert({i, i % 3})
+        end
+        box.execute([[ANALYZE t2;]])
+        local space_id = box.space.t2.id
+        local stat = box.space._sql_stat
+        t.assert_equals(#stat:select({space_id}), 2)
+        box.execute([[DROP INDEX i2 ON t2;]])
+        local rows = stat:select({space_id})
+        t.assert_equals(#rows, 1)
+        t.assert_equals(rows[1].index_id, 0)
+        box.execute([[DROP TABLE t2;]])
+        t.assert_equals(stat:select({space_id}), {})
+        -- Statistics are removed when a space is dropped from Lua too.
+        box.schema.space.create('s', {format = {{'id', 'unsigned'}}})
+        box.space.s:create_index('pk')
+        box.space.s:insert({1})
+        box.execute([[ANALYZE "s";]])
+        space_id = box.space.s.id
+        t.assert_equals(#stat:select({space_id}), 1)
+        box.space.s:drop()
+        t.assert_equals(stat:select({space_id}), {})
+    end)
+end
+
+g.test_yield = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.execute([[CREATE TABLE t3 (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE INDEX i3 ON t3(a);]])
+        box.begin()
+        for i = 1, 5000 do
+            box.space.t3:insert({i, i % 7})
+        end
+        box.commit()
+        local space_id = box.space.t3.id
+        -- The scan yields, so the space can be dropped meanwhile.
+        local f = fiber.new(box.execute, [[ANALYZE t3;]])
+        f:set_joinable(true)
+        fiber.yield()
+        box.execute([[DROP TABLE t3;]])
+        local ok, res, err = f:join()
+        t.assert(ok)
+        t.assert_equals(err, nil)
+        t.assert_not_equals(res, nil)
+        t.assert_equals(box.space._sql_stat:select({space_id}), {})
+    end)
+end
+
+g.test_access = function(cg)
+    cg.server:exec(function()
+        box.schema.user.create('u')
+        box.schema.user.grant('u', 'read', 'space', 't')
+        box.session.su('u', function()
+            -- Statistics are written on behalf of admin.
+            local _, err = box.execute([[ANALYZE t;]])
+            t.assert_equals(err, nil)
+            local key = {box.space.t.id, 0}
+            local stat = box.space._sql_stat
+            t.assert_equals(stat:get(key).tuple_count, 1000)
+            t.assert_error_msg_content_equals(
+                "Write access to space '_sql_stat' is denied for user 'u'",
+                stat.delete, stat, key)
+        end)
+        box.schema.user.drop('u')
+    end)
+end
+
+g.test_alter = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t4 (id INT PRIMARY KEY, a INT, b INT);]])
+        box.execute([[CREATE INDEX i4 ON t4(a);]])
+        for i = 1, 10 do
+            box.space.t4:insert({i, i % 2, i})
+        end
+        box.execute([[ANALYZE t4;]])
+        local key = {box.space.t4.id, box.space.t4.index.i4.id}
+        local stat = box.space._sql_stat
+        t.assert_equals(stat:get(key).distinct, {2})
+        -- Renaming an index keeps its statistics.
+        box.space.t4.index.i4:alter({name = 'j4'})
+        t.assert_equals(stat:get(key).distinct, {2})
+        -- Statistics of the old key parts are removed.
+        box.space.t4.index.j4:alter({parts = {'b'}})
+        t.assert_equals(stat:get(key), nil)
+        box.execute([[ANALYZE t4;]])
+        t.assert_equals(stat:get(key).distinct, {10})
+        box.execute([[DROP TABLE t4;]])
+    end)
+end
@@ -0,0 +1,155 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'batch_aggregate'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, d DOUBLE,
+                                      s STRING COLLATE "unicode_ci", i INT);]])
+        box.execute([[CREATE INDEX t_i ON t(i);]])
+        box.begin()
+        -- More rows than fit in a single batch.
+        for k = 1, 1000 do
+            local a = k % 13 ~= 0 and k % 97 or nil
+            box.space.t:insert({k, a, k / 4 + 0.125, 'S' .. k % 30, k})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_explain = function(cg)
+    cg.server:exec(function()
+        local function plan(sql)
+            local res = box.execute('EXPLAIN QUERY PLAN ' .. sql)
+            return res.rows[1][4]
+        end
+        t.assert_equals(plan([[SELECT SUM(a), MAX(s) FROM t;]]),
+                        'BATCH SCAN TABLE t')
+        t.assert_equals(plan([[SELECT COUNT(*) FROM t WHERE a > 10
+                               AND 'x' <> s;]]), 'BATCH SCAN TABLE t')
+        -- Indexed columns are left to the planner.
+        t.assert_str_contains(plan([[SELECT SUM(a) FROM t WHERE i < 10;]]),
+                              'SEARCH TABLE t USING COVERING INDEX t_i')
+        t.assert_str_contains(plan([[SELECT MAX(i) FROM t;]]),
+                              'SEARCH TABLE t USING COVERING INDEX t_i')
+        t.assert_not_str_contains(plan([[SELECT SUM(i), SUM(a) FROM t;]]),
+                                  'BATCH')
+        -- Scanning the primary index is the same as scanning the table.
+        t.assert_equals(plan([[SELECT COUNT(id), MAX(id) FROM t;]]),
+                        'BATCH SCAN TABLE t')
+        t.assert_str_contains(plan([[SELECT MAX(id) FROM t;]]),
+                              'SEARCH TABLE t USING PRIMARY KEY')
+        -- GROUP BY is executed row by row.
+        t.assert_not_str_contains(plan([[SELECT SUM(a) FROM t GROUP BY d;]]),
+                                  'BATCH')
+        -- Unsupported queries are executed row by row.
+        t.assert_str_contains(plan([[SELECT SUM(a + 1) FROM t;]]),
+                              'SCAN TABLE t (')
+        t.assert_str_contains(plan([[SELECT COUNT(DISTINCT a) FROM t;]]),
+                              'SCAN TABLE t (')
+        t.assert_str_contains(plan([[SELECT SUM(a) FROM t
+                                     WHERE a > 1 OR d < 2;]]),
+                              'SCAN TABLE t (')
+    end)
+end
+
+g.test_aggregates = function(cg)
+    cg.server:exec(function()
+        local function aggregate(where)
+            local sum, total, count, count_a, min_s, max_d = nil, 0, 0, 0
+            for _, tuple in box.space.t:pairs() do
+                if where(tuple) then
+                    count = count + 1
+                    if tuple.a ~= nil then
+                        count_a = count_a + 1
+                        sum = (sum or 0) + tuple.a
+                        total = total + tuple.a
+                    end
+                    local s = tuple.s:lower()
+                    if min_s == nil or s < min_s then
+                        min_s = s
+                    end
+                    if max_d == nil or tuple.d > max_d then
+                        max_d = tuple.d
+                    end
+                end
+            end
+            return {sum, total, count, count_a, min_s, max_d}
+        end
+        local function execute(where)
+            local sql = [[SELECT SUM(a), TOTAL(a), COUNT(*), COUNT(a),
+                                 LOWER(MIN(s)), MAX(d) FROM t]]
+            if where ~= nil then
+                sql = sql .. ' WHERE ' .. where
+            end
+            local res = box.execute(sql)
+            return res.rows[1]
+        end
+        t.assert_equals(execute(), aggregate(function() return true end))
+        t.assert_equals(execute('a >= 50 AND 300.5 > d'),
+                        aggregate(function(tuple)
+            return tuple.a ~= nil and tuple.a >= 50 and tuple.d < 300.5
+        end))
+        -- Strings are compared using the collation of the column.
+        t.assert_equals(execute([[s = 's7' AND a <> 7]]),
+                        aggregate(function(tuple)
+            return tuple.s == 'S7' and tuple.a ~= nil and tuple.a ~= 7
+        end))
+        -- Nothing is selected.
+        local empty = {box.NULL, 0, 0, 0, box.NULL, box.NULL}
+        t.assert_equals(execute('a > 1000'), empty)
+        t.assert_equals(execute('a = NULL'), empty)
+        local res = box.execute([[SELECT AVG(d) FROM t WHERE ? < a;]], {90})
+        local sum, count = 0, 0
+        for _, tuple in box.space.t:pairs() do
+            if tuple.a ~= nil and tuple.a > 90 then
+                sum = sum + tuple.d
+                count = count + 1
+            end
+        end
+        t.assert_equals(res.rows[1][1], sum / count)
+        res = box.execute([[SELECT COUNT(id), SUM(id), MIN(id) FROM t
+                            WHERE a < 5;]])
+        sum, count = 0, 0
+        local min
+        for _, tuple in box.space.t:pairs() do
+            if tuple.a ~= nil and tuple.a < 5 then
+                sum = sum + tuple.id
+                count = count + 1
+                min = min or tuple.id
+            end
+        end
+        t.assert_equals(res.rows[1], {count, sum, min})
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local _, err = box.execute([[SELECT SUM(a) FROM t WHERE a > 'a';]])
+        t.assert_equals(err.message,
+                        "Type mismatch: can not convert string('a') " ..
+                        "to number")
+        box.execute([[CREATE TABLE big (id INT PRIMARY KEY, a INT);]])
+        for k = 1, 300 do
+            box.space.big:insert({k, 9223372036854775807})
+        end
+        _, err = box.execute([[SELECT SUM(a) FROM big;]])
+        t.assert_equals(err.message,
+                        "Failed to execute SQL statement: " ..
+                        "integer is overflowed")
+        -- Full scan is still forbidden unless allowed.
+        box.execute([[SET SESSION "sql_seq_scan" = false;]])
+        _, err = box.execute([[SELECT SUM(a) FROM t;]])
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        t.assert_equals(err.message, "Scanning is not allowed for 't'")
+        box.execute([[DROP TABLE big;]])
+    end)
+end
@@ -0,0 +1,189 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'hash_join'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t1 (id INT PRIMARY KEY, a INT,
+                                       s STRING COLLATE "unicode_ci");]])
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, b INT,
+                                       s STRING COLLATE "unicode_ci",
+                                       n NUMBER);]])
+        box.begin()
+        for i = 1, 200 do
+            local a = i % 10 ~= 0 and i % 120 or nil
+            box.space.t1:insert({i, a, 'V' .. i % 60})
+        end
+        -- Automatic indexes are only used for big enough spaces.
+        for i = 1, 10240 do
+            local b = i % 7 ~= 0 and i % 100 or nil
+            box.space.t2:insert({i, b, 'v' .. i % 50, i % 100})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_explain = function(cg)
+    cg.server:exec(function()
+        local function plan(sql)
+            local res = box.execute('EXPLAIN QUERY PLAN ' .. sql)
+            local details = {}
+            for _, row in ipairs(res.rows) do
+                table.insert(details, row[4])
+            end
+            return table.concat(details, '\n')
+        end
+        local sql = [[SELECT t1.id, t2.id FROM t1 JOIN t2 ON t1.a = t2.b;]]
+        t.assert_str_contains(plan(sql),
+                              'SEARCH TABLE t2 USING HASH INDEX (b=?)')
+        sql = [[SELECT t1.id, t2.id FROM t1 JOIN t2 ON t1.s = t2.s;]]
+        t.assert_str_contains(plan(sql),
+                              'SEARCH TABLE t2 USING HASH INDEX (s=?)')
+        -- Hashes of NUMBER values are not consistent with comparison.
+        sql = [[SELECT t1.id, t2.id FROM t1 JOIN t2 ON t1.a = t2.n;]]
+        t.assert_str_contains(plan(sql),
+                              'SEARCH TABLE t2 USING EPHEMERAL INDEX (n=?)')
+    end)
+end
+
+g.test_join = function(cg)
+    cg.server:exec(function()
+        local function count(where)
+            local c = 0
+            for _, r1 in box.space.t1:pairs() do
+                for _, r2 in box.space.t2:pairs() do
+                    if where(r1, r2) then
+                        c = c + 1
+                    end
+                end
+            end
+            return c
+        end
+        local res = box.execute([[SELECT COUNT(*) FROM t1 JOIN t2
+                                  ON t1.a = t2.b;]])
+        t.assert_equals(res.rows[1][1], count(function(r1, r2)
+            return r1[2] ~= nil and r1[2] == r2[2]
+        end))
+        -- The key is compared using the collation of the column.
+        res = box.execute([[SELECT COUNT(*) FROM t1 JOIN t2
+                            ON t1.s = t2.s;]])
+        t.assert_equals(res.rows[1][1], count(function(r1, r2)
+            return r1[3]:lower() == r2[3]
+        end))
+        -- Values are fetched from the hash table records.
+        res = box.execute([[SELECT t1.id, t2.id, t2.b, t2.s FROM t1 JOIN t2
+                            ON t1.a = t2.b AND t1.s = t2.s
+                            ORDER BY t1.id, t2.id LIMIT 3;]])
+        t.assert_equals(res.rows, {
+            {1, 1, 1, 'v1'}, {1, 101, 1, 'v1'}, {1, 201, 1, 'v1'},
+        })
+    end)
+end
+
+g.test_left_join = function(cg)
+    cg.server:exec(function()
+        local res = box.execute([[SELECT t1.id, t2.id FROM t1 LEFT JOIN t2
+                                  ON t1.a = t2.b WHERE t1.id IN (10, 101, 110)
+                                  ORDER BY t1.id;]])
+        -- NULL key never matches, 101 and 110 have no pair.
+        t.assert_equals(res.rows, {{10, box.NULL}, {101, box.NULL},
+                                   {110, box.NULL}})
+    end)
+end
+
+g.test_numeric_keys = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE d1 (id INT PRIMARY KEY, i INT,
+                                       d DOUBLE);]])
+        box.execute([[CREATE TABLE d2 (id INT PRIMARY KEY, d DOUBLE);]])
+        -- Integral Lua numbers are encoded as MsgPack integers, wrap
+        -- them in cdata to store doubles.
+        local ffi = require('ffi')
+        local values = {0, -0.0, 1, -1, 1.5, 2 ^ 40}
+        for i, v in ipairs(values) do
+            local int = math.floor(v) == v and v or nil
+            box.space.d1:insert({i, int, ffi.new('double', v)})
+        end
+        box.begin()
+        for i = 1, 10240 do
+            local v = values[i % #values + 1]
+            if math.floor(i / #values) % 2 == 0 then
+                v = ffi.new('double', v)
+            end
+            box.space.d2:insert({i, v})
+        end
+        box.commit()
+        local res = box.execute([[EXPLAIN QUERY PLAN SELECT COUNT(*)
+                                  FROM d1 JOIN d2 ON d1.d = d2.d;]])
+        local details = {}
+        for _, row in ipairs(res.rows) do
+            table.insert(details, row[4])
+        end
+        t.assert_str_contains(table.concat(details, '\n'),
+                              'SEARCH TABLE d2 USING HASH INDEX (d=?)')
+        local function count(fieldno)
+            local c = 0
+            for _, r1 in box.space.d1:pairs() do
+                for _, r2 in box.space.d2:pairs() do
+                    if r1[fieldno] ~= nil and r1[fieldno] == r2[2] then
+                        c = c + 1
+                    end
+                end
+            end
+            return c
+        end
+        -- Integers and doubles, 0 and -0.0 must match each other.
+        res = box.execute([[SELECT COUNT(*) FROM d1 JOIN d2
+                            ON d1.d = d2.d;]])
+        t.assert_equals(res.rows[1][1], count(3))
+        res = box.execute([[SELECT COUNT(*) FROM d1 JOIN d2
+                            ON d1.i = d2.d;]])
+        t.assert_equals(res.rows[1][1], count(2))
+        -- -0.0 matches both zeros.
+        local zeros = box.space.d2:pairs():filter(function(r)
+            return r[2] == 0
+        end):length()
+        res = box.execute([[SELECT COUNT(*) FROM d1 JOIN d2
+                            ON d1.d = d2.d WHERE d1.id = 2;]])
+        t.assert_equals(res.rows[1][1], zeros)
+        box.execute([[DROP TABLE d1;]])
+        box.execute([[DROP TABLE d2;]])
+    end)
+end
+
+g.test_memory_limit = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local queries = {
+            [[SELECT t1.id, t2.id FROM t1 JOIN t2 ON t1.a = t2.b
+              ORDER BY t1.id, t2.id;]],
+            [[SELECT t1.id, t2.id, t2.s FROM t1 JOIN t2 ON t1.s = t2.s
+              ORDER BY t1.id, t2.id;]],
+            [[SELECT t1.id, t2.id FROM t1 LEFT JOIN t2 ON t1.a = t2.b
+              WHERE t1.id IN (10, 101, 110) ORDER BY t1.id;]],
+        }
+        local expected = {}
+        for i, sql in ipairs(queries) do
+            expected[i] = box.execute(sql).rows
+        end
+        -- The records are moved to an ephemeral space once the hash
+        -- table exceeds the limit, the result is the same.
+        box.error.injection.set('ERRINJ_SQL_HASH_MEMORY_MAX', 4096)
+        for i, sql in ipairs(queries) do
+            local res, err = box.execute(sql)
+            t.assert_equals(err, nil)
+            t.assert_equals(res.rows, expected[i])
+        end
+        box.error.injection.set('ERRINJ_SQL_HASH_MEMORY_MAX', -1)
+        t.assert(#expected[1] > 0)
+        t.assert(#expected[2] > 0)
+    end)
+end
@@ -0,0 +1,115 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        alias = 'sort_threads',
+        box_cfg = {
+            sql_sort_threads = 4,
+            -- Small enough to spill more PMAs than are merged at once.
+            sql_sort_memory = 1024 * 1024,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT,
+                                      s STRING);]])
+        local pad = string.rep('x', 80)
+        box.begin()
+        for i = 1, 50000 do
+            box.space.t:insert({i, (i * 7919) % 50000, pad .. i % 1000})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_order_by = function(cg)
+    cg.server:exec(function()
+        local function check()
+            local res = box.execute([[SELECT a, id FROM t ORDER BY a DESC;]])
+            t.assert_equals(#res.rows, 50000)
+            for i, row in ipairs(res.rows) do
+                t.assert_equals(row[1], 50000 - i)
+            end
+        end
+        check()
+        -- The result does not depend on the number of threads.
+        box.cfg{sql_sort_threads = 1}
+        check()
+        box.cfg{sql_sort_threads = 0}
+        check()
+        box.cfg{sql_sort_threads = 4}
+    end)
+end
+
+g.test_group_by = function(cg)
+    cg.server:exec(function()
+        local res = box.execute([[SELECT s, COUNT(*) FROM t GROUP BY s
+                                  ORDER BY s;]])
+        local exp = {}
+        for _, tuple in box.space.t:pairs() do
+            exp[tuple.s] = (exp[tuple.s] or 0) + 1
+        end
+        t.assert_equals(#res.rows, 1000)
+        local prev
+        for _, row in ipairs(res.rows) do
+            t.assert_equals(row[2], exp[row[1]])
+            if prev ~= nil then
+                t.assert_lt(prev, row[1])
+            end
+            prev = row[1]
+        end
+    end)
+end
+
+g.test_yield = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local count = 0
+        local f = fiber.new(function()
+            while true do
+                count = count + 1
+                fiber.yield()
+            end
+        end)
+        f:set_joinable(true)
+        fiber.yield()
+        count = 0
+        box.execute([[SELECT a FROM t ORDER BY s, a;]])
+        f:cancel()
+        f:join()
+        -- Other fibers run while the workers are sorting.
+        t.assert_gt(count, 0)
+        -- A memtx transaction can not yield, the result is still correct.
+        box.begin()
+        box.space.t:replace(box.space.t:get({1}))
+        local res = box.execute([[SELECT a FROM t ORDER BY a LIMIT 3;]])
+        t.assert_equals(res.rows, {{0}, {1}, {2}})
+        box.commit()
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'sql_sort_threads': must be " ..
+            "greater than or equal to 0 and less than or equal to 16",
+            box.cfg, {sql_sort_threads = 17})
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'sql_sort_memory': must be " ..
+            "non-negative", box.cfg, {sql_sort_memory = -1})
+        t.assert_equals(box.cfg.sql_sort_threads, 4)
+        box.cfg{sql_sort_memory = 0}
+        local res = box.execute([[SELECT COUNT(*) FROM
+                                  (SELECT a FROM t ORDER BY s);]])
+        t.assert_equals(res.rows, {{50000}})
+        box.cfg{sql_sort_memory = 1024 * 1024}
+    end)
+end
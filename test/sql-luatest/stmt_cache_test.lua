@@ -0,0 +1,167 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'stmt_cache'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT,
+                                      s STRING);]])
+        box.execute([[CREATE INDEX ia ON t(a);]])
+        box.execute([[CREATE INDEX ib ON t(b);]])
+        box.begin()
+        -- Values of a are skewed: almost all rows have a = 1.
+        for i = 1, 1000 do
+            box.space.t:insert({i, i <= 990 and 1 or i, i % 100, 's' .. i})
+        end
+        box.commit()
+        box.execute([[ANALYZE;]])
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_shared = function(cg)
+    cg.server:exec(function()
+        local function stmt_count()
+            return box.info.sql().cache.stmt_count
+        end
+        local stat = box.stat.sql()
+        box.execute([[SELECT id FROM t WHERE id = 1;]])
+        local count = stmt_count()
+        t.assert_gt(count, 0)
+        -- Statements which differ only in constants share a plan.
+        for i = 2, 10 do
+            local res = box.execute(string.format(
+                [[SELECT id FROM t WHERE id = %d;]], i))
+            t.assert_equals(res.rows, {{i}})
+        end
+        t.assert_equals(stmt_count(), count)
+        local res = box.execute([[SELECT id FROM t WHERE id = -1;]])
+        t.assert_equals(res.rows, {})
+        res = box.execute([[SELECT id FROM t WHERE s = 's5' OR s = 's''';]])
+        t.assert_equals(res.rows, {{5}})
+        res = box.execute([[SELECT id FROM t WHERE s = 's6' OR s = 's''';]])
+        t.assert_equals(res.rows, {{6}})
+        t.assert_equals(stmt_count(), count + 1)
+        local new_stat = box.stat.sql()
+        t.assert_ge(new_stat.sql_cache_hit_count - stat.sql_cache_hit_count,
+                    10)
+        t.assert_gt(new_stat.sql_plan_count, stat.sql_plan_count)
+        t.assert_gt(new_stat.sql_plan_time, 0)
+        -- Constants of the result set are kept.
+        res = box.execute([[SELECT 1 AS x FROM t WHERE id = 1;]])
+        t.assert_equals(res.metadata, {{name = 'X', type = 'integer'}})
+        res = box.execute([[SELECT 'a' AS x FROM t WHERE id = 1;]])
+        t.assert_equals(res.metadata, {{name = 'X', type = 'string'}})
+        -- Parameters are mixed with the replaced constants.
+        res = box.execute([[SELECT id FROM t WHERE id = ? OR id = 3
+                            ORDER BY id;]], {2})
+        t.assert_equals(res.rows, {{2}, {3}})
+        res = box.execute([[SELECT id FROM t WHERE id = :x OR id = 3
+                            ORDER BY id;]], {{[':x'] = 4}})
+        t.assert_equals(res.rows, {{3}, {4}})
+    end)
+end
+
+g.test_dml = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE d (id INT PRIMARY KEY, v DECIMAL);]])
+        for i = 1, 5 do
+            box.execute(string.format(
+                [[INSERT INTO d VALUES (%d, %d.5);]], i, -i))
+        end
+        box.execute([[UPDATE d SET v = 0.25 WHERE id = 2;]])
+        box.execute([[DELETE FROM d WHERE id = 3;]])
+        local res = box.execute([[SELECT id, CAST(v AS STRING) FROM d;]])
+        t.assert_equals(res.rows, {{1, '-1.5'}, {2, '0.25'}, {4, '-4.5'},
+                                   {5, '-5.5'}})
+        -- Errors are the same as without the cache.
+        local function errors()
+            local _, err1 = box.execute([[INSERT INTO d VALUES (1, 1);]])
+            local _, err2 = box.execute([[SELECT * FROM d WHERE id = ?;]],
+                                        {1, 2})
+            local _, err3 = box.execute([[SELECT * FROM d WHERE id = 1
+                                          AND v = x'00';]])
+            return {err1.message, err2.message, err3.message}
+        end
+        local cached = errors()
+        local size = box.cfg.sql_cache_size
+        box.cfg{sql_cache_size = 0}
+        t.assert_equals(cached, errors())
+        box.cfg{sql_cache_size = size}
+        box.execute([[DROP TABLE d;]])
+    end)
+end
+
+g.test_invalidation = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT COUNT(*) FROM t WHERE b > 97;]]
+        t.assert_equals(box.execute(sql).rows, {{20}})
+        -- SQL settings of the session are respected.
+        box.execute([[SET SESSION "sql_seq_scan" = false;]])
+        t.assert_equals(box.execute(sql).rows, {{20}})
+        local _, err = box.execute([[SELECT COUNT(*) FROM t WHERE s > 'a';]])
+        t.assert_equals(err.message, "Scanning is not allowed for 't'")
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        t.assert_equals(box.execute(
+            [[SELECT COUNT(*) FROM t WHERE s > 'a';]]).rows, {{1000}})
+        -- Statements are compiled again after a schema change.
+        box.execute([[CREATE TABLE u (id INT PRIMARY KEY, a INT);]])
+        box.execute([[INSERT INTO u VALUES (1, 1);]])
+        local res = box.execute([[SELECT * FROM u WHERE id = 1;]])
+        t.assert_equals(res.rows, {{1, 1}})
+        box.execute([[ALTER TABLE u ADD COLUMN b INT;]])
+        res = box.execute([[SELECT * FROM u WHERE id = 1;]])
+        t.assert_equals(#res.metadata, 3)
+        box.execute([[DROP TABLE u;]])
+        -- Shared statements are evicted when the cache is shrunk.
+        local size = box.cfg.sql_cache_size
+        box.cfg{sql_cache_size = 0}
+        t.assert_equals(box.info.sql().cache.stmt_count, 0)
+        t.assert_equals(box.execute(sql).rows, {{20}})
+        t.assert_equals(box.info.sql().cache.stmt_count, 0)
+        box.cfg{sql_cache_size = size}
+    end)
+end
+
+g.test_plan_variants = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT COUNT(*) FROM t WHERE a = ? AND b = ?;]]
+        local s = box.prepare(sql)
+        local function count(a, b)
+            local n = 0
+            for _, tuple in box.space.t:pairs() do
+                if tuple.a == a and tuple.b == b then
+                    n = n + 1
+                end
+            end
+            return n
+        end
+        local stat = box.stat.sql()
+        -- The plan is chosen for the selectivity of the values.
+        for _, v in ipairs({{1, 5}, {995, 95}, {1, 7}, {996, 96}}) do
+            t.assert_equals(s:execute(v).rows, {{count(v[1], v[2])}})
+        end
+        local new_stat = box.stat.sql()
+        t.assert_equals(new_stat.sql_cache_miss_count -
+                        stat.sql_cache_miss_count, 2)
+        -- Unprepared statements have plan variants too.
+        stat = new_stat
+        t.assert_equals(box.execute([[SELECT COUNT(*) FROM t WHERE a = 1
+                                      AND b = 5;]]).rows, {{10}})
+        t.assert_equals(box.execute([[SELECT COUNT(*) FROM t WHERE a = 995
+                                      AND b = 95;]]).rows, {{1}})
+        t.assert_equals(box.execute([[SELECT COUNT(*) FROM t WHERE a = 1
+                                      AND b = 5;]]).rows, {{10}})
+        new_stat = box.stat.sql()
+        t.assert_equals(new_stat.sql_cache_miss_count -
+                        stat.sql_cache_miss_count, 3)
+        s:unprepare()
+    end)
+end
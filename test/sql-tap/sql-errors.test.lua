@@ -18,7 +18,8 @@ test:do_catchsql_test(
 		ANALYZE v0;
 	]], {
 		-- <sql-errors-1.1>
-		1,"Syntax error at line 1 near 'ANALYZE'"
+		1,"Failed to execute SQL statement: can not analyze "..
+		"space 'v0' because space is a view"
 		-- </sql-errors-1.1>
 	})
 
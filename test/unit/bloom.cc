@@ -1,4 +1,5 @@
 #include "salad/bloom.h"
+#include "cpu_feature.h"
 #include <unordered_set>
 #include <vector>
 #include <iostream>
@@ -11,9 +12,10 @@ uint32_t h(uint32_t i)
 }
 
 void
-simple_test()
+simple_test(enum bloom_version version)
 {
-	cout << "*** " << __func__ << " ***" << endl;
+	cout << "*** " << __func__ << ": version " << version << " ***"
+	     << endl;
 	srand(time(0));
 	uint32_t error_count = 0;
 	uint32_t fp_rate_too_big = 0;
@@ -22,7 +24,7 @@ simple_test()
 		uint64_t false_positive = 0;
 		for (uint32_t count = 1000; count <= 10000; count *= 2) {
 			struct bloom bloom;
-			bloom_create(&bloom, count, p);
+			bloom_create(&bloom, count, p, version);
 			unordered_set<uint32_t> check;
 			for (uint32_t i = 0; i < count; i++) {
 				uint32_t val = rand() % (count * 10);
@@ -50,9 +52,10 @@ simple_test()
 }
 
 void
-store_load_test()
+store_load_test(enum bloom_version version)
 {
-	cout << "*** " << __func__ << " ***" << endl;
+	cout << "*** " << __func__ << ": version " << version << " ***"
+	     << endl;
 	srand(time(0));
 	uint32_t error_count = 0;
 	uint32_t fp_rate_too_big = 0;
@@ -61,7 +64,7 @@ store_load_test()
 		uint64_t false_positive = 0;
 		for (uint32_t count = 300; count <= 3000; count *= 10) {
 			struct bloom bloom;
-			bloom_create(&bloom, count, p);
+			bloom_create(&bloom, count, p, version);
 			unordered_set<uint32_t> check;
 			for (uint32_t i = 0; i < count; i++) {
 				uint32_t val = rand() % (count * 10);
@@ -96,9 +99,31 @@ store_load_test()
 	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
 }
 
+void
+split_check_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	bloom_init(avx2_enabled_cpu());
+	uint32_t mismatch_count = 0;
+	struct bloom_split_block block;
+	for (uint32_t i = 0; i < 100000; i++) {
+		for (int j = 0; j < BLOOM_SPLIT_BLOCK_WORDS; j++)
+			block.words[j] = rand() | rand() | rand();
+		uint32_t hash = h(rand());
+		if (bloom_split_check(&block, hash) !=
+		    bloom_split_check_generic(&block, hash))
+			mismatch_count++;
+	}
+	cout << "mismatch_count = " << mismatch_count << endl;
+}
+
 int
 main(void)
 {
-	simple_test();
-	store_load_test();
+	simple_test(BLOOM_VERSION_BLOCKED);
+	simple_test(BLOOM_VERSION_SPLIT_BLOCK);
+	store_load_test(BLOOM_VERSION_BLOCKED);
+	store_load_test(BLOOM_VERSION_SPLIT_BLOCK);
+	split_check_test();
 }
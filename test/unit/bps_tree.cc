@@ -26,8 +26,16 @@
  * for this tree flavor to prevent this.
  */
 # define SMALL_BLOCK_SIZE 256
+#elif defined(TEST_LEAF_HINTS)
+/*
+ * Only the main test tree stores hints, see below. Hints take a half
+ * of a leaf so let's make the block size greater to have enough
+ * elements in a leaf to visit all the rebalancing branches.
+ */
+# define SMALL_BLOCK_SIZE 256
 #else
-# error "Please define TEST_DEFAULT, TEST_INNER_CARD or TEST_INNER_CHILD_CARDS."
+# error "Please define TEST_DEFAULT, TEST_INNER_CARD, TEST_INNER_CHILD_CARDS " \
+	"or TEST_LEAF_HINTS."
 #endif
 
 SPTREE_DEF(test, realloc, qsort_arg);
@@ -38,6 +46,22 @@ typedef int64_t type_t;
 static int
 compare(type_t a, type_t b);
 
+#if defined(TEST_LEAF_HINTS)
+/**
+ * Order-preserving hint of a value. Every 16 neighbouring values share
+ * the same hint to check that the search handles hint ties, and values
+ * divisible by 1000 have no hint to check the fallback to the search
+ * by comparison.
+ */
+static inline uint64_t
+test_hint(type_t v)
+{
+	if (v % 1000 == 0)
+		return UINT64_MAX;
+	return ((uint64_t)v ^ (1ULL << 63)) >> 4;
+}
+#endif
+
 /* check compiling with another name and settings */
 #define BPS_TREE_NAME testtest
 #define BPS_TREE_BLOCK_SIZE 512
@@ -70,7 +94,15 @@ compare(type_t a, type_t b);
 #define bps_tree_key_t type_t
 #define bps_tree_arg_t int
 #define BPS_TREE_DEBUG_BRANCH_VISIT
+#if defined(TEST_LEAF_HINTS)
+# define BPS_TREE_ELEM_HINT(elem) test_hint(elem)
+# define BPS_TREE_KEY_HINT(key, arg) test_hint(key)
+# define BPS_LEAF_HINTS
+#endif
 #include "salad/bps_tree.h"
+#undef BPS_TREE_ELEM_HINT
+#undef BPS_TREE_KEY_HINT
+#undef BPS_LEAF_HINTS
 #undef BPS_TREE_NAME
 #undef BPS_TREE_BLOCK_SIZE
 #undef BPS_TREE_EXTENT_SIZE
@@ -918,10 +950,56 @@ insert_successor_test()
 	ok(true, "successor test");
 }
 
+static void
+bound_search_test()
+{
+	test tree;
+	test_create(&tree, 0, extent_alloc, extent_free, &extents_count, NULL);
+
+	/* Dense and sparse runs of values to get many hint ties. */
+	const type_t limit = 5000;
+	for (type_t v = -limit; v < limit; v += 1 + rand() % 20)
+		test_insert(&tree, v, 0, 0);
+	debug_check(&tree);
+
+	for (type_t key = -limit - 10; key < limit + 10; key++) {
+		type_t expect_lower = 0, expect_upper = 0;
+		bool has_lower = false, has_upper = false;
+		struct test_iterator itr = test_first(&tree);
+		for (type_t *v; (v = test_iterator_get_elem(&tree, &itr));
+		     test_iterator_next(&tree, &itr)) {
+			if (!has_lower && *v >= key) {
+				expect_lower = *v;
+				has_lower = true;
+			}
+			if (*v > key) {
+				expect_upper = *v;
+				has_upper = true;
+				break;
+			}
+		}
+		bool exact = false;
+		itr = test_lower_bound(&tree, key, &exact);
+		type_t *v = test_iterator_get_elem(&tree, &itr);
+		fail_unless(has_lower == (v != NULL));
+		fail_unless(!has_lower || *v == expect_lower);
+		fail_unless(exact == (has_lower && expect_lower == key));
+		itr = test_upper_bound(&tree, key, &exact);
+		v = test_iterator_get_elem(&tree, &itr);
+		fail_unless(has_upper == (v != NULL));
+		fail_unless(!has_upper || *v == expect_upper);
+		v = test_find(&tree, key);
+		fail_unless((v != NULL) == (has_lower && expect_lower == key));
+	}
+
+	test_destroy(&tree);
+	ok(true, "bound search test");
+}
+
 int
 main(void)
 {
-	plan(12);
+	plan(13);
 	header();
 
 	simple_check();
@@ -936,6 +1014,7 @@ main(void)
 	insert_get_iterator();
 	delete_value_check();
 	insert_successor_test();
+	bound_search_test();
 
 	footer();
 	return check_plan();
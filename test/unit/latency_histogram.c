@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "latency_histogram.h"
+#include "trivia/util.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+static void
+test_buckets(void)
+{
+	plan(4);
+	header();
+
+	bool success = true;
+	for (uint64_t v = 0; v < 1000000; v++) {
+		int bucket = latency_histogram_bucket(v);
+		uint64_t max = latency_histogram_bucket_max(bucket);
+		if (v > max || (bucket > 0 &&
+				v <= latency_histogram_bucket_max(bucket - 1))) {
+			success = false;
+			break;
+		}
+	}
+	ok(success, "values fall into the right buckets");
+	success = true;
+	for (int i = LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+	     i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+		uint64_t min = latency_histogram_bucket_max(i - 1) + 1;
+		uint64_t max = latency_histogram_bucket_max(i);
+		if ((double)(max - min + 1) / min >
+		    1.0 / LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+			success = false;
+			break;
+		}
+	}
+	ok(success, "bucket width is bounded by the relative error");
+	is(latency_histogram_bucket(UINT64_MAX),
+	   LATENCY_HISTOGRAM_BUCKET_COUNT - 1, "huge value");
+	is(latency_histogram_bucket_max(LATENCY_HISTOGRAM_BUCKET_COUNT - 1),
+	   (1ULL << LATENCY_HISTOGRAM_VALUE_BITS) - 1, "last bucket");
+
+	footer();
+	check_plan();
+}
+
+static void
+test_percentile(void)
+{
+	plan(9);
+	header();
+
+	struct latency_histogram hist;
+	memset(&hist, 0, sizeof(hist));
+	is(latency_histogram_count(&hist), 0, "empty count");
+	is(latency_histogram_percentile(&hist, 99), 0, "empty percentile");
+
+	/* 1..1000 microseconds. */
+	for (uint64_t v = 1; v <= 1000; v++)
+		latency_histogram_collect(&hist, v * 1000);
+	is(latency_histogram_count(&hist), 1000, "count");
+	is(hist.max, 1000, "max");
+	is(hist.sum, 1000 * 1001 / 2, "sum");
+	double p50 = latency_histogram_percentile(&hist, 50) * 1000000;
+	double p99 = latency_histogram_percentile(&hist, 99) * 1000000;
+	double p100 = latency_histogram_percentile(&hist, 100) * 1000000;
+	ok(p50 >= 500 && p50 <= 500 * 17.0 / 16, "p50 %f", p50);
+	ok(p99 >= 990 && p99 <= 990 * 17.0 / 16, "p99 %f", p99);
+	is(p100, 1000, "p100");
+
+	struct latency_histogram sum;
+	memset(&sum, 0, sizeof(sum));
+	latency_histogram_merge(&sum, &hist);
+	latency_histogram_merge(&sum, &hist);
+	latency_histogram_reset(&hist);
+	ok(latency_histogram_count(&sum) == 2000 &&
+	   latency_histogram_count(&hist) == 0 &&
+	   latency_histogram_percentile(&sum, 50) ==
+	   (double)p50 / 1000000, "merge and reset");
+
+	footer();
+	check_plan();
+}
+
+int
+main(void)
+{
+	plan(2);
+	test_buckets();
+	test_percentile();
+	return check_plan();
+}
@@ -348,15 +348,99 @@ test_iterator_skip_prepared(void)
 	check_plan();
 }
 
+/** Emulate a point lookup of a key that is found on disk. */
+static void
+cache_add_point(struct vy_cache *cache, struct tuple_format *format, int key)
+{
+	const struct vy_stmt_template stmt_templ =
+		STMT_TEMPLATE(1, REPLACE, key);
+	const struct vy_stmt_template key_templ =
+		STMT_TEMPLATE(0, SELECT, key);
+	struct vy_entry entry = vy_new_simple_stmt(format, cache->cmp_def,
+						   &stmt_templ);
+	struct vy_entry key_entry = vy_new_simple_stmt(format, cache->cmp_def,
+						       &key_templ);
+	vy_cache_add_point(cache, entry, key_entry);
+	tuple_unref(entry.stmt);
+	tuple_unref(key_entry.stmt);
+}
+
+/** Check if the given key is in the cache. */
+static bool
+cache_has_key(struct vy_cache *cache, struct tuple_format *format, int key)
+{
+	const struct vy_stmt_template key_templ =
+		STMT_TEMPLATE(0, SELECT, key);
+	struct vy_entry key_entry = vy_new_simple_stmt(format, cache->cmp_def,
+						       &key_templ);
+	struct vy_entry entry = vy_cache_get(cache, key_entry);
+	tuple_unref(key_entry.stmt);
+	return entry.stmt != NULL;
+}
+
+static void
+test_scan_resistance(void)
+{
+	header();
+	plan(8);
+	struct vy_cache cache;
+	uint32_t fields[] = { 0 };
+	uint32_t types[] = { FIELD_TYPE_UNSIGNED };
+	struct key_def *key_def;
+	struct tuple_format *format;
+	create_test_cache(fields, types, lengthof(fields), &cache, &key_def,
+			  &format);
+	size_t quota = cache_env.mem_quota;
+
+	/* Keys 1..8 are read twice, key 9 is read once. */
+	for (int i = 1; i <= 9; i++)
+		cache_add_point(&cache, format, i);
+	for (int i = 1; i <= 8; i++)
+		cache_add_point(&cache, format, i);
+	is(cache_env.protected_mem_used, cache.mem_used * 8 / 9,
+	   "keys read twice are protected");
+
+	/* Make room for 16 keys and scan 100 keys. */
+	vy_cache_env_set_quota(&cache_env, cache.mem_used / 9 * 16);
+	for (int i = 101; i <= 200; i++)
+		cache_add_point(&cache, format, i);
+	ok(vy_cache_tree_size(&cache.cache_tree) <= 17, "quota is respected");
+	ok(cache.stat.evict.rows > 0, "scan evicts keys");
+	bool hot_keys_cached = true;
+	for (int i = 1; i <= 8; i++) {
+		if (!cache_has_key(&cache, format, i))
+			hot_keys_cached = false;
+	}
+	ok(hot_keys_cached, "keys read twice survive scan");
+	ok(!cache_has_key(&cache, format, 9), "key read once is evicted");
+
+	/* The cache evicts its own oldest keys to fit in its quota. */
+	vy_cache_env_set_quota(&cache_env, quota);
+	cache.mem_quota = cache.mem_used;
+	size_t evicted = cache.stat.evict.rows;
+	for (int i = 201; i <= 210; i++)
+		cache_add_point(&cache, format, i);
+	ok(cache.mem_used <= cache.mem_quota, "own quota is respected");
+	ok(cache_has_key(&cache, format, 210),
+	   "new keys are added to cache over its quota");
+	ok(cache.stat.evict.rows >= evicted + 10,
+	   "own oldest keys are evicted");
+
+	destroy_test_cache(&cache, key_def, format);
+	check_plan();
+	footer();
+}
+
 int
 main(void)
 {
 	vy_iterator_C_test_init(1LLU * 1024LLU * 1024LLU * 1024LLU);
 
-	plan(2);
+	plan(3);
 
 	test_basic();
 	test_iterator_skip_prepared();
+	test_scan_resistance();
 
 	vy_iterator_C_test_finish();
 	return check_plan();
@@ -21,13 +21,15 @@ void index_delete(struct index *index) { unreachable(); }
 
 static int
 write_run(struct vy_run *run, const char *dir_name,
-	  struct vy_lsm *lsm, struct vy_stmt_stream *wi)
+	  struct vy_lsm *lsm, struct vy_stmt_stream *wi,
+	  uint32_t restart_interval, bool page_fences)
 {
 	struct vy_run_writer writer;
 	if (vy_run_writer_create(&writer, run, dir_name,
 				 lsm->space_id, lsm->index_id,
 				 lsm->cmp_def, lsm->key_def,
-				 4096, 0.1, false) != 0)
+				 4096, 0.1, restart_interval, page_fences,
+				 false) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
@@ -202,7 +204,7 @@ test_basic()
 	struct vy_run *run = vy_run_new(&run_env, 1);
 	isnt(run, NULL, "vy_run_new");
 
-	rc = write_run(run, dir_name, pk, write_stream);
+	rc = write_run(run, dir_name, pk, write_stream, 0, false);
 	is(rc, 0, "vy_run_write");
 
 	write_stream->iface->close(write_stream);
@@ -233,7 +235,8 @@ test_basic()
 	run = vy_run_new(&run_env, 2);
 	isnt(run, NULL, "vy_run_new");
 
-	rc = write_run(run, dir_name, pk, write_stream);
+	/* Store this run prefix-compressed, with page fences. */
+	rc = write_run(run, dir_name, pk, write_stream, 4, true);
 	is(rc, 0, "vy_run_write");
 
 	write_stream->iface->close(write_stream);
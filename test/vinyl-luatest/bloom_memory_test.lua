@@ -0,0 +1,96 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg({vinyl_bloom_memory = 0})
+        for i = 1, 4 do
+            local s = box.space['test' .. i]
+            if s ~= nil then
+                s:drop()
+            end
+        end
+    end)
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.vinyl_bloom_memory, 0)
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'vinyl_bloom_memory': " ..
+            "must be greater than or equal to 0",
+            box.cfg, {vinyl_bloom_memory = -1})
+        box.cfg({vinyl_bloom_memory = 1024 * 1024})
+        t.assert_equals(box.cfg.vinyl_bloom_memory, 1024 * 1024)
+    end)
+end
+
+g.test_eviction = function(cg)
+    cg.server:exec(function()
+        local spaces = {}
+        local bloom_size = 0
+        local max_bloom_size = 0
+        for i = 1, 4 do
+            local s = box.schema.space.create('test' .. i,
+                                              {engine = 'vinyl'})
+            s:create_index('pk')
+            box.begin()
+            for k = 1, 1000 do
+                s:replace({k * 2, i})
+            end
+            box.commit()
+            box.snapshot()
+            local size = s.index.pk:stat().disk.bloom_size
+            t.assert_gt(size, 0)
+            bloom_size = bloom_size + size
+            max_bloom_size = math.max(max_bloom_size, size)
+            table.insert(spaces, s)
+        end
+        t.assert_equals(box.stat.vinyl().memory.bloom_filter, bloom_size)
+
+        -- Bloom filters that don't fit are freed.
+        box.cfg({vinyl_bloom_memory = max_bloom_size})
+        t.assert_le(box.stat.vinyl().memory.bloom_filter, max_bloom_size)
+        -- Index statistics still show the size of all bloom filters.
+        local total = 0
+        for _, s in ipairs(spaces) do
+            total = total + s.index.pk:stat().disk.bloom_size
+        end
+        t.assert_equals(total, bloom_size)
+
+        -- They are loaded back on demand and still filter out
+        -- lookups of missing keys.
+        for _ = 1, 2 do
+            for i, s in ipairs(spaces) do
+                for k = 1, 100 do
+                    t.assert_equals(s:get(k * 2), {k * 2, i})
+                    t.assert_equals(s:get(k * 2 + 1), nil)
+                end
+                t.assert_le(box.stat.vinyl().memory.bloom_filter,
+                            max_bloom_size)
+            end
+        end
+        for _, s in ipairs(spaces) do
+            t.assert_gt(s.index.pk:stat().disk.iterator.bloom.hit, 0)
+        end
+
+        -- When the limit is raised, bloom filters are loaded on demand
+        -- and stay in memory.
+        box.cfg({vinyl_bloom_memory = 1024 * 1024 * 1024})
+        for _, s in ipairs(spaces) do
+            t.assert_equals(s:get(1), nil)
+        end
+        t.assert_equals(box.stat.vinyl().memory.bloom_filter, bloom_size)
+    end)
+end
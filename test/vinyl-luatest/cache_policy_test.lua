@@ -0,0 +1,110 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {vinyl_cache = 256 * 1024}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'hot', 'cold', 'test'}) do
+            if box.space[name] ~= nil then
+                box.space[name]:drop()
+            end
+        end
+    end)
+end)
+
+g.test_scan_resistance = function(cg)
+    cg.server:exec(function()
+        local hot = box.schema.space.create('hot', {engine = 'vinyl'})
+        hot:create_index('pk')
+        local cold = box.schema.space.create('cold', {engine = 'vinyl'})
+        cold:create_index('pk')
+        local pad = string.rep('x', 1000)
+        for i = 1, 100 do
+            hot:replace({i, i})
+        end
+        for i = 1, 2000 do
+            cold:replace({i, pad})
+        end
+        box.snapshot()
+
+        -- The working set of the hot space is read twice.
+        for _ = 1, 2 do
+            for i = 1, 100 do
+                hot:get(i)
+            end
+        end
+        local st = hot.index.pk:stat().cache
+        t.assert_equals(st.hit, 100)
+        t.assert_equals(st.miss, 100)
+        t.assert_equals(st.lookup, 200)
+
+        -- A scan of the cold space doesn't fit in the cache.
+        local count = 0
+        for _ in cold:pairs() do
+            count = count + 1
+        end
+        t.assert_equals(count, 2000)
+        t.assert_gt(cold.index.pk:stat().cache.evict.rows, 0)
+
+        -- But it doesn't evict the working set of the hot space.
+        for i = 1, 100 do
+            t.assert_equals(hot:get(i), {i, i})
+        end
+        st = hot.index.pk:stat().cache
+        t.assert_equals(st.evict.rows, 0)
+        t.assert_equals(st.hit, 200)
+        t.assert_equals(st.miss, 100)
+
+        -- Hits and misses are reset along with the other statistics.
+        box.stat.reset()
+        st = hot.index.pk:stat().cache
+        t.assert_equals(st.hit, 0)
+        t.assert_equals(st.miss, 0)
+    end)
+end
+
+g.test_cache_size = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_equals(
+            'Wrong index options: cache_size must be greater than ' ..
+            'or equal to 0',
+            s.create_index, s, 'pk', {cache_size = -1})
+        s:create_index('pk', {cache_size = 10 * 1024})
+        t.assert_equals(s.index.pk.options.cache_size, 10 * 1024)
+        local pad = string.rep('x', 100)
+        for i = 1, 1000 do
+            s:replace({i, pad})
+        end
+        box.snapshot()
+        for i = 1, 1000 do
+            s:get(i)
+        end
+        local st = s.index.pk:stat().cache
+        t.assert_le(st.bytes, 10 * 1024)
+        t.assert_gt(st.rows, 0)
+
+        -- Old tuples are evicted to make room for new ones.
+        t.assert_gt(st.evict.rows, 0)
+        s:get(1000)
+        t.assert_equals(s.index.pk:stat().cache.hit, st.hit + 1)
+
+        -- The limit can be changed without rebuilding the index.
+        s.index.pk:alter({cache_size = 0})
+        t.assert_equals(s.index.pk.options.cache_size, nil)
+        for i = 1, 1000 do
+            s:get(i)
+        end
+        t.assert_equals(s.index.pk:stat().cache.rows, 1000)
+    end)
+end
@@ -0,0 +1,120 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    -- 3 compaction threads.
+    cg.server = server:new({box_cfg = {vinyl_write_threads = 4}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.error.injection ~= nil then
+            box.error.injection.set('ERRINJ_VY_RUN_WRITE', false)
+            box.error.injection.set('ERRINJ_VY_SCHED_TIMEOUT', 0)
+        end
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Creates a space with a range that is big enough to split its
+-- compaction in parts and two runs in it.
+local function fill(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {
+            range_size = 64 * 1024,
+            page_size = 1024,
+            run_count_per_level = 100, -- disables auto-compaction
+        })
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        local pad = string.rep('x', 100)
+        box.begin()
+        for i = 1, 3000 do
+            s:insert({i, i % 100, pad})
+        end
+        box.commit()
+        box.snapshot()
+        box.begin()
+        for i = 1, 3000, 10 do
+            s:replace({i, i % 100 + 1, pad})
+        end
+        box.commit()
+        box.snapshot()
+        t.assert_equals(s.index.pk:stat().range_count, 1)
+        t.assert_equals(s.index.pk:stat().run_count, 2)
+    end)
+end
+
+local function check(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:count(), 3000)
+        t.assert_equals(s.index.sk:count(), 3000)
+        for i = 1, 3000, 7 do
+            local v = i % 10 == 1 and i % 100 + 1 or i % 100
+            t.assert_equals(s:get(i)[2], v)
+        end
+        t.assert_equals(#s.index.sk:select({2}), 60)
+    end)
+end
+
+g.test_split = function(cg)
+    fill(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.stat.vinyl().scheduler.tasks_inprogress, 0)
+            t.assert_equals(s.index.pk:stat().run_count, 3)
+        end)
+        -- The range is split in as many parts as there are compaction
+        -- threads, each of which writes its own run.
+        t.assert_equals(s.index.pk:stat().range_count, 3)
+        t.assert_equals(s.index.pk:stat().disk.compaction.count, 1)
+    end)
+    check(cg)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.pk:stat().range_count, 3)
+        t.assert_equals(s.index.pk:stat().run_count, 3)
+    end)
+    check(cg)
+end
+
+g.test_split_error = function(cg)
+    t.tarantool.skip_if_not_debug()
+    fill(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local tasks_failed = box.stat.vinyl().scheduler.tasks_failed
+        box.error.injection.set('ERRINJ_VY_SCHED_TIMEOUT', 0.01)
+        box.error.injection.set('ERRINJ_VY_RUN_WRITE', true)
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_gt(box.stat.vinyl().scheduler.tasks_failed,
+                        tasks_failed)
+        end)
+        t.assert_equals(s.index.pk:stat().range_count, 1)
+        t.assert_equals(s.index.pk:stat().run_count, 2)
+    end)
+    check(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.error.injection.set('ERRINJ_VY_RUN_WRITE', false)
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.pk:stat().run_count, 3)
+        end)
+        t.assert_equals(s.index.pk:stat().range_count, 3)
+    end)
+    check(cg)
+end
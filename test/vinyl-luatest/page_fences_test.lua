@@ -0,0 +1,130 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'plain', 'fenced', 'test'}) do
+            if box.space[name] ~= nil then
+                box.space[name]:drop()
+            end
+        end
+    end)
+end)
+
+g.test_option = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_contains("should be of type boolean",
+                                    s.create_index, s, 'pk',
+                                    {page_fences = 1})
+        s:create_index('pk')
+        t.assert_equals(s.index.pk.options.page_fences, nil)
+        s.index.pk:alter({page_fences = true})
+        t.assert_equals(s.index.pk.options.page_fences, true)
+    end)
+end
+
+-- Fills two spaces with the same data, one of them stored with
+-- page fences. Only odd keys are inserted so that even keys fall
+-- between pages.
+local function fill()
+    local pad = string.rep('x', 100)
+    for _, name in ipairs({'plain', 'fenced'}) do
+        local s = box.schema.space.create(name, {engine = 'vinyl'})
+        s:create_index('pk', {
+            page_size = 1024,
+            bloom_fpr = 1,
+            page_fences = name == 'fenced' or nil,
+        })
+        box.begin()
+        for i = 1, 1000, 2 do
+            s:replace({i, pad})
+        end
+        box.commit()
+        box.snapshot()
+    end
+end
+
+g.test_skip = function(cg)
+    cg.server:exec(fill)
+    cg.server:exec(function()
+        local plain = box.space.plain
+        local fenced = box.space.fenced
+        local function pages(s)
+            return s.index.pk:stat().disk.iterator.read.pages
+        end
+        t.assert_equals(fenced.index.pk:stat().disk.pages,
+                        plain.index.pk:stat().disk.pages)
+        t.assert_gt(fenced.index.pk:stat().disk.pages, 10)
+
+        -- Pages that end before the searched key aren't read.
+        for _, it in ipairs({'EQ', 'GE', 'GT', 'LE', 'LT'}) do
+            local opts = {iterator = it, limit = 1}
+            for k = 0, 1002, 2 do
+                t.assert_equals(fenced:select({k}, opts),
+                                plain:select({k}, opts))
+            end
+        end
+        t.assert_lt(pages(fenced), pages(plain))
+    end)
+    -- Restart to make sure the data isn't read from the cache.
+    cg.server:restart()
+    cg.server:exec(function()
+        local plain = box.space.plain
+        local fenced = box.space.fenced
+        local function pages(s)
+            return s.index.pk:stat().disk.iterator.read.pages
+        end
+
+        -- Runs that end before the searched key aren't read.
+        t.assert_equals(plain:select({1000}, {iterator = 'GE'}), {})
+        t.assert_equals(plain:select({999}, {iterator = 'GT'}), {})
+        t.assert_equals(plain:select({0}, {iterator = 'LE'}), {})
+        t.assert_equals(plain:get({1001}), nil)
+        t.assert_gt(plain.index.pk:stat().disk.iterator.lookup, 0)
+        t.assert_equals(pages(plain), 0)
+
+        -- Page fences are loaded from the index file on recovery.
+        for k = 0, 1002, 2 do
+            t.assert_equals(fenced:get({k}), nil)
+            t.assert_equals(plain:get({k}), nil)
+        end
+        t.assert_lt(pages(fenced), pages(plain))
+    end)
+end
+
+g.test_xlog_reader = function(cg)
+    cg.server:exec(fill)
+    cg.server:exec(function()
+        local fio = require('fio')
+        local xlog = require('xlog')
+        local function count_max_keys(s)
+            local dir = fio.pathjoin(box.cfg.vinyl_dir, s.id, s.index.pk.id)
+            local count = 0
+            for _, path in ipairs(fio.glob(fio.pathjoin(dir, '*.index'))) do
+                for _, row in xlog.pairs(path) do
+                    if row.HEADER.type == 'PAGEINFO' and
+                            row.BODY.max_key ~= nil then
+                        t.assert_type(row.BODY.max_key, 'table')
+                        count = count + 1
+                    end
+                end
+            end
+            return count
+        end
+        t.assert_equals(count_max_keys(box.space.plain), 0)
+        t.assert_equals(count_max_keys(box.space.fenced),
+                        box.space.fenced.index.pk:stat().disk.pages)
+    end)
+end
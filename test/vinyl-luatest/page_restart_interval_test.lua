@@ -0,0 +1,187 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'plain', 'compressed', 'test'}) do
+            if box.space[name] ~= nil then
+                box.space[name]:drop()
+            end
+        end
+    end)
+end)
+
+g.test_option = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        local msg = 'Wrong index options: page_restart_interval must be ' ..
+                    'greater than or equal to 0 and less than or equal ' ..
+                    'to 65535'
+        t.assert_error_msg_equals(msg, s.create_index, s, 'pk',
+                                  {page_restart_interval = -1})
+        t.assert_error_msg_equals(msg, s.create_index, s, 'pk',
+                                  {page_restart_interval = 65536})
+        s:create_index('pk')
+        t.assert_equals(s.index.pk.options.page_restart_interval, nil)
+        s.index.pk:alter({page_restart_interval = 16})
+        t.assert_equals(s.index.pk.options.page_restart_interval, 16)
+    end)
+end
+
+-- Fills two spaces with the same data, one of them stored with
+-- prefix compression.
+local function fill()
+    local function create(name, restart_interval)
+        local s = box.schema.space.create(name, {engine = 'vinyl'})
+        s:create_index('pk', {
+            parts = {{1, 'string'}, {2, 'unsigned'}},
+            page_size = 1024,
+            page_restart_interval = restart_interval,
+        })
+        s:create_index('sk', {
+            parts = {{3, 'string'}},
+            unique = false,
+            page_size = 1024,
+            page_restart_interval = restart_interval,
+        })
+        return s
+    end
+    local plain = create('plain', 0)
+    local compressed = create('compressed', 16)
+    for _, s in ipairs({plain, compressed}) do
+        box.begin()
+        for tenant = 1, 5 do
+            local prefix = string.format('tenant-%016d', tenant)
+            for id = 1, 300 do
+                s:replace({prefix, id, 'value-' .. id % 20})
+            end
+        end
+        box.commit()
+        box.snapshot()
+        -- Make the next run contain statements of all types.
+        box.begin()
+        for id = 1, 300, 3 do
+            local prefix = string.format('tenant-%016d', id % 5 + 1)
+            s:delete({prefix, id})
+            s:upsert({prefix, id + 1, 'upserted'}, {{'=', 3, 'updated'}})
+        end
+        box.commit()
+        box.snapshot()
+    end
+end
+
+-- Checks that the two spaces created by fill() have the same content.
+local function check()
+    local plain = box.space.plain
+    local compressed = box.space.compressed
+    t.assert_equals(compressed:select(), plain:select())
+    t.assert_equals(compressed.index.sk:select(), plain.index.sk:select())
+    for _, it in ipairs({'EQ', 'REQ', 'GE', 'GT', 'LE', 'LT'}) do
+        for tenant = 0, 6 do
+            local prefix = string.format('tenant-%016d', tenant)
+            local opts = {iterator = it, limit = 20}
+            t.assert_equals(compressed:select({prefix}, opts),
+                            plain:select({prefix}, opts))
+            for id = 0, 301, 7 do
+                t.assert_equals(compressed:select({prefix, id}, opts),
+                                plain:select({prefix, id}, opts))
+            end
+        end
+        for v = 0, 21 do
+            local opts = {iterator = it, limit = 20}
+            local key = {'value-' .. v}
+            t.assert_equals(compressed.index.sk:select(key, opts),
+                            plain.index.sk:select(key, opts))
+        end
+    end
+end
+
+g.test_read = function(cg)
+    cg.server:exec(fill)
+    cg.server:exec(function()
+        local plain = box.space.plain
+        local compressed = box.space.compressed
+        for _, name in ipairs({'pk', 'sk'}) do
+            local bytes_plain = plain.index[name]:stat().disk.bytes
+            local bytes = compressed.index[name]:stat().disk.bytes
+            t.assert_lt(bytes, bytes_plain)
+        end
+    end)
+    cg.server:exec(check)
+    -- Restart to make sure the data is read from disk.
+    cg.server:restart()
+    cg.server:exec(check)
+    cg.server:exec(function()
+        -- Compact the runs and check that the result is readable.
+        box.space.compressed.index.pk:alter({page_restart_interval = 4})
+        for _, s in ipairs({box.space.plain, box.space.compressed}) do
+            s.index.pk:compact()
+            s.index.sk:compact()
+        end
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.stat.vinyl().scheduler.tasks_inprogress, 0)
+            t.assert_equals(box.space.compressed.index.pk:stat().run_count,
+                            1)
+        end)
+    end)
+    cg.server:exec(check)
+end
+
+g.test_xlog_reader = function(cg)
+    cg.server:exec(fill)
+    cg.server:exec(function()
+        local fio = require('fio')
+        local xlog = require('xlog')
+        local s = box.space.compressed
+        local dir = fio.pathjoin(box.cfg.vinyl_dir, s.id, s.index.pk.id)
+        local stmts = 0
+        local deltas = 0
+        for _, path in ipairs(fio.glob(fio.pathjoin(dir, '*.run'))) do
+            for _, row in xlog.pairs(path) do
+                if row.HEADER.type == 'ROWDELTA' then
+                    t.assert_type(row.BODY.TYPE, 'number')
+                    t.assert_type(row.BODY.PREFIX_SIZE, 'number')
+                    t.assert_type(row.BODY.SUFFIX, 'string')
+                    deltas = deltas + 1
+                end
+                if row.HEADER.type ~= 'ROWINDEX' then
+                    stmts = stmts + 1
+                end
+            end
+        end
+        t.assert_gt(deltas, 0)
+        t.assert_equals(stmts, s.index.pk:stat().disk.rows)
+    end)
+end
+
+g.test_rebuild_index = function(cg)
+    cg.server:exec(fill)
+    cg.server:exec(function()
+        local fio = require('fio')
+        for _, name in ipairs({'plain', 'compressed'}) do
+            local s = box.space[name]
+            for _, index in ipairs({s.index.pk, s.index.sk}) do
+                local dir = fio.pathjoin(box.cfg.vinyl_dir, s.id, index.id)
+                for _, path in ipairs(fio.glob(fio.pathjoin(dir,
+                                                            '*.index'))) do
+                    fio.unlink(path)
+                end
+            end
+        end
+    end)
+    -- Index files are rebuilt from run files on recovery.
+    cg.server:restart({box_cfg = {force_recovery = true}})
+    cg.server:exec(check)
+    cg.server:restart({box_cfg = {force_recovery = false}})
+end
@@ -46,8 +46,8 @@ for i, path in pairs(files) do
         local rows = {}
         local i = 1
         for lsn, row in xlog.pairs(path) do
-            if row.BODY.bloom_filter ~= nil then
-                row.BODY.bloom_filter = '<bloom_filter>'
+            if row.BODY.bloom_filter_split ~= nil then
+                row.BODY.bloom_filter_split = '<bloom_filter>'
             end
             rows[i] = row
             i = i + 1
@@ -72,11 +72,16 @@ end;
 --
 -- Filter dump/compaction time as we need error injection to
 -- test them properly.
+--
+-- Filter cache hits and misses, they are checked by
+-- vinyl-luatest/cache_policy_test.lua.
 function istat()
     local st = box.space.test.index.pk:stat()
     st.latency = nil
     st.disk.dump.time = nil
     st.disk.compaction.time = nil
+    st.cache.hit = nil
+    st.cache.miss = nil
     return st
 end;
 